@@ -15,21 +15,15 @@ def compute_array(meshpath, src_coord, lis_coord, r, s, micarray):
     src = ps.Source(src_coord)
     src.radius = 0.01
 
+    # one listener propagates the scene once for the whole array and outputs a channel per microphone
+    lis = ps.Listener(list(lis_coord))
+    lis.radius = 0.01
+    lis.microphones = np.asarray(micarray).tolist()
+
+    res_ch = scene.computeIR([src], [lis], ctx)
     res = {}
-    res_buffer = []
-    rate = 0
-    for offset in micarray:
-        lis = ps.Listener((offset + lis_coord).tolist())
-        lis.radius = 0.01
-
-        res_ch = scene.computeIR([src], [lis], ctx)
-        rate = res_ch['rate']
-        sa = res_ch['samples'][0][0][0]
-        res['rate'] = rate
-        res_buffer.append(sa)
-    res['samples'] = np.zeros((len(res_buffer), np.max([len(ps) for ps in res_buffer])))
-    for i, c in enumerate(res_buffer):
-        res['samples'][i, :len(c)] = c
+    res['rate'] = res_ch['rate']
+    res['samples'] = np.array(res_ch['samples'][0][0])
     return res
 
 
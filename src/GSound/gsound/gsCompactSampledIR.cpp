@@ -0,0 +1,428 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/gsCompactSampledIR.cpp
+ * Contents:    gsound::CompactSampledIR class implementation
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+#include "gsCompactSampledIR.h"
+
+
+//##########################################################################################
+//******************************  Start GSound Namespace  **********************************
+GSOUND_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+const Float CompactSampledIR:: BLOCK_PEAK = 16384.0f;
+const Float CompactSampledIR:: MIN_HALF_FLOAT = 6.103515625e-5f;
+const Float CompactSampledIR:: MAX_HALF_FLOAT = 65504.0f;
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Constructors
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+CompactSampledIR:: CompactSampledIR()
+	:	numBlocks( 0 ),
+		startOffset( math::max<Index>() ),
+		numSamples( 0 ),
+		sampleRate( 0 ),
+		sourceDirectionsEnabled( false )
+{
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Compression Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void CompactSampledIR:: compress( const SampledIR& ir )
+{
+	sampleRate = ir.getSampleRate();
+	sourceDirectionsEnabled = ir.getSourceDirectionsEnabled() && ir.getSourceDirections() != NULL;
+	numSamples = ir.getLengthInSamples();
+	startOffset = ir.getStartTimeInSamples();
+	numBlocks = (numSamples - startOffset + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	blocks.setSize( numBlocks );
+	
+	const Float* const inputIntensity = ir.getIntensity();
+	const Vector3f* const inputDirections = ir.getDirections();
+	const Vector3f* const inputSourceDirections = ir.getSourceDirections();
+	
+	// The number of bytes that are stored for each sample of a block.
+	const Size sampleBytes = numFrequencyBands*sizeof(HalfFloat) +
+							(sourceDirectionsEnabled ? 2 : 1)*sizeof(Direction);
+	
+	//******************************************************************************
+	// Find the scale and number of non-zero samples for each block.
+	
+	Size numStoredSamples = 0;
+	Size numPositions = 0;
+	
+	for ( Index b = 0; b < numBlocks; b++ )
+	{
+		Block& block = blocks[b];
+		const Index blockStart = startOffset + b*BLOCK_SIZE;
+		const Size blockLength = math::min( numSamples - blockStart, BLOCK_SIZE );
+		Float peak[numFrequencyBands] = { 0 };
+		Size numNonZero = 0;
+		
+		for ( Index i = blockStart; i < blockStart + blockLength; i++ )
+		{
+			const Float* sample = inputIntensity + i*numFrequencyBands;
+			Bool nonZero = false;
+			
+			for ( Index k = 0; k < numFrequencyBands; k++ )
+			{
+				peak[k] = math::max( peak[k], sample[k] );
+				nonZero |= sample[k] > Float(0);
+			}
+			
+			numNonZero += nonZero;
+		}
+		
+		// Store the block densely if its sample positions would take more space than its zeros.
+		block.sampleStart = UInt32(numStoredSamples);
+		block.positionStart = UInt32(numPositions);
+		
+		if ( numNonZero*(sampleBytes + sizeof(UInt8)) >= blockLength*sampleBytes )
+			block.sampleCount = UInt32(blockLength);
+		else
+		{
+			block.sampleCount = UInt32(numNonZero);
+			numPositions += numNonZero;
+		}
+		
+		numStoredSamples += block.sampleCount;
+		
+		for ( Index k = 0; k < numFrequencyBands; k++ )
+			block.scale[k] = peak[k] / BLOCK_PEAK;
+	}
+	
+	//******************************************************************************
+	// Quantize the stored samples of each block.
+	
+	intensity.setSize( numStoredSamples*numFrequencyBands );
+	directions.setSize( numStoredSamples );
+	sourceDirections.setSize( sourceDirectionsEnabled ? numStoredSamples : 0 );
+	positions.setSize( numPositions );
+	
+	for ( Index b = 0; b < numBlocks; b++ )
+	{
+		const Block& block = blocks[b];
+		const Index blockStart = startOffset + b*BLOCK_SIZE;
+		const Size blockLength = math::min( numSamples - blockStart, BLOCK_SIZE );
+		const Bool dense = block.sampleCount == blockLength;
+		Float inverseScale[numFrequencyBands];
+		Index s = block.sampleStart;
+		Index p = block.positionStart;
+		
+		for ( Index k = 0; k < numFrequencyBands; k++ )
+			inverseScale[k] = block.scale[k] > Float(0) ? Float(1) / block.scale[k] : Float(0);
+		
+		for ( Index i = 0; i < blockLength && s < block.sampleStart + block.sampleCount; i++ )
+		{
+			const Index sampleIndex = blockStart + i;
+			const Float* sample = inputIntensity + sampleIndex*numFrequencyBands;
+			
+			if ( !dense )
+			{
+				Bool nonZero = false;
+				
+				for ( Index k = 0; k < numFrequencyBands; k++ )
+					nonZero |= sample[k] > Float(0);
+				
+				if ( !nonZero )
+					continue;
+				
+				positions[p++] = UInt8(i);
+			}
+			
+			HalfFloat* output = intensity.getPointer() + s*numFrequencyBands;
+			
+			for ( Index k = 0; k < numFrequencyBands; k++ )
+				output[k] = toHalfFloat( sample[k]*inverseScale[k] );
+			
+			directions[s] = encodeDirection( inputDirections[sampleIndex] );
+			
+			if ( sourceDirectionsEnabled )
+				sourceDirections[s] = encodeDirection( inputSourceDirections[sampleIndex] );
+			
+			s++;
+		}
+	}
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Expansion Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void CompactSampledIR:: expand( SampledIR& ir ) const
+{
+	// Make the output IR the right length, filled with zeros.
+	ir.clear();
+	ir.setSampleRate( sampleRate );
+	ir.setSourceDirectionsEnabled( sourceDirectionsEnabled );
+	ir.setLengthInSamples( numSamples );
+	ir.setStartTimeInSamples( startOffset );
+	
+	Float* const outputIntensity = ir.getIntensity();
+	Vector3f* const outputDirections = ir.getDirections();
+	Vector3f* const outputSourceDirections = ir.getSourceDirections();
+	
+	for ( Index b = 0; b < numBlocks; b++ )
+	{
+		const Block& block = blocks[b];
+		const Index blockStart = startOffset + b*BLOCK_SIZE;
+		const Size blockLength = math::min( numSamples - blockStart, BLOCK_SIZE );
+		const Bool dense = block.sampleCount == blockLength;
+		
+		for ( Index i = 0; i < block.sampleCount; i++ )
+		{
+			const Index s = block.sampleStart + i;
+			const Index sampleIndex = blockStart + (dense ? i : positions[block.positionStart + i]);
+			const HalfFloat* input = intensity.getPointer() + s*numFrequencyBands;
+			Float* output = outputIntensity + sampleIndex*numFrequencyBands;
+			
+			for ( Index k = 0; k < numFrequencyBands; k++ )
+				output[k] = Float(input[k])*block.scale[k];
+			
+			outputDirections[sampleIndex] = decodeDirection( directions[s] );
+			
+			if ( sourceDirectionsEnabled )
+				outputSourceDirections[sampleIndex] = decodeDirection( sourceDirections[s] );
+		}
+	}
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Total Intensity Computation Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+FrequencyBandResponse CompactSampledIR:: getTotalIntensity() const
+{
+	FrequencyBandResponse total( Float(0) );
+	
+	for ( Index b = 0; b < numBlocks; b++ )
+	{
+		const Block& block = blocks[b];
+		const HalfFloat* input = intensity.getPointer() + block.sampleStart*numFrequencyBands;
+		Float blockTotal[numFrequencyBands] = { 0 };
+		
+		for ( Index i = 0; i < block.sampleCount; i++, input += numFrequencyBands )
+		{
+			for ( Index k = 0; k < numFrequencyBands; k++ )
+				blockTotal[k] += Float(input[k]);
+		}
+		
+		for ( Index k = 0; k < numFrequencyBands; k++ )
+			total[k] += blockTotal[k]*block.scale[k];
+	}
+	
+	return total;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Reset Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void CompactSampledIR:: reset()
+{
+	blocks = Array<Block>();
+	intensity = Array<HalfFloat>();
+	directions = Array<Direction>();
+	sourceDirections = Array<Direction>();
+	positions = Array<UInt8>();
+	numBlocks = 0;
+	startOffset = math::max<Index>();
+	numSamples = 0;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Size in Bytes Accessor Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Size CompactSampledIR:: getSizeInBytes() const
+{
+	return sizeof(CompactSampledIR) + sizeof(Block)*blocks.getSize() + sizeof(HalfFloat)*intensity.getSize() +
+			sizeof(Direction)*(directions.getSize() + sourceDirections.getSize()) + sizeof(UInt8)*positions.getSize();
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Direction Quantization Methods
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+CompactSampledIR::Direction CompactSampledIR:: encodeDirection( const Vector3f& direction )
+{
+	Direction result;
+	const Float magnitude = direction.getMagnitude();
+	
+	if ( !(magnitude >= MIN_HALF_FLOAT) )
+	{
+		result.u = result.v = 0;
+		result.magnitude = HalfFloat( Float(0) );
+		return result;
+	}
+	
+	// Project the direction onto the octahedron, then fold the lower hemisphere over the upper one.
+	const Float l1 = math::abs( direction.x ) + math::abs( direction.y ) + math::abs( direction.z );
+	Float u = direction.x / l1;
+	Float v = direction.y / l1;
+	
+	if ( direction.z < Float(0) )
+	{
+		const Float foldedU = (Float(1) - math::abs( v ))*(u >= Float(0) ? Float(1) : Float(-1));
+		v = (Float(1) - math::abs( u ))*(v >= Float(0) ? Float(1) : Float(-1));
+		u = foldedU;
+	}
+	
+	result.u = Int16(math::round( math::clamp( u, Float(-1), Float(1) )*Float(32767) ));
+	result.v = Int16(math::round( math::clamp( v, Float(-1), Float(1) )*Float(32767) ));
+	result.magnitude = toHalfFloat( magnitude );
+	
+	return result;
+}
+
+
+
+
+Vector3f CompactSampledIR:: decodeDirection( const Direction& direction )
+{
+	const Float magnitude = direction.magnitude;
+	
+	if ( magnitude == Float(0) )
+		return Vector3f();
+	
+	// Unfold the lower hemisphere and project the octahedron back onto the sphere.
+	const Float u = Float(direction.u) / Float(32767);
+	const Float v = Float(direction.v) / Float(32767);
+	Vector3f result( u, v, Float(1) - math::abs( u ) - math::abs( v ) );
+	
+	if ( result.z < Float(0) )
+	{
+		result.x = (Float(1) - math::abs( v ))*(u >= Float(0) ? Float(1) : Float(-1));
+		result.y = (Float(1) - math::abs( u ))*(v >= Float(0) ? Float(1) : Float(-1));
+	}
+	
+	return result.normalize()*magnitude;
+}
+
+
+
+
+//##########################################################################################
+//******************************  End GSound Namespace  ************************************
+GSOUND_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
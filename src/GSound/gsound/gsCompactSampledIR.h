@@ -0,0 +1,367 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/gsCompactSampledIR.h
+ * Contents:    gsound::CompactSampledIR class declaration
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+#ifndef INCLUDE_GSOUND_COMPACT_SAMPLED_IR_H
+#define INCLUDE_GSOUND_COMPACT_SAMPLED_IR_H
+
+
+#include "gsConfig.h"
+
+
+#include "gsSampledIR.h"
+
+
+//##########################################################################################
+//******************************  Start GSound Namespace  **********************************
+GSOUND_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that stores a sampled IR in a reduced-precision, block-compressed format.
+/**
+  * A compact sampled IR holds the same information as a SampledIR in about a fifth
+  * of the memory, so that the IRs for large numbers of listeners can be kept
+  * in memory at once. The IR is divided into fixed-size blocks of samples. Each block
+  * stores its intensities as half floats relative to a per-band block scale, and its
+  * directions as 16-bit octahedral coordinates with a half float magnitude.
+  * Blocks that contain only a few non-zero samples (e.g. in a sparse IR tail) store
+  * just those samples along with their positions, and silent blocks store nothing.
+  *
+  * A compact IR cannot be modified. It is created from a SampledIR by compress(),
+  * and is converted back into a SampledIR by expand() when it needs to be rendered.
+  */
+class CompactSampledIR
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a new empty compact sampled IR of length 0.
+			CompactSampledIR();
+			
+			
+		//********************************************************************************
+		//******	Compression Methods
+			
+			
+			/// Replace the contents of this compact IR with a compressed version of the specified sampled IR.
+			void compress( const SampledIR& ir );
+			
+			
+			/// Replace the contents of the specified sampled IR with the decompressed contents of this IR.
+			/**
+			  * The sampled IR's storage is reallocated if necessary to hold this IR.
+			  */
+			void expand( SampledIR& ir ) const;
+			
+			
+		//********************************************************************************
+		//******	IR Start Time Accessor Methods
+			
+			
+			/// Return the delay time in samples of the first non-zero sample in this IR.
+			GSOUND_INLINE Size getStartTimeInSamples() const
+			{
+				return math::min( startOffset, numSamples );
+			}
+			
+			
+			/// Return the delay time in seconds of the first non-zero sample in this IR.
+			GSOUND_INLINE Float getStartTime() const
+			{
+				if ( sampleRate != SampleRate(0) )
+					return Float(math::min( startOffset, numSamples ) / sampleRate);
+				else
+					return Float(0);
+			}
+			
+			
+		//********************************************************************************
+		//******	IR Length Accessor Methods
+			
+			
+			/// Return the length in seconds of this IR.
+			GSOUND_INLINE Float getLength() const
+			{
+				if ( sampleRate != SampleRate(0) )
+					return Float(numSamples / sampleRate);
+				else
+					return Float(0);
+			}
+			
+			
+			/// Return the number of samples there are in this IR.
+			GSOUND_INLINE Size getLengthInSamples() const
+			{
+				return numSamples;
+			}
+			
+			
+		//********************************************************************************
+		//******	Sample Rate Accessor Method
+			
+			
+			/// Return the sample rate of this IR in samples per second.
+			GSOUND_INLINE SampleRate getSampleRate() const
+			{
+				return sampleRate;
+			}
+			
+			
+		//********************************************************************************
+		//******	Source Direction Accessor Method
+			
+			
+			/// Return whether or not this IR is storing source directions.
+			GSOUND_INLINE Bool getSourceDirectionsEnabled() const
+			{
+				return sourceDirectionsEnabled;
+			}
+			
+			
+		//********************************************************************************
+		//******	Total Energy Accessor Method
+			
+			
+			/// Compute and return the total fraction of the source's power contained in the impulse response for each frequency band.
+			FrequencyBandResponse getTotalIntensity() const;
+			
+			
+		//********************************************************************************
+		//******	IR Clear Methods
+			
+			
+			/// Reset the IR to be of length 0 with no impulses.
+			/**
+			  * This method keeps the IR storage to avoid many reallocations.
+			  */
+			GSOUND_INLINE void clear()
+			{
+				startOffset = math::max<Index>();
+				numSamples = 0;
+				numBlocks = 0;
+			}
+			
+			
+			/// Reset the IR to be of length 0 with no impulses.
+			/**
+			  * This method deallocates the IR storage.
+			  */
+			void reset();
+			
+			
+		//********************************************************************************
+		//******	IR Size Accessor Methods
+			
+			
+			/// Return the approximate size of the memory used by this compact IR.
+			Size getSizeInBytes() const;
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Class Declarations
+			
+			
+			/// A class that stores the location and scale of the samples for one block of the IR.
+			class Block
+			{
+				public:
+					
+					/// The index of the first stored sample for this block.
+					UInt32 sampleStart;
+					
+					/// The index of the first sample position for this block, if the block is sparse.
+					UInt32 positionStart;
+					
+					/// The number of samples that are stored for this block.
+					/**
+					  * If this is equal to the length of the block, the block is dense and
+					  * has no sample positions. If it is 0, the block is silent.
+					  */
+					UInt32 sampleCount;
+					
+					/// The scale factor that each stored intensity is multiplied by in each frequency band.
+					Float32 scale[GSOUND_FREQUENCY_COUNT];
+			};
+			
+			
+			/// A class that stores a direction quantized to 16-bit octahedral coordinates and a half float magnitude.
+			class Direction
+			{
+				public:
+					
+					/// The signed octahedral coordinates of the unit direction.
+					Int16 u, v;
+					
+					/// The magnitude of the direction vector.
+					HalfFloat magnitude;
+			};
+			
+			
+		//********************************************************************************
+		//******	Private Helper Methods
+			
+			
+			/// Convert the specified non-negative value to a half float, flushing values that are too small to zero.
+			/**
+			  * The value is scaled up by half of the half float precision first, so that the
+			  * truncating conversion rounds to the nearest half float.
+			  */
+			GSOUND_FORCE_INLINE static HalfFloat toHalfFloat( Float value )
+			{
+				if ( !(value >= MIN_HALF_FLOAT) )
+					return HalfFloat( Float(0) );
+				
+				return HalfFloat( math::min( value*Float(1.00048828125), MAX_HALF_FLOAT ) );
+			}
+			
+			
+			/// Quantize the specified direction vector.
+			static Direction encodeDirection( const Vector3f& direction );
+			
+			
+			/// Return the direction vector for the specified quantized direction.
+			static Vector3f decodeDirection( const Direction& direction );
+			
+			
+		//********************************************************************************
+		//******	Private Static Data Members
+			
+			
+			/// The global number of frequency bands in an IR.
+			static const Size numFrequencyBands = GSOUND_FREQUENCY_COUNT;
+			
+			
+			/// The number of samples in each block of the IR.
+			static const Size BLOCK_SIZE = 64;
+			
+			
+			/// The value that the largest intensity in each block and band is scaled to.
+			/**
+			  * This leaves about 28 bits of dynamic range in each block above the smallest
+			  * normalized half float, without overflowing to infinity.
+			  */
+			static const Float BLOCK_PEAK;
+			
+			
+			/// The smallest normalized half float value. Smaller values are stored as zero.
+			static const Float MIN_HALF_FLOAT;
+			
+			
+			/// The largest finite half float value. Larger values are clamped to this value.
+			static const Float MAX_HALF_FLOAT;
+			
+			
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// The blocks of the IR, starting with the block that contains the first non-zero sample.
+			Array<Block> blocks;
+			
+			
+			/// The stored intensity samples for all blocks, with interleaved frequency bands.
+			Array<HalfFloat> intensity;
+			
+			
+			/// The stored direction samples for all blocks.
+			Array<Direction> directions;
+			
+			
+			/// The stored source direction samples for all blocks, if source directions are enabled.
+			Array<Direction> sourceDirections;
+			
+			
+			/// The positions within their block of the stored samples of the sparse blocks.
+			Array<UInt8> positions;
+			
+			
+			/// The number of valid blocks in this IR.
+			Size numBlocks;
+			
+			
+			/// The index of the first non-zero sample in the IR.
+			Index startOffset;
+			
+			
+			/// The number of samples in this IR.
+			Size numSamples;
+			
+			
+			/// The sample rate of this impulse repsonse.
+			SampleRate sampleRate;
+			
+			
+			/// A boolean value that indicates whether or not this IR stores source directions.
+			Bool sourceDirectionsEnabled;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//******************************  End GSound Namespace  ************************************
+GSOUND_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_GSOUND_COMPACT_SAMPLED_IR_H
@@ -345,6 +345,7 @@ using om::Int64;
 using om::UInt64;
 using om::Float32;
 using om::Float64;
+using om::HalfFloat;
 
 using om::Hash;
 using om::Size;
@@ -355,10 +356,13 @@ using om::Time;
 
 
 using om::bind;
+using om::Function;
 using om::FunctionCall;
 using om::Thread;
 using om::ThreadPriority;
 using om::ThreadPool;
+using om::JobScheduler;
+using om::LockFreeQueue;
 using om::Atomic;
 using om::Shared;
 using om::PriorityQueue;
@@ -411,9 +415,22 @@ using om::bvh::BVHGeometry;
 using om::bvh::BVH;
 using om::bvh::BVHInstance;
 using om::bvh::AABBTree4;
+using om::bvh::AABBTree8;
 using om::bvh::BVHScene;
 
 
+/// Define the type of BVH used for sound meshes and scenes.
+/**
+  * The 8-wide tree is used when the build enables AVX (see the GSOUND_USE_AVX2 CMake option),
+  * since its node and triangle tests fill 256-bit registers. Otherwise the 4-wide SSE tree is used.
+  */
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+typedef AABBTree8 SoundBVH;
+#else
+typedef AABBTree4 SoundBVH;
+#endif
+
+
 /// Define the type to use for a vertex in a SoundMesh as a 3D vector type.
 typedef Vector3f SoundVertex;
 
@@ -437,6 +454,7 @@ using om::StaticArray;
 using om::Mutex;
 using om::ScopedMutex;
 using om::Signal;
+using om::Semaphore;
 using om::FunctionThread;
 
 using om::Timer;
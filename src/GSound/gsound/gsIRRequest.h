@@ -78,10 +78,12 @@ class IRRequest
 				:	frequencies(),
 					channelLayout( ChannelLayout::STEREO ),
 					hrtf( NULL ),
+					hrtfCacheDirectory(),
 					ir( true ),
 					normalize( false ),
 					binEnergy( true ),
 					metrics( true ),
+					accumulateHRTF( false ),
 					binTime( 0.01f )
 			{
 			}
@@ -103,6 +105,15 @@ class IRRequest
 			const HRTF* hrtf;
 			
 			
+			/// An optional directory where the spherical harmonic fits of HRTFs are cached.
+			/**
+			  * Fitting an HRTF is expensive, so if this path is not empty, the fit is stored in
+			  * a file named by a hash of the HRTF's contents. Later uses of the same HRTF, also
+			  * from other processes, memory-map the file instead of fitting the HRTF again.
+			  */
+			UTF8String hrtfCacheDirectory;
+			
+			
 			/// If set to TRUE, a spatialized pressure impulse response for auralization is computed.
 			/**
 			  * If this flag is not set, not IR is computed.
@@ -128,6 +139,21 @@ class IRRequest
 			Bool metrics;
 			
 			
+			/// If set to TRUE, discrete paths are spatialized by the HRTF in its spherical harmonic basis.
+			/**
+			  * Instead of generating and band-filtering an HRTF filter for every path, the
+			  * paths' per-band pressure is accumulated in the HRTF's spherical harmonic basis
+			  * for each block of the IR, and each block is then filtered by band-filtered
+			  * spherical harmonic HRTF filters in the frequency domain. The cost then depends
+			  * on the number of IR blocks that contain paths rather than on the number of paths,
+			  * which is much faster when there are many paths. The result is the same as the
+			  * per-path filtering up to rounding error.
+			  *
+			  * This flag has no effect if no HRTF is used.
+			  */
+			Bool accumulateHRTF;
+			
+			
 			/// The length in seconds for an impulse response bin.
 			/**
 			  * When the energy in the IR is binned, all sound energy that arrives within this
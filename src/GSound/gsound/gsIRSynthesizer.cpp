@@ -0,0 +1,189 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/gsIRSynthesizer.cpp
+ * Contents:    gsound::IRSynthesizer class implementation
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+#include "gsIRSynthesizer.h"
+
+
+//##########################################################################################
+//******************************  Start GSound Namespace  **********************************
+GSOUND_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Constructors
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+IRSynthesizer:: IRSynthesizer()
+	:	sceneIR( NULL ),
+		request( NULL ),
+		output( NULL )
+{
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Destructor
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+IRSynthesizer:: ~IRSynthesizer()
+{
+	for ( Index i = 0; i < impulseResponses.getSize(); i++ )
+		util::destruct( impulseResponses[i] );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Synthesis Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void IRSynthesizer:: synthesize( const SoundSceneIR& newSceneIR, const IRRequest& newRequest, Size numThreads,
+								const OutputFunction& newOutput )
+{
+	numThreads = math::max( numThreads, Size(1) );
+	
+	// Make a flat list of the pairs so that they can be distributed as independent tasks.
+	pairs.clear();
+	
+	for ( Index l = 0; l < newSceneIR.getListenerCount(); l++ )
+	{
+		const SoundListenerIR& listenerIR = newSceneIR.getListenerIR(l);
+		
+		// Skip listener IRs that are not associated with a listener.
+		if ( listenerIR.getListener() == NULL )
+			continue;
+		
+		for ( Index s = 0; s < listenerIR.getSourceCount(); s++ )
+			pairs.add( Pair( l, s ) );
+	}
+	
+	const Size numPairs = pairs.getSize();
+	
+	if ( numPairs == 0 )
+		return;
+	
+	// Create the scratch impulse responses for any new threads.
+	numThreads = math::min( numThreads, numPairs );
+	
+	while ( impulseResponses.getSize() < numThreads )
+		impulseResponses.add( util::construct<ImpulseResponse>() );
+	
+	sceneIR = &newSceneIR;
+	request = &newRequest;
+	output = &newOutput;
+	
+	if ( numThreads > 1 )
+	{
+		if ( jobScheduler.getThreadCount() != numThreads )
+			jobScheduler.setThreadCount( numThreads );
+		
+		// Synthesize the pairs in parallel and wait for all of them to finish.
+		jobScheduler.run( bind( &IRSynthesizer::synthesizeTask, this ), numPairs );
+	}
+	else
+	{
+		// Synthesize the pairs on the calling thread to avoid switching contexts.
+		for ( Index i = 0; i < numPairs; i++ )
+			synthesizeTask( i, 0 );
+	}
+	
+	sceneIR = NULL;
+	request = NULL;
+	output = NULL;
+}
+
+
+
+
+void IRSynthesizer:: synthesizeTask( Index pairIndex, Index threadIndex )
+{
+	const Pair& pair = pairs[pairIndex];
+	const SoundListenerIR& listenerIR = sceneIR->getListenerIR( pair.listenerIndex );
+	ImpulseResponse& ir = *impulseResponses[threadIndex];
+	
+	ir.setIR( listenerIR.getSourceIR( pair.sourceIndex ), *listenerIR.getListener(), *request );
+	
+	(*output)( pair.listenerIndex, pair.sourceIndex, ir );
+}
+
+
+
+
+//##########################################################################################
+//******************************  End GSound Namespace  ************************************
+GSOUND_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
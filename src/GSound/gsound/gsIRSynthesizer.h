@@ -0,0 +1,221 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/gsIRSynthesizer.h
+ * Contents:    gsound::IRSynthesizer class declaration
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+#ifndef INCLUDE_GSOUND_IR_SYNTHESIZER_H
+#define INCLUDE_GSOUND_IR_SYNTHESIZER_H
+
+
+#include "gsConfig.h"
+
+
+#include "gsSoundSceneIR.h"
+#include "gsImpulseResponse.h"
+
+
+//##########################################################################################
+//******************************  Start GSound Namespace  **********************************
+GSOUND_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that synthesizes the impulse responses for many source-listener pairs in parallel.
+/**
+  * After sound propagation, the IR for every source-listener pair in a scene IR is synthesized
+  * on a pool of worker threads. Each worker thread owns an ImpulseResponse object whose
+  * crossover, noise, and temporary buffers are reused for all of the pairs the worker
+  * synthesizes, so that no memory is allocated per pair once the buffers have grown
+  * to the longest IR.
+  *
+  * The synthesized IRs do not depend on the number of threads or on which thread
+  * synthesizes each pair.
+  */
+class IRSynthesizer
+{
+	public:
+		
+		//********************************************************************************
+		//******	Public Type Declarations
+			
+			
+			/// The type of function that receives each synthesized IR.
+			/**
+			  * The function is given the index of the listener IR in the scene IR, the
+			  * index of the source IR in the listener IR, and the synthesized impulse response.
+			  * It is called concurrently from the worker threads, so it must only write
+			  * to storage that is distinct for each pair. The impulse response is reused
+			  * after the function returns.
+			  */
+			typedef Function<void ( Index listenerIndex, Index sourceIndex, const ImpulseResponse& ir )> OutputFunction;
+			
+			
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a new IR synthesizer which has no worker threads.
+			IRSynthesizer();
+			
+			
+			/// Create an IR synthesizer with the same number of threads as another synthesizer.
+			private: IRSynthesizer( const IRSynthesizer& other );
+			public:
+			
+			
+		//********************************************************************************
+		//******	Destructor
+			
+			
+			/// Destroy an IR synthesizer and the scratch data for its worker threads.
+			~IRSynthesizer();
+			
+			
+		//********************************************************************************
+		//******	Assignment Operator
+			
+			
+			/// Assign the number of threads of another synthesizer to this synthesizer.
+			private: IRSynthesizer& operator = ( const IRSynthesizer& other );
+			public:
+			
+			
+		//********************************************************************************
+		//******	IR Synthesis Methods
+			
+			
+			/// Synthesize the IR for every source-listener pair in the scene IR and pass each to the output function.
+			/**
+			  * The pairs are distributed among the specified number of threads. With one
+			  * thread, the IRs are synthesized on the calling thread. The method returns
+			  * after all of the IRs have been output.
+			  */
+			void synthesize( const SoundSceneIR& sceneIR, const IRRequest& request, Size numThreads,
+							const OutputFunction& output );
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Class Declarations
+			
+			
+			/// A class that stores the indices of a source-listener pair that is synthesized.
+			class Pair
+			{
+				public:
+					
+					GSOUND_INLINE Pair( Index newListenerIndex, Index newSourceIndex )
+						:	listenerIndex( newListenerIndex ),
+							sourceIndex( newSourceIndex )
+					{
+					}
+					
+					/// The index of the listener IR in the scene IR.
+					Index listenerIndex;
+					
+					/// The index of the source IR in the listener IR.
+					Index sourceIndex;
+					
+			};
+			
+			
+		//********************************************************************************
+		//******	Private Helper Methods
+			
+			
+			/// Synthesize the IR for the pair with the given index using the given thread's impulse response.
+			void synthesizeTask( Index pairIndex, Index threadIndex );
+			
+			
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// A job scheduler that distributes the pairs among the worker threads.
+			JobScheduler jobScheduler;
+			
+			
+			/// A reusable impulse response for each worker thread.
+			ArrayList<ImpulseResponse*> impulseResponses;
+			
+			
+			/// A list of the source-listener pairs that are synthesized for the current scene IR.
+			ArrayList<Pair> pairs;
+			
+			
+			/// A pointer to the scene IR that is currently being synthesized.
+			const SoundSceneIR* sceneIR;
+			
+			
+			/// A pointer to the IR request for the current scene IR.
+			const IRRequest* request;
+			
+			
+			/// A pointer to the function that receives the synthesized IRs.
+			const OutputFunction* output;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//******************************  End GSound Namespace  ************************************
+GSOUND_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_GSOUND_IR_SYNTHESIZER_H
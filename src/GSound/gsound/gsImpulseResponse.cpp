@@ -48,6 +48,7 @@
 
 
 #include "gsImpulseResponse.h"
+#include "gsSoundMedium.h"
 
 
 //##########################################################################################
@@ -70,7 +71,10 @@ GSOUND_NAMESPACE_START
 
 ImpulseResponse:: ImpulseResponse()
 	:	buffer(),
-		noiseRand( 42 )
+		hrtf( NULL ),
+		hrtfFFT( NULL ),
+		hrtfBandFiltersHRTF( NULL ),
+		hrtfBandFiltersSampleRate( 0 )
 {
 }
 
@@ -80,7 +84,27 @@ ImpulseResponse:: ImpulseResponse()
 //##########################################################################################
 //##########################################################################################
 //############
-//############		IR Update Method
+//############		Destructor
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+ImpulseResponse:: ~ImpulseResponse()
+{
+	if ( hrtfFFT )
+		util::destruct( hrtfFFT );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Update Methods
 //############
 //##########################################################################################
 //##########################################################################################
@@ -91,282 +115,834 @@ ImpulseResponse:: ImpulseResponse()
 void ImpulseResponse:: setIR( const SoundSourceIR& sourceIR, const SoundListener& listener,
 								const IRRequest& request )
 {
-	const Size numFrequencyBands = request.frequencies.getBandCount();
-	const ChannelLayout& channelLayout = request.channelLayout;
-	const SampleRate sampleRate = sourceIR.getSampleRate();
-	const Size numChannels = channelLayout.getChannelCount();
-	buffer.setLayout( channelLayout );
-	buffer.setSampleRate( sampleRate );
+	buffer.setLayout( getLayout( request, listener ) );
+	buffer.setSampleRate( sourceIR.getSampleRate() );
 	frequencies = request.frequencies;
+	
+	// Expand the sampled IR if it is stored in compact form.
+	const SampledIR& sampledIR = sourceIR.expandSampledIR( expandedIR );
+	
+	// Bin the energy in the IR and compute its metrics if requested.
+	updateBins( sourceIR, sampledIR, request );
+	
+	// Don't go further if the IR is not requested.
+	if ( !request.ir )
+		return;
+	
 	//****************************************************************************
-	// Find the latest impulse to determine the response length.
+	// Synthesize the whole IR as one block.
 	
-	const Size filterBufferLength = 2048; // padding for crossover filters
-	const Size irLengthInSamples = sourceIR.getLengthInSamples();
-	const Size paddedIRLength = irLengthInSamples + filterBufferLength;
-	const Size numPaths = sourceIR.getPathCount();
-	const SampledIR& sampledIR = sourceIR.getSampledIR();
-	const Size sampledIRStart = sampledIR.getStartTimeInSamples();
-	const Size sampledIRLength = sampledIR.getLengthInSamples();
+	const Size paddedIRLength = getLengthInSamples( sourceIR, listener );
+	const Size numChannels = buffer.getChannelCount();
+	
+	synthesizeBlocks( sourceIR, sampledIR, listener, request, paddedIRLength, NULL );
 	
 	//****************************************************************************
-	// Bin the energy in the IR if requested.
+	// Scale the impulse response based on source/listener power.
 	
-	if ( request.binEnergy || request.metrics )
+	if ( request.normalize )
 	{
-		// Resize the bins to be the right size to hold the IR bins.
-		const Size binSize = Size(math::ceiling(request.binTime*sampleRate));
-		const Size binCount = Size(math::ceiling(Float(sourceIR.getLengthInSamples()) / Float(binSize)));
-		
-		if ( bins.getChannelCount() != Size(1) || bins.getSampleCount() != binCount )
-			bins.setFormat( Size(1), binCount );
-		
-		bins.allocate();
-		bins.zero();
-		SIMDBands* binsStart = bins.getChannel(0);
-		
-		// Bin the sampledIR.
-		for ( Index start = 0, b = 0; start < sampledIRLength; b++ )
-		{
-			const Size bSize = math::min( sampledIRLength - start, binSize );
-			binsStart[b] = math::sum( (const SIMDBands*)sampledIR.getIntensity() + start, bSize );
-			start += bSize;
-		}
+		// Find the largest sample.
+		Float maxSample = 0;
 		
-		// Add the path contributions.
-		for ( Index i = 0; i < numPaths; i++ )
+		for ( Index c = 0; c < numChannels; c++ )
 		{
-			const SoundPath& path = sourceIR.getPath(i);
-			Index binIndex = (Index)math::floor( path.getDelay() / request.binTime );
-			binsStart[binIndex] += SIMDBands::loadUnaligned( (Float*)&path.getIntensity() );
+			const Float* channel = (const Float*)buffer.getChannel(c);
+			maxSample = math::max( maxSample, math::max(
+											math::abs( math::min( channel, paddedIRLength ) ),
+											math::max( channel, paddedIRLength ) ) );
 		}
 		
-		// Compute acoustic metrics for the IR.
-		if ( request.metrics )
-		{
-			for ( Index band = 0; band < numFrequencyBands; band++ )
-				getMetrics( &bins.getChannel(0)[0][band], bins.getSampleCount(), numFrequencyBands, request.binTime, 60.0f, metrics, band );
-		}
+		if ( maxSample != 0 )
+			buffer.applyGain( Float(1)/maxSample );
+	}
+	else
+	{
+		// Apply the gain due to the source and listener.
+		buffer.applyGain( getGain( sourceIR, listener ) );
 	}
+}
+
+
+
+
+void ImpulseResponse:: streamIR( const SoundSourceIR& sourceIR, const SoundListener& listener,
+								const IRRequest& request, Size blockLength, const BlockFunction& output )
+{
+	buffer.setLayout( getLayout( request, listener ) );
+	buffer.setSampleRate( sourceIR.getSampleRate() );
+	frequencies = request.frequencies;
+	
+	// Expand the sampled IR if it is stored in compact form.
+	const SampledIR& sampledIR = sourceIR.expandSampledIR( expandedIR );
+	
+	// Bin the energy in the IR and compute its metrics if requested.
+	updateBins( sourceIR, sampledIR, request );
 	
 	// Don't go further if the IR is not requested.
 	if ( !request.ir )
 		return;
 	
-	//****************************************************************************
-	// Make sure the temporary storage is big enough.
+	synthesizeBlocks( sourceIR, sampledIR, listener, request, blockLength, &output );
+}
+
+
+
+
+void ImpulseResponse:: updateBins( const SoundSourceIR& sourceIR, const SampledIR& sampledIR, const IRRequest& request )
+{
+	if ( !request.binEnergy && !request.metrics )
+		return;
 	
-	// Resize the sound buffer to be the right size to hold the last impulse.
-	if ( buffer.getSize() != paddedIRLength )
-		buffer.setSize( paddedIRLength );
+	const Size numFrequencyBands = request.frequencies.getBandCount();
 	
-	buffer.zero();
+	// Resize the bins to be the right size to hold the IR bins.
+	const Size binSize = Size(math::ceiling(request.binTime*sourceIR.getSampleRate()));
+	const Size binCount = Size(math::ceiling(Float(sourceIR.getLengthInSamples()) / Float(binSize)));
 	
-	const Size bandIRSize = paddedIRLength*frequencies.getBandCount();
+	if ( bins.getChannelCount() != Size(1) || bins.getSampleCount() != binCount )
+		bins.setFormat( Size(1), binCount );
 	
-	if ( bandIRs.getChannelCount() < numChannels || bandIRs.getSampleCount() < bandIRSize )
-		bandIRs.setFormat( numChannels, bandIRSize );
+	bins.allocate();
+	binEnergy( sourceIR, sampledIR, request.binTime, bins.getChannel(0), binCount );
 	
-	if ( pan.getChannelCount() < numChannels || pan.getSampleCount() < sampledIRLength )
-		pan.setFormat( numChannels, sampledIRLength );
+	// Compute acoustic metrics for the IR.
+	if ( request.metrics )
+	{
+		for ( Index band = 0; band < numFrequencyBands; band++ )
+			getMetrics( &bins.getChannel(0)[0][band], bins.getSampleCount(), numFrequencyBands, request.binTime, 60.0f, metrics, band );
+	}
+}
+
+
+
+
+ChannelLayout ImpulseResponse:: getLayout( const IRRequest& request, const SoundListener& listener )
+{
+	// A microphone array listener has one channel for each microphone.
+	if ( listener.getMicrophoneCount() > 0 )
+		return ChannelLayout( listener.getMicrophoneCount() );
 	
-	bandIRs.allocate();
-	pan.allocate();
+	return request.channelLayout;
+}
 
-	// Make sure the crossover has the correct frequency bands.
-	crossover.setBands( request.frequencies, sampleRate );
+
+
+
+Gain ImpulseResponse:: getGain( const SoundSourceIR& sourceIR, const SoundListener& listener )
+{
+	// Compute the total power of the sources.
+	const Size numSources = sourceIR.getSourceCount();
+	Float totalPower = 0;
+	
+	for ( Index s = 0; s < numSources; s++ )
+		totalPower += sourceIR.getSource(s)->getPower();
+	
+	// Compute the power sensitivity of the listener.
+	const Real listenerPowerDB = listener.getSensitivity() + Real(10)*math::log10( Real(4)*gsound::math::pi<Real>() );
+	const Real listenerGain = math::pow( Real(10), listenerPowerDB / Real(10) );
+	
+	return (totalPower/(Real(4)*math::pi<Real>()))*listenerGain;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Block Synthesis Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void ImpulseResponse:: synthesizeBlocks( const SoundSourceIR& sourceIR, const SampledIR& sampledIR, const SoundListener& listener,
+										const IRRequest& request, Size blockLength, const BlockFunction* output )
+{
+	const Size numFrequencyBands = request.frequencies.getBandCount();
+	const ChannelLayout& channelLayout = buffer.getLayout();
+	const SampleRate sampleRate = sourceIR.getSampleRate();
+	const Size numChannels = channelLayout.getChannelCount();
+	
+	//****************************************************************************
+	// Find the latest impulse to determine the response length.
 	
-	// Regenerate the noise buffer if it is too short.
-	if ( noise.getSize() < paddedIRLength )
+	// The maximum number of samples that an arrival at a microphone can precede or follow the arrival at the listener.
+	// The sampled IR is synthesized this many samples ahead of each block so that no sample arrives before its block,
+	// and the IR is this much longer so that the latest arrivals at the microphones are not cut off.
+	const Size microphoneLead = getMicrophoneLead( sourceIR, listener );
+	
+	const Size filterBufferLength = FILTER_PADDING; // padding for crossover filters
+	const Size irLengthInSamples = sourceIR.getLengthInSamples();
+	const Size paddedIRLength = irLengthInSamples + filterBufferLength + microphoneLead;
+	const Size numPaths = sourceIR.getPathCount();
+	
+	blockLength = math::clamp( blockLength, Size(1), paddedIRLength );
+	const Size numBlocks = (paddedIRLength + blockLength - 1) / blockLength;
+	
+	// Get the shared crossover and band-filtered noise for the frequency bands if the current noise doesn't fit.
+	if ( bandNoise.isNull() || bandNoise->getLength() < paddedIRLength ||
+		bandNoise->getSampleRate() != sampleRate || bandNoise->getBands() != request.frequencies )
 	{
-		noise.allocate( paddedIRLength );
-		
-		for ( Index i = 0; i < paddedIRLength; i++ )
-			noise[i] = noiseRand.sample( -1.0f, 1.0f );
-		
-		CrossoverType::History history;
-		crossover.filterSIMD( history, (Float32*)noise.getPointer(), (Float32*)noise.getPointer(), paddedIRLength );
+		bandNoise = internal::BandNoise::get( request.frequencies, sampleRate, paddedIRLength );
 	}
 	
+	const CrossoverType& crossover = bandNoise->getCrossover();
+	const SIMDBands* const noise = bandNoise->getNoise();
+	
 	//****************************************************************************
-	// Interleave the IRs for each band.
+	// Make sure the temporary storage for one block is big enough.
 	
-	// Pan the IR directions based on the channel layout.
-	panDirections( sampledIR, channelLayout, listener.getOrientation(), pan );
-
-	// Interleave the sampled IR bands for each channel.
-	for ( Index c = 0; c < numChannels; c++ )
+	const Size maxHRTFOrder = 4;
+	const Size numMicrophones = listener.getMicrophoneCount();
+	const Bool useHRTF = numMicrophones == 0 && request.hrtf != NULL && request.hrtf->getChannelCount() == numChannels;
+	
+	// Generate the HRTF filter.
+	if ( useHRTF && request.hrtf != hrtf )
 	{
-		Float* channel = bandIRs.getChannel(c);
+		hrtf = request.hrtf;
 		
-		// Zero the first part before the start of the IR.
-		om::util::zero( channel, sampledIRStart*numFrequencyBands );
+		if ( request.hrtfCacheDirectory.getLength() > 0 )
+			hrtfFilter.setHRTF( *hrtf, sampleRate, request.hrtfCacheDirectory, maxHRTFOrder );
+		else
+			hrtfFilter.setHRTF( *hrtf, sampleRate, maxHRTFOrder );
 		
-		// Interleave the frequency bands for the main part of the IR.
-		interleaveBands( sampledIR, pan.getChannel(c), channel );
+		const Size bufferLength = hrtfFilter.getFilterLength() + 2;
 		
-		// Zero the part past the end of the sampled IR.
-		if ( paddedIRLength > sampledIRLength )
-			om::util::zero( channel + sampledIRLength*numFrequencyBands, (paddedIRLength - sampledIRLength)*numFrequencyBands );
+		if ( hrtfBuffer.getChannelCount() != 1 || hrtfBuffer.getSampleCount() < bufferLength )
+			hrtfBuffer.setFormat( 1, bufferLength );
+		
+		hrtfBuffer.allocate();
 	}
 	
 	//****************************************************************************
-	// Filter the interleaved IR and write the final IR output.
+	// Prepare the positions of the microphones of a microphone array listener.
+	
+	// The number of samples per meter of path distance, used to delay the sampled IR for each microphone.
+	const Real samplesPerMeter = Real(sampleRate) / getMicrophoneSpeed( sourceIR );
+	
+	if ( numMicrophones > 0 )
+	{
+		if ( microphoneOffsets.getSize() < numMicrophones )
+			microphoneOffsets.setSize( numMicrophones );
+		
+		// Transform the microphone positions into world space relative to the listener.
+		for ( Index m = 0; m < numMicrophones; m++ )
+			microphoneOffsets[m] = listener.getOrientation()*listener.getMicrophone(m);
+	}
+	
+	const Size hrtfLength = useHRTF ? hrtfFilter.getFilterLength() : Size(0);
+	const Size panLength = blockLength + microphoneLead;
+	const Size bandIRSize = math::max( panLength, hrtfLength )*numFrequencyBands;
+	
+	if ( bandIRs.getChannelCount() < numChannels || bandIRs.getSampleCount() < bandIRSize )
+		bandIRs.setFormat( numChannels, bandIRSize );
+	
+	if ( pan.getChannelCount() < numChannels || pan.getSampleCount() < panLength )
+		pan.setFormat( numChannels, panLength );
+	
+	bandIRs.allocate();
+	pan.allocate();
+	
+	if ( crossoverHistories.getSize() < numChannels )
+		crossoverHistories.allocate( numChannels );
 	
 	for ( Index c = 0; c < numChannels; c++ )
+		crossoverHistories[c] = CrossoverType::History();
+	
+	//****************************************************************************
+	// Prepare the filter that is added to the IR for each discrete path.
+	
+	// The number of samples that a path's filter extends past the path's delay.
+	Size pathFilterLength = filterBufferLength;
+	Size shOrder = 0;
+	
+	if ( useHRTF )
 	{
-		SIMDBands* irC = (SIMDBands*)bandIRs.getChannel(c);
-		Float* outputC = buffer.getChannel(c);
+		pathFilterLength = hrtfLength;
 		
-		// Convert from energy to pressure magnitude.
-		for ( Index i = 0; i < irLengthInSamples; i++ )
-			irC[i] = math::sqrt( irC[i] );
+		if ( request.accumulateHRTF )
+		{
+			shOrder = math::min( hrtfFilter.getSHOrder(), maxHRTFOrder );
+			
+			// Regenerate the band-filtered HRTF filters if the HRTF or crossover changed.
+			if ( hrtfBandFiltersHRTF != hrtf || hrtfBandFiltersFrequencies != frequencies ||
+				hrtfBandFiltersSampleRate != sampleRate )
+			{
+				prepareHRTFBandFilters( numChannels, numFrequencyBands, shOrder );
+				hrtfBandFiltersHRTF = hrtf;
+				hrtfBandFiltersFrequencies = frequencies;
+				hrtfBandFiltersSampleRate = sampleRate;
+			}
+			
+			// The convolution of an accumulated block extends past the block's start by the FFT size.
+			pathFilterLength = hrtfFFT->getSize();
+		}
+	}
+	else
+	{
+		if ( hrtfBuffer.getChannelCount() != 1 || hrtfBuffer.getSampleCount() < filterBufferLength )
+			hrtfBuffer.setFormat( 1, filterBufferLength );
 		
-		// Low-pass filter the energy histograms to remove high-frequency noise.
-		CrossoverType::History crossoverHistory;
-		crossover.filterSIMDLowPass( crossoverHistory, (Float32*)irC, (Float32*)irC, irLengthInSamples );
+		if ( impulseBands.getChannelCount() != 1 || impulseBands.getSampleCount() < filterBufferLength*numFrequencyBands )
+			impulseBands.setFormat( 1, filterBufferLength*numFrequencyBands );
 		
-		for ( Index i = 0; i < irLengthInSamples; i++ )
-			outputC[i] = math::sumScalar(noise[i] * irC[i]);
+		hrtfBuffer.allocate();
+		impulseBands.allocate();
+		hrtfBuffer.zero();
+		hrtfBuffer.getChannel(0)[0] = 1;
+		
+		// Filter the impulse into the frequency bands.
+		CrossoverType::History crossoverHistory;
+		crossover.filterScalar( crossoverHistory, hrtfBuffer.getChannel(0), impulseBands.getChannel(0), filterBufferLength );
+	}
+	
+	// The paths are sorted by their earliest possible arrival and can end later at a microphone.
+	pathFilterLength += 2*microphoneLead;
+	
+	// The buffer holds a block and the parts of its paths' filters that extend past it.
+	const Size bufferLength = math::min( blockLength + pathFilterLength, paddedIRLength );
+	
+	if ( buffer.getSize() != bufferLength )
+		buffer.setSize( bufferLength );
+	
+	buffer.zero();
+	
+	// Sort the paths by the block they start in.
+	sortPathsByBlock( sourceIR, NULL, numPaths, 0, paddedIRLength, blockLength, blockStarts, blockPaths, microphoneLead );
+	
+	// Streamed blocks are scaled as they are output because the IR is never complete.
+	Gain gain = 1;
+	
+	if ( output != NULL )
+	{
+		blockBuffer.setLayout( channelLayout );
+		blockBuffer.setSampleRate( sampleRate );
+		gain = getGain( sourceIR, listener );
 	}
 	
 	//****************************************************************************
 	
-	if ( request.hrtf != NULL && request.hrtf->getChannelCount() == numChannels )
+	for ( Index blockIndex = 0; blockIndex < numBlocks; blockIndex++ )
 	{
-		const Size maxHRTFOrder = 4;
+		const Index blockStart = blockIndex*blockLength;
+		const Size blockSize = math::min( blockLength, paddedIRLength - blockStart );
+		const Index sampledEnd = math::min( blockStart + blockSize, irLengthInSamples );
+		
+		//****************************************************************************
+		// Interleave the IRs for each band.
 		
-		// Generate the HRTF filter.
-		if ( request.hrtf != hrtf )
+		if ( numMicrophones > 0 )
 		{
-			hrtf = request.hrtf;
-			hrtfFilter.setHRTF( *hrtf, sampleRate, maxHRTFOrder );
-
-			const Size bufferLength = hrtfFilter.getFilterLength() + 2;
+			// Synthesize the sampled IR ahead of the block by the maximum microphone lead.
+			const Index microphoneStart = blockIndex == 0 ? Index(0) : math::min( blockStart + microphoneLead, irLengthInSamples );
+			const Index microphoneEnd = math::min( blockStart + blockSize + microphoneLead, irLengthInSamples );
 			
-			if ( hrtfBuffer.getChannelCount() != 1 || hrtfBuffer.getSampleCount() < bufferLength )
-				hrtfBuffer.setFormat( 1, bufferLength );
+			if ( microphoneEnd > microphoneStart )
+			{
+				addMicrophoneSampledIR( sampledIR, crossover, noise, blockStart, microphoneStart,
+										microphoneEnd - microphoneStart, bufferLength, samplesPerMeter );
+			}
+		}
+		else if ( sampledEnd > blockStart )
+		{
+			const Size sampledSize = sampledEnd - blockStart;
 			
-			hrtfBuffer.allocate();
+			// Pan the IR directions based on the channel layout.
+			panDirections( sampledIR, channelLayout, listener.getOrientation(), blockStart, sampledSize, pan );
 			
-			if ( bandIRs.getSampleCount() < hrtfFilter.getFilterLength()*numFrequencyBands )
-				bandIRs.setFormat( numChannels, hrtfFilter.getFilterLength()*numFrequencyBands );
+			// Interleave the sampled IR bands for each channel.
+			for ( Index c = 0; c < numChannels; c++ )
+				interleaveBands( sampledIR, blockStart, sampledSize, pan.getChannel(c), bandIRs.getChannel(c) );
+			
+			//****************************************************************************
+			// Filter the interleaved IR and write the final IR output.
+			
+			for ( Index c = 0; c < numChannels; c++ )
+			{
+				SIMDBands* irC = (SIMDBands*)bandIRs.getChannel(c);
+				Float* outputC = buffer.getChannel(c);
+				const SIMDBands* const noiseC = noise + blockStart;
+				
+				// Convert from energy to pressure magnitude.
+				for ( Index i = 0; i < sampledSize; i++ )
+					irC[i] = math::sqrt( irC[i] );
+				
+				// Low-pass filter the energy histograms to remove high-frequency noise.
+				// The filter history is kept from the previous block.
+				crossover.filterSIMDLowPass( crossoverHistories[c], (Float32*)irC, (Float32*)irC, sampledSize );
+				
+				for ( Index i = 0; i < sampledSize; i++ )
+					outputC[i] += math::sumScalar(noiseC[i] * irC[i]);
+			}
 		}
 		
-		const Size hrtfLength = hrtfFilter.getFilterLength();
+		//****************************************************************************
+		// Add the discrete paths that start in this block.
 		
-		for ( Index i = 0; i < numPaths; i++ )
+		const Index* const paths = blockPaths.getPointer() + blockStarts[blockIndex];
+		const Size numBlockPaths = blockStarts[blockIndex + 1] - blockStarts[blockIndex];
+		
+		if ( useHRTF && request.accumulateHRTF )
 		{
-			const SoundPath& path = sourceIR.getPath(i);
-			const Float delay = path.getDistance() / path.getSpeed();
-			const Index sampleIndex = (Index)math::floor( delay*sampleRate );
-			const FrequencyBandResponse& energy = path.getIntensity();
-			const SIMDBands energyBands = math::sqrt( SIMDBands::loadUnaligned( (Float*)&energy ) );
-			
-			// Generate a SH basis for the path.
-			SH::cartesian( maxHRTFOrder, path.getDirection()*listener.getOrientation(), shBasis );
-			
-			for ( Index c = 0; c < numChannels; c++ )
+			accumulateHRTFPaths( sourceIR, listener, paths, numBlockPaths, blockStart, math::min( bufferLength, paddedIRLength - blockStart ),
+								numChannels, numFrequencyBands, shOrder );
+		}
+		else if ( useHRTF )
+		{
+			for ( Index i = 0; i < numBlockPaths; i++ )
 			{
-				Float* const hrtfChannel = hrtfBuffer.getChannel(0);
-				SIMDBands* const hrtfChannelBands = (SIMDBands*)bandIRs.getChannel(0);
-				Float* const output = buffer.getChannel(c) + sampleIndex;
+				const SoundPath& path = sourceIR.getPath( paths[i] );
+				const Float delay = path.getDistance() / path.getSpeed();
+				const Index sampleIndex = (Index)math::floor( delay*sampleRate );
+				const FrequencyBandResponse& energy = path.getIntensity();
+				const SIMDBands energyBands = math::sqrt( SIMDBands::loadUnaligned( (Float*)&energy ) );
 				
-				// Get the time-domain filter for this path's direction and channel.
-				hrtfFilter.getFilter( c, shBasis, hrtfChannel );
+				// Generate a SH basis for the path.
+				SH::cartesian( maxHRTFOrder, path.getDirection()*listener.getOrientation(), shBasis );
 				
-				// Filter the HRTF into the frequency bands.
-				CrossoverType::History crossoverHistory;
-				crossover.filterScalar( crossoverHistory, hrtfChannel, (Float*)hrtfChannelBands, hrtfLength );
+				for ( Index c = 0; c < numChannels; c++ )
+				{
+					Float* const hrtfChannel = hrtfBuffer.getChannel(0);
+					SIMDBands* const hrtfChannelBands = (SIMDBands*)bandIRs.getChannel(0);
+					Float* const output = buffer.getChannel(c) + (sampleIndex - blockStart);
+					
+					// Get the time-domain filter for this path's direction and channel.
+					hrtfFilter.getFilter( c, shBasis, hrtfChannel );
+					
+					// Filter the HRTF into the frequency bands.
+					CrossoverType::History crossoverHistory;
+					crossover.filterScalar( crossoverHistory, hrtfChannel, (Float*)hrtfChannelBands, hrtfLength );
+					
+					const Size length = math::min( paddedIRLength - sampleIndex, hrtfLength );
+					
+					// Add the HRTF to the IR and multiply by the path's pressure.
+					for ( Index j = 0; j < length; j++ )
+						output[j] += math::sumScalar( energyBands * hrtfChannelBands[j] );
+				}
+			}
+		}
+		else if ( numMicrophones > 0 )
+		{
+			addMicrophonePaths( sourceIR, paths, numBlockPaths, blockStart, bufferLength, paddedIRLength, numMicrophones );
+		}
+		else
+		{
+			const SIMDBands* const impulseChannelBands = (const SIMDBands*)impulseBands.getChannel(0);
+			
+			for ( Index i = 0; i < numBlockPaths; i++ )
+			{
+				const SoundPath& path = sourceIR.getPath( paths[i] );
+				const Float delay = path.getDistance() / path.getSpeed();
+				const Index sampleIndex = (Index)math::floor( delay*sampleRate );
+				const FrequencyBandResponse& energy = path.getIntensity();
+				const SIMDBands energyBands = math::sqrt( SIMDBands::loadUnaligned( (Float*)&energy ) );
 				
-				const Size length = math::min( paddedIRLength - sampleIndex, hrtfLength );
+				// Pan the impulse among the output channel layout. Skip the impulse if panning failed.
+				if ( !channelLayout.panDirection( path.getDirection()*listener.getOrientation(), channelGains ) )
+					continue;
 				
-				// Add the HRTF to the IR and multiply by the path's pressure.
-				for ( Index j = 0; j < length; j++ )
-					output[j] += math::sumScalar( energyBands * hrtfChannelBands[j] );
+				for ( Index c = 0; c < numChannels; c++ )
+				{
+					Float* const output = buffer.getChannel(c) + (sampleIndex - blockStart);
+					
+					const Size length = math::min( paddedIRLength - sampleIndex, filterBufferLength );
+					
+					// Add the HRTF to the IR and multiply by the path's pressure.
+					for ( Index j = 0; j < length; j++ )
+					{
+						for ( Index b = 0; b < numFrequencyBands; b++ )
+							output[j] += (energyBands[b] * impulseChannelBands[j][b])*channelGains[c];
+					}
+				}
 			}
 		}
+		
+		//****************************************************************************
+		// Output a streamed block and move the parts of the paths past it to the start of the buffer.
+		
+		if ( output == NULL )
+			continue;
+		
+		blockBuffer.setSize( blockSize );
+		
+		for ( Index c = 0; c < numChannels; c++ )
+			om::util::copyPOD( blockBuffer.getChannel(c), buffer.getChannel(c), blockSize );
+		
+		blockBuffer.applyGain( gain );
+		(*output)( blockBuffer, blockStart );
+		
+		const Size tailLength = bufferLength - blockSize;
+		
+		for ( Index c = 0; c < numChannels; c++ )
+		{
+			Float* const channel = buffer.getChannel(c);
+			
+			for ( Index i = 0; i < tailLength; i++ )
+				channel[i] = channel[i + blockSize];
+			
+			om::util::zeroPOD( channel + tailLength, blockSize );
+		}
 	}
-	else
+}
+
+
+
+
+void ImpulseResponse:: sortPathsByBlock( const SoundSourceIR& sourceIR, const Index* pathIndices, Size numPaths,
+										Index start, Size length, Size blockLength,
+										Array<Index>& blockStarts, Array<Index>& blockPaths, Size lead )
+{
+	const SampleRate sampleRate = sourceIR.getSampleRate();
+	const Size numBlocks = (length + blockLength - 1) / blockLength;
+	
+	if ( blockStarts.getSize() < numBlocks + 1 )
+		blockStarts.setSize( numBlocks + 1 );
+	
+	if ( blockPaths.getSize() < numPaths )
+		blockPaths.setSize( numPaths );
+	
+	blockStarts.setAll( 0 );
+	
+	for ( Index i = 0; i < numPaths; i++ )
 	{
-		if ( hrtfBuffer.getChannelCount() != 1 || hrtfBuffer.getSampleCount() < filterBufferLength )
-			hrtfBuffer.setFormat( 1, filterBufferLength );
+		const SoundPath& path = sourceIR.getPath( pathIndices ? pathIndices[i] : i );
+		const Index sampleIndex = getSortIndex( path, sampleRate, lead ) - start;
 		
-		if ( bandIRs.getSampleCount() < filterBufferLength*numFrequencyBands )
-			bandIRs.setFormat( numChannels, filterBufferLength*numFrequencyBands );
+		if ( sampleIndex < length )
+			blockStarts[sampleIndex / blockLength + 1]++;
+	}
+	
+	for ( Index b = 0; b < numBlocks; b++ )
+		blockStarts[b + 1] += blockStarts[b];
+	
+	for ( Index i = 0; i < numPaths; i++ )
+	{
+		const Index pathIndex = pathIndices ? pathIndices[i] : i;
+		const SoundPath& path = sourceIR.getPath( pathIndex );
+		const Index sampleIndex = getSortIndex( path, sampleRate, lead ) - start;
+		
+		// Use each block's start as its insertion cursor, leaving it at the start of the next block.
+		if ( sampleIndex < length )
+			blockPaths[blockStarts[sampleIndex / blockLength]++] = pathIndex;
+	}
+	
+	for ( Index b = numBlocks; b > 0; b-- )
+		blockStarts[b] = blockStarts[b - 1];
+	
+	blockStarts[0] = 0;
+}
 
-		hrtfBuffer.allocate();
-		hrtfBuffer.zero();
-		hrtfBuffer.getChannel(0)[0] = 1;
 
-		// Filter the HRTF into the frequency bands.
-		CrossoverType::History crossoverHistory;
-		crossover.filterScalar( crossoverHistory, hrtfBuffer.getChannel(0), (Float*)bandIRs.getChannel(0), filterBufferLength );
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Microphone Array Methods
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Size ImpulseResponse:: getMicrophoneLead( const SoundSourceIR& sourceIR, const SoundListener& listener )
+{
+	if ( listener.getMicrophoneCount() == 0 )
+		return 0;
+	
+	const Real samplesPerMeter = Real(sourceIR.getSampleRate()) / getMicrophoneSpeed( sourceIR );
+	
+	return (Size)math::ceiling( listener.getMicrophoneRadius()*samplesPerMeter ) + 1;
+}
+
+
+
+
+Real ImpulseResponse:: getMicrophoneSpeed( const SoundSourceIR& sourceIR )
+{
+	return sourceIR.getPathCount() > 0 ? sourceIR.getPath(0).getSpeed() : SoundMedium::AIR.getSpeed();
+}
+
+
+
+
+void ImpulseResponse:: addMicrophoneSampledIR( const SampledIR& ir, const CrossoverType& crossover, const SIMDBands* noise,
+												Index blockStart, Index sampledStart, Size sampledSize,
+												Size bufferLength, Real samplesPerMeter )
+{
+	const Size numMicrophones = buffer.getChannelCount();
+	Float* const omni = pan.getChannel(0);
+	SIMDBands* const omniBands = (SIMDBands*)bandIRs.getChannel(0);
+	
+	// Synthesize the omnidirectional pressure IR for the samples once for all microphones.
+	om::util::set( omni, Float32(1), sampledSize );
+	interleaveBands( ir, sampledStart, sampledSize, omni, (Float*)omniBands );
+	
+	for ( Index i = 0; i < sampledSize; i++ )
+		omniBands[i] = math::sqrt( omniBands[i] );
+	
+	crossover.filterSIMDLowPass( crossoverHistories[0], (Float32*)omniBands, (Float32*)omniBands, sampledSize );
+	
+	for ( Index i = 0; i < sampledSize; i++ )
+		omni[i] = math::sumScalar( noise[sampledStart + i] * omniBands[i] );
+	
+	// Add each sample to each microphone, delayed by the plane-wave arrival time difference
+	// for the sample's direction. The samples are ahead of the block by at least the maximum shift.
+	const Vector3f* const directions = ir.getDirections() + sampledStart;
+	const Index firstSample = math::clamp( ir.getStartTimeInSamples(), sampledStart, sampledStart + sampledSize ) - sampledStart;
+	const Int64 bufferOffset = Int64(sampledStart) - Int64(blockStart);
+	const Int64 lastSample = Int64(bufferLength) - 1;
+	
+	for ( Index i = firstSample; i < sampledSize; i++ )
+	{
+		const Real directionMagnitude2 = directions[i].getMagnitudeSquared();
+		const Int64 bufferIndex = bufferOffset + Int64(i);
 		
+		if ( omni[i] == Float(0) )
+			continue;
+		
+		if ( directionMagnitude2 <= math::epsilon<Real>() )
+		{
+			for ( Index m = 0; m < numMicrophones; m++ )
+				buffer.getChannel(m)[bufferIndex] += omni[i];
+			
+			continue;
+		}
+		
+		const Vector3f direction = directions[i]*(samplesPerMeter / math::sqrt( directionMagnitude2 ));
+		
+		for ( Index m = 0; m < numMicrophones; m++ )
+		{
+			// Microphones closer to the arrival direction hear the sample earlier.
+			const Real shift = -math::dot( direction, microphoneOffsets[m] );
+			const Index sampleIndex = (Index)math::clamp( bufferIndex + Int64(math::round( shift )), Int64(0), lastSample );
+			
+			buffer.getChannel(m)[sampleIndex] += omni[i];
+		}
+	}
+}
 
-		for ( Index i = 0; i < numPaths; i++ )
+
+
+
+void ImpulseResponse:: addMicrophonePaths( const SoundSourceIR& sourceIR, const Index* pathIndices, Size numPaths,
+											Index blockStart, Size bufferLength, Size paddedIRLength, Size numMicrophones )
+{
+	const SampleRate sampleRate = sourceIR.getSampleRate();
+	const Size numFrequencyBands = frequencies.getBandCount();
+	const SIMDBands* const impulseChannelBands = (const SIMDBands*)impulseBands.getChannel(0);
+	const Index blockEnd = blockStart + bufferLength;
+	
+	for ( Index i = 0; i < numPaths; i++ )
+	{
+		const SoundPath& path = sourceIR.getPath( pathIndices[i] );
+		const FrequencyBandResponse& energy = path.getIntensity();
+		const SIMDBands energyBands = math::sqrt( SIMDBands::loadUnaligned( (Float*)&energy ) );
+		const Bool direct = path.getFlags().isSet( SoundPathFlags::DIRECT );
+		
+		// The path arrives from a virtual source along its direction at its distance from the listener.
+		const Vector3f virtualSource = path.getDirection()*path.getDistance();
+		
+		for ( Index m = 0; m < numMicrophones; m++ )
 		{
-			const SoundPath& path = sourceIR.getPath(i);
-			const Float delay = path.getDistance() / path.getSpeed();
-			const Index sampleIndex = (Index)math::floor( delay*sampleRate );
-			const FrequencyBandResponse& energy = path.getIntensity();
-			const SIMDBands energyBands = math::sqrt( SIMDBands::loadUnaligned( (Float*)&energy ) );
+			// Skip the direct sound for microphones that can't see the source.
+			const Real visibility = direct ? sourceIR.getMicrophoneVisibility(m) : Real(1);
 			
-			// Pan the impulse among the output channel layout. Skip the impulse if panning failed.
-			if ( !channelLayout.panDirection( path.getDirection()*listener.getOrientation(), channelGains ) )
+			if ( visibility <= Real(0) )
 				continue;
 			
-			for ( Index c = 0; c < numChannels; c++ )
+			// Compute the exact arrival time and distance attenuation of the path at the microphone.
+			const Real distance = (virtualSource - microphoneOffsets[m]).getMagnitude();
+			const Index sampleIndex = math::max( (Index)math::floor( (distance / path.getSpeed())*sampleRate ), blockStart );
+			
+			if ( sampleIndex >= math::min( paddedIRLength, blockEnd ) )
+				continue;
+			
+			const Float gain = math::sqrt( visibility )*(path.getDistance() / math::max( distance, math::epsilon<Real>() ));
+			const Size length = math::min( math::min( paddedIRLength, blockEnd ) - sampleIndex, Size(FILTER_PADDING) );
+			Float* const output = buffer.getChannel(m) + (sampleIndex - blockStart);
+			
+			for ( Index j = 0; j < length; j++ )
+			{
+				for ( Index b = 0; b < numFrequencyBands; b++ )
+					output[j] += (energyBands[b] * impulseChannelBands[j][b])*gain;
+			}
+		}
+	}
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############
+//############		HRTF Path Accumulation Methods
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void ImpulseResponse:: prepareHRTFBandFilters( Size numChannels, Size numFrequencyBands, Size shOrder )
+{
+	const Size hrtfLength = hrtfFilter.getFilterLength();
+	const Size numCoefficients = SH::getCoefficientCount( shOrder );
+	const Size numFilters = numCoefficients*numFrequencyBands;
+	
+	// Each block is convolved with the HRTF filters using an FFT that is big enough to hold
+	// the linear convolution. The real FFT size must be a multiple of 32.
+	const Size fftSize = math::max( 2*hrtfLength, Size(32) );
+	
+	if ( hrtfFFT == NULL || hrtfFFT->getSize() != fftSize )
+	{
+		if ( hrtfFFT )
+			util::destruct( hrtfFFT );
+		
+		hrtfFFT = util::construct< math::FFTReal<Float32> >( fftSize );
+	}
+	
+	if ( hrtfBandFilters.getChannelCount() != numChannels || hrtfBandFilters.getSampleCount() != numFilters*fftSize )
+		hrtfBandFilters.setFormat( numChannels, numFilters*fftSize );
+	
+	hrtfBandFilters.allocate();
+	
+	// The inverse FFT is not normalized, so the normalization is applied to the filters.
+	const Float fftNormalize = Float(1) / Float(fftSize);
+	Float* const hrtfChannel = hrtfBuffer.getChannel(0);
+	SIMDBands* const hrtfChannelBands = (SIMDBands*)bandIRs.getChannel(0);
+	SHExpansion<Float> coefficientBasis( shOrder );
+	const CrossoverType& crossover = bandNoise->getCrossover();
+	
+	for ( Index c = 0; c < numChannels; c++ )
+	{
+		Float* const channelFilters = hrtfBandFilters.getChannel(c);
+		
+		for ( Index k = 0; k < numCoefficients; k++ )
+		{
+			// Get the time-domain filter for this spherical harmonic coefficient alone.
+			om::util::zeroPOD( coefficientBasis.getCoefficients(), numCoefficients );
+			coefficientBasis.getCoefficients()[k] = Float(1);
+			hrtfFilter.getFilter( c, coefficientBasis, hrtfChannel );
+			
+			// Filter the coefficient's filter into the frequency bands, the same as for a single path.
+			CrossoverType::History crossoverHistory;
+			crossover.filterScalar( crossoverHistory, hrtfChannel, (Float*)hrtfChannelBands, hrtfLength );
+			
+			// Convert each band's filter to frequency domain.
+			for ( Index b = 0; b < numFrequencyBands; b++ )
 			{
-				SIMDBands* const hrtfChannelBands = (SIMDBands*)bandIRs.getChannel(0);
-				Float* const output = buffer.getChannel(c) + sampleIndex;
+				Float* const filter = channelFilters + (k*numFrequencyBands + b)*fftSize;
 				
-				const Size length = math::min( paddedIRLength - sampleIndex, filterBufferLength );
+				for ( Index j = 0; j < hrtfLength; j++ )
+					filter[j] = hrtfChannelBands[j][b]*fftNormalize;
 				
-				// Add the HRTF to the IR and multiply by the path's pressure.
-				for ( Index j = 0; j < length; j++ )
-				{
-					for ( Index b = 0; b < numFrequencyBands; b++ )
-						output[j] += (energyBands[b] * hrtfChannelBands[j][b])*channelGains[c];
-				}
+				om::util::zeroPOD( filter + hrtfLength, fftSize - hrtfLength );
+				hrtfFFT->fftUnordered( filter );
 			}
 		}
 	}
+}
+
+
+
+
+void ImpulseResponse:: accumulateHRTFPaths( const SoundSourceIR& sourceIR, const SoundListener& listener,
+											const Index* pathIndices, Size numPaths, Index irStart, Size irLength,
+											Size numChannels, Size numFrequencyBands, Size shOrder )
+{
+	if ( numPaths == 0 || hrtfFFT == NULL )
+		return;
+	
+	const SampleRate sampleRate = buffer.getSampleRate();
+	const Size hrtfLength = hrtfFilter.getFilterLength();
+	const Size fftSize = hrtfFFT->getSize();
+	const Size blockLength = fftSize - hrtfLength + 1;
+	const Size numBlocks = (irLength + blockLength - 1) / blockLength;
+	const Size numCoefficients = SH::getCoefficientCount( shOrder );
+	const Size numFilters = numCoefficients*numFrequencyBands;
+	
+	// Sort the paths by the IR block that they start in.
+	sortPathsByBlock( sourceIR, pathIndices, numPaths, irStart, irLength, blockLength, hrtfBlockStarts, hrtfBlockPaths );
 	
 	//****************************************************************************
-	// Scale the impulse response based on source/listener power.
+	// Make sure the temporary storage is big enough.
 	
-	if ( request.normalize )
+	if ( hrtfBlock.getChannelCount() != 1 || hrtfBlock.getSampleCount() < numFilters*fftSize )
+		hrtfBlock.setFormat( 1, numFilters*fftSize );
+	
+	if ( hrtfBlockOutput.getChannelCount() != 1 || hrtfBlockOutput.getSampleCount() < fftSize )
+		hrtfBlockOutput.setFormat( 1, fftSize );
+	
+	hrtfBlock.allocate();
+	hrtfBlockOutput.allocate();
+	
+	Float* const block = hrtfBlock.getChannel(0);
+	Float* const blockOutput = hrtfBlockOutput.getChannel(0);
+	
+	//****************************************************************************
+	// Filter each block that contains paths with the spherical harmonic HRTF filters.
+	
+	for ( Index b = 0; b < numBlocks; b++ )
 	{
-		// Find the largest sample.
-		Float maxSample = 0;
+		const Index pathsStart = hrtfBlockStarts[b];
+		const Index pathsEnd = hrtfBlockStarts[b + 1];
 		
-		for ( Index c = 0; c < numChannels; c++ )
+		if ( pathsStart == pathsEnd )
+			continue;
+		
+		const Index blockStart = b*blockLength;
+		
+		// Accumulate each path's per-band pressure, weighted by its spherical harmonic basis.
+		om::util::zeroPOD( block, numFilters*fftSize );
+		
+		for ( Index i = pathsStart; i < pathsEnd; i++ )
 		{
-			const Float* channel = (const Float*)buffer.getChannel(c);
-			maxSample = math::max( maxSample, math::max(
-											math::abs( math::min( channel, paddedIRLength ) ),
-											math::max( channel, paddedIRLength ) ) );
+			const SoundPath& path = sourceIR.getPath( hrtfBlockPaths[i] );
+			const Index sampleIndex = (Index)math::floor( (path.getDistance() / path.getSpeed())*sampleRate ) - irStart;
+			const SIMDBands energyBands = math::sqrt( SIMDBands::loadUnaligned( (Float*)&path.getIntensity() ) );
+			Float* const pathBlock = block + (sampleIndex - blockStart);
+			
+			SH::cartesian( shOrder, path.getDirection()*listener.getOrientation(), shBasis );
+			const Float* const basis = shBasis.getCoefficients();
+			
+			for ( Index k = 0; k < numCoefficients; k++ )
+			{
+				Float* const coefficientBlock = pathBlock + k*numFrequencyBands*fftSize;
+				
+				for ( Index f = 0; f < numFrequencyBands; f++ )
+					coefficientBlock[f*fftSize] += basis[k]*energyBands[f];
+			}
 		}
 		
-		if ( maxSample != 0 )
-			buffer.applyGain( Float(1)/maxSample );
-	}
-	else
-	{
-		// Compute the total power of the sources.
-		const Size numSources = sourceIR.getSourceCount();
-		Float totalPower = 0;
+		for ( Index f = 0; f < numFilters; f++ )
+			hrtfFFT->fftUnordered( block + f*fftSize );
 		
-		for ( Index s = 0; s < numSources; s++ )
-			totalPower += sourceIR.getSource(s)->getPower();
+		// Apply the filters for each channel and add the result to the IR.
+		const Size outputLength = math::min( irLength - blockStart, fftSize );
 		
-		// Compute the power sensitivity of the listener.
-		const Real listenerPowerDB = listener.getSensitivity() + Real(10)*math::log10( Real(4)*gsound::math::pi<Real>() );
-		const Real listenerGain = math::pow( Real(10), listenerPowerDB / Real(10) );
-		
-		// Apply the gain due to the source and listener.
-		buffer.applyGain( (totalPower/(Real(4)*math::pi<Real>()))*listenerGain );
+		for ( Index c = 0; c < numChannels; c++ )
+		{
+			const Float* const channelFilters = hrtfBandFilters.getChannel(c);
+			
+			om::util::zeroPOD( blockOutput, fftSize );
+			
+			for ( Index f = 0; f < numFilters; f++ )
+			{
+				hrtfFFT->multiplyAddUnordered( (math::Complex<Float32>*)blockOutput,
+												(const math::Complex<Float32>*)(block + f*fftSize),
+												(const math::Complex<Float32>*)(channelFilters + f*fftSize) );
+			}
+			
+			hrtfFFT->ifftUnordered( blockOutput );
+			math::add( buffer.getChannel(c) + blockStart, blockOutput, outputLength );
+		}
 	}
 }
 
@@ -384,25 +960,25 @@ void ImpulseResponse:: setIR( const SoundSourceIR& sourceIR, const SoundListener
 
 
 
-void ImpulseResponse:: interleaveBands( const SampledIR& ir, const Float* pan, Float* output )
+void ImpulseResponse:: interleaveBands( const SampledIR& ir, Index partitionOffset, Size partitionLength,
+										const Float* pan, Float* output )
 {
+	// Find the part of the partition that overlaps the sampled IR.
+	const Index partitionEnd = partitionOffset + partitionLength;
+	const Index irStart = math::clamp( ir.getStartTimeInSamples(), partitionOffset, partitionEnd ) - partitionOffset;
+	const Index irEnd = math::max( math::clamp( ir.getLengthInSamples(), partitionOffset, partitionEnd ) - partitionOffset, irStart );
+	const SIMDBands* bands = (const SIMDBands*)ir.getIntensity() + partitionOffset;
+	SIMDBands* outputBands = (SIMDBands*)output;
+	
 	// Zero the first bit of the interleaved IR.
-	om::util::zeroPOD( (SIMDBands*)output, ir.getStartTimeInSamples() );
+	om::util::zeroPOD( outputBands, irStart );
 	
 	// Do the panning for the rest of the IR.
-	const SIMDBands* bands = (const SIMDBands*)ir.getIntensity() + ir.getStartTimeInSamples();
-	SIMDBands* outputBands = (SIMDBands*)output + ir.getStartTimeInSamples();
-	const Float* const panEnd = pan + ir.getLengthInSamples();
-	pan += ir.getStartTimeInSamples();
+	for ( Index i = irStart; i < irEnd; i++ )
+		outputBands[i] = bands[i]*SIMDBands(pan[i]);
 	
-	while ( pan != panEnd )
-	{
-		*outputBands = *bands*SIMDBands(*pan);
-		
-		pan++;
-		bands++;
-		outputBands++;
-	}
+	// Zero the part past the end of the sampled IR.
+	om::util::zeroPOD( outputBands + irEnd, partitionLength - irEnd );
 }
 
 
@@ -420,11 +996,14 @@ void ImpulseResponse:: interleaveBands( const SampledIR& ir, const Float* pan, F
 
 
 void ImpulseResponse:: panDirections( const SampledIR& ir, const ChannelLayout& channelLayout, const Matrix3f& orientation,
-										internal::SampleBuffer<Float>& pan )
+										Index partitionOffset, Size partitionLength, internal::SampleBuffer<Float>& pan )
 {
 	const Size numChannels = channelLayout.getChannelCount();
-	const Index irStart = ir.getStartTimeInSamples();
-	const Size irLength = ir.getLengthInSamples();
+	
+	// Pan the part of the partition that overlaps the sampled IR, storing the pan values relative to the partition.
+	const Index partitionEnd = partitionOffset + partitionLength;
+	const Index irStart = math::clamp( ir.getStartTimeInSamples(), partitionOffset, partitionEnd );
+	const Size irLength = math::max( math::clamp( ir.getLengthInSamples(), partitionOffset, partitionEnd ), irStart );
 
 	if (channelLayout.getType() == ChannelLayout::AMBISONIC_B)
 	{
@@ -444,16 +1023,16 @@ void ImpulseResponse:: panDirections( const SampledIR& ir, const ChannelLayout&
 				Float azimuth, elevation;
 				azimuth = math::atan2( -d.z, d.x );
 				elevation = math::asin( d.y );
-				pan.getChannel(0)[i] = math::sqrt(2.0f) / 2;
-				pan.getChannel(1)[i] = math::abs(math::cos(azimuth) * math::cos(elevation));
-				pan.getChannel(2)[i] = math::abs(math::sin(azimuth) * math::cos(elevation));
-				pan.getChannel(3)[i] = math::abs(math::sin(elevation));
+				pan.getChannel(0)[i - partitionOffset] = math::sqrt(2.0f) / 2;
+				pan.getChannel(1)[i - partitionOffset] = math::abs(math::cos(azimuth) * math::cos(elevation));
+				pan.getChannel(2)[i - partitionOffset] = math::abs(math::sin(azimuth) * math::cos(elevation));
+				pan.getChannel(3)[i - partitionOffset] = math::abs(math::sin(elevation));
 			}
 			else
 			{
-				pan.getChannel(0)[i] = math::sqrt(2.0f) / 2;
+				pan.getChannel(0)[i - partitionOffset] = math::sqrt(2.0f) / 2;
 				for ( Index c = 1; c < numChannels; c++ )
-					pan.getChannel(c)[i] = Float32(1);
+					pan.getChannel(c)[i - partitionOffset] = Float32(1);
 			}
 		}
 	}
@@ -464,37 +1043,15 @@ void ImpulseResponse:: panDirections( const SampledIR& ir, const ChannelLayout&
 			// Mono IR.
 			case 1:
 			{
-				om::util::set( pan.getChannel(0) + irStart, Float32(1), irLength - irStart );
+				om::util::set( pan.getChannel(0) + (irStart - partitionOffset), Float32(1), irLength - irStart );
 			}
 				break;
 
 			default:
 			{
-				// Build the panning buffer.
-				const Vector3f* directions = ir.getDirections() + irStart;
-
-				for ( Index i = irStart; i < irLength; i++, directions++ )
-				{
-					Real directionMagnitude2 = (*directions).getMagnitudeSquared();
-
-					if ( directionMagnitude2 > math::epsilon<Real>() )
-					{
-						// Compute the normalized panning direction for this sample.
-						const Vector3f d = (*directions / math::sqrt(directionMagnitude2))*orientation;
-
-						// Pan the impulse among the output channel layout. Skip the impulse if panning failed.
-						if ( channelLayout.panDirection( d, channelGains ) )
-						{
-							for ( Index c = 0; c < numChannels; c++ )
-								pan.getChannel(c)[i] = channelGains[c];
-						}
-					}
-					else
-					{
-						for ( Index c = 0; c < numChannels; c++ )
-							pan.getChannel(c)[i] = Float32(1);
-					}
-				}
+				// Pan the directions using a lookup table for the channel layout.
+				panTable.setLayout( channelLayout );
+				panTable.pan( ir.getDirections() + irStart, irLength - irStart, orientation, pan, irStart - partitionOffset );
 			}
 				break;
 		}
@@ -517,62 +1074,20 @@ void ImpulseResponse:: panDirections( const SampledIR& ir, const ChannelLayout&
 
 void ImpulseResponse:: getMetrics( const SoundSourceIR& ir, const FrequencyBands& frequencies, Float snrDB, IRMetrics& metrics )
 {
-	//****************************************************************************
-	// Build the energy time curve from the IR.
-	
-	const SampledIR& sampledIR = ir.getSampledIR();
-	const Size irLength = ir.getLengthInSamples();
-	const Size sampledIRStart = sampledIR.getStartTimeInSamples();
-	const Size sampledIRLength = sampledIR.getLengthInSamples();
-	const Float sampleRate = (Float)ir.getSampleRate();
-	const SIMDBands* irSamples = (const SIMDBands*)sampledIR.getIntensity();
-	
-	om::PODArray<SIMDBands,1,Size,AlignedAllocator<16> > etc;
-	etc.allocate( irLength );
-	etc.zero();
-	
-	// Copy the sampled IR into the etc.
-	om::util::copyPOD( etc.getPointer() + sampledIRStart, irSamples + sampledIRStart, sampledIRLength - sampledIRStart );
-	
-	// Add all paths to the etc.
-	const Size numPaths = ir.getPathCount();
-	
-	for ( Index i = 0; i < numPaths; i++ )
-	{
-		const SoundPath& path = ir.getPath(i);
-		const Float delay = path.getDistance() / path.getSpeed();
-		const Index sampleIndex = (Index)math::floor( delay*sampleRate );
-		
-		etc[sampleIndex] += SIMDBands::loadUnaligned( (Float*)&path.getIntensity() );
-	}
-	
-	//****************************************************************************
-	
 	const Float binTime = 0.01f;
 	const Size binSize = Size(math::ceiling(binTime*ir.getSampleRate()));
-	const Size binCount = Size(math::ceiling(Float(irLength) / Float(binSize)));
-	om::PODArray<Float32,1,Size,AlignedAllocator<16> > bins;
+	const Size binCount = Size(math::ceiling(Float(ir.getLengthInSamples()) / Float(binSize)));
+	
+	// Bin the energy in all bands at once, without building the energy time curve.
+	om::PODArray<SIMDBands,1,Size,AlignedAllocator<16> > bins;
 	bins.allocate( binCount );
 	
+	SampledIR expandedIR;
+	binEnergy( ir, ir.expandSampledIR( expandedIR ), binTime, bins.getPointer(), binCount );
+	
 	// Get the metrics for each frequency band.
 	for ( Index band = 0; band < GSOUND_FREQUENCY_COUNT; band++ )
-	{
-		// Bin the IR.
-		bins.zero();
-		for ( Index i = 0, b = 0; i < irLength; b++ )
-		{
-			const Size bSize = math::min( irLength - i, binSize );
-			const Size bEnd = i + bSize;
-			
-			for ( Index j = i; j < bEnd; j++ )
-				bins[b] += etc[j][band];
-			
-			i += bSize;
-		}
-		
-		// Get the metrics for this frequency band.
-		getMetrics( bins.getPointer(), binCount, 1, binTime, snrDB, metrics, band );
-	}
+		getMetrics( &bins[0][band], binCount, GSOUND_FREQUENCY_COUNT, binTime, snrDB, metrics, band );
 }
 
 
@@ -634,6 +1149,36 @@ void ImpulseResponse:: getMetrics( const SoundBuffer& ir, const FrequencyBands&
 
 
 
+void ImpulseResponse:: binEnergy( const SoundSourceIR& sourceIR, const SampledIR& sampledIR, Float binTime,
+									SIMDBands* bins, Size binCount )
+{
+	const Size sampledIRLength = sampledIR.getLengthInSamples();
+	const Size binSize = Size(math::ceiling(binTime*sourceIR.getSampleRate()));
+	
+	om::util::zeroPOD( bins, binCount );
+	
+	// Bin the sampledIR.
+	for ( Index start = 0, b = 0; start < sampledIRLength; b++ )
+	{
+		const Size bSize = math::min( sampledIRLength - start, binSize );
+		bins[b] = math::sum( (const SIMDBands*)sampledIR.getIntensity() + start, bSize );
+		start += bSize;
+	}
+	
+	// Add the path contributions.
+	const Size numPaths = sourceIR.getPathCount();
+	
+	for ( Index i = 0; i < numPaths; i++ )
+	{
+		const SoundPath& path = sourceIR.getPath(i);
+		const Index binIndex = math::min( (Index)math::floor( path.getDelay() / binTime ), binCount - 1 );
+		bins[binIndex] += SIMDBands::loadUnaligned( (Float*)&path.getIntensity() );
+	}
+}
+
+
+
+
 template < typename T >
 static Index advanceMax( const T* bins, Size numBins, Size stride, Index position )
 {
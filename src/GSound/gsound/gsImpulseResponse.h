@@ -57,7 +57,8 @@
 #include "gsSoundListenerIR.h"
 #include "gsIRRequest.h"
 #include "gsIRMetrics.h"
-#include "internal/gsSIMDCrossover.h"
+#include "internal/gsBandNoise.h"
+#include "internal/gsChannelPanTable.h"
 #include "internal/gsSampleBuffer.h"
 #include "internal/gsHRTFFilter.h"
 
@@ -82,6 +83,19 @@ class ImpulseResponse
 {
 	public:
 		
+		//********************************************************************************
+		//******	Public Type Declarations
+			
+			
+			/// The type of function that receives each block of a streamed impulse response.
+			/**
+			  * The function is given a buffer that contains the block's samples for all
+			  * channels and the index of the block's first sample in the IR. The buffer
+			  * is reused after the function returns.
+			  */
+			typedef Function<void ( const SoundBuffer& block, Index blockStart )> BlockFunction;
+		
+		
 		//********************************************************************************
 		//******	Constructors
 			
@@ -90,6 +104,14 @@ class ImpulseResponse
 			ImpulseResponse();
 			
 			
+		//********************************************************************************
+		//******	Destructor
+			
+			
+			/// Destroy an impulse response, releasing all internal resources.
+			~ImpulseResponse();
+		
+		
 		//********************************************************************************
 		//******	Response Update Methods
 			
@@ -108,6 +130,24 @@ class ImpulseResponse
 						const IRRequest& request );
 			
 			
+			/// Synthesize the IR for the specified source IR in blocks of the given length and pass each block to the output function.
+			/**
+			  * This produces the same IR as setIR(), up to rounding error, but only one block
+			  * and the filter tails of its paths are stored at a time. The memory that is
+			  * used does not depend on the length of the IR, so that long IRs with many
+			  * channels can be written directly to a file or another consumer.
+			  * The crossover filter history is kept from one block to the next.
+			  *
+			  * The blocks are output in order and all have the given length except for the last.
+			  * The normalize flag of the request is ignored because the largest sample is not
+			  * known until the last block, so the blocks are always scaled based on the source
+			  * power and listener sensitivity. The energy bins and metrics are computed
+			  * as for setIR(), but this object's buffer does not contain the IR afterwards.
+			  */
+			void streamIR( const SoundSourceIR& sourceIR, const SoundListener& listener,
+							const IRRequest& request, Size blockLength, const BlockFunction& output );
+		
+		
 		//********************************************************************************
 		//******	IR Length Accessor Methods
 			
@@ -126,6 +166,18 @@ class ImpulseResponse
 			}
 			
 			
+			/// Return the length in samples of the IR that setIR() produces for the specified source IR and listener.
+			/**
+			  * This allows a caller to allocate output storage for many IRs before
+			  * any of them are synthesized. The IR of a microphone array listener is
+			  * longer by the time that sound takes to cross the array's radius.
+			  */
+			GSOUND_INLINE static Size getLengthInSamples( const SoundSourceIR& sourceIR, const SoundListener& listener )
+			{
+				return sourceIR.getLengthInSamples() + FILTER_PADDING + getMicrophoneLead( sourceIR, listener );
+			}
+			
+			
 		//********************************************************************************
 		//******	Channel Layout Accessor Methods
 			
@@ -234,23 +286,106 @@ class ImpulseResponse
 			
 	private:
 		
+		//********************************************************************************
+		//******	Private Copy Operations
+			
+			
+			/// Declared private to prevent copying because the HRTF filter data cannot be copied.
+			ImpulseResponse( const ImpulseResponse& other );
+			
+			
+			/// Declared private to prevent copying because the HRTF filter data cannot be copied.
+			ImpulseResponse& operator = ( const ImpulseResponse& other );
+		
+		
+		//********************************************************************************
+		//******	Private Static Data Members
+			
+			
+			/// The number of samples of padding added to the end of each IR for the crossover filter tails.
+			static const Size FILTER_PADDING = 2048;
+			
+			
 		//********************************************************************************
 		//******	Private Type Declarations
 			
 			
 			/// Define the type of SIMD crossover to use for frequency band filtering.
-			typedef internal::SIMDCrossover<Float32,GSOUND_FREQUENCY_COUNT> CrossoverType;
+			typedef internal::BandNoise::CrossoverType CrossoverType;
 			
 			
 		//********************************************************************************
 		//******	Private Helper Methods
 			
 			
-			static void interleaveBands( const SampledIR& ir, const Float* pan, Float* output );
+			/// Bin the energy in the source IR and its expanded sampled IR and compute its metrics if the request asks for them.
+			void updateBins( const SoundSourceIR& sourceIR, const SampledIR& sampledIR, const IRRequest& request );
+			
+			
+			/// Return the gain that is applied to an IR because of the source power and listener sensitivity.
+			static Gain getGain( const SoundSourceIR& sourceIR, const SoundListener& listener );
+			
+			
+			/// Synthesize the IR in blocks, either into this IR's buffer as one block or to the output function if it is not NULL.
+			void synthesizeBlocks( const SoundSourceIR& sourceIR, const SampledIR& sampledIR, const SoundListener& listener,
+									const IRRequest& request, Size blockLength, const BlockFunction* output );
+			
+			
+			/// Sort the indices of the paths by the IR block that they start in, keeping the paths' order within each block.
+			/**
+			  * If the path indices are NULL, all paths in the source IR are sorted. Paths
+			  * outside of the given length after the start are skipped. Each path is sorted
+			  * by its arrival time minus the lead, so that paths which can arrive up to the
+			  * lead earlier at a microphone are in the block of their earliest arrival.
+			  */
+			static void sortPathsByBlock( const SoundSourceIR& sourceIR, const Index* pathIndices, Size numPaths,
+										Index start, Size length, Size blockLength,
+										Array<Index>& blockStarts, Array<Index>& blockPaths, Size lead = 0 );
+			
+			
+			/// Return the sample index that a path is sorted by, its arrival time minus the given lead in samples.
+			GSOUND_FORCE_INLINE static Index getSortIndex( const SoundPath& path, SampleRate sampleRate, Size lead )
+			{
+				const Index sampleIndex = (Index)math::floor( (path.getDistance() / path.getSpeed())*sampleRate );
+				
+				return sampleIndex > lead ? sampleIndex - lead : Index(0);
+			}
+			
+			
+			/// Return the channel layout of the IR for the specified request and listener.
+			static ChannelLayout getLayout( const IRRequest& request, const SoundListener& listener );
+			
+			
+			/// Return the maximum number of samples that an arrival at a microphone can precede or follow the arrival at the listener.
+			static Size getMicrophoneLead( const SoundSourceIR& sourceIR, const SoundListener& listener );
+			
+			
+			/// Return the speed of sound that is used to convert the microphone offsets to sample delays.
+			static Real getMicrophoneSpeed( const SoundSourceIR& sourceIR );
+			
+			
+			/// Add a range of the sampled IR to each microphone channel of the block, delayed for each sample's direction.
+			void addMicrophoneSampledIR( const SampledIR& ir, const CrossoverType& crossover, const SIMDBands* noise,
+										Index blockStart, Index sampledStart, Size sampledSize,
+										Size bufferLength, Real samplesPerMeter );
+			
+			
+			/// Add the specified paths to each microphone channel with the arrival time and attenuation at the microphone.
+			void addMicrophonePaths( const SoundSourceIR& sourceIR, const Index* pathIndices, Size numPaths,
+									Index blockStart, Size bufferLength, Size paddedIRLength, Size numMicrophones );
+			
+			
+			static void interleaveBands( const SampledIR& ir, Index partitionOffset, Size partitionLength,
+										const Float* pan, Float* output );
 			
 			
 			void panDirections( const SampledIR& ir, const ChannelLayout& channelLayout, const Matrix3f& orientation,
-								internal::SampleBuffer<Float>& pan );
+								Index partitionOffset, Size partitionLength, internal::SampleBuffer<Float>& pan );
+			
+			
+			/// Add the energy of the expanded sampled IR and discrete paths to bins of the given length in seconds.
+			static void binEnergy( const SoundSourceIR& sourceIR, const SampledIR& sampledIR, Float binTime,
+									SIMDBands* bins, Size binCount );
 			
 			
 			template < typename T >
@@ -261,6 +396,20 @@ class ImpulseResponse
 			static void energyTimeCurve( const SoundBuffer& input, SoundBuffer& result );
 			
 			
+			/// Filter the current HRTF's spherical harmonic filters into frequency bands and convert them to frequency domain.
+			void prepareHRTFBandFilters( Size numChannels, Size numFrequencyBands, Size shOrder );
+			
+			
+			/// Spatialize the given discrete paths by accumulating them in the HRTF's spherical harmonic basis.
+			/**
+			  * The paths are added to this IR's buffer relative to the given IR start,
+			  * for the given length of the buffer.
+			  */
+			void accumulateHRTFPaths( const SoundSourceIR& sourceIR, const SoundListener& listener,
+									const Index* pathIndices, Size numPaths, Index irStart, Size irLength,
+									Size numChannels, Size numFrequencyBands, Size shOrder );
+		
+		
 		//********************************************************************************
 		//******	Private Data Members
 			
@@ -285,10 +434,6 @@ class ImpulseResponse
 			FrequencyBands frequencies;
 			
 			
-			/// An object that is used to filter the impulse response into different frequency bands.
-			CrossoverType crossover;
-			
-			
 			/// A temporary buffer of pan values for each channel (stored packed one after another).
 			internal::SampleBuffer<Float> pan;
 			
@@ -297,26 +442,54 @@ class ImpulseResponse
 			internal::SampleBuffer<Float> bandIRs;
 			
 			
+			/// The crossover filter history for each channel, kept from one block of the IR to the next.
+			om::PODArray<CrossoverType::History,1,Size,AlignedAllocator<16> > crossoverHistories;
+			
+			
+			/// The start index in the sorted path list of each block's paths.
+			Array<Index> blockStarts;
+			
+			
+			/// The indices of the paths in the source IR, sorted by block.
+			Array<Index> blockPaths;
+			
+			
+			/// A buffer that contains the scaled samples of a streamed IR block.
+			SoundBuffer blockBuffer;
+			
+			
+			/// A temporary sampled IR that a compact source IR is expanded into before it is synthesized.
+			SampledIR expandedIR;
+			
+			
 			/// A temporary array of gain coefficients used for panning sound paths.
 			Array<Gain> channelGains;
 			
 			
-			/// A spherical harmonic basis used for HRTF interpolation.
-			SHExpansion<Float> shBasis;
+			/// A lookup table that pans the sampled IR's directions to the current channel layout.
+			internal::ChannelPanTable panTable;
 			
 			
-			/// A buffer of filtered noise that is used to reconstruct the phase of the pressure IR.
-			om::PODArray<SIMDBands,1,Size,AlignedAllocator<16> > noise;
+			/// The world-space offsets from the listener to each microphone of a microphone array listener.
+			Array<Vector3f> microphoneOffsets;
 			
 			
-			/// A random number generator used to generate the IR's filtered noise.
-			om::math::Random<Float> noiseRand;
+			/// A spherical harmonic basis used for HRTF interpolation.
+			SHExpansion<Float> shBasis;
+			
+			
+			/// The shared crossover and filtered noise that are used to reconstruct the phase of the pressure IR.
+			Shared<const internal::BandNoise> bandNoise;
 			
 			
 			/// A temporary buffer that contains a broadband interpolated HRTF filter.
 			internal::SampleBuffer<Float> hrtfBuffer;
 			
 			
+			/// A unit impulse filtered into the frequency bands, which is added to the IR for each path when no HRTF is used.
+			internal::SampleBuffer<Float> impulseBands;
+			
+			
 			/// An object that maintains data for an HRTF so that it can be used to filter audio.
 			internal::HRTFFilter hrtfFilter;
 			
@@ -325,6 +498,42 @@ class ImpulseResponse
 			const HRTF* hrtf;
 			
 			
+			/// A real FFT used to convolve blocks of accumulated paths with the spherical harmonic HRTF filters.
+			math::FFTReal<Float32>* hrtfFFT;
+			
+			
+			/// The frequency-domain band-filtered HRTF filters for each channel, spherical harmonic coefficient and band.
+			internal::SampleBuffer<Float> hrtfBandFilters;
+			
+			
+			/// The per-band pressure of the paths in one IR block, projected into the spherical harmonic basis.
+			internal::SampleBuffer<Float> hrtfBlock;
+			
+			
+			/// A temporary buffer where each channel's filtered block is accumulated in frequency domain.
+			internal::SampleBuffer<Float> hrtfBlockOutput;
+			
+			
+			/// The start index in the sorted path list of each IR block's paths.
+			Array<Index> hrtfBlockStarts;
+			
+			
+			/// The indices of the paths in the source IR, sorted by IR block.
+			Array<Index> hrtfBlockPaths;
+			
+			
+			/// A pointer to the HRTF that the band-filtered HRTF filters were computed for.
+			const HRTF* hrtfBandFiltersHRTF;
+			
+			
+			/// The frequency bands that the band-filtered HRTF filters were computed for.
+			FrequencyBands hrtfBandFiltersFrequencies;
+			
+			
+			/// The sample rate that the band-filtered HRTF filters were computed for.
+			SampleRate hrtfBandFiltersSampleRate;
+
+
 			
 };
 
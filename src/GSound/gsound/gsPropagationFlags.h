@@ -245,6 +245,16 @@ class PropagationFlags
 				  */
 				DOPPLER_SORTING = (1 << 18),
 				
+				/// A flag indicating whether or not sampled IRs are stored in compact form.
+				/**
+				  * If this flag is set, the sampled IR for each source is converted to a
+				  * reduced-precision, block-compressed representation after each listener has been
+				  * propagated, and its full-precision storage is released. This reduces the memory
+				  * required when there are many listeners at the cost of some precision and the
+				  * time to expand each IR when it is rendered.
+				  */
+				COMPACT_IR = (1 << 20),
+				
 				/// A flag indicating whether or not statistical information about the propagation/rendering systems should be output.
 				/**
 				  * If this flag is set and a corresponding statistics object is set in the request,
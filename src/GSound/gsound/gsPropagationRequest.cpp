@@ -100,6 +100,7 @@ PropagationRequest:: PropagationRequest()
 		numDiffuseSamples( 1 ),
 		numVisibilityRays( 200 ),
 		rayOffset( 0.0001f ),
+		randomSeed( 0 ),
 		
 		// Caching parameters.
 		responseTime( 3.0f ),
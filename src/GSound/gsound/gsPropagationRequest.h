@@ -322,6 +322,17 @@ class PropagationRequest
 			Real rayOffset;
 			
 			
+			/// The seed for the random streams that generate ray directions and visibility samples.
+			/**
+			  * Each ray draws its random numbers from a counter-based stream that is keyed by this seed,
+			  * the frame's timestamp, the listener index, and the ray's index. The same request therefore
+			  * produces the same set of rays regardless of the number of threads or how work is scheduled,
+			  * and any ray can be regenerated on its own. Calling internalData.reset() restarts
+			  * the frame timestamp so that a sequence of frames can be reproduced.
+			  */
+			UInt32 randomSeed;
+		
+		
 		//********************************************************************************
 		//******	Caching Parameters
 			
@@ -251,6 +251,36 @@ Bool SampledIR:: addIR( const SampledIR& other )
 
 
 
+Bool SampledIR:: addIR( const SampledIR& other, Index startIndex, Size number )
+{
+	if ( sampleRate != other.sampleRate )
+		return false;
+	
+	// Clamp the range to the valid samples of both IRs.
+	const Index rangeStart = math::max( startIndex, other.getStartTimeInSamples() );
+	const Index rangeEnd = math::min( math::min( startIndex + number, other.numSamples ), numSamples );
+	
+	if ( rangeStart >= rangeEnd )
+		return true;
+	
+	const Size rangeSize = rangeEnd - rangeStart;
+	
+	// Add the other IR's range.
+	math::add( (Real*)(directions + rangeStart), (Real*)(other.directions + rangeStart), 3*rangeSize );
+	
+	if ( sourceDirectionsEnabled && other.sourceDirectionsEnabled )
+		math::add( (Real*)(sourceDirections + rangeStart), (Real*)(other.sourceDirections + rangeStart), 3*rangeSize );
+	
+	math::add( intensity + rangeStart*numFrequencyBands,
+				other.intensity + rangeStart*numFrequencyBands,
+				rangeSize*numFrequencyBands );
+	
+	return true;
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############
@@ -309,20 +339,20 @@ void SampledIR:: reset()
 {
 	if ( intensity )
 	{
-		intensity = NULL;
 		util::deallocateAligned( intensity );
+		intensity = NULL;
 	}
 	
 	if ( directions )
 	{
-		directions = NULL;
 		util::deallocateAligned( directions );
+		directions = NULL;
 	}
 	
 	if ( sourceDirections )
 	{
-		sourceDirections = NULL;
 		util::deallocateAligned( sourceDirections );
+		sourceDirections = NULL;
 	}
 	
 	startOffset = math::max<Index>();
@@ -380,17 +410,14 @@ void SampledIR:: setSourceDirectionsEnabled( Bool newSourceDirectionsEnabled )
 
 FrequencyBandResponse SampledIR:: getTotalIntensity() const
 {
-	FrequencyBandResponse total( Float(0) );
-	const FrequencyBandResponse* bandIntensities = (const FrequencyBandResponse*)intensity;
-	const FrequencyBandResponse* const bandIntensitiesEnd = bandIntensities + numSamples;
+	if ( numSamples == 0 )
+		return FrequencyBandResponse( Float(0) );
 	
-	while ( bandIntensities != bandIntensitiesEnd )
-	{
-		total += *bandIntensities;
-		bandIntensities++;
-	}
+	// Sum all bands at once, skipping the zero samples before the start of the IR.
+	const Index startIndex = this->getStartTimeInSamples();
+	const SIMDBands total = math::sum( (const SIMDBands*)intensity + startIndex, numSamples - startIndex );
 	
-	return total;
+	return FrequencyBandResponse( (const Real*)&total );
 }
 
 
@@ -236,9 +236,10 @@ class SampledIR
 				Index sampleIndex = (Index)math::floor( math::max( delay*sampleRate, SampleRate(0) ) );
 				Size newNumSamples = sampleIndex + 1;
 				
-				// Reallocate or zero the IR if necessary.
+				// Reallocate or zero the IR if necessary. The capacity grows geometrically so that
+				// an IR built from impulses with increasing delays is not reallocated for every impulse.
 				if ( newNumSamples > capacity )
-					reallocate( newNumSamples );
+					reallocate( math::max( newNumSamples, capacity + capacity/2 ) );
 
 //                if ( sampleIndex > numSamples )  // originally, Carl didn't account for the equal case
                 if ( sampleIndex >= numSamples )
@@ -273,6 +274,18 @@ class SampledIR
 			Bool addIR( const SampledIR& other );
 			
 			
+			/// Accumulate a range of samples from another IR in this one, without changing this IR's length or start time.
+			/**
+			  * Only the samples in the range that are within both IRs are added, so this IR
+			  * should first be made long enough to hold the other IR. Since no other samples are
+			  * modified, disjoint ranges of the same IR can be accumulated concurrently by different threads.
+			  *
+			  * If the two IRs do not have the same sample rate, the method fails and FALSE is returned.
+			  * Otherwise, the method succeeds and returns TRUE.
+			  */
+			Bool addIR( const SampledIR& other, Index startIndex, Size number );
+			
+			
 			/// Reset the IR to be of length 0 with no impulses.
 			/**
 			  * This method keeps the IR storage to avoid many reallocations.
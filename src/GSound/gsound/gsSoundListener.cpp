@@ -127,6 +127,31 @@ FrequencyBandResponse SoundListener:: getThresholdPower( const FrequencyBands& f
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############
+//############		Microphone Array Accessor Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Real SoundListener:: getMicrophoneRadius() const
+{
+	const Size numMicrophones = microphones.getSize();
+	Real radius = 0;
+	
+	for ( Index i = 0; i < numMicrophones; i++ )
+		radius = math::max( radius, microphones[i].getMagnitude() );
+	
+	return radius;
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############
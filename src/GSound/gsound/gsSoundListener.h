@@ -217,6 +217,56 @@ class SoundListener : public SoundDetector
 			FrequencyBandResponse getThresholdPower( const FrequencyBands& frequencies ) const;
 			
 			
+		//********************************************************************************
+		//******	Microphone Array Accessor Methods
+			
+			
+			/// Return the number of microphones in this listener's microphone array.
+			/**
+			  * A listener with no microphones is a single point receiver whose impulse
+			  * responses are panned among a channel layout. If a listener has microphones,
+			  * sound is still propagated once for the listener's position, but the impulse
+			  * response has one omnidirectional channel for each microphone. The arrival time
+			  * and distance attenuation of each path are corrected for each microphone's
+			  * position, and the direct sound is validated separately for each microphone.
+			  */
+			GSOUND_INLINE Size getMicrophoneCount() const
+			{
+				return microphones.getSize();
+			}
+			
+			
+			/// Return the position of the microphone at the specified index, relative to the listener.
+			/**
+			  * The position is specified in meters in the listener's local coordinate frame.
+			  */
+			GSOUND_INLINE const Vector3f& getMicrophone( Index microphoneIndex ) const
+			{
+				return microphones[microphoneIndex];
+			}
+			
+			
+			/// Add a microphone at the specified position relative to the listener to the end of the microphone array.
+			/**
+			  * The position is specified in meters in the listener's local coordinate frame.
+			  */
+			GSOUND_INLINE void addMicrophone( const Vector3f& position )
+			{
+				microphones.add( position );
+			}
+			
+			
+			/// Remove all microphones from this listener, making it a single point receiver.
+			GSOUND_INLINE void clearMicrophones()
+			{
+				microphones.clear();
+			}
+			
+			
+			/// Return the largest distance from the listener's position to one of its microphones.
+			Real getMicrophoneRadius() const;
+		
+		
 		//********************************************************************************
 		//******	Flags Accessor Methods
 			
@@ -373,6 +423,10 @@ class SoundListener : public SoundDetector
 			FrequencyResponse threshold;
 			
 			
+			/// The positions of the microphones in the listener's microphone array, relative to the listener.
+			ArrayList<Vector3f> microphones;
+			
+			
 			
 };
 
@@ -208,6 +208,28 @@ void SoundListenerIR:: trim()
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Compaction Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void SoundListenerIR:: compact()
+{
+	const Size numSourceIRs = sourceIRs.getSize();
+	
+	for ( Index i = 0; i < numSourceIRs; i++ )
+		sourceIRs[i].compact();
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############
@@ -245,6 +245,18 @@ class SoundListenerIR
 			void trim();
 			
 			
+		//********************************************************************************
+		//******	IR Compaction Method
+			
+			
+			/// Convert the sampled IRs for all sources to compact form, releasing their full-precision storage.
+			/**
+			  * This reduces the memory used by the listener's sampled IRs to about a fifth,
+			  * at the cost of some precision. The IRs are expanded again when they are rendered.
+			  */
+			void compact();
+		
+		
 		//********************************************************************************
 		//******	Storage Size Accessor Methods
 			
@@ -1207,6 +1207,7 @@ class SoundListenerRenderer:: UpdateThreadState
 			totalSize += pathSortIDs.getCapacity()*sizeof(PathSortID);
 			totalSize += channelGains.getSize()*sizeof(Gain);
 			totalSize += shBasis.getCoefficientCount()*sizeof(Float32);
+			totalSize += expandedIR.getSizeInBytes();
 			
 			return totalSize;
 		}
@@ -1230,6 +1231,9 @@ class SoundListenerRenderer:: UpdateThreadState
 		/// A temporary spherical harmonic basis for a single 3D direction vector.
 		SHExpansion<Float32> shBasis;
 		
+		/// A temporary sampled IR that a compact source IR is expanded into before it is rendered.
+		SampledIR expandedIR;
+
 };
 
 
@@ -2090,7 +2094,7 @@ void SoundListenerRenderer:: updateConvolutionIR( ConvolutionState& convolutionS
 												const SoundListener& listener, const FrequencyBands& frequencies,
 												UpdateThreadState& threadState )
 {
-	const SampledIR& ir = sourceIR.getSampledIR();
+	const SampledIR& ir = sourceIR.expandSampledIR( threadState.expandedIR );
 	const Size sampledIRLength = math::min( ir.getLengthInSamples(), convolutionState.maxIRLengthInSamples );
 	const Index irStart = sourceIR.getStartTimeInSamples();
 	const Size irLength = math::min( sourceIR.getLengthInSamples(), convolutionState.maxIRLengthInSamples );
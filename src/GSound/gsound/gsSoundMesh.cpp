@@ -57,6 +57,217 @@ GSOUND_NAMESPACE_START
 //##########################################################################################
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Mesh Image Class Declaration
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+class SoundMesh:: MeshImage
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a mesh image for the specified memory-mapped file, which the image then owns.
+			GSOUND_INLINE MeshImage( om::fs::File* newFile, const UByte* newData, Size newSize )
+				:	file( newFile ),
+					data( newData ),
+					size( newSize )
+			{
+			}
+			
+			
+			/// Create a mesh image for the specified aligned memory allocation, which the image then owns.
+			GSOUND_INLINE MeshImage( UByte* newData, Size newSize )
+				:	file( NULL ),
+					data( newData ),
+					size( newSize )
+			{
+			}
+		
+		
+		//********************************************************************************
+		//******	Destructor
+			
+			
+			/// Destroy this mesh image, unmapping the file or deallocating the memory.
+			GSOUND_INLINE ~MeshImage()
+			{
+				if ( file )
+					util::destruct( file );
+				else if ( data )
+					util::deallocateAligned( data );
+			}
+		
+		
+		//********************************************************************************
+		//******	Data Members
+			
+			
+			/// The memory-mapped file for this image, or NULL if the image is in allocated memory.
+			om::fs::File* file;
+			
+			
+			/// A pointer to the start of the image's memory.
+			const UByte* data;
+			
+			
+			/// The size in bytes of the image's memory.
+			Size size;
+	
+	
+	private:
+		
+		//********************************************************************************
+		//******	Private Copy Operations
+			
+			
+			/// Declared private to prevent copying of the image memory.
+			MeshImage( const MeshImage& other );
+			
+			
+			/// Declared private to prevent copying of the image memory.
+			MeshImage& operator = ( const MeshImage& other );
+
+
+
+};
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Image Header Class Declaration
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+class SoundMesh:: ImageHeader
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructor
+			
+			
+			/// Create a new header for an empty version-2 mesh file.
+			GSOUND_INLINE ImageHeader()
+			{
+				om::util::zeroPOD( this, 1 );
+				om::util::copy( format, FORMAT, 9 );
+				format[9] = VERSION;
+				format[10] = ENDIANNESS;
+			}
+		
+		
+		//********************************************************************************
+		//******	Validation Methods
+			
+			
+			/// Return whether or not the specified data starts with a native version-2 mesh file header.
+			GSOUND_INLINE static Bool isImage( const UByte* data, Size dataSize )
+			{
+				if ( data == NULL || dataSize < sizeof(ImageHeader) )
+					return false;
+				
+				for ( Index i = 0; i < 9; i++ )
+				{
+					if ( data[i] != FORMAT[i] )
+						return false;
+				}
+				
+				return data[9] == VERSION && data[10] == ENDIANNESS;
+			}
+			
+			
+			/// Return whether or not the specified section is aligned and fits within the image.
+			/**
+			  * The element count is compared to the remaining size before it is multiplied,
+			  * so that a corrupt count can't overflow.
+			  */
+			GSOUND_INLINE Bool hasSection( UInt64 offset, UInt64 count, Size elementSize ) const
+			{
+				return offset % IMAGE_ALIGNMENT == 0 && offset >= sizeof(ImageHeader) &&
+						offset <= imageSize && count <= (imageSize - offset) / elementSize;
+			}
+		
+		
+		//********************************************************************************
+		//******	Static Data Members
+			
+			
+			/// The characters that start every mesh file.
+			static const UByte FORMAT[9];
+			
+			
+			/// The version of the mesh file format that has this header.
+			static const UByte VERSION = 2;
+			
+			
+			/// The endianness code of the current platform, 0 if little endian, 1 if big endian.
+#if defined(GSOUND_BIG_ENDIAN)
+			static const UByte ENDIANNESS = 1;
+#else
+			static const UByte ENDIANNESS = 0;
+#endif
+			
+			
+			/// The size in bytes of a vertex record: 3*float32.
+			static const Size VERTEX_SIZE = 3*sizeof(Float32);
+			
+			
+			/// The size in bytes of a triangle record: 10*uint32.
+			static const Size TRIANGLE_SIZE = 10*sizeof(UInt32);
+			
+			
+			/// The size in bytes of a diffraction edge record: 6*uint32, 2*uint16, 8*float32.
+			static const Size EDGE_SIZE = 6*sizeof(UInt32) + 2*sizeof(UInt16) + 8*sizeof(Float32);
+		
+		
+		//********************************************************************************
+		//******	Data Members
+			
+			
+			// The header is 128 bytes, starting with the same 16 bytes as a version-1 file.
+			UByte format[16];
+			UInt64 imageSize;
+			UInt64 numVertices;
+			UInt64 numTriangles;
+			UInt64 numEdges;
+			UInt64 numNeighbors;
+			UInt64 numMaterials;
+			UInt64 materialsOffset;
+			UInt64 materialsSize;
+			UInt64 verticesOffset;
+			UInt64 trianglesOffset;
+			UInt64 edgesOffset;
+			UInt64 neighborsOffset;
+			UInt64 bvhOffset;
+			UInt64 bvhSize;
+
+
+
+};
+
+
+const UByte SoundMesh::ImageHeader:: FORMAT[9] = { 'S','O','U','N','D','M','E','S','H' };
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -73,6 +284,7 @@ SoundMesh:: SoundMesh()
 		triangles(),
 		materials(),
 		bvh(),
+		image(),
 		diffractionGraph(),
 		userData( NULL )
 {
@@ -86,6 +298,7 @@ SoundMesh:: SoundMesh( const SoundMesh& other )
 		materials(),
 		triangles(),
 		bvh( NULL ),
+		image( other.image ),
 		diffractionGraph(),
 		boundingSphere( other.boundingSphere ),
 		boundingBox( other.boundingBox ),
@@ -141,6 +354,7 @@ SoundMesh& SoundMesh:: operator = ( const SoundMesh& other )
 			util::destruct( bvh );
 		
 		this->setData( other.vertices, other.triangles, other.materials, other.diffractionGraph );
+		image = other.image;
 		name = other.name;
 		userData = other.userData;
 	}
@@ -192,7 +406,8 @@ Size SoundMesh:: getSizeInBytes() const
 void SoundMesh:: setData( const Shared<ArrayList<SoundVertex> >& newVertices,
 							const Shared<ArrayList<TriangleType> >& newTriangles,
 							const Shared<ArrayList<SoundMaterial> >& newMaterials,
-							const Shared<internal::DiffractionGraph>& newDiffractionGraph )
+							const Shared<internal::DiffractionGraph>& newDiffractionGraph,
+							ThreadPool* threadPool )
 {
 	vertices = newVertices;
 	triangles = newTriangles;
@@ -201,7 +416,40 @@ void SoundMesh:: setData( const Shared<ArrayList<SoundVertex> >& newVertices,
 	
 	// Construct the BVH.
 	bvh = util::construct<MeshBVH>( this );
-	bvh->bvh.rebuild();
+	
+	if ( threadPool != NULL )
+		bvh->bvh.rebuild( *threadPool );
+	else
+		bvh->bvh.rebuild();
+	
+	// Generate a bounding sphere for the mesh.
+	boundingSphere = Sphere3f( vertices->getPointer(), vertices->getSize() );
+	boundingBox = AABB3f( vertices->getPointer(), vertices->getSize() );
+}
+
+
+
+
+void SoundMesh:: setImageData( const Shared<ArrayList<SoundVertex> >& newVertices,
+								const Shared<ArrayList<TriangleType> >& newTriangles,
+								const Shared<ArrayList<SoundMaterial> >& newMaterials,
+								const Shared<internal::DiffractionGraph>& newDiffractionGraph,
+								const Shared<MeshImage>& newImage, const UByte* bvhImage, Size bvhImageSize )
+{
+	if ( bvh != NULL )
+		util::destruct( bvh );
+	
+	vertices = newVertices;
+	triangles = newTriangles;
+	materials = newMaterials;
+	diffractionGraph = newDiffractionGraph;
+	image = newImage;
+	
+	// Use the prebuilt BVH in place, or rebuild it if the image was written for a different kind of BVH.
+	bvh = util::construct<MeshBVH>( this );
+	
+	if ( bvhImage == NULL || !bvh->bvh.setImage( bvhImage, bvhImageSize ) )
+		bvh->bvh.rebuild();
 	
 	// Generate a bounding sphere for the mesh.
 	boundingSphere = Sphere3f( vertices->getPointer(), vertices->getSize() );
@@ -279,7 +527,17 @@ Bool SoundMesh:: load( const char* pathToFile, SoundMesh& mesh )
 	
 	om::UTF8String filePathString( reinterpret_cast<const om::UTF8Char*>(pathToFile) );
 	
-	// Open the file.
+	// Memory-map the file so that a mesh in the native version-2 format can be used in place.
+	om::fs::File* file = util::construct<om::fs::File>( om::fs::Path( filePathString ) );
+	const om::LargeSize fileSize = file->exists() ? file->getSize() : 0;
+	const UByte* data = fileSize >= sizeof(ImageHeader) ? (const UByte*)file->map( om::fs::File::READ ) : NULL;
+	
+	if ( ImageHeader::isImage( data, (Size)fileSize ) )
+		return loadMeshVersion2( Shared<MeshImage>::construct( file, data, (Size)fileSize ), mesh );
+	
+	util::destruct( file );
+	
+	// Read other versions of the format from a stream.
 	om::FileReader reader( filePathString );
 	
 	if ( !reader.open() )
@@ -318,6 +576,36 @@ Bool SoundMesh:: load( om::DataInputStream& stream, SoundMesh& mesh )
 
 
 Bool SoundMesh:: saveMeshToStream( const SoundMesh& mesh, om::DataOutputStream& stream )
+{
+	const Size numVertices = mesh.vertices.isSet() ? mesh.vertices->getSize() : 0;
+	const Size numTriangles = mesh.triangles.isSet() ? mesh.triangles->getSize() : 0;
+	const Size numEdges = mesh.diffractionGraph.isSet() ? mesh.diffractionGraph->getEdgeCount() : 0;
+	const Size numNeighbors = mesh.diffractionGraph.isSet() ? mesh.diffractionGraph->getEdgeNeighborCount() : 0;
+	const Size numMaterials = mesh.materials.isSet() ? mesh.materials->getSize() : 0;
+	
+	// Version 2 stores 32-bit indices (and 1-offset edge indices), so very large meshes are saved in version 1.
+	if ( numVertices > math::max<UInt32>() || numTriangles > math::max<UInt32>() || numEdges >= math::max<UInt32>() ||
+		numNeighbors > math::max<UInt32>() || numMaterials > math::max<UInt32>() )
+		return saveMeshVersion1( mesh, stream );
+	
+	return saveMeshVersion2( mesh, stream );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Version 1 Save Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Bool SoundMesh:: saveMeshVersion1( const SoundMesh& mesh, om::DataOutputStream& stream )
 {
 	//***************************************************************************
 	// Write the base header.
@@ -549,6 +837,192 @@ Bool SoundMesh:: saveMeshToStream( const SoundMesh& mesh, om::DataOutputStream&
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Version 2 Save Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Bool SoundMesh:: saveMeshVersion2( const SoundMesh& mesh, om::DataOutputStream& stream )
+{
+	//***************************************************************************
+	// Get basic information about the mesh.
+	
+	const Shared<ArrayList<SoundVertex> >& vertices = mesh.vertices;
+	const Shared<ArrayList<TriangleType> >& triangles = mesh.triangles;
+	const Shared<ArrayList<SoundMaterial> >& materials = mesh.materials;
+	const Shared<internal::DiffractionGraph>& diffractionGraph = mesh.diffractionGraph;
+	
+	const SoundVertex* const verticesStart = vertices.isSet() ? vertices->getPointer() : NULL;
+	const SoundMesh::TriangleType* const trianglesStart = triangles.isSet() ? triangles->getPointer() : NULL;
+	const SoundMaterial* const materialsStart = materials.isSet() ? materials->getPointer() : NULL;
+	const internal::DiffractionEdge* const edgesStart = diffractionGraph.isSet() ? &diffractionGraph->getEdge(0) : NULL;
+	
+	const Size numVertices = vertices.isSet() ? vertices->getSize() : 0;
+	const Size numTriangles = triangles.isSet() ? triangles->getSize() : 0;
+	const Size numEdges = diffractionGraph.isSet() ? diffractionGraph->getEdgeCount() : 0;
+	const Size numNeighbors = diffractionGraph.isSet() ? diffractionGraph->getEdgeNeighborCount() : 0;
+	const Size numMaterials = materials.isSet() ? materials->getSize() : 0;
+	
+	//***************************************************************************
+	// Write the BVH image to temporary aligned memory.
+	
+	Size bvhImageSize = mesh.bvh ? mesh.bvh->bvh.getImageSize() : 0;
+	UByte* bvhImage = NULL;
+	
+	if ( bvhImageSize > 0 )
+	{
+		bvhImage = util::allocateAligned<UByte>( bvhImageSize, SoundBVH::IMAGE_ALIGNMENT );
+		
+		// Leave out the BVH if it can't be written, so that it is rebuilt on load.
+		if ( !mesh.bvh->bvh.writeImage( bvhImage ) )
+			bvhImageSize = 0;
+	}
+	
+	//***************************************************************************
+	// Compute the aligned offset of each array and write the header.
+	
+	ImageHeader header;
+	header.numVertices = numVertices;
+	header.numTriangles = numTriangles;
+	header.numEdges = numEdges;
+	header.numNeighbors = numNeighbors;
+	header.numMaterials = numMaterials;
+	header.materialsOffset = math::nextMultiple( UInt64(sizeof(ImageHeader)), UInt64(IMAGE_ALIGNMENT) );
+	header.materialsSize = materials.isSet() ? getMaterialsSize( *materials ) : 0;
+	header.verticesOffset = math::nextMultiple( UInt64(header.materialsOffset + header.materialsSize), UInt64(IMAGE_ALIGNMENT) );
+	header.trianglesOffset = math::nextMultiple( UInt64(header.verticesOffset + numVertices*ImageHeader::VERTEX_SIZE), UInt64(IMAGE_ALIGNMENT) );
+	header.edgesOffset = math::nextMultiple( UInt64(header.trianglesOffset + numTriangles*ImageHeader::TRIANGLE_SIZE), UInt64(IMAGE_ALIGNMENT) );
+	header.neighborsOffset = math::nextMultiple( UInt64(header.edgesOffset + numEdges*ImageHeader::EDGE_SIZE), UInt64(IMAGE_ALIGNMENT) );
+	header.bvhOffset = math::nextMultiple( UInt64(header.neighborsOffset + numNeighbors*sizeof(UInt32)), UInt64(IMAGE_ALIGNMENT) );
+	header.bvhSize = bvhImageSize;
+	header.imageSize = header.bvhOffset + header.bvhSize;
+	
+	stream.writeData( (const UByte*)&header, sizeof(ImageHeader) );
+	Size position = sizeof(ImageHeader);
+	
+	//***************************************************************************
+	// Write the materials and vertices in the mesh.
+	
+	Size dataBufferSize = 0;
+	UByte* dataBuffer = NULL;
+	
+	writePadding( stream, position, (Size)header.materialsOffset );
+	
+	if ( materials.isSet() )
+		writeMaterials( *materials, dataBuffer, dataBufferSize, stream );
+	
+	position += (Size)header.materialsSize;
+	writePadding( stream, position, (Size)header.verticesOffset );
+	
+	if ( vertices.isSet() )
+		writeVertices( *vertices, dataBuffer, dataBufferSize, stream );
+	
+	position += numVertices*ImageHeader::VERTEX_SIZE;
+	
+	//***************************************************************************
+	// Write the triangles in the mesh as fixed-size records.
+	
+	writePadding( stream, position, (Size)header.trianglesOffset );
+	enlargeBuffer( dataBuffer, dataBufferSize, numTriangles*ImageHeader::TRIANGLE_SIZE );
+	UByte* writePosition = dataBuffer;
+	
+	for ( Index i = 0; i < numTriangles; i++ )
+	{
+		const SoundMesh::TriangleType& triangle = (*triangles)[i];
+		
+		writeUInt32( writePosition, UInt32(triangle.getVertex(0) - verticesStart) );
+		writeUInt32( writePosition, UInt32(triangle.getVertex(1) - verticesStart) );
+		writeUInt32( writePosition, UInt32(triangle.getVertex(2) - verticesStart) );
+		
+		// Write 1-offset edge indices, or 0 if there is no edge.
+		writeUInt32( writePosition, triangle.getDiffractionEdge(0) ? UInt32((triangle.getDiffractionEdge(0) - edgesStart) + 1) : 0 );
+		writeUInt32( writePosition, triangle.getDiffractionEdge(1) ? UInt32((triangle.getDiffractionEdge(1) - edgesStart) + 1) : 0 );
+		writeUInt32( writePosition, triangle.getDiffractionEdge(2) ? UInt32((triangle.getDiffractionEdge(2) - edgesStart) + 1) : 0 );
+		
+		// Write material index, key vertex, subdivision rows and columns.
+		writeUInt32( writePosition, UInt32(triangle.getMaterial() - materialsStart) );
+		writeUInt32( writePosition, UInt32(triangle.getKeyVertex()) );
+		writeUInt32( writePosition, UInt32(triangle.getRowCount()) );
+		writeUInt32( writePosition, UInt32(triangle.getColumnCount()) );
+	}
+	
+	stream.writeData( dataBuffer, numTriangles*ImageHeader::TRIANGLE_SIZE );
+	position += numTriangles*ImageHeader::TRIANGLE_SIZE;
+	
+	//***************************************************************************
+	// Write the diffraction graph.
+	
+	writePadding( stream, position, (Size)header.edgesOffset );
+	enlargeBuffer( dataBuffer, dataBufferSize, numEdges*ImageHeader::EDGE_SIZE );
+	writePosition = dataBuffer;
+	
+	for ( Index i = 0; i < numEdges; i++ )
+	{
+		const internal::DiffractionEdge& edge = diffractionGraph->getEdge(i);
+		
+		writeUInt32( writePosition, UInt32(edge.v1 - verticesStart) );
+		writeUInt32( writePosition, UInt32(edge.v2 - verticesStart) );
+		writeUInt32( writePosition, UInt32(edge.triangle1 - trianglesStart) );
+		writeUInt32( writePosition, UInt32(edge.triangle2 - trianglesStart) );
+		writeUInt32( writePosition, edge.numNeighbors );
+		writeUInt32( writePosition, edge.neighborListOffset );
+		writeUInt16( writePosition, edge.edgeIndex1 );
+		writeUInt16( writePosition, edge.edgeIndex2 );
+		
+		writeFloat32( writePosition, edge.plane1.normal.x );
+		writeFloat32( writePosition, edge.plane1.normal.y );
+		writeFloat32( writePosition, edge.plane1.normal.z );
+		writeFloat32( writePosition, edge.plane1.offset );
+		
+		writeFloat32( writePosition, edge.plane2.normal.x );
+		writeFloat32( writePosition, edge.plane2.normal.y );
+		writeFloat32( writePosition, edge.plane2.normal.z );
+		writeFloat32( writePosition, edge.plane2.offset );
+	}
+	
+	stream.writeData( dataBuffer, numEdges*ImageHeader::EDGE_SIZE );
+	position += numEdges*ImageHeader::EDGE_SIZE;
+	
+	// Write the packed edge neighbors so that they can be used in place.
+	writePadding( stream, position, (Size)header.neighborsOffset );
+	enlargeBuffer( dataBuffer, dataBufferSize, numNeighbors*sizeof(UInt32) );
+	writePosition = dataBuffer;
+	
+	for ( Index i = 0; i < numNeighbors; i++ )
+		writeUInt32( writePosition, (UInt32)diffractionGraph->getEdgeNeighborIndex(i) );
+	
+	stream.writeData( dataBuffer, numNeighbors*sizeof(UInt32) );
+	position += numNeighbors*sizeof(UInt32);
+	
+	//***************************************************************************
+	// Write the BVH image.
+	
+	if ( bvhImageSize > 0 )
+	{
+		writePadding( stream, position, (Size)header.bvhOffset );
+		stream.writeData( bvhImage, bvhImageSize );
+	}
+	
+	//***************************************************************************
+	// Clean up the temporary buffers.
+	
+	if ( bvhImage )
+		util::deallocateAligned( bvhImage );
+	
+	releaseBuffer( dataBuffer );
+	
+	return true;
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -588,6 +1062,8 @@ Bool SoundMesh:: loadMeshFromStream( om::DataInputStream& stream, SoundMesh& mes
 	{
 		case 1:
 			return loadMeshVersion1( stream, endianness, mesh );
+		case 2:
+			return loadMeshVersion2( stream, headerData, mesh );
 	}
 	
 	return false;
@@ -893,6 +1369,208 @@ Bool SoundMesh:: loadMeshVersion1( om::DataInputStream& stream, om::data::Endian
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Version 2 Load Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Bool SoundMesh:: loadMeshVersion2( om::DataInputStream& stream, const UByte* baseHeader, SoundMesh& mesh )
+{
+	//***************************************************************************
+	// Read the rest of the header.
+	
+	const Size baseHeaderSize = 16;
+	const Size headerRemainder = sizeof(ImageHeader) - baseHeaderSize;
+	ImageHeader header;
+	
+	om::util::copyPOD( (UByte*)&header, baseHeader, baseHeaderSize );
+	
+	if ( stream.readData( (UByte*)&header + baseHeaderSize, headerRemainder ) < headerRemainder ||
+		!ImageHeader::isImage( (const UByte*)&header, sizeof(ImageHeader) ) ||
+		header.imageSize < sizeof(ImageHeader) || header.imageSize > math::max<Size>() )
+		return false;
+	
+	//***************************************************************************
+	// Read the rest of the mesh into aligned memory that has the same layout as a memory-mapped file.
+	
+	const Size imageSize = (Size)header.imageSize;
+	UByte* data = util::allocateAligned<UByte>( imageSize, IMAGE_ALIGNMENT );
+	Shared<MeshImage> image = Shared<MeshImage>::construct( data, imageSize );
+	
+	om::util::copyPOD( data, (const UByte*)&header, sizeof(ImageHeader) );
+	
+	if ( stream.readData( data + sizeof(ImageHeader), imageSize - sizeof(ImageHeader) ) < imageSize - sizeof(ImageHeader) )
+		return false;
+	
+	return loadMeshVersion2( image, mesh );
+}
+
+
+
+
+Bool SoundMesh:: loadMeshVersion2( const Shared<MeshImage>& image, SoundMesh& mesh )
+{
+	const UByte* const data = image->data;
+	
+	if ( !ImageHeader::isImage( data, image->size ) )
+		return false;
+	
+	//***************************************************************************
+	// Make sure that every array is aligned and lies within the image.
+	
+	const ImageHeader& header = *(const ImageHeader*)data;
+	const Size minMaterialSize = 3*sizeof(UInt32) + 4*sizeof(Float32);
+	
+	if ( header.imageSize > image->size ||
+		!header.hasSection( header.materialsOffset, header.materialsSize, 1 ) ||
+		!header.hasSection( header.verticesOffset, header.numVertices, ImageHeader::VERTEX_SIZE ) ||
+		!header.hasSection( header.trianglesOffset, header.numTriangles, ImageHeader::TRIANGLE_SIZE ) ||
+		!header.hasSection( header.edgesOffset, header.numEdges, ImageHeader::EDGE_SIZE ) ||
+		!header.hasSection( header.neighborsOffset, header.numNeighbors, sizeof(UInt32) ) ||
+		!header.hasSection( header.bvhOffset, header.bvhSize, 1 ) ||
+		header.numMaterials > header.materialsSize / minMaterialSize )
+		return false;
+	
+	const Size numVertices = (Size)header.numVertices;
+	const Size numTriangles = (Size)header.numTriangles;
+	const Size numEdges = (Size)header.numEdges;
+	const Size numNeighbors = (Size)header.numNeighbors;
+	const Size numMaterials = (Size)header.numMaterials;
+	
+	//***************************************************************************
+	// Read the materials for the mesh.
+	
+	Shared<ArrayList<SoundMaterial> > materials = Shared<ArrayList<SoundMaterial> >::construct( numMaterials );
+	om::BinaryDecoder materialStream;
+	materialStream.setData( data + header.materialsOffset, (Size)header.materialsSize );
+	
+	Size dataBufferSize = 0;
+	UByte* dataBuffer = NULL;
+	Bool readMaterialsResult = readMaterials( *materials, numMaterials, dataBuffer, dataBufferSize,
+											om::data::Endianness(), materialStream );
+	releaseBuffer( dataBuffer );
+	
+	if ( !readMaterialsResult )
+		return false;
+	
+	const SoundMaterial* const materialsStart = materials->getPointer();
+	
+	//***************************************************************************
+	// Read the vertices for the mesh.
+	
+	Shared<ArrayList<SoundVertex> > vertices = Shared<ArrayList<SoundVertex> >::construct( numVertices );
+	const Float32* vertexData = (const Float32*)(data + header.verticesOffset);
+	
+	for ( Index i = 0; i < numVertices; i++, vertexData += 3 )
+		vertices->add( SoundVertex( vertexData[0], vertexData[1], vertexData[2] ) );
+	
+	const SoundVertex* const verticesStart = vertices->getPointer();
+	
+	//***************************************************************************
+	// Read the triangles for the mesh, checking that their indices are in range.
+	
+	Shared<ArrayList<TriangleType> > triangles = Shared<ArrayList<TriangleType> >::construct( numTriangles );
+	const UInt32* triangleData = (const UInt32*)(data + header.trianglesOffset);
+	
+	for ( Index i = 0; i < numTriangles; i++, triangleData += ImageHeader::TRIANGLE_SIZE/sizeof(UInt32) )
+	{
+		const UInt32* t = triangleData;
+		
+		if ( t[0] >= numVertices || t[1] >= numVertices || t[2] >= numVertices ||
+			t[3] > numEdges || t[4] > numEdges || t[5] > numEdges || t[6] >= numMaterials )
+			return false;
+		
+		TriangleType triangle( verticesStart + t[0], verticesStart + t[1], verticesStart + t[2], materialsStart + t[6] );
+		triangle.setKeyVertex( t[7] );
+		triangle.setRowCount( t[8] );
+		triangle.setColumnCount( t[9] );
+		
+		// Store the 1-offset edge indices until the edges are created.
+		triangle.setDiffractionEdge( 0, (const internal::DiffractionEdge*)Index(t[3]) );
+		triangle.setDiffractionEdge( 1, (const internal::DiffractionEdge*)Index(t[4]) );
+		triangle.setDiffractionEdge( 2, (const internal::DiffractionEdge*)Index(t[5]) );
+		
+		triangles->add( triangle );
+	}
+	
+	const TriangleType* const trianglesStart = triangles->getPointer();
+	
+	//***************************************************************************
+	// Read the diffraction edges.
+	
+	Shared<ArrayList<internal::DiffractionEdge> > edges = Shared<ArrayList<internal::DiffractionEdge> >::construct( numEdges );
+	const UByte* edgeData = data + header.edgesOffset;
+	
+	for ( Index i = 0; i < numEdges; i++, edgeData += ImageHeader::EDGE_SIZE )
+	{
+		const UInt32* indices = (const UInt32*)edgeData;
+		const UInt16* edgeIndices = (const UInt16*)(indices + 6);
+		const Float32* planes = (const Float32*)(edgeIndices + 2);
+		
+		if ( indices[0] >= numVertices || indices[1] >= numVertices ||
+			indices[2] >= numTriangles || indices[3] >= numTriangles ||
+			UInt64(indices[4]) + UInt64(indices[5]) > numNeighbors )
+			return false;
+		
+		Plane3f p1, p2;
+		p1.normal = Vector3f( planes[0], planes[1], planes[2] );
+		p1.offset = planes[3];
+		p2.normal = Vector3f( planes[4], planes[5], planes[6] );
+		p2.offset = planes[7];
+		
+		internal::DiffractionEdge e( trianglesStart + indices[2], edgeIndices[0], trianglesStart + indices[3], edgeIndices[1],
+									verticesStart + indices[0], verticesStart + indices[1], p1, p2 );
+		
+		e.numNeighbors = indices[4];
+		e.neighborListOffset = indices[5];
+		
+		edges->add( e );
+	}
+	
+	const internal::DiffractionEdge* const edgesStart = edges->getPointer();
+	
+	// Finalize all triangle edge pointers.
+	for ( Index i = 0; i < numTriangles; i++ )
+	{
+		TriangleType& t = (*triangles)[i];
+		
+		for ( Index j = 0; j < 3; j++ )
+		{
+			if ( t.getDiffractionEdge(j) )
+				t.setDiffractionEdge( j, edgesStart + (Index(t.getDiffractionEdge(j)) - 1) );
+		}
+	}
+	
+	// Use the packed edge neighbor indices in place, checking that they refer to valid edges.
+	const UInt32* neighbors = numNeighbors > 0 ? (const UInt32*)(data + header.neighborsOffset) : NULL;
+	
+	for ( Index i = 0; i < numNeighbors; i++ )
+	{
+		if ( neighbors[i] >= numEdges )
+			return false;
+	}
+	
+	Shared<internal::DiffractionGraph> graph = Shared<internal::DiffractionGraph>::construct( edges, neighbors, numNeighbors );
+	
+	//***************************************************************************
+	// Construct the final mesh, using the BVH image in place.
+	
+	const UByte* bvhImage = header.bvhSize > 0 ? data + header.bvhOffset : NULL;
+	
+	mesh.setImageData( vertices, triangles, materials, graph, image, bvhImage, (Size)header.bvhSize );
+	
+	return true;
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -1127,11 +1805,8 @@ void SoundMesh:: writeResponse( UByte*& data, const FrequencyResponse& response
 
 
 
-void SoundMesh:: writeMaterials( const ArrayList<SoundMaterial>& materials,
-								UByte*& dataBuffer, Size& dataBufferSize,
-								om::DataOutputStream& stream )
+Size SoundMesh:: getMaterialsSize( const ArrayList<SoundMaterial>& materials )
 {
-	// Compute the size on disk of the materials in the mesh.
 	const Size numMaterials = materials.getSize();
 	Size materialDataSize = 0;
 	
@@ -1144,6 +1819,20 @@ void SoundMesh:: writeMaterials( const ArrayList<SoundMaterial>& materials,
 		materialDataSize += 4*sizeof(Float32);
 	}
 	
+	return materialDataSize;
+}
+
+
+
+
+void SoundMesh:: writeMaterials( const ArrayList<SoundMaterial>& materials,
+								UByte*& dataBuffer, Size& dataBufferSize,
+								om::DataOutputStream& stream )
+{
+	// Compute the size on disk of the materials in the mesh.
+	const Size numMaterials = materials.getSize();
+	const Size materialDataSize = getMaterialsSize( materials );
+	
 	// Make sure the temporary buffer is big enough.
 	enlargeBuffer( dataBuffer, dataBufferSize, materialDataSize );
 	
@@ -1237,6 +1926,22 @@ void SoundMesh:: releaseBuffer( const UByte* data )
 
 
 
+void SoundMesh:: writePadding( om::DataOutputStream& stream, Size& position, Size offset )
+{
+	const Size paddingSize = 64;
+	const UByte padding[paddingSize] = { 0 };
+	
+	while ( position < offset )
+	{
+		const Size numBytes = math::min( offset - position, paddingSize );
+		stream.writeData( padding, numBytes );
+		position += numBytes;
+	}
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -1309,6 +2014,62 @@ void SoundMesh:: releaseBuffer( const UByte* data )
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Version 2 Specification
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/**
+  * Version 2 of the GSound Sound Mesh binary format.
+  *
+  * Version 2 is written in the native byte order of the platform that saved it, and each
+  * array starts at an offset from the start of the file that is a multiple of 256 bytes.
+  * A file can therefore be memory-mapped and its arrays addressed directly. Indices are
+  * always 32-bit, so meshes with more than 2^32 vertices, triangles, neighbors or
+  * materials are saved in version 1 instead. Files with a different byte order are rejected.
+  *
+  * The 128-byte header starts with the same 16 bytes as version 1 (with a checksum of 0), followed by:
+  * - imageSize: uint64 specifying the total size of the file in bytes.
+  * - numVertices, numTriangles, numEdges, numNeighbors, numMaterials: 5*uint64 counts.
+  * - materialsOffset, materialsSize: 2*uint64 specifying the location of the material data.
+  * - verticesOffset, trianglesOffset, edgesOffset, neighborsOffset: 4*uint64 array offsets.
+  * - bvhOffset, bvhSize: 2*uint64 specifying the location of the BVH image, or a size of 0 if there is none.
+  *
+  * The materials are encoded as in version 1.
+  *
+  * The vertices for the mesh:
+  * - vertices: numVertices*3*float32 vertex coordinates.
+  *
+  * The triangles for the mesh: (per triangle)
+  * - vertices: 3*uint32 specifying the indices of the triangle's vertices.
+  * - edges: 3*uint32 specifying the 1-offset indices of the triangle's diffraction edges, or 0 if there is no edge.
+  * - material, key, numRows, numColumns: 4*uint32 as in version 1.
+  *
+  * The edge graph for the mesh: (per edge)
+  * - vertices: 2*uint32 specifying the indices of the edge vertices.
+  * - triangles: 2*uint32 specifying the indices of the edge triangles.
+  * - numNeighbors: uint32 specifying the number of neighbors for the edge.
+  * - neighborOffset: uint32 specifying the offset of this edge's first neighbor in the neighbor list.
+  * - edges: 2*uint16 specifying the edge indices of the edge triangles for this edge.
+  * - plane1, plane2: 2*4*float32 specifying the oriented planes of the edge's triangles.
+  *
+  * The neighbor list for the mesh, which is used in place:
+  * - neighbors: numNeighbors*uint32 specifying the edge neighbors in the mesh.
+  *
+  * The BVH image, which is written by the BVH's writeImage() method. The nodes are copied
+  * on load, while the primitive indices and cached triangles are used in place. If the image
+  * was written by a different type of BVH, the BVH is rebuilt instead.
+  */
+
+
+
+
 //##########################################################################################
 //******************************  End GSound Namespace  ************************************
 GSOUND_NAMESPACE_END
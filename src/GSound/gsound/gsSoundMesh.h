@@ -328,12 +328,35 @@ class SoundMesh
 			GSOUND_FORCE_INLINE void intersectRay( SoundRay& ray ) const;
 			
 			
+			/// Test whether or not a ray hits anything in the mesh before the specified maximum distance.
+			GSOUND_FORCE_INLINE Bool testRay( const Ray3f& ray, Float maxDistance ) const
+			{
+				SoundRay soundRay( ray, 0.0f, maxDistance );
+				
+				this->testRay( soundRay );
+				
+				return soundRay.hitValid();
+			}
+			
+			
+			/// Test whether or not a ray hits anything in this mesh, stopping at the first intersection.
+			/**
+			  * If the ray hits something, the ray's intersection information
+			  * describes the first triangle that was found, which is not necessarily the closest one.
+			  */
+			GSOUND_FORCE_INLINE void testRay( SoundRay& ray ) const;
+		
+		
 		//********************************************************************************
 		//******	Mesh Load/Save Methods
 			
 			
 			/// Save this mesh to the specified NULL-terminated UTF-8 file path.
 			/**
+			  * The mesh is written in the native byte order with its arrays and prebuilt BVH
+			  * at aligned offsets, so that load() can memory-map the file and use much
+			  * of it in place instead of parsing it and rebuilding the BVH.
+			  *
 			  * The method returns whether or not the mesh was able to be successfully written.
 			  */
 			Bool save( const char* pathToFile ) const;
@@ -349,6 +372,12 @@ class SoundMesh
 			
 			/// Load a mesh from the specified NULL-terminated UTF-8 file path.
 			/**
+			  * A file in the current native format is memory-mapped read-only. The mesh
+			  * uses the file's BVH primitives and diffraction edge neighbors in place, so
+			  * processes that load the same file share one copy of that data in the page cache.
+			  * The mapping stays open until the mesh and all meshes copied from it are destroyed.
+			  * Older and non-native files are read through a stream.
+			  *
 			  * If the mesh loading fails, a NULL pointer is returned.
 			  */
 			static Bool load( const char* pathToFile, SoundMesh& mesh );
@@ -372,6 +401,14 @@ class SoundMesh
 			class MeshBVH;
 			
 			
+			/// A class that keeps the memory of a loaded mesh file alive while the mesh uses it.
+			class MeshImage;
+			
+			
+			/// A class that stores the header at the start of a version-2 mesh file.
+			class ImageHeader;
+			
+			
 			/// Mark the SoundScene class as a friend so that it can access internal data.
 			friend class SoundObject;
 			
@@ -395,13 +432,28 @@ class SoundMesh
 			/// Create a new mesh which uses the given vertices, triangles, materials, and diffraction data.
 			/**
 			  * The new mesh uses the given edge and edge visibility data for diffraction queries.
+			  *
+			  * If a thread pool is specified, the mesh's BVH is built in parallel using the pool's threads.
+			  * The resulting BVH is the same regardless of the number of threads.
 			  */
 			void setData( const Shared<ArrayList<SoundVertex> >& newVertices,
 						const Shared<ArrayList<TriangleType> >& newTriangles,
 						const Shared<ArrayList<SoundMaterial> >& newMaterials,
-						const Shared<internal::DiffractionGraph>& newDiffractionGraph );
+						const Shared<internal::DiffractionGraph>& newDiffractionGraph,
+						ThreadPool* threadPool = NULL );
 			
 			
+			/// Set the data for this mesh from a mesh image, using the image's BVH if possible.
+			/**
+			  * If the BVH image is not compatible with this mesh's BVH, the BVH is rebuilt.
+			  */
+			void setImageData( const Shared<ArrayList<SoundVertex> >& newVertices,
+								const Shared<ArrayList<TriangleType> >& newTriangles,
+								const Shared<ArrayList<SoundMaterial> >& newMaterials,
+								const Shared<internal::DiffractionGraph>& newDiffractionGraph,
+								const Shared<MeshImage>& newImage, const UByte* bvhImage, Size bvhImageSize );
+		
+		
 		//********************************************************************************
 		//******	Mesh I/O Methods
 			
@@ -410,6 +462,14 @@ class SoundMesh
 			static Bool saveMeshToStream( const SoundMesh& mesh, om::DataOutputStream& stream );
 			
 			
+			/// Save the specified sound mesh to a data output stream using the version-1 format.
+			static Bool saveMeshVersion1( const SoundMesh& mesh, om::DataOutputStream& stream );
+			
+			
+			/// Save the specified sound mesh to a data output stream using the memory-mappable version-2 format.
+			static Bool saveMeshVersion2( const SoundMesh& mesh, om::DataOutputStream& stream );
+			
+			
 			/// Load a sound mesh from the specified data stream.
 			static Bool loadMeshFromStream( om::DataInputStream& stream, SoundMesh& mesh );
 			
@@ -418,6 +478,14 @@ class SoundMesh
 			static Bool loadMeshVersion1( om::DataInputStream& stream, om::data::Endianness endianness, SoundMesh& mesh );
 			
 			
+			/// Load a version-2 sound mesh from the specified data stream, after the 16-byte base header has been read.
+			static Bool loadMeshVersion2( om::DataInputStream& stream, const UByte* baseHeader, SoundMesh& mesh );
+			
+			
+			/// Load a version-2 sound mesh from the memory of the specified mesh image.
+			static Bool loadMeshVersion2( const Shared<MeshImage>& image, SoundMesh& mesh );
+		
+		
 		//********************************************************************************
 		//******	Mesh Reading Helper Methods
 			
@@ -459,6 +527,9 @@ class SoundMesh
 			GSOUND_FORCE_INLINE static void writeResponse( UByte*& data, const FrequencyResponse& response );
 			
 			
+			GSOUND_INLINE static Size getMaterialsSize( const ArrayList<SoundMaterial>& materials );
+			
+			
 			GSOUND_INLINE void static writeMaterials( const ArrayList<SoundMaterial>& materials,
 													UByte*& dataBuffer, Size& dataBufferSize,
 													om::DataOutputStream& stream );
@@ -479,6 +550,22 @@ class SoundMesh
 			GSOUND_FORCE_INLINE static void releaseBuffer( const UByte* data );
 			
 			
+			/// Write zeros to the stream to advance the current position to the specified offset.
+			GSOUND_INLINE static void writePadding( om::DataOutputStream& stream, Size& position, Size offset );
+		
+		
+		//********************************************************************************
+		//******	Private Static Data Members
+			
+			
+			/// The alignment in bytes of each array in a version-2 mesh file.
+			/**
+			  * This is at least the alignment that any SoundBVH image requires, so that
+			  * a file has the same layout regardless of the BVH type that reads it.
+			  */
+			static const Size IMAGE_ALIGNMENT = 256;
+		
+		
 		//********************************************************************************
 		//******	Private Data Members
 			
@@ -499,6 +586,10 @@ class SoundMesh
 			MeshBVH* bvh;
 			
 			
+			/// The loaded mesh file that this mesh's BVH and diffraction graph use in place, if any.
+			Shared<MeshImage> image;
+			
+			
 			/// An object which describes the diffraction edges for this mesh.
 			Shared<internal::DiffractionGraph> diffractionGraph;
 			
@@ -610,7 +701,7 @@ class SoundMesh:: MeshBVH : public BVHGeometry
 			
 			
 			/// The BVH that holds the mesh geometry.
-			om::bvh::AABBTree4 bvh;
+			SoundBVH bvh;
 			
 			
 			/// A pointer to the mesh shape that is a source of primitives.
@@ -638,6 +729,14 @@ void SoundMesh:: intersectRay( SoundRay& ray ) const
 
 
 
+void SoundMesh:: testRay( SoundRay& ray ) const
+{
+	bvh->bvh.testRay( ray );
+}
+
+
+
+
 //##########################################################################################
 //******************************  End GSound Namespace  ************************************
 GSOUND_NAMESPACE_END
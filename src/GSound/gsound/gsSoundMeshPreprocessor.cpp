@@ -2931,9 +2931,9 @@ Bool SoundMeshPreprocessor:: buildSoundMesh( const ArrayList<FatVertex>& inputVe
 	//***************************************************************************
 	// Construct the BVH for this mesh.
 	
-	// Construct the BVH object in a temporary mesh object.
-	SoundMesh mesh2;
-	mesh2.setData( vertices, triangles, materials, Shared<DiffractionGraph>() );
+	// Set the mesh attributes, building the BVH in parallel with the preprocessing threads.
+	// The diffraction graph is added afterwards since it is built using the mesh's BVH.
+	mesh.setData( vertices, triangles, materials, Shared<DiffractionGraph>(), &threadPool );
 	
 	// Update the timer and the BVH timing information.
 	timer.update();
@@ -2944,20 +2944,12 @@ Bool SoundMeshPreprocessor:: buildSoundMesh( const ArrayList<FatVertex>& inputVe
 	//***************************************************************************
 	// Build the diffraction graph if necessary.
 	
-	Shared<DiffractionGraph> diffractionGraph;
-	
 	if ( request.flags.isSet( MeshFlags::DIFFRACTION_EDGES ) )
 	{
-		diffractionGraph = buildEdgeGraph( inputVertices, inputTriangles,
-											*vertices, *triangles, *mesh2.getBVH(), request );
+		mesh.diffractionGraph = buildEdgeGraph( inputVertices, inputTriangles,
+												*vertices, *triangles, *mesh.getBVH(), request );
 	}
 	
-	//***************************************************************************
-	// Construct and return the final mesh.
-	
-	// Set the mesh attributes.
-	mesh.setData( vertices, triangles, materials, diffractionGraph );
-	
 	return true;
 }
 
@@ -3317,7 +3309,7 @@ void SoundMeshPreprocessor:: testEdgeVisibility( ArrayList<DiffractionEdge>& edg
 					
 					// Trace the ray. If it doesn't hit anything, the edges are mutually visible.
 					BVHRay bvhRay( ray, 0.0f, distance - 2*edgeOffset );
-					bvh.intersectRay( bvhRay );
+					bvh.testRay( bvhRay );
 					
 					if ( !bvhRay.hitValid() )
 					{
@@ -529,6 +529,202 @@ class SoundObject
 			}
 			
 			
+			/// Test whether or not a ray hits anything in this object before the ray's maximum distance.
+			/**
+			  * The mesh traversal stops at the first triangle that is hit, so if there
+			  * is a hit, the ray's intersection information describes that triangle,
+			  * which is not necessarily the closest one. The hit distance is still
+			  * guaranteed to be less than the ray's original maximum distance.
+			  */
+			GSOUND_FORCE_INLINE void testRay( SoundRay& ray ) const
+			{
+				// Save the world-space origin and direction.
+				om::math::SIMDFloat4 worldOrigin = ray.origin;
+				om::math::SIMDFloat4 worldDirection = ray.direction;
+				om::bvh::PrimitiveIndex worldPrimitive = ray.primitive;
+				Float32 worldTMin = ray.tMin;
+				Float32 worldTMax = ray.tMax;
+				
+				// Transform into object-local space.
+				ray.origin = transform.transformToLocal( (Vector3f)ray.origin );
+				ray.direction = transform.rotateToLocal( (Vector3f)ray.direction );
+				ray.tMin = transform.transformToLocal( ray.tMin ).getMin();
+				ray.tMax = transform.transformToLocal( ray.tMax ).getMax();
+				ray.primitive = BVHGeometry::INVALID_PRIMITIVE;
+				
+				const Float32 localTMax = ray.tMax;
+				
+				// Test the ray against the mesh, stopping at the first hit.
+				mesh->getBVH()->testRay( ray );
+				
+				Float32 worldDistance = worldTMax;
+				
+				if ( ray.hitValid() )
+				{
+					om::math::SIMDFloat4 worldIntersection = transform.transformToWorld( (Vector3f)ray.getHitPoint() );
+					worldDistance = math::dot( worldIntersection - worldOrigin, worldDirection )[0];
+					
+					// The local distance range is conservative for non-uniform scales, so the first hit
+					// may lie past the world-space maximum distance. Fall back to the closest hit then.
+					if ( worldDistance >= worldTMax )
+					{
+						ray.tMax = localTMax;
+						ray.primitive = BVHGeometry::INVALID_PRIMITIVE;
+						mesh->getBVH()->intersectRay( ray );
+						
+						if ( ray.hitValid() )
+						{
+							worldIntersection = transform.transformToWorld( (Vector3f)ray.getHitPoint() );
+							worldDistance = math::dot( worldIntersection - worldOrigin, worldDirection )[0];
+						}
+					}
+				}
+				
+				if ( ray.hitValid() && worldDistance < worldTMax )
+				{
+					// There was a valid intersection.
+					ray.tMax = worldDistance;
+					ray.normal = transform.rotateToWorld( (Vector3f)ray.normal );
+					ray.object = (SoundObject*)this;
+					ray.triangle = mesh->triangles->getPointer() + ray.primitive;
+				}
+				else
+				{
+					ray.tMax = worldTMax;
+					ray.primitive = worldPrimitive;
+				}
+				
+				// Restore the world-space ray data.
+				ray.origin = worldOrigin;
+				ray.direction = worldDirection;
+				ray.tMin = worldTMin;
+			}
+			
+			
+			/// Trace the specified rays through this object and compute the closest intersection for each ray.
+			/**
+			  * The rays are transformed into object-local space in groups and each group
+			  * is traced through the mesh's BVH with a single call. Each ray is updated
+			  * exactly as if intersectRay() had been called for it.
+			  */
+			GSOUND_INLINE void intersectRays( SoundRay* const* rays, Size numRays ) const
+			{
+				const BVH* meshBVH = mesh->getBVH();
+				BVHRay localRays[RAY_BATCH_SIZE];
+				
+				for ( Index start = 0; start < numRays; start += RAY_BATCH_SIZE )
+				{
+					SoundRay* const* batch = rays + start;
+					const Size batchSize = math::min( numRays - start, RAY_BATCH_SIZE );
+					
+					// Transform the rays into object-local space.
+					for ( Index i = 0; i < batchSize; i++ )
+					{
+						const SoundRay& ray = *batch[i];
+						BVHRay& localRay = localRays[i];
+						
+						localRay.origin = transform.transformToLocal( (Vector3f)ray.origin );
+						localRay.direction = transform.rotateToLocal( (Vector3f)ray.direction );
+						localRay.tMin = transform.transformToLocal( ray.tMin ).getMin();
+						localRay.tMax = transform.transformToLocal( ray.tMax ).getMax();
+						localRay.primitive = BVHGeometry::INVALID_PRIMITIVE;
+					}
+					
+					// Intersect the rays with the mesh.
+					meshBVH->intersectRays( localRays, batchSize );
+					
+					// Update the world-space rays that were hit closer than their current intersection.
+					for ( Index i = 0; i < batchSize; i++ )
+					{
+						const BVHRay& localRay = localRays[i];
+						
+						if ( !localRay.hitValid() )
+							continue;
+						
+						SoundRay& ray = *batch[i];
+						
+						// Compute the intersection point and distance along the ray in world space.
+						om::math::SIMDFloat4 worldIntersection = transform.transformToWorld( (Vector3f)localRay.getHitPoint() );
+						Float32 worldDistance = math::dot( worldIntersection - ray.origin, ray.direction )[0];
+						
+						if ( worldDistance < ray.tMax )
+						{
+							ray.tMax = worldDistance;
+							ray.normal = transform.rotateToWorld( (Vector3f)localRay.normal );
+							ray.primitive = localRay.primitive;
+							ray.object = (SoundObject*)this;
+							ray.triangle = mesh->triangles->getPointer() + localRay.primitive;
+						}
+					}
+				}
+			}
+			
+			
+			/// Test whether or not each of the specified rays hits anything in this object.
+			/**
+			  * The rays are transformed into object-local space in groups and each group
+			  * is tested against the mesh's BVH with a single call. Each ray is updated
+			  * exactly as if testRay() had been called for it. Rays that have already
+			  * hit something should not be passed to this method.
+			  */
+			GSOUND_INLINE void testRays( SoundRay* const* rays, Size numRays ) const
+			{
+				const BVH* meshBVH = mesh->getBVH();
+				BVHRay localRays[RAY_BATCH_SIZE];
+				
+				for ( Index start = 0; start < numRays; start += RAY_BATCH_SIZE )
+				{
+					SoundRay* const* batch = rays + start;
+					const Size batchSize = math::min( numRays - start, RAY_BATCH_SIZE );
+					
+					// Transform the rays into object-local space.
+					for ( Index i = 0; i < batchSize; i++ )
+					{
+						const SoundRay& ray = *batch[i];
+						BVHRay& localRay = localRays[i];
+						
+						localRay.origin = transform.transformToLocal( (Vector3f)ray.origin );
+						localRay.direction = transform.rotateToLocal( (Vector3f)ray.direction );
+						localRay.tMin = transform.transformToLocal( ray.tMin ).getMin();
+						localRay.tMax = transform.transformToLocal( ray.tMax ).getMax();
+						localRay.primitive = BVHGeometry::INVALID_PRIMITIVE;
+					}
+					
+					// Test the rays against the mesh, stopping at the first hit for each ray.
+					meshBVH->testRays( localRays, batchSize );
+					
+					for ( Index i = 0; i < batchSize; i++ )
+					{
+						const BVHRay& localRay = localRays[i];
+						
+						if ( !localRay.hitValid() )
+							continue;
+						
+						SoundRay& ray = *batch[i];
+						
+						// Compute the intersection point and distance along the ray in world space.
+						om::math::SIMDFloat4 worldIntersection = transform.transformToWorld( (Vector3f)localRay.getHitPoint() );
+						Float32 worldDistance = math::dot( worldIntersection - ray.origin, ray.direction )[0];
+						
+						if ( worldDistance < ray.tMax )
+						{
+							ray.tMax = worldDistance;
+							ray.normal = transform.rotateToWorld( (Vector3f)localRay.normal );
+							ray.primitive = localRay.primitive;
+							ray.object = (SoundObject*)this;
+							ray.triangle = mesh->triangles->getPointer() + localRay.primitive;
+						}
+						else
+						{
+							// The first hit was past the world-space distance, retest the ray on its own.
+							this->testRay( ray );
+						}
+					}
+				}
+			}
+	
+	
+			
 			
 			
 	private:
@@ -547,6 +743,20 @@ class SoundObject
 			
 			
 			
+		//********************************************************************************
+		//********************************************************************************
+		//********************************************************************************
+		//******	Private Static Data Members
+			
+			
+			
+			
+			/// The maximum number of rays that are transformed to object space and traced through the mesh together.
+			static const Size RAY_BATCH_SIZE = 64;
+			
+			
+			
+			
 		//********************************************************************************
 		//********************************************************************************
 		//********************************************************************************
@@ -0,0 +1,349 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/gsSoundPathFile.cpp
+ * Contents:    gsound::SoundPathFile class implementation
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+
+#include "gsSoundPathFile.h"
+
+
+//##########################################################################################
+//******************************  Start GSound Namespace  **********************************
+GSOUND_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Header Class Declaration
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+class SoundPathFile:: Header
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructor
+			
+			
+			/// Create a new header for an empty file of paths in the current record format.
+			GSOUND_INLINE Header()
+				:	version( VERSION ),
+					byteOrder( ENDIAN_CHECK ),
+					recordSize( (UInt32)sizeof(SoundPathRecord) ),
+					bandCount( GSOUND_FREQUENCY_COUNT ),
+					pathCount( 0 ),
+					dataOffset( DATA_OFFSET )
+			{
+				om::util::copy( magic, MAGIC, 8 );
+			}
+		
+		
+		//********************************************************************************
+		//******	Validation Method
+			
+			
+			/// Return whether or not this header describes paths that can be read by this version of the library.
+			GSOUND_INLINE Bool isValid() const
+			{
+				for ( Index i = 0; i < 8; i++ )
+				{
+					if ( magic[i] != MAGIC[i] )
+						return false;
+				}
+				
+				return version == VERSION && byteOrder == ENDIAN_CHECK && recordSize == sizeof(SoundPathRecord) &&
+						bandCount == GSOUND_FREQUENCY_COUNT && dataOffset == DATA_OFFSET;
+			}
+		
+		
+		//********************************************************************************
+		//******	Static Data Members
+			
+			
+			/// The characters that start every path file.
+			static const UByte MAGIC[8];
+			
+			
+			/// The current version of the path file format.
+			static const UInt32 VERSION = 1;
+			
+			
+			/// A value that is used to detect files written with a different byte order.
+			static const UInt32 ENDIAN_CHECK = 0x01020304;
+			
+			
+			/// The offset of the first path record, after the header and band frequencies, rounded up to 16 bytes.
+			static const UInt64 DATA_OFFSET = (40 + GSOUND_FREQUENCY_COUNT*sizeof(Float32) + 15) & ~UInt64(15);
+		
+		
+		//********************************************************************************
+		//******	Data Members
+			
+			
+			// The header is 40 bytes and is followed by the band frequencies.
+			UByte magic[8];
+			UInt32 version;
+			UInt32 byteOrder;
+			UInt32 recordSize;
+			UInt32 bandCount;
+			UInt64 pathCount;
+			UInt64 dataOffset;
+			
+			
+			
+};
+
+
+const UByte SoundPathFile::Header:: MAGIC[8] = { 'G', 'S', 'P', 'A', 'T', 'H', 'S', 0 };
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Constructor
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+SoundPathFile:: SoundPathFile()
+	:	file( NULL ),
+		frequencies( NULL ),
+		paths( NULL ),
+		numPaths( 0 )
+{
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Destructor
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+SoundPathFile:: ~SoundPathFile()
+{
+	close();
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		File Open Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Bool SoundPathFile:: open( const UTF8String& fileName )
+{
+	close();
+	
+	om::fs::File* newFile = util::construct<om::fs::File>( om::fs::Path( fileName ) );
+	const om::LargeSize fileSize = newFile->exists() ? newFile->getSize() : 0;
+	const UByte* data = fileSize >= Header::DATA_OFFSET ? (const UByte*)newFile->map( om::fs::File::READ ) : NULL;
+	const Header* header = (const Header*)data;
+	
+	// Make sure that the file has the same format and contains all of its paths.
+	// Any data after the last path is left over from an interrupted write and is ignored.
+	if ( header == NULL || !header->isValid() ||
+		fileSize < header->dataOffset + header->pathCount*sizeof(SoundPathRecord) )
+	{
+		util::destruct( newFile );
+		return false;
+	}
+	
+	file = newFile;
+	frequencies = (const Float32*)(data + sizeof(Header));
+	paths = (const SoundPathRecord*)(data + header->dataOffset);
+	numPaths = (Size)header->pathCount;
+	
+	return true;
+}
+
+
+
+
+void SoundPathFile:: close()
+{
+	if ( file )
+	{
+		util::destruct( file );
+		file = NULL;
+		frequencies = NULL;
+		paths = NULL;
+		numPaths = 0;
+	}
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		File Writing Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Bool SoundPathFile:: write( const UTF8String& fileName, const FrequencyBands& bands,
+							const SoundPathRecord* newPaths, Size numNewPaths, Bool append )
+{
+	const om::fs::Path path( fileName );
+	Header header;
+	Float32 bandFrequencies[GSOUND_FREQUENCY_COUNT];
+	
+	for ( Index i = 0; i < GSOUND_FREQUENCY_COUNT; i++ )
+		bandFrequencies[i] = bands[i];
+	
+	// Read the header of an existing file to find where the new paths go.
+	Bool appending = false;
+	
+	if ( append )
+	{
+		om::io::FileReader reader( path );
+		om::io::DataInputStream& input = reader;
+		
+		if ( reader.fileExists() && reader.getFileSize() > 0 )
+		{
+			Float32 fileFrequencies[GSOUND_FREQUENCY_COUNT];
+			
+			if ( !reader.open() ||
+				input.readData( (UByte*)&header, sizeof(Header) ) != sizeof(Header) ||
+				input.readData( (UByte*)fileFrequencies, sizeof(fileFrequencies) ) != sizeof(fileFrequencies) ||
+				!header.isValid() || reader.getFileSize() < header.dataOffset + header.pathCount*sizeof(SoundPathRecord) )
+				return false;
+			
+			// The paths in one file must all have the same frequency bands.
+			for ( Index i = 0; i < GSOUND_FREQUENCY_COUNT; i++ )
+			{
+				if ( fileFrequencies[i] != bandFrequencies[i] )
+					return false;
+			}
+			
+			appending = true;
+		}
+	}
+	
+	om::io::FileWriter writer( path );
+	
+	if ( !writer.open() )
+		return false;
+	
+	Bool written;
+	
+	if ( appending )
+		written = writer.seekAbsolute( header.dataOffset + header.pathCount*sizeof(SoundPathRecord) ) ==
+					header.dataOffset + header.pathCount*sizeof(SoundPathRecord);
+	else
+	{
+		// Replace the file with a header for no paths, then the frequencies padded to the data offset.
+		const UByte padding[16] = { 0 };
+		const Size paddingSize = Size(header.dataOffset - sizeof(Header) - sizeof(bandFrequencies));
+		
+		written = writer.erase() &&
+				writer.writeData( (const UByte*)&header, sizeof(Header) ) == sizeof(Header) &&
+				writer.writeData( (const UByte*)bandFrequencies, sizeof(bandFrequencies) ) == sizeof(bandFrequencies) &&
+				writer.writeData( padding, paddingSize ) == paddingSize;
+	}
+	
+	// Write the paths, then update the path count in the header once they are all in the file.
+	const Size dataSize = numNewPaths*sizeof(SoundPathRecord);
+	written = written && writer.writeData( (const UByte*)newPaths, dataSize ) == dataSize;
+	
+	if ( written )
+	{
+		writer.flush();
+		header.pathCount += numNewPaths;
+		written = writer.seekStart() &&
+				writer.writeData( (const UByte*)&header, sizeof(Header) ) == sizeof(Header);
+	}
+	
+	writer.close();
+	
+	return written;
+}
+
+
+
+
+//##########################################################################################
+//******************************  End GSound Namespace  ************************************
+GSOUND_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
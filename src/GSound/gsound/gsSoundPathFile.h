@@ -0,0 +1,255 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/gsSoundPathFile.h
+ * Contents:    gsound::SoundPathFile class declaration
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+
+#ifndef INCLUDE_GSOUND_SOUND_PATH_FILE_H
+#define INCLUDE_GSOUND_SOUND_PATH_FILE_H
+
+
+#include "gsConfig.h"
+
+
+#include "gsFrequencyBands.h"
+#include "gsSoundPathRecord.h"
+
+
+//##########################################################################################
+//******************************  Start GSound Namespace  **********************************
+GSOUND_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that stores lists of discrete sound paths in a binary file that can be memory-mapped.
+/**
+  * A path file contains a 40-byte header, the center frequencies of the frequency bands
+  * as Float32 values, and then a contiguous array of SoundPathRecord objects that starts
+  * at a 16-byte aligned data offset. The header contains (in bytes):
+  *
+  *   0: UByte magic[8] = "GSPATHS", 8: UInt32 version, 12: UInt32 byte order check,
+  *   16: UInt32 record size, 20: UInt32 band count, 24: UInt64 path count,
+  *   32: UInt64 data offset
+  *
+  * Files are written in the native byte order. Because the records are stored without
+  * any per-path framing, a file can be mapped directly as an array of records, either
+  * with this class or with another tool (e.g. numpy.memmap), so very large datasets of
+  * paths can be read without loading them into memory.
+  *
+  * Paths for many source-listener pairs can be appended to the same file. The path count
+  * in the header is only updated after the new records are written, so an interrupted
+  * write leaves the previously written paths readable.
+  */
+class SoundPathFile
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructor
+			
+			
+			/// Create a new path file object that doesn't have any file open.
+			SoundPathFile();
+		
+		
+		//********************************************************************************
+		//******	Destructor
+			
+			
+			/// Destroy this path file object, unmapping the file if it is open.
+			~SoundPathFile();
+		
+		
+		//********************************************************************************
+		//******	File Open Methods
+			
+			
+			/// Map the file with the specified name for reading its paths.
+			/**
+			  * The method returns whether or not the file was a valid path file that
+			  * was written with the same byte order, band count, and record layout.
+			  * Any previously open file is closed.
+			  */
+			Bool open( const UTF8String& fileName );
+			
+			
+			/// Unmap and close the currently open file, if there is one.
+			void close();
+			
+			
+			/// Return whether or not this object has a path file open.
+			GSOUND_INLINE Bool isOpen() const
+			{
+				return file != NULL;
+			}
+		
+		
+		//********************************************************************************
+		//******	Path Accessor Methods
+			
+			
+			/// Return the number of paths that are stored in the open file.
+			GSOUND_INLINE Size getPathCount() const
+			{
+				return numPaths;
+			}
+			
+			
+			/// Return a pointer to the contiguous array of paths in the open file.
+			GSOUND_INLINE const SoundPathRecord* getPaths() const
+			{
+				return paths;
+			}
+			
+			
+			/// Return a reference to the path at the specified index in the open file.
+			GSOUND_INLINE const SoundPathRecord& getPath( Index pathIndex ) const
+			{
+				GSOUND_DEBUG_ASSERT( pathIndex < numPaths );
+				
+				return paths[pathIndex];
+			}
+		
+		
+		//********************************************************************************
+		//******	Frequency Band Accessor Methods
+			
+			
+			/// Return the center frequency of the band at the specified index for the open file's path intensities.
+			GSOUND_INLINE Float32 getFrequency( Index bandIndex ) const
+			{
+				GSOUND_DEBUG_ASSERT( bandIndex < GSOUND_FREQUENCY_COUNT );
+				
+				return frequencies[bandIndex];
+			}
+			
+			
+			/// Return a pointer to the GSOUND_FREQUENCY_COUNT band center frequencies in the open file.
+			GSOUND_INLINE const Float32* getFrequencies() const
+			{
+				return frequencies;
+			}
+		
+		
+		//********************************************************************************
+		//******	File Writing Methods
+			
+			
+			/// Write the specified paths to the file with the given name.
+			/**
+			  * If the append flag is set and the file already contains paths for the same
+			  * frequency bands, the new paths are added after the existing ones. Otherwise,
+			  * the file is replaced by a new file that contains only the specified paths.
+			  *
+			  * The method returns whether or not all of the paths were written successfully.
+			  * A file can't be written while it is open for reading.
+			  */
+			static Bool write( const UTF8String& fileName, const FrequencyBands& bands,
+								const SoundPathRecord* newPaths, Size numNewPaths, Bool append = false );
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Class Declarations
+			
+			
+			/// A class that stores the header at the start of a path file.
+			class Header;
+		
+		
+		//********************************************************************************
+		//******	Private Copy Operations
+			
+			
+			/// Declared private to prevent copying of the file mapping.
+			SoundPathFile( const SoundPathFile& other );
+			
+			
+			/// Declared private to prevent copying of the file mapping.
+			SoundPathFile& operator = ( const SoundPathFile& other );
+		
+		
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// The memory-mapped file that is currently open, or NULL if there is no open file.
+			om::fs::File* file;
+			
+			
+			/// A pointer to the band center frequencies in the mapped file.
+			const Float32* frequencies;
+			
+			
+			/// A pointer to the array of path records in the mapped file.
+			const SoundPathRecord* paths;
+			
+			
+			/// The number of path records in the mapped file.
+			Size numPaths;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//******************************  End GSound Namespace  ************************************
+GSOUND_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_GSOUND_SOUND_PATH_FILE_H
@@ -0,0 +1,207 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/gsSoundPathRecord.h
+ * Contents:    gsound::SoundPathRecord class declaration
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+
+#ifndef INCLUDE_GSOUND_SOUND_PATH_RECORD_H
+#define INCLUDE_GSOUND_SOUND_PATH_RECORD_H
+
+
+#include "gsConfig.h"
+
+
+#include "gsSoundPath.h"
+
+
+//##########################################################################################
+//******************************  Start GSound Namespace  **********************************
+GSOUND_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that stores a discrete sound path in a fixed binary layout for export and storage.
+/**
+  * A path record contains the same information as a SoundPath, along with the indices
+  * of the source and listener that the path connects, packed into a plain structure
+  * with no padding that can be copied, written to disk, or memory-mapped directly.
+  * The layout is (in bytes):
+  *
+  *   0: UInt64 hash, 8: UInt32 source, 12: UInt32 listener, 16: UInt32 flags,
+  *   20: Float32 delay, 24: Float32 distance, 28: Float32 relativeSpeed,
+  *   32: Float32 direction[3], 44: Float32 sourceDirection[3],
+  *   56: Float32 intensity[GSOUND_FREQUENCY_COUNT]
+  *
+  * The record size is a multiple of 8 bytes so that arrays of records stay aligned.
+  */
+class SoundPathRecord
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a new uninitialized path record.
+			GSOUND_INLINE SoundPathRecord()
+			{
+			}
+			
+			
+			/// Create a new path record for the specified path between a source and listener.
+			GSOUND_INLINE SoundPathRecord( const SoundPath& path, UInt32 newSourceIndex, UInt32 newListenerIndex )
+				:	hash( path.getHashCode() ),
+					source( newSourceIndex ),
+					listener( newListenerIndex ),
+					flags( path.getFlags() ),
+					delay( path.getDelay() ),
+					distance( path.getDistance() ),
+					relativeSpeed( path.getRelativeSpeed() )
+			{
+				const Vector3f& pathDirection = path.getDirection();
+				const Vector3f& pathSourceDirection = path.getSourceDirection();
+				const FrequencyBandResponse& pathIntensity = path.getIntensity();
+				
+				for ( Index i = 0; i < 3; i++ )
+				{
+					direction[i] = pathDirection[i];
+					sourceDirection[i] = pathSourceDirection[i];
+				}
+				
+				for ( Index i = 0; i < GSOUND_FREQUENCY_COUNT; i++ )
+					intensity[i] = pathIntensity[i];
+			}
+		
+		
+		//********************************************************************************
+		//******	Path Reversal Method
+			
+			
+			/// Exchange the source and listener ends of this path record.
+			/**
+			  * Sound propagation is reciprocal, so a path that was computed with the source
+			  * and listener swapped can be converted to the original configuration by swapping
+			  * the source and listener indices and the directions at each end of the path.
+			  */
+			GSOUND_INLINE void reverse()
+			{
+				const UInt32 temp = source;
+				source = listener;
+				listener = temp;
+				
+				for ( Index i = 0; i < 3; i++ )
+				{
+					const Float32 tempDirection = direction[i];
+					direction[i] = sourceDirection[i];
+					sourceDirection[i] = tempDirection;
+				}
+			}
+		
+		
+		//********************************************************************************
+		//******	Public Data Members
+			
+			
+			/// An integer hash code ID for the path that identifies it from one frame to the next.
+			UInt64 hash;
+			
+			
+			/// The index of the source that the path starts at.
+			UInt32 source;
+			
+			
+			/// The index of the listener that the path ends at.
+			UInt32 listener;
+			
+			
+			/// The SoundPathFlags value describing the path.
+			UInt32 flags;
+			
+			
+			/// The delay time in seconds from the source to the listener along the path.
+			Float32 delay;
+			
+			
+			/// The total distance in meters from the listener to the source along the path.
+			Float32 distance;
+			
+			
+			/// The relative speed of the source and listener along the path in meters per second.
+			Float32 relativeSpeed;
+			
+			
+			/// The unit world-space direction from the listener to the virtual source.
+			Float32 direction[3];
+			
+			
+			/// The unit world-space direction from the source towards the listener along the path.
+			Float32 sourceDirection[3];
+			
+			
+			/// The fraction of the source's power that traveled along the path in each frequency band.
+			Float32 intensity[GSOUND_FREQUENCY_COUNT];
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//******************************  End GSound Namespace  ************************************
+GSOUND_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_GSOUND_SOUND_PATH_RECORD_H
@@ -91,7 +91,8 @@ class SoundPropagator:: ListenerData
 			:	listener( newListener ),
 				listenerData( newListenerData ),
 				soundPathCache( &newListenerData->soundPathCache ),
-				outputIR( newOutputIR )
+				outputIR( newOutputIR ),
+				sourceIRLength( 0 )
 		{
 		}
 		
@@ -107,6 +108,9 @@ class SoundPropagator:: ListenerData
 		/// A pointer to the output IR for this listener.
 		SoundListenerIR* outputIR;
 		
+		/// The sum of the lengths of the listener's source IRs on the current frame.
+		Float sourceIRLength;
+
 		
 };
 
@@ -545,35 +549,210 @@ class SoundPropagator:: ThreadData
 {
 	public:
 		
+		/// An enum that specifies where a thread puts the diffuse paths that it finds.
+		enum PathOutput
+		{
+			/// Diffuse paths are handed off to the main thread in path buffers.
+			PATH_OUTPUT_BUFFERS,
+			
+			/// Diffuse paths are accumulated in the thread's partial IR for each source.
+			PATH_OUTPUT_PARTIAL_IRS,
+			
+			/// Diffuse paths are sorted into the diffuse cache shard that contains the path's bucket.
+			PATH_OUTPUT_CACHE_SHARDS
+		};
+		
+		
+		/// An enum that identifies the independent random streams used by sound propagation.
+		enum RandomStream
+		{
+			/// Streams for specular probe rays traced from the listener, indexed by batch and ray.
+			RANDOM_STREAM_LISTENER_SPECULAR = 1,
+			
+			/// Streams for diffuse probe rays traced from the listener, indexed by batch and ray.
+			RANDOM_STREAM_LISTENER_DIFFUSE = 2,
+			
+			/// Streams for diffuse rays traced from a source, indexed by batch and ray.
+			RANDOM_STREAM_SOURCE_DIFFUSE = 3,
+			
+			/// Streams for direct path visibility samples, indexed by source.
+			RANDOM_STREAM_DIRECT = 4,
+			
+			/// Streams for revalidating cached specular paths, indexed by cache bucket.
+			RANDOM_STREAM_SPECULAR_CACHE = 5,
+			
+			/// Streams for visibility cache rays, indexed by source.
+			RANDOM_STREAM_VISIBILITY = 6
+		};
+		
+		
 		GSOUND_INLINE ThreadData( UInt32 randomSeed, SoundPropagator* newPropagator )
 			:	randomVariable( randomSeed ),
+				randomListenerIndex( 0 ),
 				numDiffuseRaysCast( 0 ),
 				numSpecularRaysCast( 0 ),
 				totalRayDepth( 0 ),
 				diffuseBufferIndex( 0 ),
-				diffuseBufferFilled( 0 ),
-				threadDone( 0 ),
+				pathOutput( PATH_OUTPUT_BUFFERS ),
 				propagator( newPropagator )
 		{
-			diffusePaths[0].setCapacity( PATH_BUFFER_SIZE );
-			diffusePaths[1].setCapacity( PATH_BUFFER_SIZE );
+			for ( Index i = 0; i < NUM_PATH_BUFFERS; i++ )
+				diffusePaths[i].setCapacity( PATH_BUFFER_SIZE );
+			
+			randomKey[0] = randomKey[1] = 0;
+			resetPathBuffers();
 		}
 		
 		
-		/// Add a diffuse path to the output buffer.
+		/// Set the key for the thread's random streams for the current frame and listener.
+		GSOUND_INLINE void setRandomKey( UInt32 seed, UInt32 timeStamp, UInt32 listenerIndex )
+		{
+			randomKey[0] = seed;
+			randomKey[1] = timeStamp;
+			randomListenerIndex = listenerIndex;
+		}
+		
+		
+		/// Restart the thread's random variable at the start of the specified random stream.
+		/**
+		  * The state is computed from a Philox counter that contains the stream identifiers and
+		  * the current listener, so the samples only depend on the stream and not on which thread
+		  * or in what order the stream is used.
+		  */
+		GSOUND_INLINE void setRandomStream( UInt32 stream, UInt32 index0, UInt32 index1 )
+		{
+			const UInt32 counter[4] = { index0, index1, randomListenerIndex, stream };
+			UInt32 output[4];
+			math::Philox4x32::generate( counter, randomKey, output );
+			
+			const math::Random<Real>::SeedType state[2] =
+			{
+				(math::Random<Real>::SeedType(output[1]) << 32) | output[0],
+				(math::Random<Real>::SeedType(output[3]) << 32) | output[2]
+			};
+			
+			randomVariable.setState( state );
+		}
+		
+		
+		/// Add a diffuse path to the thread's output.
 		GSOUND_INLINE void postPath( const DiffusePathData& newDiffusePath )
 		{
+			if ( pathOutput == PATH_OUTPUT_PARTIAL_IRS )
+			{
+				// Accumulate the paths locally in batches, the partial IRs are merged after all rays are traced.
+				ArrayList<DiffusePathData>& batchPaths = diffusePaths[diffuseBufferIndex];
+				batchPaths.add( newDiffusePath );
+				
+				if ( batchPaths.getSize() >= IMPULSE_BATCH_SIZE )
+					flushPartialIRs();
+				
+				return;
+			}
+			else if ( pathOutput == PATH_OUTPUT_CACHE_SHARDS )
+			{
+				// Put the path in the shard that owns its cache bucket so that shards can be inserted concurrently.
+				const DiffusePathCache& diffuseCache = *propagator->sourceDataList[newDiffusePath.sourceIndex].diffuseCache;
+				const Index shardIndex = (newDiffusePath.pathHash % diffuseCache.getBucketCount()) % NUM_CACHE_SHARDS;
+				
+				cacheShards[shardIndex].add( newDiffusePath );
+				return;
+			}
+			
 			diffusePaths[diffuseBufferIndex].add( newDiffusePath );
 			
-			// If there are enough paths in the buffer, signal the main thread that they are available.
-			if ( diffusePaths[diffuseBufferIndex].getSize() >= PATH_BUFFER_SIZE && !diffuseBufferFilled )
+			// If there are enough paths in the buffer, hand it off to the main thread if there is an empty buffer to switch to.
+			Index freeBufferIndex;
+			
+			if ( diffusePaths[diffuseBufferIndex].getSize() >= PATH_BUFFER_SIZE && freeBuffers.remove( freeBufferIndex ) )
 			{
-				// Swap the buffers so that the main thread can consume the new paths.
-				diffuseBufferIndex = 1 - diffuseBufferIndex;
+				// This never fails because the queue can hold every buffer.
+				filledBuffers.add( diffuseBufferIndex );
+				diffuseBufferIndex = freeBufferIndex;
 				
 				// Signal that there is a new buffer.
-				diffuseBufferFilled++;
-				propagator->mainThreadSignal.signal();
+				propagator->pathSemaphore.up();
+			}
+		}
+		
+		
+		/// Remove the next buffer of diffuse paths that the thread has handed off, returning whether or not there was one.
+		/**
+		  * This method should only be called by the main thread.
+		  */
+		GSOUND_INLINE Bool removeFilledBuffer( Index& bufferIndex )
+		{
+			return filledBuffers.remove( bufferIndex );
+		}
+		
+		
+		/// Clear a buffer of diffuse paths that was consumed by the main thread and give it back to the thread.
+		GSOUND_INLINE void releaseFilledBuffer( Index bufferIndex )
+		{
+			diffusePaths[bufferIndex].clear();
+			freeBuffers.add( bufferIndex );
+		}
+		
+		
+		/// Reset the path buffer queues so that the thread fills the first buffer and all others are free.
+		/**
+		  * This method should only be called when the thread is not tracing rays
+		  * and after all buffers have been consumed.
+		  */
+		GSOUND_INLINE void resetPathBuffers()
+		{
+			filledBuffers.clear();
+			freeBuffers.clear();
+			diffuseBufferIndex = 0;
+			
+			for ( Index i = 1; i < NUM_PATH_BUFFERS; i++ )
+				freeBuffers.add( i );
+		}
+		
+		
+		/// Reset the ray statistics before the thread starts tracing rays for a new job.
+		GSOUND_INLINE void resetRayCounts()
+		{
+			numDiffuseRaysCast = 0;
+			numSpecularRaysCast = 0;
+			totalRayDepth = 0;
+		}
+		
+		
+		/// Add the paths that have been buffered for the partial IRs in order of increasing delay, then clear the buffer.
+		GSOUND_INLINE void flushPartialIRs()
+		{
+			ArrayList<DiffusePathData>& batchPaths = diffusePaths[diffuseBufferIndex];
+			const Size numPaths = batchPaths.getSize();
+			
+			sortDiffusePaths( batchPaths, pathOrder );
+			
+			for ( Index i = 0; i < numPaths; i++ )
+			{
+				const DiffusePathData& path = batchPaths[(Index)pathOrder[i]];
+				propagator->addDiffuseImpulse( path, partialIRs[path.sourceIndex] );
+			}
+			
+			batchPaths.clear();
+		}
+		
+		
+		/// Prepare an empty partial IR for each source that has the same format as the source's output IR.
+		GSOUND_INLINE void resetPartialIRs( const ArrayList<SourceData>& sourceDataList )
+		{
+			const Size numSources = sourceDataList.getSize();
+			
+			while ( partialIRs.getSize() < numSources )
+				partialIRs.add( SampledIR() );
+			
+			for ( Index s = 0; s < numSources; s++ )
+			{
+				const SampledIR& outputIR = sourceDataList[s].outputIR->getSampledIR();
+				SampledIR& partialIR = partialIRs[s];
+				
+				partialIR.clear();
+				partialIR.setSampleRate( outputIR.getSampleRate() );
+				partialIR.setSourceDirectionsEnabled( outputIR.getSourceDirectionsEnabled() );
 			}
 		}
 		
@@ -587,6 +766,14 @@ class SoundPropagator:: ThreadData
 		math::Random<Real> randomVariable;
 		
 		
+		/// The Philox key for the thread's random streams, containing the seed and frame timestamp.
+		UInt32 randomKey[2];
+		
+		
+		/// The index of the listener whose random streams are currently generated.
+		UInt32 randomListenerIndex;
+		
+		
 		/// A temporary object which is used to accumulate all points along a diffuse path.
 		internal::SoundPathID diffusePathID;
 		
@@ -603,6 +790,18 @@ class SoundPropagator:: ThreadData
 		Array<Ray3f> validationRays;
 		
 		
+		/// A temporary array of visibility sample rays that are traced through the scene together.
+		Array<SoundRay,Size,AlignedAllocator<16> > sampleRays;
+		
+		
+		/// A temporary array of the direct visibility rays from the listener and its microphones to a batch of sources.
+		Array<SoundRay,Size,AlignedAllocator<16> > directRays;
+		
+		
+		/// A temporary array of the distances along each validation ray, negative if the ray is not valid.
+		Array<Real> sampleDistances;
+		
+		
 		/// An object which stores information needed when doing a diffraction query.
 		DiffractionQuery diffractionQuery;
 		
@@ -611,20 +810,36 @@ class SoundPropagator:: ThreadData
 		ArrayList<SpecularPathData> specularPaths;
 		
 		
-		/// A pair of output buffers of diffuse paths that hit the listener.
-		ArrayList<DiffusePathData> diffusePaths[2];
+		/// A set of output buffers of diffuse paths that hit the listener.
+		ArrayList<DiffusePathData> diffusePaths[NUM_PATH_BUFFERS];
 		
 		
 		/// The index of the current buffer where the thread is putting its output diffuse paths.
 		Index diffuseBufferIndex;
 		
 		
-		/// An atomic boolean value that is 1 when the thread has filled a buffer of diffuse paths.
-		Atomic<UInt32> diffuseBufferFilled;
+		/// A lock-free queue of the indices of full path buffers that the thread has handed off to the main thread.
+		LockFreeQueue<Index,NUM_PATH_BUFFERS> filledBuffers;
+		
+		
+		/// A lock-free queue of the indices of empty path buffers that the main thread has given back to the thread.
+		LockFreeQueue<Index,NUM_PATH_BUFFERS> freeBuffers;
+		
 		
+		/// Where the thread puts the diffuse paths that it finds for the current job.
+		PathOutput pathOutput;
 		
-		/// An atomic boolean value that is 1 when the thread is finished tracing all rays.
-		Atomic<UInt32> threadDone;
+		
+		/// A thread-local IR for each source where diffuse paths are accumulated without synchronization.
+		ArrayList<SampledIR> partialIRs;
+		
+		
+		/// A temporary list used to sort the paths that are added to the partial IRs.
+		ArrayList<UInt64> pathOrder;
+		
+		
+		/// Lists of the diffuse paths found by this thread, partitioned by diffuse cache shard.
+		ArrayList<DiffusePathData> cacheShards[NUM_CACHE_SHARDS];
 		
 		
 		/// The total number of diffuse rays that were cast by this thread.
@@ -644,6 +859,79 @@ class SoundPropagator:: ThreadData
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Job Data Class Definition
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+class SoundPropagator:: JobData
+{
+	public:
+		
+		GSOUND_INLINE JobData()
+			:	listener( NULL ),
+				directListener( NULL ),
+				source( NULL ),
+				soundPathCache( NULL ),
+				maxSpecularDepth( 0 ),
+				numSpecularRays( 0 ),
+				maxDiffuseDepth( 0 ),
+				numDiffuseRays( 0 ),
+				maxIRLength( 0 ),
+				sourceIndex( 0 ),
+				numSources( 0 ),
+				numChunks( 0 )
+		{
+		}
+		
+		/// A pointer to the listener detector for the job.
+		const SoundDetector* listener;
+		
+		/// A pointer to the listener whose direct paths are computed by the job.
+		const SoundListener* directListener;
+		
+		/// A pointer to the source detector for the job, or NULL if rays are traced from the listener.
+		const SoundDetector* source;
+		
+		/// A pointer to the specular path cache for the current listener.
+		SoundPathCache* soundPathCache;
+		
+		/// The maximum depth of specular rays.
+		Size maxSpecularDepth;
+		
+		/// The total number of specular rays to trace for all tasks.
+		Size numSpecularRays;
+		
+		/// The maximum depth of diffuse rays.
+		Size maxDiffuseDepth;
+		
+		/// The total number of diffuse rays to trace for all tasks.
+		Size numDiffuseRays;
+		
+		/// The maximum IR length in seconds for the paths that are found.
+		Float maxIRLength;
+		
+		/// The index of the first source that the job produces output for.
+		Index sourceIndex;
+		
+		/// The number of sources that the job produces output for.
+		Size numSources;
+		
+		/// The number of IR chunks per source that are merged from the threads' partial IRs.
+		Size numChunks;
+		
+		
+};
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -656,22 +944,26 @@ class SoundPropagator:: ThreadData
 
 
 SoundPropagator:: SoundPropagator()
-	:	request(),
+	:	numThreads( 1 ),
+		request(),
 		scene( NULL ),
-		statistics( NULL )
+		statistics( NULL ),
+		jobData( NULL )
 {
-	threadPool.setPriority( ThreadPriority::LOW );
+	jobScheduler.setPriority( ThreadPriority::LOW );
 }
 
 
 
 
 SoundPropagator:: SoundPropagator( const SoundPropagator& other )
-	:	request(),
+	:	numThreads( 1 ),
+		request(),
 		scene( NULL ),
-		statistics( NULL )
+		statistics( NULL ),
+		jobData( NULL )
 {
-	threadPool.setPriority( ThreadPriority::LOW );
+	jobScheduler.setPriority( ThreadPriority::LOW );
 }
 
 
@@ -690,6 +982,8 @@ SoundPropagator:: SoundPropagator( const SoundPropagator& other )
 
 SoundPropagator:: ~SoundPropagator()
 {
+	for ( Index i = 0; i < listenerPropagators.getSize(); i++ )
+		util::destruct( listenerPropagators[i] );
 }
 
 
@@ -713,7 +1007,7 @@ SoundPropagator& SoundPropagator:: operator = ( const SoundPropagator& other )
 		// Copy the other internal state of the SoundPropagator object.
 		request = other.request;
 		scene = other.scene;
-		//threadPool = other.threadPool;
+		//jobScheduler = other.jobScheduler;
 	}
 	
 	return *this;
@@ -759,11 +1053,11 @@ void SoundPropagator:: propagateSound( const SoundScene& newScene, PropagationRe
 	Timer totalTimer;
 	
 	//***************************************************************************
-	// Initialize the thread pool if necessary.
+	// Initialize the job scheduler if necessary.
 	
-	// Add the necessary number of threads to the thread pool.
-	if ( threadPool.getThreadCount() != request->numThreads )
-		threadPool.setThreadCount( request->numThreads );
+	// Add the necessary number of threads to the job scheduler.
+	if ( jobScheduler.getThreadCount() != request->numThreads )
+		jobScheduler.setThreadCount( request->numThreads );
 	
 	//***************************************************************************
 	
@@ -781,162 +1075,264 @@ void SoundPropagator:: propagateSound( const SoundScene& newScene, PropagationRe
 	//***************************************************************************
 	// Do sound propagation for each listener in the scene.
 	
+	const Size numListeners = listenerDataList.getSize();
+	
+	if ( getListenerParallel( numListeners ) )
+	{
+		// Propagate whole listeners concurrently, each one on a single thread with its own thread data.
+		prepareListenerPropagators();
+		
+		jobScheduler.run( bind( &SoundPropagator::propagateListenerTask, this ), numListeners );
+		
+		// Reset the temporary pointers of the listener propagators.
+		for ( Index i = 0; i < listenerPropagators.getSize(); i++ )
+		{
+			SoundPropagator* listenerPropagator = listenerPropagators[i];
+			listenerPropagator->scene = NULL;
+			listenerPropagator->request = NULL;
+			listenerPropagator->statistics = NULL;
+		}
+	}
+	else
+	{
+		numThreads = request->numThreads;
+		
+		for ( Index l = 0; l < numListeners; l++ )
+			propagateListener( listenerDataList[l], l );
+	}
+	
+	// Accumulate the IR lengths for all listeners.
 	Float maxListenerIRLength = 0;
 	Float averageIRLength = 0;
 	Size numAverageIRSources = 0;
-	const Size numListeners = listenerDataList.getSize();
 	
 	for ( Index l = 0; l < numListeners; l++ )
 	{
-		// Get the listener.
-		ListenerData& listenerData = listenerDataList[l];
-		const SoundListener& listener = *listenerData.listener;
-		SoundListenerIR& listenerIR = *listenerData.outputIR;
+		const ListenerData& listenerData = listenerDataList[l];
 		
+		maxListenerIRLength = math::max( maxListenerIRLength, listenerData.listenerData->irLength );
+		averageIRLength += listenerData.sourceIRLength;
+		numAverageIRSources += listenerData.outputIR->getSourceCount();
+	}
+	
+	// Remove old source and listener data.
+	request->internalData.removeOldData();
+	
+	// Store the total time that was spent on this frame.
+	Time totalTime = totalTimer.getElapsedTime();
+	
+	if ( statistics != NULL )
+	{
+		statistics->averageIRLength = averageIRLength / (numAverageIRSources*numListeners);
+		statistics->maxIRLength = maxListenerIRLength;
+		statistics->propagationTime = totalTime;
+	}
+	
+	//***************************************************************************
+	// Reset temporary pointers to NULL.
+	
+	scene = NULL;
+	request = NULL;
+	statistics = NULL;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Listener Scheduling Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Bool SoundPropagator:: getListenerParallel( Size numListeners ) const
+{
+	const Size numWorkers = jobScheduler.getThreadCount();
+	
+	// Source clustering modifies the scene's clusters for each listener, so the listeners must be done in order.
+	if ( numWorkers < 2 || numListeners < 2 || request->flags.isSet( PropagationFlags::SOURCE_CLUSTERING ) )
+		return false;
+	
+	// With many listeners per thread, the threads stay busy and there is no per-listener synchronization.
+	if ( numListeners >= numWorkers*MIN_LISTENERS_PER_THREAD )
+		return true;
+	
+	// Otherwise, only propagate listeners concurrently if a listener's rays are too few to keep all threads busy.
+	const Size numRays = (Size)(math::max( request->numSpecularRays, request->numDiffuseRays )*request->quality);
+	const Size numBatches = (numRays + RAY_BATCH_SIZE - 1) / RAY_BATCH_SIZE;
+	
+	return numBatches < numWorkers*MIN_RAY_BATCHES_PER_THREAD;
+}
+
+
+
+
+void SoundPropagator:: copyListenerStatistics( const SoundStatistics& listenerStatistics )
+{
+	statistics->sourceCount = listenerStatistics.sourceCount;
+	statistics->sourceClusterCount = listenerStatistics.sourceClusterCount;
+	statistics->clusteringTime = listenerStatistics.clusteringTime;
+	statistics->rayTracingTime = listenerStatistics.rayTracingTime;
+	statistics->diffuseRayCount = listenerStatistics.diffuseRayCount;
+	statistics->specularRayCount = listenerStatistics.specularRayCount;
+	statistics->diffuseRayDepth = listenerStatistics.diffuseRayDepth;
+	statistics->cacheUpdateTime = listenerStatistics.cacheUpdateTime;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Single Listener Propagation Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void SoundPropagator:: propagateListener( ListenerData& listenerData, Index listenerIndex )
+{
+	const SoundListener& listener = *listenerData.listener;
+	SoundListenerIR& listenerIR = *listenerData.outputIR;
+	
+	//***************************************************************************
+	// Prepare data structures for propagation.
+	
+	// Make sure that the IR is initialized and empty for each sound source.
+	prepareListenerSourceData( listener, listenerIR );
+	
+	// Key the random streams by the seed, frame, and listener so that the rays don't depend on scheduling.
+	for ( Index i = 0; i < threadDataList.getSize(); i++ )
+		threadDataList[i].setRandomKey( request->randomSeed, UInt32(request->internalData.timeStamp), UInt32(listenerIndex) );
+	
+	//***************************************************************************
+	// Find all direct/transmitted contribution paths.
+	
+	// Only do sound propagation if there are objects in the scene.
+	if ( scene->getObjectCount() > 0 )
+	{
 		//***************************************************************************
-		// Prepare data structures for propagation.
+		// Update the visibility caches for the sources and listener.
 		
-		// Make sure that the IR is initialized and empty for each sound source.
-		prepareListenerSourceData( listener, listenerIR );
+		if ( request->flags.isSet( PropagationFlags::VISIBILITY_CACHE ) )
+			updateSourcesVisibility();
 		
 		//***************************************************************************
-		// Find all direct/transmitted contribution paths.
+		// Check previously found cached paths to see if they are still valid.
 		
-		// Only do sound propagation if there are objects in the scene.
-		if ( scene->getObjectCount() > 0 )
-		{
-			//***************************************************************************
-			// Update the visibility caches for the sources and listener.
-			
-			if ( request->flags.isSet( PropagationFlags::VISIBILITY_CACHE ) )
-				updateSourcesVisibility();
-			
-			//***************************************************************************
-			// Check previously found cached paths to see if they are still valid.
-			
-			if ( request->flags.isSet( PropagationFlags::SPECULAR_CACHE ) )
-				validateSpecularCache( listenerData, listenerIR );
-			else
-				listenerData.soundPathCache->clear();
-			
-			//***************************************************************************
-			// Do listener sound propagation.
-			
-			doListenerPropagation( listenerData, listenerIR );
-			
-			//***************************************************************************
-			// Do source sound propagation.
-			
-			if ( request->flags.isSet( PropagationFlags::SOURCE_DIFFUSE ) )
-				doSourcesPropagation( listener, listenerIR );
-		}
+		if ( request->flags.isSet( PropagationFlags::SPECULAR_CACHE ) )
+			validateSpecularCache( listenerData, listenerIR );
+		else
+			listenerData.soundPathCache->clear();
+		
+		//***************************************************************************
+		// Do listener sound propagation.
 		
-		addDirectPaths( listener, listenerIR, threadDataList[0] );
+		doListenerPropagation( listenerData, listenerIR );
 		
 		//***************************************************************************
-		// Post-process the IRs for the listener.
+		// Do source sound propagation.
 		
-		// Convert the threshold in dB SPL to threshold in sound power.
-		const FrequencyBandResponse thresholdPower = listener.getThresholdPower( request->frequencies );
-		const Size numSources = listenerIR.getSourceCount();
-		Float listenerIRLength = 0;
-		numAverageIRSources += numSources;
+		if ( request->flags.isSet( PropagationFlags::SOURCE_DIFFUSE ) )
+			doSourcesPropagation( listener, listenerIR );
+	}
+	
+	addDirectPaths( listener );
+	
+	//***************************************************************************
+	// Post-process the IRs for the listener.
+	
+	// Convert the threshold in dB SPL to threshold in sound power.
+	const FrequencyBandResponse thresholdPower = listener.getThresholdPower( request->frequencies );
+	const Size numSources = listenerIR.getSourceCount();
+	Float listenerIRLength = 0;
+	listenerData.sourceIRLength = 0;
+	
+	for ( Index s = 0; s < numSources; s++ )
+	{
+		SourceData& sourceData = sourceDataList[s];
+		SoundSourceIR& sourceIR = listenerIR.getSourceIR(s);
+		Float sourceIRLength = 0;
 		
-		for ( Index s = 0; s < numSources; s++ )
-		{
-			SourceData& sourceData = sourceDataList[s];
-			SoundSourceIR& sourceIR = listenerIR.getSourceIR(s);
-			Float sourceIRLength = 0;
-			
-			// Trim the length of the IR based on the listener's threshold of hearing.
-			if ( request->flags.isSet( PropagationFlags::IR_THRESHOLD ) )
-				sourceIRLength = sourceIR.trim( thresholdPower );
-			else
-				sourceIRLength = sourceIR.getLength();
-			
-			// Determine the max IR length for the source on the next frame based on the current IR length.
-			if ( request->flags.isSet( PropagationFlags::IR_THRESHOLD ) &&
-				request->flags.isSet( PropagationFlags::ADAPTIVE_IR_LENGTH ) )
-			{
-				const Float baseGrowth = request->irGrowthRate*request->dt;
-				Float previousMaxLength = sourceData.sourceData->maxIRLength;
-				Float growth;
-				
-				if ( sourceIRLength + baseGrowth < previousMaxLength )
-				{
-					// Shrink the IR if the trimmed IR was significantly shorter than the prevous max length.
-					growth = -math::min( baseGrowth, previousMaxLength - sourceIRLength );
-				}
-				else
-				{
-					// Grow the IR by at least the base growth.
-					growth = math::max( baseGrowth, sourceIRLength - previousMaxLength );
-				}
-				
-				Float maxIRLength = math::clamp( previousMaxLength + growth, request->minIRLength, request->maxIRLength );
-				
-				// Save the max IR length for later.
-				sourceData.sourceData->maxIRLength = maxIRLength;
-			}
-			
-			// Save the source IR length in the data for the source.
-			sourceData.sourceData->irLength = sourceIRLength;
-			sourceData.irCache->setLengthInSamples( sourceIR.getLengthInSamples() );
-			
-			averageIRLength += sourceIRLength;
-			
-			// Compute the maximum source IR length for the listener.
-			listenerIRLength = math::max( listenerIRLength, sourceIRLength );
-		}
+		// Trim the length of the IR based on the listener's threshold of hearing.
+		if ( request->flags.isSet( PropagationFlags::IR_THRESHOLD ) )
+			sourceIRLength = sourceIR.trim( thresholdPower );
+		else
+			sourceIRLength = sourceIR.getLength();
 		
-		// Determine the max IR length for the listener on the next frame based on the current IR length.
+		// Determine the max IR length for the source on the next frame based on the current IR length.
 		if ( request->flags.isSet( PropagationFlags::IR_THRESHOLD ) &&
 			request->flags.isSet( PropagationFlags::ADAPTIVE_IR_LENGTH ) )
 		{
 			const Float baseGrowth = request->irGrowthRate*request->dt;
-			Float previousMaxLength = listenerData.listenerData->maxIRLength;
+			Float previousMaxLength = sourceData.sourceData->maxIRLength;
 			Float growth;
 			
-			if ( listenerIRLength + baseGrowth < previousMaxLength )
+			if ( sourceIRLength + baseGrowth < previousMaxLength )
 			{
 				// Shrink the IR if the trimmed IR was significantly shorter than the prevous max length.
-				growth = -math::min( baseGrowth, previousMaxLength - listenerIRLength );
+				growth = -math::min( baseGrowth, previousMaxLength - sourceIRLength );
 			}
 			else
 			{
 				// Grow the IR by at least the base growth.
-				growth = math::max( baseGrowth, listenerIRLength - previousMaxLength );
+				growth = math::max( baseGrowth, sourceIRLength - previousMaxLength );
 			}
 			
 			Float maxIRLength = math::clamp( previousMaxLength + growth, request->minIRLength, request->maxIRLength );
 			
 			// Save the max IR length for later.
-			listenerData.listenerData->maxIRLength = maxIRLength;
+			sourceData.sourceData->maxIRLength = maxIRLength;
 		}
 		
-		listenerData.listenerData->irLength = listenerIRLength;
-		maxListenerIRLength = math::max( maxListenerIRLength, listenerIRLength );
+		// Save the source IR length in the data for the source.
+		sourceData.sourceData->irLength = sourceIRLength;
+		sourceData.irCache->setLengthInSamples( sourceIR.getLengthInSamples() );
+		
+		listenerData.sourceIRLength += sourceIRLength;
+		
+		// Compute the maximum source IR length for the listener.
+		listenerIRLength = math::max( listenerIRLength, sourceIRLength );
+		
+		// Release the full-precision sampled IR once the listener is done with it.
+		if ( request->flags.isSet( PropagationFlags::COMPACT_IR ) )
+			sourceIR.compact();
 	}
 	
-	// Remove old source and listener data.
-	request->internalData.removeOldData();
-	
-	// Store the total time that was spent on this frame.
-	Time totalTime = totalTimer.getElapsedTime();
-	
-	if ( statistics != NULL )
+	// Determine the max IR length for the listener on the next frame based on the current IR length.
+	if ( request->flags.isSet( PropagationFlags::IR_THRESHOLD ) &&
+		request->flags.isSet( PropagationFlags::ADAPTIVE_IR_LENGTH ) )
 	{
-		statistics->averageIRLength = averageIRLength / (numAverageIRSources*numListeners);
-		statistics->maxIRLength = maxListenerIRLength;
-		statistics->propagationTime = totalTime;
+		const Float baseGrowth = request->irGrowthRate*request->dt;
+		Float previousMaxLength = listenerData.listenerData->maxIRLength;
+		Float growth;
+		
+		if ( listenerIRLength + baseGrowth < previousMaxLength )
+		{
+			// Shrink the IR if the trimmed IR was significantly shorter than the prevous max length.
+			growth = -math::min( baseGrowth, previousMaxLength - listenerIRLength );
+		}
+		else
+		{
+			// Grow the IR by at least the base growth.
+			growth = math::max( baseGrowth, listenerIRLength - previousMaxLength );
+		}
+		
+		Float maxIRLength = math::clamp( previousMaxLength + growth, request->minIRLength, request->maxIRLength );
+		
+		// Save the max IR length for later.
+		listenerData.listenerData->maxIRLength = maxIRLength;
 	}
 	
-	//***************************************************************************
-	// Reset temporary pointers to NULL.
-	
-	scene = NULL;
-	request = NULL;
-	statistics = NULL;
+	listenerData.listenerData->irLength = listenerIRLength;
 }
 
 
@@ -964,7 +1360,7 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 	const Size numSpecularRays = (Size)(request->numSpecularRays*request->quality);
 	const Size maxDiffuseDepth = (Size)(request->maxDiffuseDepth/*request->quality*/);
 	const Size numDiffuseRays = (Size)(request->numDiffuseRays*request->quality);
-	const Size numThreads = request->numThreads;
+	const Size numThreads = this->numThreads;
 	const Size numSources = sourceDataList.getSize();
 	
 	const SoundListener& listener = *listenerData.listener;
@@ -978,49 +1374,66 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 	
 	Timer timer;
 	
-	if ( numThreads > 1 )
+	// Decide where the threads put the diffuse paths that they find. With multiple threads, the caches
+	// are updated from thread-local storage in parallel rather than serially by the main thread.
+	ThreadData::PathOutput pathOutput = ThreadData::PATH_OUTPUT_BUFFERS;
+	
+	if ( numThreads > 1 && diffuseEnabled )
+	{
+		if ( irCacheEnabled )
+			pathOutput = ThreadData::PATH_OUTPUT_PARTIAL_IRS;
+		else if ( diffuseCacheEnabled )
+			pathOutput = ThreadData::PATH_OUTPUT_CACHE_SHARDS;
+	}
+	
+	for ( Index i = 0; i < numThreads; i++ )
 	{
-		// Compute the total number of rays that should be traced for each thread.
-		const Size specularRaysPerThread = (Size)math::ceiling( Real(numSpecularRays) / Real(numThreads) );
-		const Size diffuseRaysPerThread = (Size)math::ceiling( Real(numDiffuseRays) / Real(numThreads) );
-		Index specularRayStart = 0;
-		Index diffuseRayStart = 0;
+		ThreadData& threadData = threadDataList[i];
+		threadData.resetRayCounts();
+		threadData.pathOutput = pathOutput;
 		
-		// Queue the diffuse jobs for all threads.
-		for ( Index i = 0; i < numThreads; i++ )
-		{
-			// Compute the number of rays that this thread should have.
-			const Size numSpecularThreadRays = math::min( numSpecularRays - specularRayStart, specularRaysPerThread );
-			const Size numDiffuseThreadRays = math::min( numDiffuseRays - diffuseRayStart, diffuseRaysPerThread );
-			
-			// Queue the job for this range of rays.
-			threadPool.addJob( FunctionCall< void ( const SoundDetector&, const SoundPathCache&, Size, Size, Size, Size, Float, ThreadData& )>(
-										bind( &SoundPropagator::propagateListenerRays, this ),
-										listener, soundPathCache, maxSpecularDepth, numSpecularThreadRays,
-										maxDiffuseDepth, numDiffuseThreadRays, maxIRLength, threadDataList[i] ) );
-			
-			specularRayStart += numSpecularThreadRays;
-			diffuseRayStart += numDiffuseThreadRays;
-		}
+		if ( pathOutput == ThreadData::PATH_OUTPUT_PARTIAL_IRS )
+			threadData.resetPartialIRs( sourceDataList );
+	}
+	
+	JobData job;
+	job.listener = &listener;
+	job.soundPathCache = &soundPathCache;
+	job.maxSpecularDepth = maxSpecularDepth;
+	job.numSpecularRays = numSpecularRays;
+	job.maxDiffuseDepth = maxDiffuseDepth;
+	job.numDiffuseRays = numDiffuseRays;
+	job.maxIRLength = maxIRLength;
+	jobData = &job;
+	
+	// Split the rays into small batches that are load balanced between the threads.
+	// The batches are the same for any number of threads so that the same random streams are used.
+	const Size numBatches = (math::max( numSpecularRays, numDiffuseRays ) + RAY_BATCH_SIZE - 1) / RAY_BATCH_SIZE;
+	
+	if ( numThreads > 1 )
+	{
+		pathSemaphore.reset();
+		jobScheduler.start( bind( &SoundPropagator::propagateListenerRaysTask, this ), numBatches, &pathSemaphore );
 		
 		//************************************************************************
 		// Wait for the ray tracing jobs to finish and concurrently consume the diffuse paths generated.
 		
-		if ( diffuseEnabled )
+		if ( diffuseEnabled && pathOutput == ThreadData::PATH_OUTPUT_BUFFERS )
 		{
-			Bool processing = true;
-			
-			while ( processing )
+			while ( true )
 			{
+				// Check for completion before consuming so that no paths handed off before completion are missed.
+				const Bool finished = jobScheduler.isFinished();
+				
 				// Process any new path buffers.
 				for ( Index i = 0; i < numThreads; i++ )
 				{
 					ThreadData& threadData = threadDataList[i];
+					Index bufferIndex;
 					
-					// Process new diffuse paths.
-					if ( threadData.diffuseBufferFilled )
+					while ( threadData.removeFilledBuffer( bufferIndex ) )
 					{
-						ArrayList<DiffusePathData>& newDiffusePaths = threadData.diffusePaths[!threadData.diffuseBufferIndex];
+						ArrayList<DiffusePathData>& newDiffusePaths = threadData.diffusePaths[bufferIndex];
 						
 						// Update the caches with the new paths.
 						if ( irCacheEnabled )
@@ -1030,39 +1443,39 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 						else
 							outputDiffusePaths( newDiffusePaths, listenerIR );
 						
-						// Clear the list of paths for next time.
-						newDiffusePaths.clear();
-						
-						// Signal to the thread that the path buffer has been consumed.
-						threadData.diffuseBufferFilled--;
+						// Give the path buffer back to the thread.
+						threadData.releaseFilledBuffer( bufferIndex );
 					}
 				}
 				
-				// Check to see if all of the threads are done.
-				processing = false;
-				
-				for ( Index i = 0; i < numThreads; i++ )
-				{
-					if ( !threadDataList[i].threadDone )
-						processing = true;
-				}
+				if ( finished )
+					break;
 				
-				// Give up the CPU since we have finished consuming all new paths.
-				//Thread::sleep(0.0001);
-				mainThreadSignal.wait( 0.0001 );
+				// Sleep until a thread hands off another buffer or all tasks finish.
+				pathSemaphore.down();
 			}
 		}
 		
 		// Wait for the ray tracing jobs to finish.
-		threadPool.finishJobs();
+		jobScheduler.finish();
+		
+		//************************************************************************
+		// Update the caches in parallel with the paths that each thread stored locally.
+		
+		if ( pathOutput == ThreadData::PATH_OUTPUT_PARTIAL_IRS )
+			mergePartialIRs( 0, numSources );
+		else if ( pathOutput == ThreadData::PATH_OUTPUT_CACHE_SHARDS )
+			jobScheduler.run( bind( &SoundPropagator::updateDiffuseCacheShardTask, this ), NUM_CACHE_SHARDS );
 	}
 	else
 	{
 		// Do all diffuse propagation on the main thread to avoid switching contexts.
-		propagateListenerRays( listener, soundPathCache, maxSpecularDepth, numSpecularRays,
-								maxDiffuseDepth, numDiffuseRays, maxIRLength, threadDataList[0] );
+		for ( Index i = 0; i < numBatches; i++ )
+			propagateListenerRaysTask( i, 0 );
 	}
 	
+	jobData = NULL;
+	
 	//************************************************************************
 	// Consume the final set of output paths.
 	
@@ -1075,8 +1488,8 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 	{
 		ThreadData& threadData = threadDataList[i];
 		
-		// Check both output buffers for paths.
-		for ( Index bufferIndex = 0; bufferIndex < 2; bufferIndex++ )
+		// Check all output buffers for paths.
+		for ( Index bufferIndex = 0; bufferIndex < NUM_PATH_BUFFERS; bufferIndex++ )
 		{
 			ArrayList<DiffusePathData>& newDiffusePaths = threadData.diffusePaths[bufferIndex];
 			
@@ -1095,12 +1508,8 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 			}
 		}
 		
-		// Make sure the atomic variables are in the correct state for next time.
-		if  ( threadData.diffuseBufferFilled )
-			threadData.diffuseBufferFilled--;
-		
-		if  ( threadData.threadDone )
-			threadData.threadDone--;
+		// Make sure the path buffer queues are in the correct state for next time.
+		threadData.resetPathBuffers();
 		
 		// Count the number of diffuse rays that were cast this frame.
 		numDiffuseRaysCast += threadDataList[i].numDiffuseRaysCast;
@@ -1128,17 +1537,10 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 			if ( numThreads > 1 )
 			{
 				for ( Index s = 0; s < numSources; s++ )
-				{
-					IRCache& irCache = *sourceDataList[s].irCache;
-					SoundSourceIR& sourceIR = *sourceDataList[s].outputIR;
-					
-					threadPool.addJob( FunctionCall< void ( IRCache&, Size, SoundSourceIR& )>(
-												bind( &SoundPropagator::outputIRCache, this ),
-												irCache, numDiffuseRaysCast, sourceIR ) );
-				}
+					sourceDataList[s].numDiffuseRaysCast = numDiffuseRaysCast;
 				
-				// Wait for the cache update jobs to finish.
-				threadPool.finishJobs();
+				// Update the caches in parallel and wait for the cache update tasks to finish.
+				jobScheduler.run( bind( &SoundPropagator::outputIRCacheTask, this ), numSources );
 			}
 			else
 			{
@@ -1156,17 +1558,10 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 			if ( numThreads > 1 )
 			{
 				for ( Index s = 0; s < numSources; s++ )
-				{
-					DiffusePathCache& diffuseCache = *sourceDataList[s].diffuseCache;
-					SoundSourceIR& sourceIR = *sourceDataList[s].outputIR;
-					
-					threadPool.addJob( FunctionCall< void ( DiffusePathCache&, Size, SoundSourceIR& )>(
-												bind( &SoundPropagator::outputDiffuseCache, this ),
-												diffuseCache, numDiffuseRaysCast, sourceIR ) );
-				}
+					sourceDataList[s].numDiffuseRaysCast = numDiffuseRaysCast;
 				
-				// Wait for the cache update jobs to finish.
-				threadPool.finishJobs();
+				// Update the caches in parallel and wait for the cache update tasks to finish.
+				jobScheduler.run( bind( &SoundPropagator::outputDiffuseCacheTask, this ), numSources );
 			}
 			else
 			{
@@ -1245,7 +1640,7 @@ void SoundPropagator:: doListenerPropagation( const ListenerData& listenerData,
 void SoundPropagator:: propagateListenerRays( const SoundDetector& listener, const internal::SoundPathCache& soundPathCache,
 												Size maxSpecularDepth, Size numSpecularRays,
 												Size maxDiffuseDepth, Size numDiffuseRays,
-												Float maxIRLength, ThreadData& threadData )
+												Float maxIRLength, Index rayStart, ThreadData& threadData )
 {
 	const Bool specularEnabled = request->flags.isSet( PropagationFlags::SPECULAR );
 	const Bool diffuseEnabled = request->flags.isSet( PropagationFlags::DIFFUSE );
@@ -1264,10 +1659,13 @@ void SoundPropagator:: propagateListenerRays( const SoundDetector& listener, con
 	{
 		// Cast as many rays as there is room in the ray budget.
 		Size rayCastsRemaining = numSpecularRays*specularDepth;
-		threadData.numSpecularRaysCast = 0;
+		Index rayIndex = 0;
 		
 		while ( rayCastsRemaining > Size(0) )
 		{
+			// Start the random stream for this ray.
+			threadData.setRandomStream( ThreadData::RANDOM_STREAM_LISTENER_SPECULAR, UInt32(rayStart), UInt32(rayIndex++) );
+			
 			// Create the starting ray for this probe sequence.
 			Ray3f ray( listener.getPosition(), getRandomDirection( threadData.randomVariable ) );
 			
@@ -1282,16 +1680,17 @@ void SoundPropagator:: propagateListenerRays( const SoundDetector& listener, con
 	//************************************************************************
 	// Trace diffuse rays from the listener if source diffuse is not enabled.
 	
-	threadData.totalRayDepth = 0;
-	
 	if ( diffuseEnabled && !request->flags.isSet( PropagationFlags::SOURCE_DIFFUSE ) )
 	{
 		// Cast as many rays as there is room in the ray budget.
 		Size rayCastsRemaining = numDiffuseRays*maxDiffuseDepth;
-		threadData.numDiffuseRaysCast = 0;
+		Index rayIndex = 0;
 		
 		while ( rayCastsRemaining > Size(0) )
 		{
+			// Start the random stream for this ray.
+			threadData.setRandomStream( ThreadData::RANDOM_STREAM_LISTENER_DIFFUSE, UInt32(rayStart), UInt32(rayIndex++) );
+			
 			// Create the starting ray for this probe sequence.
 			Ray3f ray( listener.getPosition(), getRandomDirection( threadData.randomVariable ) );
 			
@@ -1308,10 +1707,6 @@ void SoundPropagator:: propagateListenerRays( const SoundDetector& listener, con
 			threadData.numDiffuseRaysCast++;
 		}
 	}
-	
-	// Signal that we are done processing.
-	threadData.threadDone++;
-	mainThreadSignal.signal();
 }
 
 
@@ -1841,32 +2236,20 @@ void SoundPropagator:: validateSpecularCache( const ListenerData& listenerData,
 	//****************************************************************************************
 	// Validate the previously cached paths in parallel.
 	
-	const Size numThreads = request->numThreads;
+	const Size numThreads = this->numThreads;
 	const Size bucketCount = soundPathCache.getBucketCount();
 	
 	if ( numThreads > 1 )
 	{
-		// Compute the total number of buckets that should be updated for each thread.
-		const Size bucketsPerThread = (Size)math::ceiling( Real(bucketCount) / Real(numThreads) );
-		Index bucketStart = 0;
+		JobData job;
+		job.soundPathCache = &soundPathCache;
+		jobData = &job;
 		
-		// Update the cache in parallel for each range of buckets in the cache.
-		for ( Index i = 0; i < numThreads; i++ )
-		{
-			ThreadData& threadData = threadDataList[i];
-			
-			// Compute the number of buckets that this thread should have.
-			Size numThreadBuckets = math::min( bucketCount - bucketStart, bucketsPerThread );
-			
-			threadPool.addJob( FunctionCall< void ( SoundPathCache&, Index, Size, ThreadData& )>(
-										bind( &SoundPropagator::validateSpecularCacheRange, this ),
-										soundPathCache, bucketStart, numThreadBuckets, threadData ) );
-			
-			bucketStart += numThreadBuckets;
-		}
+		// Update the cache in parallel for each batch of buckets in the cache and wait for the tasks to finish.
+		const Size numBatches = (bucketCount + BUCKET_BATCH_SIZE - 1) / BUCKET_BATCH_SIZE;
+		jobScheduler.run( bind( &SoundPropagator::validateSpecularCacheTask, this ), numBatches );
 		
-		// Wait for the jobs to finish.
-		threadPool.finishJobs();
+		jobData = NULL;
 	}
 	else
 	{
@@ -1947,6 +2330,9 @@ void SoundPropagator:: validateSpecularCacheRange( internal::SoundPathCache& spe
 	{
 		SoundPathCache::BucketType& bucket = specularCache.getBucket(b);
 		
+		// Validate the paths in each bucket with the same samples regardless of which thread processes the bucket.
+		threadData.setRandomStream( ThreadData::RANDOM_STREAM_SPECULAR_CACHE, UInt32(b), 0 );
+		
 		for ( Index i = 0; i < bucket.getSize(); )
 		{
 			SoundPathCache::Entry& entry = bucket[i];
@@ -2172,7 +2558,7 @@ Bool SoundPropagator:: validatePointSpecularPath( const Sphere3f& sourceSphere,
 		
 		// Trace a ray from this intersection point to the source to make sure that
 		// the source is reachable from this location.
-		if ( scene->intersectRay( testRay, sourceToTriangleDistance - 2*rayOffset ) )
+		if ( scene->testRay( testRay, sourceToTriangleDistance - 2*rayOffset ) )
 			return false;
 		
 		// Calculate the intersection point of this ray with the triangle
@@ -2204,7 +2590,7 @@ Bool SoundPropagator:: validatePointSpecularPath( const Sphere3f& sourceSphere,
 	Real rayDistance = directionFromListener.getMagnitude();
 	directionFromListener /= rayDistance;
 	
-	if ( scene->intersectRay( Ray3f( listenerPosition, directionFromListener ), rayDistance ) )
+	if ( scene->testRay( Ray3f( listenerPosition, directionFromListener ), rayDistance ) )
 		return false;
 	
 	totalDistance += rayDistance;
@@ -2241,12 +2627,20 @@ Bool SoundPropagator:: sampleSpecularPath( const Sphere3f& sourceSphere, const V
 	// Generate the validation rays from the source in the direction of the listener image.
 	
 	Array<Ray3f>& validationRays = threadData.validationRays;
+	Array<SoundRay,Size,AlignedAllocator<16> >& sampleRays = threadData.sampleRays;
+	Array<Real>& sampleDistances = threadData.sampleDistances;
 	Size numValidRays = 0;
 	
 	// Make sure there are enough rays.
 	if ( validationRays.getSize() < numSpecularSamples )
 		validationRays.setSize( numSpecularSamples );
 	
+	if ( sampleRays.getSize() < numSpecularSamples )
+		sampleRays.setSize( numSpecularSamples );
+	
+	if ( sampleDistances.getSize() < numSpecularSamples )
+		sampleDistances.setSize( numSpecularSamples );
+	
 	const WorldSpaceTriangle& lastTriangle = imagePositions.getLast().triangle;
 	const Vector3f& lastListenerImagePosition = imagePositions.getLast().imagePosition;
 	Vector3f sourceDirection = sourceSphere.position - lastListenerImagePosition;
@@ -2262,6 +2656,7 @@ Bool SoundPropagator:: sampleSpecularPath( const Sphere3f& sourceSphere, const V
 	// Compute the rotation matrix for the direction samples.
 	Matrix3f sourceRotation = Matrix3f::planeBasis( sourceDirection );
 	Real averageDistance = 0;
+	Size numSampleRays = 0;
 	
 	// Generate the specular sampling rays from the source.
 	for ( Index i = 0; i < numSpecularSamples; i++ )
@@ -2284,11 +2679,26 @@ Bool SoundPropagator:: sampleSpecularPath( const Sphere3f& sourceSphere, const V
 		ray.origin += ray.direction*sphereDistance;
 		ray.direction = -ray.direction;
 		
-		// Trace a ray through the scene to make sure there is no occluder.
+		// Queue the ray to be traced through the scene to make sure there is no occluder.
 		Real rayDistance = sphereDistance - triangleDistance;
-		if ( scene->intersectRay( ray, rayDistance - 2*rayOffset ) )
+		sampleRays[numSampleRays] = SoundRay( ray, 0.0f, rayDistance - 2*rayOffset );
+		sampleDistances[numSampleRays] = rayDistance;
+		numSampleRays++;
+	}
+	
+	// Trace all of the sampling rays from the source together.
+	scene->testRays( sampleRays.getPointer(), numSampleRays );
+	
+	for ( Index i = 0; i < numSampleRays; i++ )
+	{
+		const SoundRay& sampleRay = sampleRays[i];
+		
+		if ( sampleRay.hitValid() )
 			continue;
 		
+		const Real rayDistance = sampleDistances[i];
+		Ray3f ray( (Vector3f)sampleRay.origin, (Vector3f)sampleRay.direction );
+		
 		// Compute the reflected ray.
 		// Only update the origin because we can compute the direction later with better accuracy.
 		ray.origin = ray.origin + ray.direction*rayDistance;
@@ -2331,18 +2741,43 @@ Bool SoundPropagator:: sampleSpecularPath( const Sphere3f& sourceSphere, const V
 		sourceImagePosition = triangle.plane.getReflection( sourceImagePosition );
 		
 		Real averageDistance = 0;
+		numSampleRays = 0;
 		
-		// For each validation ray, update its direction and check the visiblity of the next path segment.
-		for ( Index j = 0; j < numValidRays; )
+		// For each validation ray, update its direction and make sure it intersects the triangle at this depth.
+		// A negative distance marks rays that miss the triangle.
+		for ( Index j = 0; j < numValidRays; j++ )
 		{
 			Ray3f& ray = validationRays[j];
 			ray.direction = (listenerImagePosition - ray.origin).normalize();
 			Real rayDistance;
 			
-			// Make sure the ray intersects the triangle at this depth.
-			// Make sure the path along the ray to the triangle is clear.
-			if ( !ray.intersectsTriangle( triangle.v1, triangle.v2, triangle.v3, rayDistance ) ||
-				scene->intersectRay( ray, rayDistance - 2*rayOffset ) )
+			if ( ray.intersectsTriangle( triangle.v1, triangle.v2, triangle.v3, rayDistance ) )
+			{
+				sampleRays[numSampleRays] = SoundRay( ray, 0.0f, rayDistance - 2*rayOffset );
+				numSampleRays++;
+			}
+			else
+				rayDistance = Real(-1);
+			
+			sampleDistances[j] = rayDistance;
+		}
+		
+		// Trace the rays that hit the triangle together to make sure the path to the triangle is clear.
+		scene->testRays( sampleRays.getPointer(), numSampleRays );
+		
+		for ( Index j = 0, k = 0; j < numValidRays; j++ )
+		{
+			if ( sampleDistances[j] >= Real(0) && sampleRays[k++].hitValid() )
+				sampleDistances[j] = Real(-1);
+		}
+		
+		// Check the visiblity of the next path segment for each validation ray.
+		for ( Index j = 0; j < numValidRays; )
+		{
+			Ray3f& ray = validationRays[j];
+			const Real rayDistance = sampleDistances[j];
+			
+			if ( rayDistance < Real(0) )
 			{
 				// Swap this ray with the last and reduce the number of valid rays.
 				numValidRays--;
@@ -2352,6 +2787,7 @@ Bool SoundPropagator:: sampleSpecularPath( const Sphere3f& sourceSphere, const V
 					return false;
 				
 				ray = validationRays[numValidRays];
+				sampleDistances[j] = sampleDistances[numValidRays];
 				continue;
 			}
 			
@@ -2385,8 +2821,18 @@ Bool SoundPropagator:: sampleSpecularPath( const Sphere3f& sourceSphere, const V
 		Real rayDistance;
 		ray.direction = (listenerPosition - ray.origin).normalize( rayDistance );
 		
-		// Make sure the path along the ray to the listener is clear.
-		if ( scene->intersectRay( ray, rayDistance - 2*rayOffset ) )
+		sampleRays[i] = SoundRay( ray, 0.0f, rayDistance - 2*rayOffset );
+		sampleDistances[i] = rayDistance;
+	}
+	
+	// Trace the rays together to make sure the path along each ray to the listener is clear.
+	scene->testRays( sampleRays.getPointer(), numFinalValidRays );
+	
+	for ( Index i = 0; i < numFinalValidRays; i++ )
+	{
+		const Real rayDistance = sampleDistances[i];
+		
+		if ( sampleRays[i].hitValid() )
 		{
 			numValidRays--;
 			
@@ -2471,9 +2917,12 @@ void SoundPropagator:: outputDiffusePaths( const ArrayList<DiffusePathData>& new
 	
 	if ( sampledIREnabled )
 	{
+		sortDiffusePaths( newPaths, diffusePathOrder );
+		
+		// Add the paths in order of increasing delay.
 		for ( Index i = 0; i < numNewPaths; i++ )
 		{
-			const DiffusePathData& pathData = newPaths[i];
+			const DiffusePathData& pathData = newPaths[(Index)diffusePathOrder[i]];
 			SoundSourceIR& sourceIR = listenerIR.getSourceIR(pathData.sourceIndex);
 			const Real delay = pathData.distance / speedOfSound;
 			
@@ -2749,44 +3198,129 @@ void SoundPropagator:: outputDiffuseCache( internal::DiffusePathCache& diffuseCa
 
 void SoundPropagator:: updateIRCache( SoundSourceIR& sourceIR, const ArrayList<DiffusePathData>& newPaths )
 {
-	// Get the propagation medium for the scene.
-	const SoundMedium& medium = scene->getMedium();
-	const Real speedOfSound = medium.getSpeed();
+	SampledIR& sampledIR = sourceIR.getSampledIR();
 	const Size numNewPaths = newPaths.getSize();
-	const Bool airAbsorption = request->flags.isSet( PropagationFlags::AIR_ABSORPTION );
+	
+	sortDiffusePaths( newPaths, diffusePathOrder );
+	
+	// Add each path's contribution to the source IR in order of increasing delay.
+	for ( Index i = 0; i < numNewPaths; i++ )
+		addDiffuseImpulse( newPaths[(Index)diffusePathOrder[i]], sampledIR );
+}
+
+
+
+
+void SoundPropagator:: updateIRCaches( const ArrayList<DiffusePathData>& newPaths )
+{
+	const Size numNewPaths = newPaths.getSize();
+	
+	sortDiffusePaths( newPaths, diffusePathOrder );
 	
 	for ( Index i = 0; i < numNewPaths; i++ )
 	{
-		const DiffusePathData& path = newPaths[i];
+		const DiffusePathData& path = newPaths[(Index)diffusePathOrder[i]];
 		
-		// Add the path's contribution to the source IR.
-		sourceIR.addImpulse( path.distance / speedOfSound,
-							(airAbsorption ? medium.getAttenuation( path.distance )*path.energy : path.energy),
-							path.direction, path.sourceDirection );
+		// Add the path's contribution to the source IR in order of increasing delay.
+		addDiffuseImpulse( path, sourceDataList[path.sourceIndex].outputIR->getSampledIR() );
 	}
 }
 
 
 
 
-void SoundPropagator:: updateIRCaches( const ArrayList<DiffusePathData>& newPaths )
+void SoundPropagator:: addDiffuseImpulse( const DiffusePathData& path, SampledIR& sampledIR ) const
 {
 	// Get the propagation medium for the scene.
 	const SoundMedium& medium = scene->getMedium();
-	const Real speedOfSound = medium.getSpeed();
-	const Size numNewPaths = newPaths.getSize();
 	const Bool airAbsorption = request->flags.isSet( PropagationFlags::AIR_ABSORPTION );
 	
-	for ( Index i = 0; i < numNewPaths; i++ )
+	sampledIR.addImpulse( path.distance / medium.getSpeed(),
+						(airAbsorption ? medium.getAttenuation( path.distance )*path.energy : path.energy),
+						path.direction, path.sourceDirection );
+}
+
+
+
+
+void SoundPropagator:: sortDiffusePaths( const ArrayList<DiffusePathData>& paths, ArrayList<UInt64>& order )
+{
+	const Size numPaths = paths.getSize();
+	order.clear();
+	
+	// Pack each path's distance above its index so that the keys can be sorted as integers.
+	// The bit pattern of a non-negative float increases monotonically with its value.
+	for ( Index i = 0; i < numPaths; i++ )
 	{
-		const DiffusePathData& path = newPaths[i];
-		SoundSourceIR& sourceIR = *sourceDataList[path.sourceIndex].outputIR;
+		const Float32 distance = math::max( Float32(paths[i].distance), Float32(0) );
+		order.add( (UInt64(*(const UInt32*)&distance) << 32) | UInt64(i) );
+	}
+	
+	std::sort( order.getPointer(), order.getPointer() + numPaths );
+	
+	// Keep only the path indices.
+	for ( Index i = 0; i < numPaths; i++ )
+		order[i] &= UInt64(0xFFFFFFFF);
+}
+
+
+
+
+void SoundPropagator:: mergePartialIRs( Index sourceStartIndex, Size numSources )
+{
+	const Size numThreads = this->numThreads;
+	const Index sourceEndIndex = sourceStartIndex + numSources;
+	Size maxLength = 0;
+	
+	// Add the paths that are still buffered by each thread to its partial IRs.
+	for ( Index i = 0; i < numThreads; i++ )
+		threadDataList[i].flushPartialIRs();
+	
+	//************************************************************************
+	// Make each output IR long enough to hold all of the partial IRs.
+	
+	for ( Index s = sourceStartIndex; s < sourceEndIndex; s++ )
+	{
+		SampledIR& sampledIR = sourceDataList[s].outputIR->getSampledIR();
+		Size length = 0;
+		Index startOffset = math::max<Index>();
 		
-		// Add the path's contribution to the source IR.
-		sourceIR.addImpulse( path.distance / speedOfSound,
-							(airAbsorption ? medium.getAttenuation( path.distance )*path.energy : path.energy),
-							path.direction, path.sourceDirection );
+		for ( Index i = 0; i < numThreads; i++ )
+		{
+			const SampledIR& partialIR = threadDataList[i].partialIRs[s];
+			
+			if ( partialIR.getLengthInSamples() > 0 )
+			{
+				length = math::max( length, partialIR.getLengthInSamples() );
+				startOffset = math::min( startOffset, partialIR.getStartTimeInSamples() );
+			}
+		}
+		
+		if ( length == 0 )
+			continue;
+		
+		// Extend the IR on this thread so that the merge tasks only need to add samples.
+		if ( length > sampledIR.getLengthInSamples() )
+			sampledIR.setLengthInSamples( length );
+		
+		sampledIR.setStartTimeInSamples( math::min( sampledIR.getStartTimeInSamples(), startOffset ) );
+		maxLength = math::max( maxLength, length );
 	}
+	
+	if ( maxLength == 0 )
+		return;
+	
+	//************************************************************************
+	// Add the partial IRs in parallel, where each task adds a disjoint chunk of one source's IR.
+	
+	JobData job;
+	job.sourceIndex = sourceStartIndex;
+	job.numSources = numSources;
+	job.numChunks = (maxLength + IR_CHUNK_SIZE - 1) / IR_CHUNK_SIZE;
+	jobData = &job;
+	
+	jobScheduler.run( bind( &SoundPropagator::mergePartialIRsTask, this ), numSources*job.numChunks );
+	jobData = NULL;
 }
 
 
@@ -2843,7 +3377,7 @@ void SoundPropagator:: doSourcesPropagation( const SoundDetector& listener, Soun
 	const Bool diffuseEnabled = request->flags.isSet( PropagationFlags::DIFFUSE );
 	const Size maxDiffuseDepth = request->maxDiffuseDepth;
 	const Size numDiffuseRays = request->numDiffuseRays;
-	const Size numThreads = request->numThreads;
+	const Size numThreads = this->numThreads;
 	const Size numSources = sourceDataList.getSize();
 	
 	// Do sound propagation for each source.
@@ -2857,19 +3391,8 @@ void SoundPropagator:: doSourcesPropagation( const SoundDetector& listener, Soun
 	{
 		if ( numThreads > 1 )
 		{
-			for ( Index s = 0; s < numSources; s++ )
-			{
-				IRCache& irCache = *sourceDataList[s].irCache;
-				SoundSourceIR& sourceIR = *sourceDataList[s].outputIR;
-				Size numDiffuseRaysCast = sourceDataList[s].numDiffuseRaysCast;
-				
-				threadPool.addJob( FunctionCall< void ( IRCache&, Size, SoundSourceIR& )>(
-											bind( &SoundPropagator::outputIRCache, this ),
-											irCache, numDiffuseRaysCast, sourceIR ) );
-			}
-			
-			// Wait for the cache update jobs to finish.
-			threadPool.finishJobs();
+			// Update the caches in parallel and wait for the cache update tasks to finish.
+			jobScheduler.run( bind( &SoundPropagator::outputIRCacheTask, this ), numSources );
 		}
 		else
 		{
@@ -2891,7 +3414,7 @@ void SoundPropagator:: doSourcesPropagation( const SoundDetector& listener, Soun
 void SoundPropagator:: doSourcePropagation( const SoundDetector& listener, Index sourceIndex,
 											Size maxDiffuseDepth, Size numDiffuseRays )
 {
-	const Size numThreads = request->numThreads;
+	const Size numThreads = this->numThreads;
 	
 	SourceData& sourceData = sourceDataList[sourceIndex];
 	const SoundDetector& source = *sourceData.detector;
@@ -2914,75 +3437,50 @@ void SoundPropagator:: doSourcePropagation( const SoundDetector& listener, Index
 	//************************************************************************
 	// Trace diffuse rays from the source
 	
-	if ( numThreads > Size(1) )
+	for ( Index i = 0; i < numThreads; i++ )
 	{
-		// Compute the total number of rays that should be traced for each thread.
-		const Size raysPerThread = (Size)math::ceiling( Real(numDiffuseRays) / Real(numThreads) );
-		Index rayStart = 0;
-		
-		// Queue the diffuse jobs for all threads.
-		for ( Index i = 0; i < numThreads; i++ )
-		{
-			ThreadData& threadData = threadDataList[i];
-			
-			// Compute the number of rays that this thread should have.
-			const Size numDiffuseThreadRays = math::min( numDiffuseRays - rayStart, raysPerThread );
-			
-			// Queue the job for this range of rays.
-			threadPool.addJob( FunctionCall< void ( const SoundDetector&, const SoundDetector&, Size, Size, Float, ThreadData& )>(
-										bind( &SoundPropagator::propagateSourceRays, this ),
-										source, listener, maxDiffuseDepth, numDiffuseThreadRays, maxIRLength, threadData ) );
-			
-			rayStart += numDiffuseThreadRays;
-		}
-		
-		Bool processing = true;
+		ThreadData& threadData = threadDataList[i];
+		threadData.resetRayCounts();
 		
-		while ( processing )
+		// With multiple threads, accumulate the paths in thread-local IRs that are merged in parallel.
+		if ( numThreads > Size(1) )
 		{
-			// Process any new path buffers.
-			for ( Index i = 0; i < numThreads; i++ )
-			{
-				ThreadData& threadData = threadDataList[i];
-				
-				// Process new diffuse paths.
-				if ( threadData.diffuseBufferFilled )
-				{
-					ArrayList<DiffusePathData>& newDiffusePaths = threadData.diffusePaths[!threadData.diffuseBufferIndex];
-					
-					// Update the caches with the new paths.
-					updateIRCache( sourceIR, newDiffusePaths );
-					
-					// Clear the list of paths for next time.
-					newDiffusePaths.clear();
-					
-					// Signal to the thread that the path buffer has been consumed.
-					threadData.diffuseBufferFilled--;
-				}
-			}
-			
-			// Give up the CPU since we have finished consuming all new paths.
-			Thread::yield();
-			
-			// Check to see if all of the threads are done.
-			processing = false;
-			
-			for ( Index i = 0; i < numThreads; i++ )
-			{
-				if ( !threadDataList[i].threadDone )
-					processing = true;
-			}
+			threadData.pathOutput = ThreadData::PATH_OUTPUT_PARTIAL_IRS;
+			threadData.resetPartialIRs( sourceDataList );
 		}
+		else
+			threadData.pathOutput = ThreadData::PATH_OUTPUT_BUFFERS;
+	}
+	
+	JobData job;
+	job.listener = &listener;
+	job.source = &source;
+	job.maxDiffuseDepth = maxDiffuseDepth;
+	job.numDiffuseRays = numDiffuseRays;
+	job.maxIRLength = maxIRLength;
+	job.sourceIndex = sourceIndex;
+	jobData = &job;
+	
+	// Split the rays into small batches that are load balanced between the threads.
+	const Size numBatches = (numDiffuseRays + RAY_BATCH_SIZE - 1) / RAY_BATCH_SIZE;
+	
+	if ( numThreads > Size(1) )
+	{
+		// Trace the rays and wait for the ray tracing jobs to finish.
+		jobScheduler.run( bind( &SoundPropagator::propagateSourceRaysTask, this ), numBatches );
 		
-		// Wait for the ray tracing jobs to finish.
-		threadPool.finishJobs();
+		// Add the paths that each thread accumulated to the source's IR in parallel.
+		mergePartialIRs( sourceIndex, 1 );
 	}
 	else
 	{
 		// Do all diffuse propagation on the main thread to avoid switching contexts.
-		propagateSourceRays( source, listener, maxDiffuseDepth, numDiffuseRays, maxIRLength, threadDataList[0] );
+		for ( Index i = 0; i < numBatches; i++ )
+			propagateSourceRaysTask( i, 0 );
 	}
 	
+	jobData = NULL;
+	
 	
 	//************************************************************************
 	// Consume the final set of output paths.
@@ -2994,8 +3492,8 @@ void SoundPropagator:: doSourcePropagation( const SoundDetector& listener, Index
 	{
 		ThreadData& threadData = threadDataList[i];
 		
-		// Check both output buffers for paths.
-		for ( Index bufferIndex = 0; bufferIndex < 2; bufferIndex++ )
+		// Check all output buffers for paths.
+		for ( Index bufferIndex = 0; bufferIndex < NUM_PATH_BUFFERS; bufferIndex++ )
 		{
 			ArrayList<DiffusePathData>& newDiffusePaths = threadData.diffusePaths[bufferIndex];
 			
@@ -3009,12 +3507,8 @@ void SoundPropagator:: doSourcePropagation( const SoundDetector& listener, Index
 			}
 		}
 		
-		// Make sure the atomic variables are in the correct state for next time.
-		if  ( threadData.diffuseBufferFilled )
-			threadData.diffuseBufferFilled--;
-		
-		if  ( threadData.threadDone )
-			threadData.threadDone--;
+		// Make sure the path buffer queues are in the correct state for next time.
+		threadData.resetPathBuffers();
 		
 		// Count the number of diffuse rays that were cast this frame.
 		sourceData.numDiffuseRaysCast += threadDataList[i].numDiffuseRaysCast;
@@ -3024,17 +3518,22 @@ void SoundPropagator:: doSourcePropagation( const SoundDetector& listener, Index
 
 
 
-void SoundPropagator:: propagateSourceRays( const SoundDetector& source, const SoundDetector& listener,
-										Size maxDiffuseDepth, Size numDiffuseRays, Float maxIRLength, ThreadData& threadData )
+void SoundPropagator:: propagateSourceRays( const SoundDetector& source, Index sourceIndex, const SoundDetector& listener,
+										Size maxDiffuseDepth, Size numDiffuseRays, Float maxIRLength, Index rayStart,
+										ThreadData& threadData )
 {
 	//************************************************************************
 	// Trace diffuse rays from the source
 	
 	Size rayCastsRemaining = numDiffuseRays*maxDiffuseDepth;
-	threadData.numDiffuseRaysCast = 0;
+	Index rayIndex = 0;
 	
 	while ( rayCastsRemaining > Size(0) )
 	{
+		// Start the random stream for this ray, distinguishing the streams of different sources.
+		threadData.setRandomStream( ThreadData::RANDOM_STREAM_SOURCE_DIFFUSE | (UInt32(sourceIndex) << 8),
+									UInt32(rayStart), UInt32(rayIndex++) );
+		
 		// Create the starting ray for this probe sequence.
 		Ray3f ray( source.getPosition(), getRandomDirection( threadData.randomVariable ) );
 		
@@ -3042,20 +3541,17 @@ void SoundPropagator:: propagateSourceRays( const SoundDetector& source, const S
 		ray.origin += source.getRadius()*ray.direction;
 		
 		rayCastsRemaining -= propagateSourceDiffuseRay( listener, ray, math::min( maxDiffuseDepth, rayCastsRemaining ),
-														maxIRLength, ray.direction, threadData );
+														maxIRLength, ray.direction, sourceIndex, threadData );
 		threadData.numDiffuseRaysCast++;
 	}
-	
-	// Signal that we are done processing.
-	threadData.threadDone++;
 }
 
 
 
 
 Size SoundPropagator:: propagateSourceDiffuseRay( const SoundDetector& detector, Ray3f ray, Size numBounces,
-												Float maxIRLength,
-												const Vector3f& sourceDirection, ThreadData& threadData )
+												Float maxIRLength, const Vector3f& sourceDirection,
+												Index sourceIndex, ThreadData& threadData )
 {
 	const Size numDiffuseSamples = request->numDiffuseSamples;
 	const Real rayOffset = request->rayOffset;
@@ -3161,7 +3657,7 @@ Size SoundPropagator:: propagateSourceDiffuseRay( const SoundDetector& detector,
 								DiffusePathData( 0, (listenerVisibility*radiusNormalize)*reflectionAttenuation*inverseScatteringAttenuation,
 												-listenerDirection, sourceDirection,
 												totalDistance + listenerDistance, 0,
-												0 ) );
+												sourceIndex ) );
 			}
 		}
 		else
@@ -3190,27 +3686,12 @@ Size SoundPropagator:: propagateSourceDiffuseRay( const SoundDetector& detector,
 
 void SoundPropagator:: updateSourcesVisibility()
 {
-	Timer visibilityTimer;
-	
-	const Size numVisibilityRays = request->numVisibilityRays;
-	const Size numSources = sourceDataList.getSize();
-	
-	for ( Index s = 0; s < numSources; s++ )
-	{
-		SourceData& sourceData = sourceDataList[s];
-		const SoundDetector& source = *sourceData.detector;
-		VisibilityCache* visibilityCache = sourceData.visibilityCache;
-		
-		if ( !visibilityCache )
-			continue;
-		
-		threadPool.addJob( FunctionCall< void ( const Vector3f&, Real, Size, VisibilityCache& )>(
-										bind( &SoundPropagator::updateVisibility, this ),
-										source.getPosition(), source.getRadius(), numVisibilityRays, *visibilityCache ) );
-	}
+	Timer visibilityTimer;
+	
+	const Size numSources = sourceDataList.getSize();
 	
-	// Wait until the visibility for all sources has been updated.
-	threadPool.finishJobs();
+	// Update the visibility for all sources in parallel and wait until it has been updated.
+	jobScheduler.run( bind( &SoundPropagator::updateVisibilityTask, this ), numSources );
 	
 	Time visibilityTime = visibilityTimer.getElapsedTime();
 }
@@ -3229,9 +3710,9 @@ void SoundPropagator:: updateSourcesVisibility()
 
 
 
-void SoundPropagator:: updateVisibility( const Vector3f& position, Real radius, Size numVisibilityRays, VisibilityCache& visibilityCache )
+void SoundPropagator:: updateVisibility( const Vector3f& position, Real radius, Size numVisibilityRays, VisibilityCache& visibilityCache,
+										ThreadData& threadData )
 {
-	ThreadData& threadData = threadDataList[threadPool.getCurrentThreadIndex()];
 	const Index timeStamp = request->internalData.timeStamp;
 	
 	Ray3f ray( position, Vector3f() );
@@ -3275,6 +3756,156 @@ void SoundPropagator:: updateVisibility( const Vector3f& position, Real radius,
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Job Scheduler Task Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void SoundPropagator:: propagateListenerTask( Index listenerIndex, Index threadIndex )
+{
+	SoundPropagator& listenerPropagator = *listenerPropagators[threadIndex];
+	
+	listenerPropagator.propagateListener( listenerDataList[listenerIndex], listenerIndex );
+	
+	// Report the statistics for the last listener, as when the listeners are propagated one at a time.
+	if ( statistics != NULL && listenerIndex + 1 == listenerDataList.getSize() )
+		copyListenerStatistics( listenerPropagator.listenerStatistics );
+}
+
+
+
+
+void SoundPropagator:: propagateListenerRaysTask( Index batchIndex, Index threadIndex )
+{
+	const JobData& job = *jobData;
+	const Index rayStart = batchIndex*RAY_BATCH_SIZE;
+	
+	// Determine how many rays of each type are in this batch.
+	const Size numSpecularBatchRays = rayStart < job.numSpecularRays ?
+										math::min( job.numSpecularRays - rayStart, Size(RAY_BATCH_SIZE) ) : Size(0);
+	const Size numDiffuseBatchRays = rayStart < job.numDiffuseRays ?
+										math::min( job.numDiffuseRays - rayStart, Size(RAY_BATCH_SIZE) ) : Size(0);
+	
+	propagateListenerRays( *job.listener, *job.soundPathCache, job.maxSpecularDepth, numSpecularBatchRays,
+							job.maxDiffuseDepth, numDiffuseBatchRays, job.maxIRLength, rayStart, threadDataList[threadIndex] );
+}
+
+
+
+
+void SoundPropagator:: propagateSourceRaysTask( Index batchIndex, Index threadIndex )
+{
+	const JobData& job = *jobData;
+	const Index rayStart = batchIndex*RAY_BATCH_SIZE;
+	const Size numBatchRays = math::min( job.numDiffuseRays - rayStart, Size(RAY_BATCH_SIZE) );
+	
+	propagateSourceRays( *job.source, job.sourceIndex, *job.listener, job.maxDiffuseDepth, numBatchRays,
+						job.maxIRLength, rayStart, threadDataList[threadIndex] );
+}
+
+
+
+
+void SoundPropagator:: validateSpecularCacheTask( Index batchIndex, Index threadIndex )
+{
+	SoundPathCache& soundPathCache = *jobData->soundPathCache;
+	const Index bucketStart = batchIndex*BUCKET_BATCH_SIZE;
+	const Size numBatchBuckets = math::min( soundPathCache.getBucketCount() - bucketStart, Size(BUCKET_BATCH_SIZE) );
+	
+	validateSpecularCacheRange( soundPathCache, bucketStart, numBatchBuckets, threadDataList[threadIndex] );
+}
+
+
+
+
+void SoundPropagator:: outputIRCacheTask( Index sourceIndex, Index threadIndex )
+{
+	SourceData& sourceData = sourceDataList[sourceIndex];
+	
+	outputIRCache( *sourceData.irCache, sourceData.numDiffuseRaysCast, *sourceData.outputIR );
+}
+
+
+
+
+void SoundPropagator:: outputDiffuseCacheTask( Index sourceIndex, Index threadIndex )
+{
+	SourceData& sourceData = sourceDataList[sourceIndex];
+	
+	outputDiffuseCache( *sourceData.diffuseCache, sourceData.numDiffuseRaysCast, *sourceData.outputIR );
+}
+
+
+
+
+void SoundPropagator:: addDirectPathsTask( Index batchIndex, Index threadIndex )
+{
+	const Index sourceStart = batchIndex*DIRECT_SOURCE_BATCH_SIZE;
+	const Size numSources = math::min( sourceDataList.getSize() - sourceStart, DIRECT_SOURCE_BATCH_SIZE );
+	
+	addDirectPaths( *jobData->directListener, sourceStart, numSources, threadDataList[threadIndex] );
+}
+
+
+
+
+void SoundPropagator:: updateVisibilityTask( Index sourceIndex, Index threadIndex )
+{
+	SourceData& sourceData = sourceDataList[sourceIndex];
+	const SoundDetector& source = *sourceData.detector;
+	VisibilityCache* visibilityCache = sourceData.visibilityCache;
+	
+	if ( !visibilityCache )
+		return;
+	
+	threadDataList[threadIndex].setRandomStream( ThreadData::RANDOM_STREAM_VISIBILITY, UInt32(sourceIndex), 0 );
+	
+	updateVisibility( source.getPosition(), source.getRadius(), request->numVisibilityRays,
+					*visibilityCache, threadDataList[threadIndex] );
+}
+
+
+
+
+void SoundPropagator:: mergePartialIRsTask( Index chunkIndex, Index threadIndex )
+{
+	const JobData& job = *jobData;
+	const Size numThreads = this->numThreads;
+	const Index sourceIndex = job.sourceIndex + chunkIndex / job.numChunks;
+	const Index sampleStart = (chunkIndex % job.numChunks)*IR_CHUNK_SIZE;
+	SampledIR& sampledIR = sourceDataList[sourceIndex].outputIR->getSampledIR();
+	
+	// Add this chunk of the IR from each thread's partial IR.
+	for ( Index i = 0; i < numThreads; i++ )
+		sampledIR.addIR( threadDataList[i].partialIRs[sourceIndex], sampleStart, IR_CHUNK_SIZE );
+}
+
+
+
+
+void SoundPropagator:: updateDiffuseCacheShardTask( Index shardIndex, Index threadIndex )
+{
+	const Size numThreads = this->numThreads;
+	
+	for ( Index i = 0; i < numThreads; i++ )
+	{
+		ArrayList<DiffusePathData>& shardPaths = threadDataList[i].cacheShards[shardIndex];
+		
+		// Paths in different shards are always in different cache buckets, so no locking is needed.
+		updateDiffuseCaches( shardPaths );
+		shardPaths.clear();
+	}
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -3286,96 +3917,188 @@ void SoundPropagator:: updateVisibility( const Vector3f& position, Real radius,
 
 
 
-void SoundPropagator:: addDirectPaths( const SoundListener& listener, SoundListenerIR& listenerIR, ThreadData& threadData )
+void SoundPropagator:: addDirectPaths( const SoundListener& listener )
+{
+	if ( !request->flags.isSet( PropagationFlags::DIRECT ) )
+		return;
+	
+	const Size numSources = sourceDataList.getSize();
+	const Size numBatches = (numSources + DIRECT_SOURCE_BATCH_SIZE - 1) / DIRECT_SOURCE_BATCH_SIZE;
+	
+	if ( numThreads > 1 && numSources >= numThreads*MIN_DIRECT_SOURCES_PER_THREAD )
+	{
+		JobData job;
+		job.directListener = &listener;
+		jobData = &job;
+		
+		// Each task writes only to its own sources' IRs, so there is nothing to merge afterwards.
+		jobScheduler.run( bind( &SoundPropagator::addDirectPathsTask, this ), numBatches );
+		
+		jobData = NULL;
+	}
+	else
+	{
+		for ( Index b = 0; b < numBatches; b++ )
+		{
+			const Index sourceStart = b*DIRECT_SOURCE_BATCH_SIZE;
+			
+			addDirectPaths( listener, sourceStart, math::min( numSources - sourceStart, DIRECT_SOURCE_BATCH_SIZE ),
+							threadDataList[0] );
+		}
+	}
+}
+
+
+
+
+void SoundPropagator:: addDirectPaths( const SoundListener& listener, Index sourceStart, Size numSources, ThreadData& threadData )
+{
+	const Vector3f& listenerPosition = listener.getPosition();
+	const Size numMicrophones = listener.getMicrophoneCount();
+	
+	// Each source has a ray from every microphone, followed by one ray from the listener
+	// if the source's visibility is not sampled with many rays.
+	const Size numListenerRays = request->numDirectRays > 1 ? 0 : 1;
+	const Size numSourceRays = numMicrophones + numListenerRays;
+	const Size numRays = numSources*numSourceRays;
+	Array<SoundRay,Size,AlignedAllocator<16> >& directRays = threadData.directRays;
+	
+	if ( directRays.getSize() < numRays )
+		directRays.setSize( numRays );
+	
+	for ( Index s = 0; s < numSources; s++ )
+	{
+		const SoundDetector& source = *sourceDataList[sourceStart + s].detector;
+		const Vector3f& sourcePosition = source.getPosition();
+		SoundRay* const sourceRays = directRays.getPointer() + s*numSourceRays;
+		
+		for ( Index m = 0; m < numMicrophones; m++ )
+		{
+			const Vector3f microphonePosition = listenerPosition + listener.getOrientation()*listener.getMicrophone(m);
+			sourceRays[m] = getDirectRay( microphonePosition, sourcePosition, source.getRadius() );
+		}
+		
+		if ( numListenerRays > 0 )
+			sourceRays[numMicrophones] = getDirectRay( listenerPosition, sourcePosition, source.getRadius() );
+	}
+	
+	// Trace the visibility rays of all sources in the batch through the scene together.
+	if ( numRays > 0 )
+		scene->testRays( directRays.getPointer(), numRays );
+	
+	for ( Index s = 0; s < numSources; s++ )
+	{
+		const Index sourceIndex = sourceStart + s;
+		
+		addDirectPath( listener, sourceIndex, *sourceDataList[sourceIndex].outputIR,
+						directRays.getPointer() + s*numSourceRays, threadData );
+	}
+}
+
+
+
+
+void SoundPropagator:: addDirectPath( const SoundListener& listener, Index sourceIndex, SoundSourceIR& sourceIR,
+									const SoundRay* visibilityRays, ThreadData& threadData )
 {
-	const Bool directEnabled = request->flags.isSet( PropagationFlags::DIRECT );
 	const Bool sampledIREnabled = request->flags.isSet( PropagationFlags::SAMPLED_IR );
 	const Bool dopplerSortingEnabled = request->flags.isSet( PropagationFlags::DOPPLER_SORTING );
 	//const Bool transmissionEnabled = request->flags.isSet( PropagationFlags::TRANSMISSION );
 	
+	const SourceData& sourceData = sourceDataList[sourceIndex];
+	const SoundDetector& source = *sourceData.detector;
+	const Vector3f& sourcePosition = source.getPosition();
 	const Vector3f& listenerPosition = listener.getPosition();
-	Ray3f validationRay( listenerPosition, Vector3f() );
-	const Size numSources = sourceDataList.getSize();
 	SoundPathID& pathID = threadData.specularPathID;
 	Vector3f averageDirection;
 	
-	// Shoot out direct rays from the listener to each source.
-	for ( Index s = 0; s < numSources; s++ )
+	pathID.clearPoints();
+	pathID.setSource( &source );
+	pathID.setListener( &listener );
+	
+	Vector3f sourceDirection = sourcePosition - listenerPosition;
+	Real sourceDistance = sourceDirection.getMagnitude();
+	
+	// Validate the direct sound separately for each microphone of a microphone array listener.
+	const Size numMicrophones = listener.getMicrophoneCount();
+	Bool microphoneVisible = false;
+	
+	for ( Index m = 0; m < numMicrophones; m++ )
 	{
-		const SoundDetector& source = *sourceDataList[s].detector;
-		const Vector3f& sourcePosition = source.getPosition();
+		const Bool visible = !visibilityRays[m].hitValid();
+		sourceIR.setMicrophoneVisibility( m, visible ? Real(1) : Real(0) );
+		microphoneVisible |= visible;
+	}
+	
+	// Compute the angular size of the source.
+	const Real distSquared = math::square(sourceDistance) - math::square(source.getRadius());
+	const Real sourceHalfAngle = math::acos( (distSquared > Real(0) ? math::sqrt(distSquared) : Real(0)) / sourceDistance );
+	
+	// Compute the number of rays to trace for this source, based on the angular size of the source.
+	const Size numDirectRays = (Size)math::max( request->numDirectRays*math::sqrt( math::sin( sourceHalfAngle ) ), Real(1) );
+	
+	Real sourceVisiblity = 0;
+	
+	if ( request->numDirectRays > 1 )
+	{
+		threadData.setRandomStream( ThreadData::RANDOM_STREAM_DIRECT, UInt32(sourceIndex), 0 );
+		
+		// Get the visibility factor of the source based on occlusion (between 0 and 1).
+		sourceVisiblity = getDirectVisibility( sourcePosition, source.getRadius(), listenerPosition, listener.getRadius(),
+												averageDirection, numDirectRays, threadData );
+	}
+	else
+	{
+		if ( sourceDistance != Real(0) )
+		{
+			averageDirection = sourceDirection / sourceDistance;
+			
+			if ( !visibilityRays[numMicrophones].hitValid() )
+				sourceVisiblity = 1;
+		}
+	}
+	
+	// A microphone array hears the direct sound if any of its microphones can see the source.
+	if ( microphoneVisible && sourceVisiblity == Real(0) && sourceDistance != Real(0) )
+	{
+		sourceVisiblity = 1;
+		averageDirection = sourceDirection / sourceDistance;
+	}
+	
+	if ( sourceVisiblity > Real(0) )
+	{
+		sourceDirection /= sourceDistance;
+		Real relativeSpeed = getRelativeSpeed( listener, sourceDirection, source, sourceDirection );
 		
-		pathID.clearPoints();
-		pathID.setSource( &source );
-		pathID.setListener( &listener );
+		FrequencyBandResponse energy = getDistanceAttenuation(sourceDistance) * sourceVisiblity;
 		
-		Vector3f sourceDirection = sourcePosition - listenerPosition;
-		Real sourceDistance = sourceDirection.getMagnitude();
+		if ( sourceData.directivity )
+			energy *= sourceData.directivity->getResponse( (-sourceDirection)*source.getOrientation() );
 		
-		if ( directEnabled )
+		// The direct sound for a microphone array is always a discrete path so that its arrival
+		// time can be corrected exactly for each microphone.
+		if ( sampledIREnabled && numMicrophones == 0 )
 		{
-			// Compute the angular size of the source.
-			const Real distSquared = math::square(sourceDistance) - math::square(source.getRadius());
-			const Real sourceHalfAngle = math::acos( (distSquared > Real(0) ? math::sqrt(distSquared) : Real(0)) / sourceDistance );
-			
-			// Compute the number of rays to trace for this source, based on the angular size of the source.
-			const Size numDirectRays = (Size)math::max( request->numDirectRays*math::sqrt( math::sin( sourceHalfAngle ) ), Real(1) );
-			
-			Real sourceVisiblity = 0;
-			
-			if ( request->numDirectRays > 1 )
+			if ( dopplerSortingEnabled )
 			{
-				// Get the visibility factor of the source based on occlusion (between 0 and 1).
-				sourceVisiblity = getDirectVisibility( source.getPosition(), source.getRadius(), listenerPosition, listener.getRadius(),
-														averageDirection, numDirectRays, threadData );
+				sourceIR.addPath( SoundPath( pathID.getHashCode(), SoundPathFlags::DIRECT,
+							energy,
+							averageDirection, -averageDirection, sourceDistance,
+							relativeSpeed, scene->getMedium().getSpeed() ) );
 			}
 			else
 			{
-				if ( sourceDistance != Real(0) )
-				{
-					averageDirection = sourceDirection / sourceDistance;
-					
-					if ( !scene->intersectRay( Ray3f( listenerPosition, averageDirection ),
-												math::max( sourceDistance - source.getRadius(), Real(0) ) ) )
-						sourceVisiblity = 1;
-				}
-			}
-			
-			if ( sourceVisiblity > Real(0) )
-			{
-				sourceDirection /= sourceDistance;
-				Real relativeSpeed = getRelativeSpeed( listener, sourceDirection, source, sourceDirection );
-				
-				SoundSourceIR& sourceIR = listenerIR.getSourceIR(s);
-				FrequencyBandResponse energy = getDistanceAttenuation(sourceDistance) * sourceVisiblity;
-				
-				if ( sourceDataList[s].directivity )
-					energy *= sourceDataList[s].directivity->getResponse( (-sourceDirection)*source.getOrientation() );
-				
-				if ( sampledIREnabled )
-				{
-					if ( dopplerSortingEnabled )
-					{
-						sourceIR.addPath( SoundPath( pathID.getHashCode(), SoundPathFlags::DIRECT,
-									energy,
-									averageDirection, -averageDirection, sourceDistance,
-									relativeSpeed, scene->getMedium().getSpeed() ) );
-					}
-					else
-					{
-						sourceIR.addImpulse( sourceDistance / scene->getMedium().getSpeed(), energy,
-											averageDirection, -averageDirection );
-					}
-				}
-				else
-				{
-					sourceIR.addPath( SoundPath( pathID.getHashCode(), SoundPathFlags::DIRECT,
-										energy,
-										averageDirection, -averageDirection, sourceDistance,
-										relativeSpeed, scene->getMedium().getSpeed() ) );
-				}
+				sourceIR.addImpulse( sourceDistance / scene->getMedium().getSpeed(), energy,
+									averageDirection, -averageDirection );
 			}
 		}
+		else
+		{
+			sourceIR.addPath( SoundPath( pathID.getHashCode(), SoundPathFlags::DIRECT,
+								energy,
+								averageDirection, -averageDirection, sourceDistance,
+								relativeSpeed, scene->getMedium().getSpeed() ) );
+		}
 	}
 }
 
@@ -3565,7 +4288,7 @@ void SoundPropagator:: recursiveDiffraction( ThreadData& threadData, const World
 				break;
 			}
 			
-			if ( scene->intersectRay( Ray3f( lastPoint.point + direction*diffractionEpsilon, direction ),
+			if ( scene->testRay( Ray3f( lastPoint.point + direction*diffractionEpsilon, direction ),
 								distance - diffractionEpsilon*2 ) )
 			{
 				valid = false;
@@ -3609,7 +4332,7 @@ void SoundPropagator:: recursiveDiffraction( ThreadData& threadData, const World
 				sourceDirection /= sourceDistance;
 				
 				// Check the path from the source's image position to the listener to make sure it is clear.
-				Bool sourceVisible = !scene->intersectRay( Ray3f( listenerImagePosition + sourceDirection*diffractionEpsilon, sourceDirection ), 
+				Bool sourceVisible = !scene->testRay( Ray3f( listenerImagePosition + sourceDirection*diffractionEpsilon, sourceDirection ), 
 														sourceDistance - diffractionEpsilon*2 );
 				
 				if ( sourceVisible )
@@ -3811,7 +4534,7 @@ Bool SoundPropagator:: validateDiffractionPath( const SoundPathID& pathID, Index
 			else
 				return false;
 			
-			if ( scene->intersectRay( Ray3f( currentPoint + sourceDirection*diffractionEpsilon, sourceDirection ),
+			if ( scene->testRay( Ray3f( currentPoint + sourceDirection*diffractionEpsilon, sourceDirection ),
 								distance - diffractionEpsilon*2 ) )
 				return false;
 			
@@ -3836,7 +4559,7 @@ Bool SoundPropagator:: validateDiffractionPath( const SoundPathID& pathID, Index
 			else
 				return false;
 			
-			if ( scene->intersectRay( Ray3f( currentPoint + sourceDirection*diffractionEpsilon, sourceDirection ),
+			if ( scene->testRay( Ray3f( currentPoint + sourceDirection*diffractionEpsilon, sourceDirection ),
 								distance - diffractionEpsilon*2 ) )
 				return false;
 		}
@@ -3999,8 +4722,25 @@ void SoundPropagator:: prepareSceneData( const SoundScene& newScene, SoundSceneI
 	// Prepare the per-thread IR data.
 	
 	// Compute the maximum number of concurrent threads for this scene.
-	const Size numThreadData = threadPool.getThreadCount();
-	
+	prepareThreadData( jobScheduler.getThreadCount() );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Thread Data Preparation Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void SoundPropagator:: prepareThreadData( Size numThreadData )
+{
 	// Add new thread data objects if necessary. Use a deterministic random seed.
 	for ( Index i = threadDataList.getSize(); i < numThreadData; i++ )
 		threadDataList.add( ThreadData( UInt32(42*(i + 1) + 27), this ) );
@@ -4009,6 +4749,41 @@ void SoundPropagator:: prepareSceneData( const SoundScene& newScene, SoundSceneI
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Listener Propagator Preparation Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void SoundPropagator:: prepareListenerPropagators()
+{
+	const Size numWorkers = jobScheduler.getThreadCount();
+	
+	// Add new listener propagators if necessary.
+	for ( Index i = listenerPropagators.getSize(); i < numWorkers; i++ )
+		listenerPropagators.add( util::construct<SoundPropagator>() );
+	
+	for ( Index i = 0; i < numWorkers; i++ )
+	{
+		SoundPropagator& listenerPropagator = *listenerPropagators[i];
+		
+		// Each listener propagator traces all rays for its listeners on the calling worker thread.
+		listenerPropagator.numThreads = 1;
+		listenerPropagator.request = request;
+		listenerPropagator.scene = scene;
+		listenerPropagator.statistics = statistics != NULL ? &listenerPropagator.listenerStatistics : NULL;
+		listenerPropagator.prepareThreadData( 1 );
+	}
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -4468,8 +5243,13 @@ Real SoundPropagator:: getDetectorVisibility( const SoundDetector& detector, con
 	// Compute the angular size of the detector.
 	const Real cosHalfAngle = getSphereCosHalfAngle( detectorDistance, detector.getRadius() );
 	
-	// Take samples to determine the detector's visibility.
-	Size numVisible = 0;
+	// Make sure there is enough space for the sample rays.
+	Array<SoundRay,Size,AlignedAllocator<16> >& sampleRays = threadData.sampleRays;
+	
+	if ( sampleRays.getSize() < numSamples )
+		sampleRays.setSize( numSamples );
+	
+	Size numSampleRays = 0;
 	
 	for ( Index i = 0; i < numSamples; i++ )
 	{
@@ -4482,12 +5262,22 @@ Real SoundPropagator:: getDetectorVisibility( const SoundDetector& detector, con
 		
 		if ( validationRay.intersectsSphere( detector.getBoundingSphere(), rayDistance ) )
 		{
-			// Trace a ray to see if that point is visible.
-			if ( !scene->intersectRay( validationRay, rayDistance ) )
-				numVisible++;
+			sampleRays[numSampleRays] = SoundRay( validationRay, 0.0f, rayDistance );
+			numSampleRays++;
 		}
 	}
 	
+	// Trace the sample rays together to see which points on the detector are visible.
+	scene->testRays( sampleRays.getPointer(), numSampleRays );
+	
+	Size numVisible = 0;
+	
+	for ( Index i = 0; i < numSampleRays; i++ )
+	{
+		if ( !sampleRays[i].hitValid() )
+			numVisible++;
+	}
+	
 	// The visibility is the fraction of rays that hit the detector.
 	return Real(numVisible) / Real(numSamples);
 }
@@ -4524,9 +5314,13 @@ Real SoundPropagator:: getDirectVisibility( const Vector3f& sourcePosition, Real
 	// Compute the rotation matrix for the direction samples.
 	Matrix3f detectorRotation = Matrix3f::planeBasis( detectorDirection );
 	
-	// Take samples to determine the detector's visibility.
-	Size numVisible = 0;
-	averageDirection = detectorDirection;
+	// Make sure there is enough space for the sample rays.
+	Array<SoundRay,Size,AlignedAllocator<16> >& sampleRays = threadData.sampleRays;
+	
+	if ( sampleRays.getSize() < numSamples )
+		sampleRays.setSize( numSamples );
+	
+	Size numSampleRays = 0;
 	
 	for ( Index i = 0; i < numSamples; i++ )
 	{
@@ -4543,11 +5337,22 @@ Real SoundPropagator:: getDirectVisibility( const Vector3f& sourcePosition, Real
 		rayDistance -= listenerRadius;
 		validationRay.origin += validationRay.direction*listenerRadius;
 		
-		// Trace a ray to see if that point is visible.
-		if ( !scene->intersectRay( validationRay, rayDistance ) )
+		sampleRays[numSampleRays] = SoundRay( validationRay, 0.0f, rayDistance );
+		numSampleRays++;
+	}
+	
+	// Trace the sample rays together to see which points on the source are visible.
+	scene->testRays( sampleRays.getPointer(), numSampleRays );
+	
+	Size numVisible = 0;
+	averageDirection = detectorDirection;
+	
+	for ( Index i = 0; i < numSampleRays; i++ )
+	{
+		if ( !sampleRays[i].hitValid() )
 		{
 			numVisible++;
-			averageDirection += validationRay.direction;
+			averageDirection += (Vector3f)sampleRays[i].direction;
 		}
 	}
 	
@@ -178,16 +178,32 @@ class SoundPropagator
 			class ThreadData;
 			
 			
+			/// A class that stores the parameters shared by all tasks of the current job scheduler task set.
+			class JobData;
+			
+			
 		//********************************************************************************
 		//******	Listener Sound Propagation Methods
 			
 			
+			/// Return whether or not whole listeners should be propagated concurrently rather than one at a time.
+			/**
+			  * Listener parallelism is chosen when there are many listeners per thread,
+			  * or when each listener has too few rays to keep every thread busy.
+			  */
+			Bool getListenerParallel( Size numListeners ) const;
+			
+			
+			/// Propagate sound for the specified listener and post-process its IRs.
+			void propagateListener( ListenerData& listenerData, Index listenerIndex );
+			
+			
 			void doListenerPropagation( const ListenerData& listenerData, SoundListenerIR& listenerIR );
 			
 			
 			void propagateListenerRays( const SoundDetector& listener, const internal::SoundPathCache& soundPathCache,
 										Size maxSpecularDepth, Size numSpecularRays, Size maxDiffuseDepth, Size numDiffuseRays,
-										Float maxIRLength, ThreadData& threadData );
+										Float maxIRLength, Index rayStart, ThreadData& threadData );
 			
 			
 			Size propagateListenerSpecularRay( const SoundDetector& listener, const internal::SoundPathCache& soundPathCache,
@@ -213,12 +229,14 @@ class SoundPropagator
 			
 			
 			/// Do diffuse sound propagation for the specified sound source and parameters.
-			void propagateSourceRays( const SoundDetector& source, const SoundDetector& listener,
-									Size maxDiffuseDepth, Size numDiffuseRays, Float maxIRLength, ThreadData& threadData );
+			void propagateSourceRays( const SoundDetector& source, Index sourceIndex, const SoundDetector& listener,
+									Size maxDiffuseDepth, Size numDiffuseRays, Float maxIRLength, Index rayStart,
+									ThreadData& threadData );
 			
 			
 			Size propagateSourceDiffuseRay( const SoundDetector& listener, Ray3f ray, Size numBounces,
-											Float maxIRLength, const Vector3f& sourceDirection, ThreadData& threadData );
+											Float maxIRLength, const Vector3f& sourceDirection,
+											Index sourceIndex, ThreadData& threadData );
 			
 			
 			/// Update the visibility caches for all sources in the scene.
@@ -226,9 +244,53 @@ class SoundPropagator
 			
 			
 			void updateVisibility( const Vector3f& position, Real radius, Size numVisibilityRays,
-									internal::VisibilityCache& visibilityCache );
+									internal::VisibilityCache& visibilityCache, ThreadData& threadData );
 			
 			
+		//********************************************************************************
+		//******	Job Scheduler Task Methods
+			
+			
+			/// Propagate sound for the specified listener using the listener propagator of the calling thread.
+			void propagateListenerTask( Index listenerIndex, Index threadIndex );
+			
+			
+			/// Trace one batch of specular and diffuse rays from the listener of the current job.
+			void propagateListenerRaysTask( Index batchIndex, Index threadIndex );
+			
+			
+			/// Trace one batch of diffuse rays from the source of the current job.
+			void propagateSourceRaysTask( Index batchIndex, Index threadIndex );
+			
+			
+			/// Validate one batch of buckets in the specular cache of the current job.
+			void validateSpecularCacheTask( Index batchIndex, Index threadIndex );
+			
+			
+			/// Compute the output IR for the IR cache of the specified source.
+			void outputIRCacheTask( Index sourceIndex, Index threadIndex );
+			
+			
+			/// Compute the output IR for the diffuse cache of the specified source.
+			void outputDiffuseCacheTask( Index sourceIndex, Index threadIndex );
+			
+			
+			/// Update the visibility cache of the specified source.
+			void updateVisibilityTask( Index sourceIndex, Index threadIndex );
+			
+			
+			/// Add the direct/transmitted paths for the specified batch of sources and the listener of the current job.
+			void addDirectPathsTask( Index batchIndex, Index threadIndex );
+			
+			
+			/// Add the samples in one chunk of the job's sources' IRs from every thread's partial IRs.
+			void mergePartialIRsTask( Index chunkIndex, Index threadIndex );
+			
+			
+			/// Insert the diffuse paths that every thread found for one diffuse cache shard into the diffuse caches.
+			void updateDiffuseCacheShardTask( Index shardIndex, Index threadIndex );
+		
+		
 		//********************************************************************************
 		//******	Diffuse Propagation Methods
 			
@@ -265,6 +327,21 @@ class SoundPropagator
 			GSOUND_FORCE_INLINE void outputIRCache( internal::IRCache& irCache, Size numDiffuseRaysCast, SoundSourceIR& sourceIR );
 			
 			
+			/// Add the contribution of the specified diffuse path to a sampled IR.
+			GSOUND_FORCE_INLINE void addDiffuseImpulse( const DiffusePathData& path, SampledIR& sampledIR ) const;
+			
+			
+			/// Compute the order of the specified paths that sorts them by increasing distance.
+			/**
+			  * Accumulating paths in this order makes the IR memory accesses nearly sequential.
+			  */
+			static void sortDiffusePaths( const ArrayList<DiffusePathData>& paths, ArrayList<UInt64>& order );
+			
+			
+			/// Add the thread-local partial IRs for a range of sources to the sources' output IRs in parallel.
+			void mergePartialIRs( Index sourceStartIndex, Size numSources );
+		
+		
 		//********************************************************************************
 		//******	Specular Propagation Methods
 			
@@ -307,7 +384,42 @@ class SoundPropagator
 			
 			
 			/// Add all direct/transmitted propagation paths to the propagation path buffer.
-			void addDirectPaths( const SoundListener& listener, SoundListenerIR& pathBuffer, ThreadData& threadData );
+			/**
+			  * The sources are processed in batches of DIRECT_SOURCE_BATCH_SIZE, which are split between
+			  * the worker threads when there are enough of them to amortize the scheduling cost.
+			  * Each source's paths are written directly to its IR.
+			  */
+			void addDirectPaths( const SoundListener& listener );
+			
+			
+			/// Add the direct/transmitted propagation paths for a batch of sources to their IRs.
+			/**
+			  * The visibility rays from the listener and its microphones to all sources in the batch
+			  * are traced through the scene with a single call.
+			  */
+			void addDirectPaths( const SoundListener& listener, Index sourceStart, Size numSources, ThreadData& threadData );
+			
+			
+			/// Add the direct/transmitted propagation paths for the specified source to its IR.
+			/**
+			  * The visibility rays contain one traced ray from each microphone of the listener to the source,
+			  * followed by a ray from the listener if the source's visibility is not sampled with many rays.
+			  */
+			void addDirectPath( const SoundListener& listener, Index sourceIndex, SoundSourceIR& sourceIR,
+								const SoundRay* visibilityRays, ThreadData& threadData );
+			
+			
+			/// Return a ray from the specified point that ends at the surface of a spherical source.
+			GSOUND_INLINE static SoundRay getDirectRay( const Vector3f& origin, const Vector3f& sourcePosition, Real sourceRadius )
+			{
+				Vector3f direction = sourcePosition - origin;
+				const Real distance = direction.getMagnitude();
+				
+				if ( distance > math::epsilon<Real>() )
+					direction /= distance;
+				
+				return SoundRay( Ray3f( origin, direction ), Real(0), math::max( distance - sourceRadius, Real(0) ) );
+			}
 			
 			
 		//********************************************************************************
@@ -340,6 +452,18 @@ class SoundPropagator
 			void prepareSceneData( const SoundScene& newScene, SoundSceneIR& sceneIR );
 			
 			
+			/// Make sure that there are at least the specified number of thread-local data objects.
+			void prepareThreadData( Size numThreadData );
+			
+			
+			/// Prepare a single-threaded listener propagator for each worker thread for listener-parallel propagation.
+			void prepareListenerPropagators();
+			
+			
+			/// Copy the statistics that are computed for each listener from a listener propagator's statistics.
+			void copyListenerStatistics( const SoundStatistics& listenerStatistics );
+			
+			
 			/// Prepare the internal source data and listener IR for sound propagation for the specified listener.
 			void prepareListenerSourceData( const SoundListener& listener, SoundListenerIR& listenerIR );
 			
@@ -455,6 +579,54 @@ class SoundPropagator
 			static const Size PATH_BUFFER_SIZE = 128;
 			
 			
+			/// The number of output path buffers that each thread cycles between the thread and the main thread.
+			static const Size NUM_PATH_BUFFERS = 4;
+			
+			
+			/// The number of probe rays that are traced by each ray tracing task.
+			/**
+			  * Small batches let idle threads steal work from threads that trace
+			  * expensive high-order paths, so that all threads finish at nearly the same time.
+			  */
+			static const Size RAY_BATCH_SIZE = 32;
+			
+			
+			/// The number of specular cache buckets that are validated by each validation task.
+			static const Size BUCKET_BATCH_SIZE = 64;
+			
+			
+			/// The number of independent shards that the diffuse caches are partitioned into for parallel updates.
+			/**
+			  * A path belongs to the shard of its cache bucket index, so that no two
+			  * shards ever modify the same bucket.
+			  */
+			static const Size NUM_CACHE_SHARDS = 16;
+			
+			
+			/// The number of listeners per thread above which listeners are always propagated concurrently.
+			static const Size MIN_LISTENERS_PER_THREAD = 4;
+			
+			
+			/// The number of ray batches per thread that a listener needs to be propagated by all threads at once.
+			static const Size MIN_RAY_BATCHES_PER_THREAD = 16;
+			
+			
+			/// The number of sources per thread above which the direct paths are computed in parallel.
+			static const Size MIN_DIRECT_SOURCES_PER_THREAD = 8;
+			
+			
+			/// The number of sources whose direct visibility rays are traced through the scene together.
+			static const Size DIRECT_SOURCE_BATCH_SIZE = 8;
+			
+			
+			/// The number of IR samples that are merged from the threads' partial IRs by each merge task.
+			static const Size IR_CHUNK_SIZE = 4096;
+			
+			
+			/// The number of diffuse paths that a thread buffers before sorting them and adding them to its partial IRs.
+			static const Size IMPULSE_BATCH_SIZE = 1024;
+		
+		
 		//********************************************************************************
 		//******	Private Data Members
 			
@@ -471,12 +643,36 @@ class SoundPropagator
 			ArrayList<ThreadData> threadDataList;
 			
 			
-			/// A pool of worker threads which the sound propagator delegates tasks to.
-			ThreadPool threadPool;
+			/// The number of threads that are used to propagate sound for each listener.
+			/**
+			  * This is the request's thread count when the listeners are propagated one at a time,
+			  * or 1 for the listener propagators that each propagate whole listeners concurrently.
+			  */
+			Size numThreads;
 			
 			
-			/// A signal that the main thread waits on when it has no paths to process.
-			Signal mainThreadSignal;
+			/// A single-threaded propagator for each worker thread that propagates whole listeners concurrently.
+			/**
+			  * Each listener propagator has its own source and thread data, so that many listeners
+			  * with modest ray budgets can be propagated without synchronizing the threads for each listener.
+			  */
+			ArrayList<SoundPropagator*> listenerPropagators;
+			
+			
+			/// The statistics for the last listener that this listener propagator propagated.
+			SoundStatistics listenerStatistics;
+			
+			
+			/// A work-stealing scheduler of worker threads which the sound propagator delegates tasks to.
+			JobScheduler jobScheduler;
+			
+			
+			/// A semaphore that the main thread waits on when it has no paths to process.
+			/**
+			  * Worker threads raise the semaphore when they hand off a full path buffer,
+			  * and the job scheduler raises it when the last task finishes.
+			  */
+			Semaphore pathSemaphore;
 			
 			
 			/// A pointer to the current sound propagation request.
@@ -491,6 +687,14 @@ class SoundPropagator
 			SoundStatistics* statistics;
 			
 			
+			/// A temporary pointer to the parameters of the current job scheduler task set.
+			const JobData* jobData;
+			
+			
+			/// A temporary list used by the main thread to sort diffuse paths before they are added to an IR.
+			ArrayList<UInt64> diffusePathOrder;
+
+
 			
 };
 
@@ -363,13 +363,46 @@ class SoundScene
 			GSOUND_FORCE_INLINE Bool intersectRay( SoundRay& ray ) const;
 			
 			
-			/// Trace a ray through the scene to the specified maximum distance, returning TRUE if it hits anything.
-			GSOUND_FORCE_INLINE Bool testRay( SoundRay& ray ) const
+			/// Test whether or not a ray hits anything in the scene before the specified maximum distance.
+			/**
+			  * This method is faster than intersectRay() because the traversal
+			  * stops at the first intersection rather than finding the closest one.
+			  */
+			GSOUND_FORCE_INLINE Bool testRay( const Ray3f& ray, Float maxDistance ) const
 			{
-				return this->intersectRay( ray );
+				SoundRay soundRay( ray, 0.0f, maxDistance );
+				
+				return this->testRay( soundRay );
 			}
 			
 			
+			/// Trace a ray through the scene to the specified maximum distance, returning TRUE if it hits anything.
+			/**
+			  * The traversal stops at the first intersection that is found, so if the ray
+			  * hits something, the ray's intersection information is not necessarily for the closest hit.
+			  */
+			GSOUND_FORCE_INLINE Bool testRay( SoundRay& ray ) const;
+			
+			
+			/// Trace an array of rays through the scene and find the first intersected triangle for each ray.
+			/**
+			  * Each ray is updated exactly as if intersectRay() had been called for it,
+			  * but the rays are traced through each object's mesh in groups, amortizing
+			  * the object transformation and per-object dispatch over many rays.
+			  * After tracing, the hitValid() method of each ray indicates whether it hit anything.
+			  */
+			GSOUND_INLINE void intersectRays( SoundRay* rays, Size numRays ) const;
+			
+			
+			/// Test whether or not each ray in an array hits anything in the scene before its maximum distance.
+			/**
+			  * Each ray is updated exactly as if testRay() had been called for it.
+			  * The traversal for a ray stops at its first intersection and rays that have
+			  * already hit an object are not tested against the remaining objects.
+			  */
+			GSOUND_INLINE void testRays( SoundRay* rays, Size numRays ) const;
+		
+		
 		//********************************************************************************
 		//******	Sound Medium Accessor Methods
 			
@@ -461,6 +494,10 @@ class SoundScene
 			static const Size OBJECT_COUNT_THRESHOLD = 8;
 			
 			
+			/// The maximum number of rays that are tested against the objects' bounding spheres together.
+			static const Size RAY_BATCH_SIZE = 64;
+			
+			
 		//********************************************************************************
 		//******	Private Data Members
 			
@@ -573,6 +610,29 @@ class SoundScene:: SceneBVH : public BVHGeometry
 					object->intersectRay( *((SoundRay*)&ray) );
 				}
 			}
+			
+			
+			/// Test whether or not the primitive with the specified index is intersected by the specified ray.
+			virtual void testRay( om::bvh::PrimitiveIndex primitiveIndex, BVHRay& ray ) const
+			{
+				SoundObject* object = scene->objects[primitiveIndex];
+				object->testRay( *((SoundRay*)&ray) );
+			}
+			
+			
+			/// Test whether or not any of the primitives with the specified indices are intersected by the specified ray.
+			virtual void testRay( const om::bvh::PrimitiveIndex* primitiveIndices,
+									om::bvh::PrimitiveCount numPrimitives, BVHRay& ray ) const
+			{
+				for ( om::bvh::PrimitiveCount i = 0; i < numPrimitives; i++ )
+				{
+					SoundObject* object = scene->objects[primitiveIndices[i]];
+					object->testRay( *((SoundRay*)&ray) );
+					
+					if ( ray.hitValid() )
+						return;
+				}
+			}
 				
 				
 		//********************************************************************************
@@ -580,7 +640,7 @@ class SoundScene:: SceneBVH : public BVHGeometry
 			
 			
 			/// The BVH that holds the scene geometry.
-			om::bvh::AABBTree4 bvh;
+			SoundBVH bvh;
 			
 			
 			/// A pointer to the scene that this geometry is in.
@@ -621,6 +681,131 @@ Bool SoundScene:: intersectRay( SoundRay& ray ) const
 
 
 
+
+Bool SoundScene:: testRay( SoundRay& ray ) const
+{
+	const Size numObjects = objects.getSize();
+	
+	if ( numObjects < OBJECT_COUNT_THRESHOLD )
+	{
+		// Stop at the first object that is hit.
+		for ( Index i = 0; i < numObjects; i++ )
+		{
+			SoundObject* object = objects[i];
+			
+			if ( Ray3f( ray.origin, ray.direction ).intersectsSphere( object->getBoundingSphere() ) )
+			{
+				object->testRay( ray );
+				
+				if ( ray.hitValid() )
+					return true;
+			}
+		}
+		
+		return false;
+	}
+	else
+	{
+		bvh->bvh.testRay( ray );
+		
+		return ray.hitValid();
+	}
+}
+
+
+
+
+void SoundScene:: intersectRays( SoundRay* rays, Size numRays ) const
+{
+	const Size numObjects = objects.getSize();
+	
+	if ( numObjects < OBJECT_COUNT_THRESHOLD )
+	{
+		SoundRay* objectRays[RAY_BATCH_SIZE];
+		
+		for ( Index start = 0; start < numRays; start += RAY_BATCH_SIZE )
+		{
+			SoundRay* const batch = rays + start;
+			const Size batchSize = math::min( numRays - start, RAY_BATCH_SIZE );
+			
+			// Visit the objects in the same order as intersectRay() so that the results are identical.
+			for ( Index i = 0; i < numObjects; i++ )
+			{
+				SoundObject* object = objects[i];
+				const Sphere3f& objectSphere = object->getBoundingSphere();
+				Size numObjectRays = 0;
+				
+				// Gather the rays that hit the object's bounding sphere.
+				for ( Index j = 0; j < batchSize; j++ )
+				{
+					if ( Ray3f( batch[j].origin, batch[j].direction ).intersectsSphere( objectSphere ) )
+					{
+						objectRays[numObjectRays] = batch + j;
+						numObjectRays++;
+					}
+				}
+				
+				if ( numObjectRays > 0 )
+					object->intersectRays( objectRays, numObjectRays );
+			}
+		}
+	}
+	else
+	{
+		for ( Index i = 0; i < numRays; i++ )
+			bvh->bvh.intersectRay( rays[i] );
+	}
+}
+
+
+
+
+void SoundScene:: testRays( SoundRay* rays, Size numRays ) const
+{
+	const Size numObjects = objects.getSize();
+	
+	if ( numObjects < OBJECT_COUNT_THRESHOLD )
+	{
+		SoundRay* objectRays[RAY_BATCH_SIZE];
+		
+		for ( Index start = 0; start < numRays; start += RAY_BATCH_SIZE )
+		{
+			SoundRay* const batch = rays + start;
+			const Size batchSize = math::min( numRays - start, RAY_BATCH_SIZE );
+			
+			// Visit the objects in the same order as testRay() so that the results are identical.
+			for ( Index i = 0; i < numObjects; i++ )
+			{
+				SoundObject* object = objects[i];
+				const Sphere3f& objectSphere = object->getBoundingSphere();
+				Size numObjectRays = 0;
+				
+				// Gather the rays that are not yet occluded and that hit the object's bounding sphere.
+				for ( Index j = 0; j < batchSize; j++ )
+				{
+					if ( !batch[j].hitValid() &&
+						Ray3f( batch[j].origin, batch[j].direction ).intersectsSphere( objectSphere ) )
+					{
+						objectRays[numObjectRays] = batch + j;
+						numObjectRays++;
+					}
+				}
+				
+				if ( numObjectRays > 0 )
+					object->testRays( objectRays, numObjectRays );
+			}
+		}
+	}
+	else
+	{
+		for ( Index i = 0; i < numRays; i++ )
+			bvh->bvh.testRay( rays[i] );
+	}
+}
+
+
+
+
 //##########################################################################################
 //******************************  End GSound Namespace  ************************************
 GSOUND_NAMESPACE_END
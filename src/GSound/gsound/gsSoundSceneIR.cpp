@@ -194,6 +194,26 @@ void SoundSceneIR:: reset()
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Compaction Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void SoundSceneIR:: compact()
+{
+	for ( Index i = 0; i < listenerIRs.getSize(); i++ )
+		listenerIRs[i].compact();
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############
@@ -186,6 +186,14 @@ class SoundSceneIR
 			void reset();
 			
 			
+		//********************************************************************************
+		//******	IR Compaction Method
+			
+			
+			/// Convert the sampled IRs for all listeners and sources to compact form, releasing their full-precision storage.
+			void compact();
+		
+		
 		//********************************************************************************
 		//******	Path Count Accessor Method
 			
@@ -143,6 +143,8 @@ void SoundSourceIR:: reset()
 {
 	paths.reset();
 	sampledIR.reset();
+	compactIR.reset();
+	microphoneVisibility.clear();
 	startTime = math::max<Float>();
 	length = 0;
 }
@@ -150,6 +152,31 @@ void SoundSourceIR:: reset()
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############
+//############		IR Compaction Method
+//############
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void SoundSourceIR:: compact()
+{
+	if ( sampledIR.getLengthInSamples() == 0 )
+		return;
+	
+	compactIR.compress( sampledIR );
+	
+	// Release the full-precision storage. The sample rate and source direction setting are kept.
+	sampledIR.reset();
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############
@@ -173,7 +200,7 @@ Float SoundSourceIR:: trim( const FrequencyBandResponse& thresholdPower )
 	// Convert the threshold in sound power to threshold in relative intensity.
 	FrequencyBandResponse threshold = thresholdPower / totalPower;
 	
-	Float sampledIRLength = sampledIR.trim( threshold );
+	Float sampledIRLength = this->isCompact() ? compactIR.getLength() : sampledIR.trim( threshold );
 	
 	return math::max( sampledIRLength, length );
 }
@@ -203,7 +230,7 @@ FrequencyBandResponse SoundSourceIR:: getTotalIntensity() const
 		totalIntensity += path.getIntensity();
 	}
 	
-	return totalIntensity + sampledIR.getTotalIntensity();
+	return totalIntensity + sampledIR.getTotalIntensity() + compactIR.getTotalIntensity();
 }
 
 
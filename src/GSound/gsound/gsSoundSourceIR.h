@@ -57,6 +57,7 @@
 #include "gsSoundSource.h"
 #include "gsSoundPath.h"
 #include "gsSampledIR.h"
+#include "gsCompactSampledIR.h"
 
 
 //##########################################################################################
@@ -224,6 +225,23 @@ class SoundSourceIR
 			}
 			
 			
+			/// Return a reference to the full-precision sampled IR for this sound source IR, expanding it if it is compact.
+			/**
+			  * If this IR has been compacted, the compact IR is expanded into the specified
+			  * buffer and a reference to the buffer is returned. Otherwise, a reference to this
+			  * IR's sampled IR is returned and the buffer is not modified.
+			  */
+			GSOUND_INLINE const SampledIR& expandSampledIR( SampledIR& buffer ) const
+			{
+				if ( !this->isCompact() )
+					return sampledIR;
+				
+				compactIR.expand( buffer );
+				
+				return buffer;
+			}
+			
+			
 			/// Add the specified impulse to this sound source IR's sampled impulse response.
 			GSOUND_INLINE void addImpulse( Float delay, const FrequencyBandResponse& newEnergy,
 											const Vector3f& direction, const Vector3f& sourceDirection )
@@ -239,6 +257,63 @@ class SoundSourceIR
 			}
 			
 			
+		//********************************************************************************
+		//******	Compact IR Accessor Methods
+			
+			
+			/// Return whether or not the sampled IR for this sound source IR is stored in compact form.
+			GSOUND_INLINE Bool isCompact() const
+			{
+				return compactIR.getLengthInSamples() > 0;
+			}
+			
+			
+			/// Return a reference to the compact version of the sampled IR for this sound source IR.
+			/**
+			  * The compact IR is empty unless compact() has been called since the IR was last cleared.
+			  */
+			GSOUND_INLINE const CompactSampledIR& getCompactIR() const
+			{
+				return compactIR;
+			}
+			
+			
+			/// Convert the sampled IR for this sound source IR to compact form, releasing its full-precision storage.
+			/**
+			  * After this method is called, the sampled IR is empty and the response
+			  * should be read with expandSampledIR(). No impulses should be added to the IR
+			  * until it is cleared, which also discards the compact IR.
+			  */
+			void compact();
+		
+		
+		//********************************************************************************
+		//******	Microphone Direct Visibility Accessor Methods
+			
+			
+			/// Return the fraction of the direct sound that reaches the microphone at the specified index.
+			/**
+			  * If the listener has a microphone array, the visibility of the source is validated
+			  * separately for each microphone, and the direct path is only added to the impulse
+			  * response channels of the microphones that can see the source.
+			  * The visibility is 1 for microphones that were not validated.
+			  */
+			GSOUND_INLINE Real getMicrophoneVisibility( Index microphoneIndex ) const
+			{
+				return microphoneIndex < microphoneVisibility.getSize() ? microphoneVisibility[microphoneIndex] : Real(1);
+			}
+			
+			
+			/// Set the fraction of the direct sound that reaches the microphone at the specified index.
+			GSOUND_INLINE void setMicrophoneVisibility( Index microphoneIndex, Real newVisibility )
+			{
+				while ( microphoneVisibility.getSize() <= microphoneIndex )
+					microphoneVisibility.add( Real(1) );
+				
+				microphoneVisibility[microphoneIndex] = newVisibility;
+			}
+		
+		
 		//********************************************************************************
 		//******	IR Clear Methods
 			
@@ -251,6 +326,8 @@ class SoundSourceIR
 			{
 				paths.clear();
 				sampledIR.clear();
+				compactIR.clear();
+				microphoneVisibility.clear();
 				startTime = math::max<Float>();
 				length = 0;
 			}
@@ -273,7 +350,9 @@ class SoundSourceIR
 			  */
 			GSOUND_INLINE Float getStartTime() const
 			{
-				return math::min( math::min( startTime, sampledIR.getStartTime() ), this->getLength() );
+				const Float sampledStartTime = this->isCompact() ? compactIR.getStartTime() : sampledIR.getStartTime();
+				
+				return math::min( math::min( startTime, sampledStartTime ), this->getLength() );
 			}
 			
 			
@@ -292,7 +371,7 @@ class SoundSourceIR
 			/// Return the length in seconds of this IR.
 			GSOUND_INLINE Float getLength() const
 			{
-				return math::max( length, sampledIR.getLength() );
+				return math::max( length, this->isCompact() ? compactIR.getLength() : sampledIR.getLength() );
 			}
 			
 			
@@ -301,7 +380,7 @@ class SoundSourceIR
 			{
 				SampleRate sampleRate = sampledIR.getSampleRate();
 				Size pathLength = (Size)math::ceiling(length*sampleRate);
-				return math::max( pathLength, sampledIR.getLengthInSamples() );
+				return math::max( pathLength, this->isCompact() ? compactIR.getLengthInSamples() : sampledIR.getLengthInSamples() );
 			}
 			
 			
@@ -342,6 +421,7 @@ class SoundSourceIR
 			/// Trim the source IR's length based on the specified threshold of hearing in units of sound power (watts).
 			/**
 			  * The method returns the resulting length of the IR in seconds.
+			  * A compact IR is not trimmed.
 			  */
 			Float trim( const FrequencyBandResponse& thresholdPower );
 			
@@ -411,7 +491,8 @@ class SoundSourceIR
 			GSOUND_INLINE Size getSizeInBytes() const
 			{
 				return sizeof(SoundSourceIR) + paths.getCapacity()*sizeof(SoundPath) + 
-						sources.getCapacity()*sizeof(SoundSource*) + sampledIR.getSizeInBytes();
+						sources.getCapacity()*sizeof(SoundSource*) + sampledIR.getSizeInBytes() +
+						compactIR.getSizeInBytes();
 			}
 			
 			
@@ -429,6 +510,14 @@ class SoundSourceIR
 			SampledIR sampledIR;
 			
 			
+			/// An object that contains a compact version of the sampled IR, if the IR has been compacted.
+			CompactSampledIR compactIR;
+			
+			
+			/// The fraction of the direct sound that reaches each microphone of the listener's microphone array.
+			ShortArrayList<Real,8> microphoneVisibility;
+			
+			
 			/// A list of to the sound sources that this sound impulse response contains paths for.
 			ShortArrayList<const SoundSource*,4> sources;
 			
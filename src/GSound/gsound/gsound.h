@@ -191,10 +191,14 @@
 
 // Impulse Response Classes.
 #include "gsSampledIR.h"
+#include "gsCompactSampledIR.h"
 #include "gsSoundSourceIR.h"
 #include "gsSoundListenerIR.h"
 #include "gsSoundSceneIR.h"
 #include "gsImpulseResponse.h"
+#include "gsIRSynthesizer.h"
+#include "gsSoundPathRecord.h"
+#include "gsSoundPathFile.h"
 
 
 // Rendering Classes.
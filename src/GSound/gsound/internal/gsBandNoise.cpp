@@ -0,0 +1,154 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/internal/gsBandNoise.cpp
+ * Contents:    gsound::internal::BandNoise class implementation
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "gsBandNoise.h"
+
+
+//##########################################################################################
+//**************************  Start GSound Internal Namespace  *****************************
+GSOUND_INTERNAL_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+/// A mutex that protects the list of shared band noise.
+static Mutex bandNoiseMutex;
+
+
+/// The band noise that has been created, at most one for each combination of bands and sample rate.
+static ArrayList< Shared<BandNoise> > bandNoiseList;
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Constructor
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+BandNoise:: BandNoise( const FrequencyBands& bands, SampleRate newSampleRate, Size length )
+	:	sampleRate( newSampleRate )
+{
+	crossover.setBands( bands, sampleRate );
+	noise.allocate( length );
+	
+	// Generate white noise, then filter it into the frequency bands.
+	math::Random<Float> noiseRand( NOISE_SEED );
+	
+	for ( Index i = 0; i < length; i++ )
+		noise[i] = noiseRand.sample( -1.0f, 1.0f );
+	
+	CrossoverType::History history;
+	crossover.filterSIMD( history, (const Float32*)noise.getPointer(), (Float32*)noise.getPointer(), length );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Shared Band Noise Accessor Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Shared<const BandNoise> BandNoise:: get( const FrequencyBands& bands, SampleRate sampleRate, Size minLength )
+{
+	ScopedMutex lock( bandNoiseMutex );
+	
+	const Size numNoise = bandNoiseList.getSize();
+	Index noiseIndex = numNoise;
+	
+	// Find the existing noise for the bands and sample rate.
+	for ( Index i = 0; i < numNoise; i++ )
+	{
+		const BandNoise& bandNoise = *bandNoiseList[i];
+		
+		if ( bandNoise.sampleRate == sampleRate && bandNoise.getBands() == bands )
+		{
+			if ( bandNoise.getLength() >= minLength )
+				return bandNoiseList[i];
+			
+			noiseIndex = i;
+			break;
+		}
+	}
+	
+	// Create longer noise. It replaces the shorter noise in the list, which stays
+	// alive until the impulse responses that are still using it release it.
+	const Size length = math::nextPowerOfTwo( math::max( minLength, MIN_LENGTH ) );
+	Shared<BandNoise> newNoise( new ( util::allocate<BandNoise>() ) BandNoise( bands, sampleRate, length ) );
+	
+	if ( noiseIndex < numNoise )
+		bandNoiseList[noiseIndex] = newNoise;
+	else
+		bandNoiseList.add( newNoise );
+	
+	return newNoise;
+}
+
+
+
+
+//##########################################################################################
+//**************************  End GSound Internal Namespace  *******************************
+GSOUND_INTERNAL_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
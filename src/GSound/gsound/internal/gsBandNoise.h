@@ -0,0 +1,193 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/internal/gsBandNoise.h
+ * Contents:    gsound::internal::BandNoise class declaration
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef INCLUDE_GSOUND_BAND_NOISE_H
+#define INCLUDE_GSOUND_BAND_NOISE_H
+
+
+#include "gsInternalConfig.h"
+
+
+#include "gsSIMDCrossover.h"
+
+
+//##########################################################################################
+//**************************  Start GSound Internal Namespace  *****************************
+GSOUND_INTERNAL_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that stores band-filtered noise and the crossover that filtered it for a set of frequency bands.
+/**
+  * Impulse responses use the noise to reconstruct the phase of a pressure IR from
+  * per-band energy. Band noise objects are immutable once created and are shared
+  * between all impulse responses in the process, so that the noise is filtered
+  * only once for each combination of frequency bands, sample rate, and length.
+  */
+class BandNoise
+{
+	public:
+		
+		//********************************************************************************
+		//******	Public Type Declarations
+			
+			
+			/// The type of SIMD crossover that is used to filter the noise into frequency bands.
+			typedef SIMDCrossover<Float32,GSOUND_FREQUENCY_COUNT> CrossoverType;
+			
+			
+		//********************************************************************************
+		//******	Shared Band Noise Accessor Method
+			
+			
+			/// Return the shared band noise for the specified frequency bands and sample rate, at least the given length.
+			/**
+			  * The length is rounded up to the next power of two so that IRs of similar
+			  * length share the same noise. The noise for a shorter length is always a prefix of the
+			  * noise for a longer length, so the rounding does not change the noise samples.
+			  *
+			  * This method is thread-safe.
+			  */
+			static Shared<const BandNoise> get( const FrequencyBands& bands, SampleRate sampleRate, Size minLength );
+			
+			
+		//********************************************************************************
+		//******	Accessor Methods
+			
+			
+			/// Return the frequency bands that this noise was filtered for.
+			GSOUND_INLINE const FrequencyBands& getBands() const
+			{
+				return crossover.getBands();
+			}
+			
+			
+			/// Return the sample rate that this noise was filtered for.
+			GSOUND_INLINE SampleRate getSampleRate() const
+			{
+				return sampleRate;
+			}
+			
+			
+			/// Return the crossover for the frequency bands and sample rate of this noise.
+			GSOUND_INLINE const CrossoverType& getCrossover() const
+			{
+				return crossover;
+			}
+			
+			
+			/// Return the number of samples of band-filtered noise.
+			GSOUND_INLINE Size getLength() const
+			{
+				return noise.getSize();
+			}
+			
+			
+			/// Return a pointer to the band-filtered noise samples, with the bands for each sample interleaved.
+			GSOUND_INLINE const SIMDBands* getNoise() const
+			{
+				return noise.getPointer();
+			}
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Constructor
+			
+			
+			/// Create band noise with the specified frequency bands, sample rate, and length.
+			BandNoise( const FrequencyBands& bands, SampleRate newSampleRate, Size length );
+			
+			
+		//********************************************************************************
+		//******	Private Static Data Members
+			
+			
+			/// The minimum length in samples of the shared band noise.
+			static const Size MIN_LENGTH = 4096;
+			
+			
+			/// The seed of the noise random number generator.
+			static const UInt64 NOISE_SEED = 42;
+			
+			
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// The crossover that was used to filter the noise into frequency bands.
+			CrossoverType crossover;
+			
+			
+			/// The band-filtered noise, with the bands for each sample interleaved.
+			om::PODArray<SIMDBands,1,Size,AlignedAllocator<16> > noise;
+			
+			
+			/// The sample rate that this noise was filtered for.
+			SampleRate sampleRate;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//**************************  End GSound Internal Namespace  *******************************
+GSOUND_INTERNAL_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_GSOUND_BAND_NOISE_H
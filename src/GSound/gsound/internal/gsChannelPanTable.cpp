@@ -0,0 +1,253 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/internal/gsChannelPanTable.cpp
+ * Contents:    gsound::internal::ChannelPanTable class implementation
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "gsChannelPanTable.h"
+
+
+//##########################################################################################
+//**************************  Start GSound Internal Namespace  *****************************
+GSOUND_INTERNAL_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+typedef math::SIMDScalar<Float32,4> SIMDFloat4;
+typedef math::SIMDScalar<Int32,4> SIMDInt4;
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Constructor
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+ChannelPanTable:: ChannelPanTable()
+{
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Channel Layout Accessor Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void ChannelPanTable:: setLayout( const ChannelLayout& newLayout )
+{
+	if ( newLayout == layout && gains.getSize() > 0 )
+		return;
+	
+	layout = newLayout;
+	
+	const Size numChannels = layout.getChannelCount();
+	const Size numEntries = TABLE_SIZE + 1;
+	gains.setSize( numEntries*numChannels );
+	
+	Array<Gain> channelGains( numChannels );
+	
+	for ( Index i = 0; i < TABLE_SIZE; i++ )
+	{
+		// Find a horizontal direction on the unit diamond |x| + |z| = 1 with this entry's pseudo-angle.
+		// The pseudo-angle goes from 0 to 4 counter-clockwise from the +X axis, one unit per quadrant.
+		const Float p = Float(4*i) / Float(TABLE_SIZE);
+		Vector3f direction;
+		
+		if ( p < Float(1) )
+			direction = Vector3f( Float(1) - p, 0, -p );
+		else if ( p < Float(2) )
+			direction = Vector3f( Float(1) - p, 0, p - Float(2) );
+		else if ( p < Float(3) )
+			direction = Vector3f( p - Float(3), 0, p - Float(2) );
+		else
+			direction = Vector3f( p - Float(3), 0, Float(4) - p );
+		
+		Float* entry = gains.getPointer() + i*numChannels;
+		
+		// Directions that can't be panned are silent, like discrete paths that fail to pan.
+		if ( layout.panDirection( direction, channelGains ) )
+		{
+			for ( Index c = 0; c < numChannels; c++ )
+				entry[c] = channelGains[c];
+		}
+		else
+			om::util::zeroPOD( entry, numChannels );
+	}
+	
+	// Duplicate the first entry at the end so that interpolation wraps around.
+	om::util::copyPOD( gains.getPointer() + TABLE_SIZE*numChannels, gains.getPointer(), numChannels );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Panning Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void ChannelPanTable:: pan( const Vector3f* directions, Size numDirections, const Matrix3f& orientation,
+							SampleBuffer<Float>& output, Index outputOffset ) const
+{
+	const Size numChannels = layout.getChannelCount();
+	const Float* const table = gains.getPointer();
+	const SIMDFloat4 epsilon( math::epsilon<Real>() );
+	const SIMDFloat4 tableScale( Float(TABLE_SIZE) / Float(4) );
+	const SIMDFloat4 zero( Float(0) );
+	const SIMDFloat4 one( Float(1) );
+	const SIMDFloat4 two( Float(2) );
+	const SIMDFloat4 minDistance( math::minPositive<Float>() );
+	const SIMDInt4 maxIndex( Int32(TABLE_SIZE - 1) );
+	
+	// The listener-space X and Z components that the pan depends on are the dot products with these axes.
+	const SIMDFloat4 xAxisX( orientation.x.x ), xAxisY( orientation.x.y ), xAxisZ( orientation.x.z );
+	const SIMDFloat4 zAxisX( orientation.z.x ), zAxisY( orientation.z.y ), zAxisZ( orientation.z.z );
+	
+	OM_ALIGN(16) Float32 x[4];
+	OM_ALIGN(16) Float32 y[4];
+	OM_ALIGN(16) Float32 z[4];
+	OM_ALIGN(16) Int32 indices[4];
+	Index offsets[4];
+	
+	for ( Index i = 0; i < numDirections; i += 4 )
+	{
+		const Size numLanes = math::min( numDirections - i, Size(4) );
+		
+		// Transpose the directions into SIMD registers, padding partial groups with zero directions.
+		for ( Index j = 0; j < 4; j++ )
+		{
+			if ( j < numLanes )
+			{
+				const Vector3f& d = directions[i + j];
+				x[j] = d.x;		y[j] = d.y;		z[j] = d.z;
+			}
+			else
+				x[j] = y[j] = z[j] = Float32(0);
+		}
+		
+		const SIMDFloat4 dx = SIMDFloat4::load( x );
+		const SIMDFloat4 dy = SIMDFloat4::load( y );
+		const SIMDFloat4 dz = SIMDFloat4::load( z );
+		
+		// Directions with zero length are not panned.
+		const SIMDInt4 unpanned = (dx*dx + dy*dy + dz*dz) <= epsilon;
+		
+		// Rotate the directions into listener space. The angle is measured from the +X axis toward -Z.
+		const SIMDFloat4 u = dx*xAxisX + dy*xAxisY + dz*xAxisZ;
+		const SIMDFloat4 v = -(dx*zAxisX + dy*zAxisY + dz*zAxisZ);
+		
+		// Compute the pseudo-angle of the horizontal direction in the range [0,4).
+		const SIMDFloat4 absU = math::abs( u );
+		const SIMDFloat4 absV = math::abs( v );
+		const SIMDFloat4 inverseDistance = one / math::max( absU + absV, minDistance );
+		const SIMDInt4 uNegative = u < zero;
+		const SIMDInt4 vNegative = v < zero;
+		const SIMDFloat4 angle = math::select( uNegative == vNegative, absV*inverseDistance, one + absU*inverseDistance ) +
+									math::select( vNegative, two, zero );
+		
+		// Find the table entries and interpolation fractions for the directions.
+		const SIMDFloat4 tableIndex = angle*tableScale;
+		const SIMDInt4 index = math::min( SIMDInt4(tableIndex), maxIndex );
+		const SIMDFloat4 fraction = math::min( tableIndex - SIMDFloat4(index), one );
+		const SIMDFloat4 inverseFraction = one - fraction;
+		
+		index.store( indices );
+		
+		for ( Index j = 0; j < 4; j++ )
+			offsets[j] = indices[j]*numChannels;
+		
+		for ( Index c = 0; c < numChannels; c++ )
+		{
+			const SIMDFloat4 gain0( table[offsets[0] + c], table[offsets[1] + c],
+									table[offsets[2] + c], table[offsets[3] + c] );
+			const SIMDFloat4 gain1( table[offsets[0] + numChannels + c], table[offsets[1] + numChannels + c],
+									table[offsets[2] + numChannels + c], table[offsets[3] + numChannels + c] );
+			const SIMDFloat4 gain = math::select( unpanned, one, gain0*inverseFraction + gain1*fraction );
+			Float32* channel = output.getChannel( c, outputOffset + i );
+			
+			if ( numLanes == 4 )
+				gain.storeUnaligned( channel );
+			else
+			{
+				for ( Index j = 0; j < numLanes; j++ )
+					channel[j] = gain[j];
+			}
+		}
+	}
+}
+
+
+
+
+//##########################################################################################
+//**************************  End GSound Internal Namespace  *******************************
+GSOUND_INTERNAL_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
@@ -0,0 +1,168 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        gsound/internal/gsChannelPanTable.h
+ * Contents:    gsound::internal::ChannelPanTable class declaration
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+#ifndef INCLUDE_GSOUND_CHANNEL_PAN_TABLE_H
+#define INCLUDE_GSOUND_CHANNEL_PAN_TABLE_H
+
+
+#include "gsInternalConfig.h"
+
+
+#include "gsSampleBuffer.h"
+
+
+//##########################################################################################
+//**************************  Start GSound Internal Namespace  *****************************
+GSOUND_INTERNAL_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that provides a lookup table for fast directional panning to an arbitrary channel layout.
+/**
+  * A channel layout pans a direction using only its azimuth in the horizontal
+  * plane, so the table stores the gains for every channel at evenly-spaced
+  * values of a pseudo-angle around the listener. The pseudo-angle increases
+  * monotonically with the azimuth but can be computed from a direction without
+  * trigonometry. The gains for a direction are linearly interpolated between
+  * the two nearest table entries.
+  *
+  * The panning method processes 4 directions at a time using SIMD instructions
+  * and writes the gains for each channel contiguously, so that layouts with many
+  * channels (e.g. large speaker arrays) pan as quickly per channel as stereo.
+  */
+class ChannelPanTable
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructor
+			
+			
+			/// Create a new empty pan table that has no channels.
+			ChannelPanTable();
+			
+			
+		//********************************************************************************
+		//******	Channel Layout Accessor Methods
+			
+			
+			/// Return the channel layout that this pan table is panning to.
+			GSOUND_INLINE const ChannelLayout& getLayout() const
+			{
+				return layout;
+			}
+			
+			
+			/// Set the channel layout that this pan table is panning to.
+			/**
+			  * The table is only rebuilt if the new layout is different than the current layout.
+			  */
+			void setLayout( const ChannelLayout& newLayout );
+			
+			
+		//********************************************************************************
+		//******	Panning Method
+			
+			
+			/// Compute the channel gains for the specified world-space directions, relative to a listener orientation.
+			/**
+			  * The directions don't need to be normalized. The gains for the ith direction are
+			  * written to the output buffer at index (outputOffset + i) in each channel. A direction
+			  * with zero length has a gain of 1 in all channels. The output buffer must have at
+			  * least as many channels as the channel layout.
+			  */
+			void pan( const Vector3f* directions, Size numDirections, const Matrix3f& orientation,
+					SampleBuffer<Float>& output, Index outputOffset ) const;
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Static Data Members
+			
+			
+			/// The number of table entries around the full circle of azimuth angles.
+			static const Size TABLE_SIZE = 4096;
+			
+			
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// The channel layout that this pan table is panning to.
+			ChannelLayout layout;
+			
+			
+			/// The gains for each table entry, with the gains for all channels of an entry stored contiguously.
+			/**
+			  * There are (TABLE_SIZE + 1) entries, where the last entry is a copy of the first
+			  * so that interpolation wraps around the circle.
+			  */
+			Array<Float> gains;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//**************************  End GSound Internal Namespace  *******************************
+GSOUND_INTERNAL_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_GSOUND_CHANNEL_PAN_TABLE_H
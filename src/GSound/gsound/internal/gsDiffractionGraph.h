@@ -78,6 +78,8 @@ class DiffractionGraph
 			
 			/// Create a default empty diffraction graph with no edges or connections.
 			GSOUND_INLINE DiffractionGraph()
+				:	neighbors( NULL ),
+					numNeighbors( 0 )
 			{
 			}
 			
@@ -85,7 +87,9 @@ class DiffractionGraph
 			/// Create a default empty diffraction graph with the specified edges but no edge neighbors.
 			GSOUND_INLINE DiffractionGraph( const Shared<ArrayList<DiffractionEdge> >& newEdges )
 				:	edges( newEdges ),
-					edgeNeighbors()
+					edgeNeighbors(),
+					neighbors( NULL ),
+					numNeighbors( 0 )
 			{
 			}
 			
@@ -94,7 +98,24 @@ class DiffractionGraph
 			GSOUND_INLINE DiffractionGraph( const Shared<ArrayList<DiffractionEdge> >& newEdges,
 											const ArrayList<UInt32>& newEdgeNeighbors )
 				:	edges( newEdges ),
-					edgeNeighbors( newEdgeNeighbors )
+					edgeNeighbors( newEdgeNeighbors ),
+					neighbors( edgeNeighbors.getPointer() ),
+					numNeighbors( edgeNeighbors.getSize() )
+			{
+			}
+			
+			
+			/// Create a diffraction graph with the specified edges that uses an external packed array of edge neighbors in place.
+			/**
+			  * The neighbor array is not copied, so it must remain valid for the lifetime of the graph.
+			  * This allows the neighbors to be used directly from a memory-mapped mesh file.
+			  */
+			GSOUND_INLINE DiffractionGraph( const Shared<ArrayList<DiffractionEdge> >& newEdges,
+											const UInt32* newEdgeNeighbors, Size newNumEdgeNeighbors )
+				:	edges( newEdges ),
+					edgeNeighbors(),
+					neighbors( newEdgeNeighbors ),
+					numNeighbors( newNumEdgeNeighbors )
 			{
 			}
 			
@@ -131,9 +152,9 @@ class DiffractionGraph
 			  */
 			GSOUND_FORCE_INLINE const internal::DiffractionEdge& getEdgeNeighbor( Index edgeNeighborIndex ) const
 			{
-				GSOUND_DEBUG_ASSERT( edgeNeighborIndex < edgeNeighbors.getSize() );
+				GSOUND_DEBUG_ASSERT( edgeNeighborIndex < numNeighbors );
 				
-				UInt32 edgeIndex = edgeNeighbors[edgeNeighborIndex];
+				UInt32 edgeIndex = neighbors[edgeNeighborIndex];
 				
 				GSOUND_DEBUG_ASSERT( edgeIndex < edges->getSize() );
 				
@@ -149,16 +170,16 @@ class DiffractionGraph
 			  */
 			GSOUND_FORCE_INLINE Index getEdgeNeighborIndex( Index edgeNeighborIndex ) const
 			{
-				GSOUND_DEBUG_ASSERT( edgeNeighborIndex < edgeNeighbors.getSize() );
+				GSOUND_DEBUG_ASSERT( edgeNeighborIndex < numNeighbors );
 				
-				return edgeNeighbors[edgeNeighborIndex];
+				return neighbors[edgeNeighborIndex];
 			}
 			
 			
 			/// Get the number of visible edges in this SoundMesh.
 			GSOUND_FORCE_INLINE Size getEdgeNeighborCount() const
 			{
-				return edgeNeighbors.getSize();
+				return numNeighbors;
 			}
 			
 			
@@ -175,6 +196,18 @@ class DiffractionGraph
 			
 	private:
 		
+		//********************************************************************************
+		//******	Private Copy Operations
+			
+			
+			/// Declared private to prevent copying, since the neighbor pointer can refer to the graph's own list.
+			DiffractionGraph( const DiffractionGraph& other );
+			
+			
+			/// Declared private to prevent copying, since the neighbor pointer can refer to the graph's own list.
+			DiffractionGraph& operator = ( const DiffractionGraph& other );
+		
+		
 		//********************************************************************************
 		//******	Private Data Members
 			
@@ -187,6 +220,14 @@ class DiffractionGraph
 			ArrayList<UInt32> edgeNeighbors;
 			
 			
+			/// A pointer to the packed edge neighbor indices, either in the list above or in external memory.
+			const UInt32* neighbors;
+			
+			
+			/// The number of packed edge neighbor indices that this graph has.
+			Size numNeighbors;
+
+
 			
 };
 
@@ -68,6 +68,16 @@ class HRTFFilter:: Sample
 
 
 
+/// A mutex that serializes FFTW plan creation and destruction, which are not thread-safe.
+/**
+  * Plans are executed with the thread-safe new-array execute functions, so only
+  * the planner calls need to be protected when filters are set up on several threads.
+  */
+static Mutex fftPlanMutex;
+
+
+
+
 class HRTFFilter:: FFTData
 {
 	public:
@@ -79,6 +89,7 @@ class HRTFFilter:: FFTData
 			GSOUND_INLINE FFTData( Size newLength )
 				:	length( newLength )
 			{
+				ScopedMutex lock( fftPlanMutex );
 				fftPlan = fftwf_plan_dft_r2c_1d( (int)newLength, NULL, NULL, FFTW_ESTIMATE | FFTW_DESTROY_INPUT );
 				ifftPlan = fftwf_plan_dft_c2r_1d( (int)newLength, NULL, NULL, FFTW_ESTIMATE | FFTW_DESTROY_INPUT );
 			}
@@ -90,6 +101,8 @@ class HRTFFilter:: FFTData
 			
 			GSOUND_INLINE ~FFTData()
 			{
+				ScopedMutex lock( fftPlanMutex );
+				
 				if ( fftPlan )
 					fftwf_destroy_plan( fftPlan );
 				
@@ -133,6 +146,120 @@ class HRTFFilter:: FFTData
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Cache Header Class Declaration
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+class HRTFFilter:: CacheHeader
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructor
+			
+			
+			/// Create a new cache header for filters with the specified format.
+			GSOUND_INLINE CacheHeader( UInt64 newKey, Size newNumChannels, Size newOrder, Size newLength,
+										SampleRate newSampleRate )
+				:	version( VERSION ),
+					byteOrder( ENDIAN_CHECK ),
+					key( newKey ),
+					numChannels( (UInt32)newNumChannels ),
+					order( (UInt32)newOrder ),
+					length( (UInt32)newLength ),
+					floatSize( (UInt32)sizeof(Float) ),
+					sampleRate( newSampleRate )
+			{
+				om::util::copy( magic, MAGIC, 8 );
+			}
+		
+		
+		//********************************************************************************
+		//******	Validation Methods
+			
+			
+			/// Return whether or not this header was written by this version of the library for the given key.
+			GSOUND_INLINE Bool isValid( UInt64 cacheKey ) const
+			{
+				for ( Index i = 0; i < 8; i++ )
+				{
+					if ( magic[i] != MAGIC[i] )
+						return false;
+				}
+				
+				return version == VERSION && byteOrder == ENDIAN_CHECK && floatSize == sizeof(Float) &&
+						key == cacheKey && numChannels > 0 && length > 0;
+			}
+			
+			
+			/// Return the total number of filter values that follow this header.
+			GSOUND_INLINE Size getFilterDataSize() const
+			{
+				return Size(numChannels)*SH::getCoefficientCount(order)*(Size(length) + 2);
+			}
+		
+		
+		//********************************************************************************
+		//******	Static Data Members
+			
+			
+			/// The characters that start every HRTF filter cache file.
+			static const UByte MAGIC[8];
+			
+			
+			/// The current version of the cache file format.
+			static const UInt32 VERSION = 1;
+			
+			
+			/// A value that is used to detect files written with a different byte order.
+			static const UInt32 ENDIAN_CHECK = 0x01020304;
+		
+		
+		//********************************************************************************
+		//******	Data Members
+			
+			
+			// The header is 48 bytes so that the filter data after it stays 16-byte aligned when mapped.
+			UByte magic[8];
+			UInt32 version;
+			UInt32 byteOrder;
+			UInt64 key;
+			UInt32 numChannels;
+			UInt32 order;
+			UInt32 length;
+			UInt32 floatSize;
+			Float64 sampleRate;
+
+
+};
+
+
+const UByte HRTFFilter::CacheHeader:: MAGIC[8] = { 'G', 'S', 'H', 'R', 'T', 'F', 0, 0 };
+
+
+
+
+/// Add the bytes of the specified value to a 64-bit FNV-1a hash.
+template < typename T >
+GSOUND_FORCE_INLINE static void hashValues( UInt64& hash, const T* values, Size number )
+{
+	const UByte* bytes = (const UByte*)values;
+	const UByte* const bytesEnd = bytes + number*sizeof(T);
+	
+	for ( ; bytes != bytesEnd; bytes++ )
+		hash = (hash ^ *bytes)*UInt64(0x100000001B3ull);
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -145,7 +272,9 @@ class HRTFFilter:: FFTData
 
 
 HRTFFilter:: HRTFFilter()
-	:	channels(),
+	:	channelCount( 0 ),
+		filters( NULL ),
+		cacheFile( NULL ),
 		order( 0 ),
 		fftData( NULL ),
 		sampleRate( 0 )
@@ -168,6 +297,7 @@ HRTFFilter:: HRTFFilter()
 
 HRTFFilter:: ~HRTFFilter()
 {
+	releaseCacheFile();
 	deinitializeFFTData();
 }
 
@@ -195,9 +325,8 @@ Bool HRTFFilter:: setHRTF( const HRTF& newHRTF, SampleRate newSampleRate, Size m
 	if ( maxIRLength == 0 || numChannels == 0 || newSampleRate <= SampleRate(0) )
 		return false;
 	
-	// Make sure this HRTF has the right number of channels.
-	if ( channels.getSize() != numChannels )
-		channels.setSize( numChannels );
+	// The spherical harmonic expansion of each channel while it is being fitted.
+	om::ShortArray<Channel,2> channels( numChannels );
 	
 	// Determine the padded filter length.
 	sampleRate = newSampleRate;
@@ -407,6 +536,48 @@ Bool HRTFFilter:: setHRTF( const HRTF& newHRTF, SampleRate newSampleRate, Size m
 		lastCoefficientCount = coefficientCount;
 	}
 	
+	//*******************************************************************************
+	// Pack the fitted filters contiguously so that they can be cached in a file.
+	
+	const Size coefficientCount = SH::getCoefficientCount(order);
+	
+	releaseCacheFile();
+	filterStorage.allocate( numChannels*coefficientCount*paddedLength );
+	
+	for ( Index c = 0; c < numChannels; c++ )
+	{
+		for ( Index i = 0; i < coefficientCount; i++ )
+		{
+			om::util::copyPOD( filterStorage.getPointer() + (c*coefficientCount + i)*paddedLength,
+								channels[c].hrtf[i].getScalars(), paddedLength );
+		}
+	}
+	
+	filters = filterStorage.getPointer();
+	channelCount = numChannels;
+	
+	return true;
+}
+
+
+
+
+Bool HRTFFilter:: setHRTF( const HRTF& newHRTF, SampleRate newSampleRate, const UTF8String& cacheDirectory,
+							Size maxOrder, Float maxError, Float convergence, Size numIntegrationSamples )
+{
+	const UInt64 key = getCacheKey( newHRTF, newSampleRate, maxOrder, maxError, convergence, numIntegrationSamples );
+	const om::fs::Path cachePath( om::fs::Path( cacheDirectory ), UTF8String("hrtf_") + UTF8String( key, 16 ) + ".gshrtf" );
+	
+	// Use the cached fit if there is one.
+	if ( mapCacheFile( cachePath, key ) )
+		return true;
+	
+	if ( !setHRTF( newHRTF, newSampleRate, maxOrder, maxError, convergence, numIntegrationSamples ) )
+		return false;
+	
+	// Save the fit for the next time the HRTF is used. A failure to write the cache is not an error.
+	writeCacheFile( cachePath, key );
+	
 	return true;
 }
 
@@ -447,12 +618,7 @@ Bool HRTFFilter:: getFilter( Index channelIndex, const SHExpansion<Float>& basis
 	
 	const Float* coefficients = basis.getCoefficients();
 	
-	if ( coefficients == NULL || channelIndex >= channels.getSize() )
-		return false;
-	
-	const Filter* filters = channels[channelIndex].hrtf.getPointer();
-	
-	if ( filters == NULL )
+	if ( coefficients == NULL || channelIndex >= channelCount || filters == NULL )
 		return false;
 	
 	// Determine how many filter coefficients to use.
@@ -460,13 +626,14 @@ Bool HRTFFilter:: getFilter( Index channelIndex, const SHExpansion<Float>& basis
 	const Size coefficientCount = SH::getCoefficientCount( minOrder );
 	
 	const Size filterSize = length + 2;
+	const Float* channelFilters = filters + channelIndex*SH::getCoefficientCount( order )*filterSize;
 	Float* filter = (Float*)complexFilter;
 	
 	// Compute the dot product of the basis with the HRTF filter for the channel.
-	math::multiply( filter, filters[0].getScalars(), coefficients[0], filterSize );
+	math::multiply( filter, channelFilters, coefficients[0], filterSize );
 	
 	for ( Index i = 1; i < coefficientCount; i++ )
-		math::multiplyAdd( filter, filters[i].getScalars(), coefficients[i], filterSize );
+		math::multiplyAdd( filter, channelFilters + i*filterSize, coefficients[i], filterSize );
 	
 	return true;
 }
@@ -568,6 +735,143 @@ Bool HRTFFilter:: interpolateSample( const Vector3f& direction, const Sample* sa
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Cache File Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+UInt64 HRTFFilter:: getCacheKey( const HRTF& newHRTF, SampleRate newSampleRate, Size maxOrder, Float maxError,
+								Float convergence, Size numIntegrationSamples )
+{
+	UInt64 hash = UInt64(0xCBF29CE484222325ull);
+	
+	// Hash the fitting parameters.
+	const UInt32 version = CacheHeader::VERSION;
+	const Float64 sampleRate64 = newSampleRate;
+	const UInt64 parameters[2] = { maxOrder, numIntegrationSamples };
+	const Float thresholds[2] = { maxError, convergence };
+	hashValues( hash, &version, 1 );
+	hashValues( hash, &sampleRate64, 1 );
+	hashValues( hash, parameters, 2 );
+	hashValues( hash, thresholds, 2 );
+	
+	// Hash the HRTF format.
+	const Size filterLength = newHRTF.getFilterLength();
+	const Size numChannels = newHRTF.getChannelCount();
+	const Float64 hrtfSampleRate = newHRTF.getSampleRate();
+	const UInt64 format[2] = { filterLength, numChannels };
+	hashValues( hash, format, 2 );
+	hashValues( hash, &hrtfSampleRate, 1 );
+	hashValues( hash, &newHRTF.getOrientation(), 1 );
+	
+	// Hash the HRTF samples.
+	for ( Index c = 0; c < numChannels; c++ )
+	{
+		const UInt64 numSamples = newHRTF.getSampleCount(c);
+		hashValues( hash, &numSamples, 1 );
+		
+		for ( Index i = 0; i < numSamples; i++ )
+		{
+			hashValues( hash, &newHRTF.getSampleDirection(c, i), 1 );
+			hashValues( hash, newHRTF.getSampleData(c, i), filterLength );
+		}
+	}
+	
+	return hash;
+}
+
+
+
+
+Bool HRTFFilter:: mapCacheFile( const om::fs::Path& path, UInt64 key )
+{
+	om::fs::File* file = util::construct<om::fs::File>( path );
+	const om::LargeSize fileSize = file->exists() ? file->getSize() : 0;
+	const UByte* data = fileSize >= sizeof(CacheHeader) ? (const UByte*)file->map( om::fs::File::READ ) : NULL;
+	const CacheHeader* header = (const CacheHeader*)data;
+	
+	// Make sure that the file matches the key and contains all of the filter data.
+	if ( header == NULL || !header->isValid( key ) ||
+		fileSize != sizeof(CacheHeader) + header->getFilterDataSize()*sizeof(Float) )
+	{
+		util::destruct( file );
+		return false;
+	}
+	
+	releaseCacheFile();
+	filterStorage.deallocate();
+	cacheFile = file;
+	
+	channelCount = header->numChannels;
+	order = header->order;
+	length = header->length;
+	sampleRate = header->sampleRate;
+	filters = (const Float*)(data + sizeof(CacheHeader));
+	
+	// Initialize the FFT data if it has not yet been initialized.
+	if ( fftData == NULL || fftData->length != length )
+		initializeFFTData( length );
+	
+	return true;
+}
+
+
+
+
+Bool HRTFFilter:: writeCacheFile( const om::fs::Path& path, UInt64 key ) const
+{
+	if ( filters == NULL )
+		return false;
+	
+	const CacheHeader header( key, channelCount, order, length, sampleRate );
+	const Size dataSize = header.getFilterDataSize()*sizeof(Float);
+	
+	// Write to a uniquely-named temporary file, then rename it so that no other process maps a partial file.
+	const UTF8String tempName = path.getName() + "." +
+								UTF8String( (UInt64)om::time::Time::getCurrent().getNanoseconds(), 16 ) + ".tmp";
+	const om::fs::Path tempPath( path.getParent(), tempName );
+	om::io::FileWriter writer( tempPath );
+	
+	if ( !writer.open() )
+		return false;
+	
+	const Bool written = writer.writeData( (const UByte*)&header, sizeof(CacheHeader) ) == sizeof(CacheHeader) &&
+						writer.writeData( (const UByte*)filters, dataSize ) == dataSize;
+	writer.close();
+	
+	om::fs::File tempFile( tempPath );
+	
+	if ( !written || !tempFile.setName( path.getName() ) )
+	{
+		tempFile.remove();
+		return false;
+	}
+	
+	return true;
+}
+
+
+
+
+void HRTFFilter:: releaseCacheFile()
+{
+	if ( cacheFile )
+	{
+		util::destruct( cacheFile );
+		cacheFile = NULL;
+		filters = NULL;
+	}
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -99,7 +99,7 @@ class HRTFFilter
 			/// Return the number of channels there are in this HRTF.
 			GSOUND_INLINE Size getChannelCount() const
 			{
-				return channels.getSize();
+				return channelCount;
 			}
 			
 			
@@ -117,6 +117,29 @@ class HRTFFilter
 							Float convergence = Float(0.00), Size numIntegrationSamples = Size(2000) );
 			
 			
+			/// Reset the HRTF filter to correspond to the specified HRTF, reusing a fit stored in a cache directory.
+			/**
+			  * The cache file for the HRTF is named by a hash of the HRTF's contents and
+			  * the fitting parameters. If a valid cache file exists, it is memory-mapped and
+			  * the spherical harmonic filters are used directly from the mapping, so that
+			  * processes that use the same HRTF share one copy of the data. Otherwise, the HRTF
+			  * is fitted as in setHRTF() and the result is written to the cache directory.
+			  *
+			  * The method returns whether or not the HRTF filter was successfully set, even
+			  * if the cache file could not be written.
+			  */
+			Bool setHRTF( const HRTF& newHRTF, SampleRate sampleRate, const UTF8String& cacheDirectory,
+							Size maxOrder = Size(9), Float maxError = Float(0.05),
+							Float convergence = Float(0.00), Size numIntegrationSamples = Size(2000) );
+			
+			
+			/// Return whether or not the filters for this HRTF are memory-mapped from a cache file.
+			GSOUND_INLINE Bool isMapped() const
+			{
+				return cacheFile != NULL;
+			}
+		
+		
 		//********************************************************************************
 		//******	Filter Accessor Methods
 			
@@ -166,6 +189,18 @@ class HRTFFilter
 			
 	private:
 		
+		//********************************************************************************
+		//******	Private Copy Operations
+			
+			
+			/// Declared private to prevent copying, since the filters and FFT data are owned through raw pointers.
+			HRTFFilter( const HRTFFilter& other );
+			
+			
+			/// Declared private to prevent copying, since the filters and FFT data are owned through raw pointers.
+			HRTFFilter& operator = ( const HRTFFilter& other );
+		
+		
 		//********************************************************************************
 		//******	Private Class Declaration
 			
@@ -178,6 +213,10 @@ class HRTFFilter
 			class FFTData;
 			
 			
+			/// The header at the start of an HRTF filter cache file.
+			class CacheHeader;
+			
+			
 			/// A class that stores a single HRTF sample for a 3D normalized direction.
 			class Sample;
 			
@@ -224,12 +263,46 @@ class HRTFFilter
 			void  deinitializeFFTData();
 			
 			
+			/// Return a hash of the HRTF contents and fitting parameters that identifies a cache file.
+			static UInt64 getCacheKey( const HRTF& newHRTF, SampleRate sampleRate, Size maxOrder, Float maxError,
+										Float convergence, Size numIntegrationSamples );
+			
+			
+			/// Memory-map the filters from the specified cache file if it is valid for the given key.
+			Bool mapCacheFile( const om::fs::Path& path, UInt64 key );
+			
+			
+			/// Write the current filters to the specified cache file.
+			Bool writeCacheFile( const om::fs::Path& path, UInt64 key ) const;
+			
+			
+			/// Unmap the cache file that the filters are mapped from, if there is one.
+			void releaseCacheFile();
+		
+		
 		//********************************************************************************
 		//******	Private Data Members
 			
 			
-			/// An array of the channels in this HRTF.
-			om::ShortArray<Channel,2> channels;
+			/// The number of channels in this HRTF.
+			Size channelCount;
+			
+			
+			/// A pointer to the frequency-domain spherical harmonic filters for all channels.
+			/**
+			  * The filters are stored contiguously, ordered by channel, then by spherical
+			  * harmonic coefficient. Each filter has (N + 2) values. The pointer refers either
+			  * to the filter storage or to a memory-mapped cache file.
+			  */
+			const Float* filters;
+			
+			
+			/// The storage for the filters when they are fitted by this object rather than mapped.
+			om::PODArray<Float,1,Size,AlignedAllocator<16> > filterStorage;
+			
+			
+			/// The cache file that the filters are mapped from, or NULL if the filters are not mapped.
+			om::fs::File* cacheFile;
 			
 			
 			/// The order of the spherical harmonic expansion of this HRTF.
@@ -219,6 +219,8 @@ void PropagationData:: removeOldData()
 void PropagationData:: reset()
 {
 	listeners.clear();
+	timeStamp = 0;
+	time = 0;
 }
 
 
@@ -136,7 +136,7 @@ class PropagationData
 			void removeOldData();
 			
 			
-			/// Remove all cached data from this propagation data object.
+			/// Remove all cached data from this propagation data object and restart the frame timestamp.
 			void reset();
 			
 			
@@ -183,7 +183,7 @@ class GSOUND_ALIGN(16) SIMDCrossover
 			
 			/// Apply this crossover filter to the specified input buffer, writing the band-separated SIMD output.
 			GSOUND_FORCE_INLINE void filterScalar( History& history, const T* input,
-												T* simdOutput, Size numSamples )
+												T* simdOutput, Size numSamples ) const
 			{
 				if ( !filters )
 					return;
@@ -236,7 +236,7 @@ class GSOUND_ALIGN(16) SIMDCrossover
 			
 			
 			/// Apply this crossover filter to the specified SIMD input buffer, writing the filtered output.
-			GSOUND_FORCE_INLINE void filterSIMD( History& history, const T* simdInput, T* simdOutput, Size numSamples )
+			GSOUND_FORCE_INLINE void filterSIMD( History& history, const T* simdInput, T* simdOutput, Size numSamples ) const
 			{
 				if ( !filters )
 					return;
@@ -275,7 +275,7 @@ class GSOUND_ALIGN(16) SIMDCrossover
 			
 			
 			/// Apply this crossover filter to the specified SIMD input buffer, writing the filtered output.
-			GSOUND_FORCE_INLINE void filterSIMDLowPass( History& history, const T* simdInput, T* simdOutput, Size numSamples )
+			GSOUND_FORCE_INLINE void filterSIMDLowPass( History& history, const T* simdInput, T* simdOutput, Size numSamples ) const
 			{
 				if ( !filters )
 					return;
@@ -314,7 +314,7 @@ class GSOUND_ALIGN(16) SIMDCrossover
 			
 			
 			/// Apply this crossover filter to the specified SIMD input buffer, writing the filtered output.
-			GSOUND_FORCE_INLINE void filterSIMDLowPassSingle( History& history, const SIMDType& simdInput, SIMDType& simdOutput )
+			GSOUND_FORCE_INLINE void filterSIMDLowPassSingle( History& history, const SIMDType& simdInput, SIMDType& simdOutput ) const
 			{
 				simdOutput = simdInput;
 				
@@ -30,7 +30,7 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "omAABBTree4.h"
+#include "omAABBTree.h"
 
 
 //##########################################################################################
@@ -51,7 +51,8 @@ OM_BVH_NAMESPACE_START
 
 
 
-class OM_ALIGN(16) AABBTree4:: TraversalRay
+template < Size width >
+class OM_ALIGN(16) AABBTree<width>:: TraversalRay
 {
 	public:
 		
@@ -59,17 +60,23 @@ class OM_ALIGN(16) AABBTree4:: TraversalRay
 		//******	Constructors
 			
 			
+			/// Create a traversal ray with uninitialized sign offsets, to be assigned later.
+			OM_INLINE TraversalRay()
+			{
+			}
+			
+			
 			OM_INLINE TraversalRay( const BVHRay& ray )
 				:	origin( ray.origin ),
 					direction( ray.direction ),
 					inverseDirection( math::reciprocal( ray.direction ) )
 			{
-				signMin[0] = sizeof(SIMDFloat4)*(ray.direction[0] < Float32(0) ? 1 : 0);
-				signMin[1] = sizeof(SIMDFloat4)*(ray.direction[1] < Float32(0) ? 3 : 2);
-				signMin[2] = sizeof(SIMDFloat4)*(ray.direction[2] < Float32(0) ? 5 : 4);
-				signMax[0] = sizeof(SIMDFloat4) ^ signMin[0];
-				signMax[1] = sizeof(SIMDFloat4) ^ signMin[1];
-				signMax[2] = sizeof(SIMDFloat4) ^ signMin[2];
+				signMin[0] = sizeof(SIMDFloatN)*(ray.direction[0] < Float32(0) ? 1 : 0);
+				signMin[1] = sizeof(SIMDFloatN)*(ray.direction[1] < Float32(0) ? 3 : 2);
+				signMin[2] = sizeof(SIMDFloatN)*(ray.direction[2] < Float32(0) ? 5 : 4);
+				signMax[0] = sizeof(SIMDFloatN) ^ signMin[0];
+				signMax[1] = sizeof(SIMDFloatN) ^ signMin[1];
+				signMax[2] = sizeof(SIMDFloatN) ^ signMin[2];
 			}
 			
 			
@@ -77,15 +84,15 @@ class OM_ALIGN(16) AABBTree4:: TraversalRay
 		//******	Public Data Members
 			
 			
-			SIMDVector3f origin;
+			SIMDVector3fN origin;
 			
 			
 			/// The direction vector of this SIMD Ray.
-			SIMDVector3f direction;
+			SIMDVector3fN direction;
 			
 			
 			/// The inverse of the direction vector of this SIMD Ray.
-			SIMDVector3f inverseDirection;
+			SIMDVector3fN inverseDirection;
 			
 			
 			/// Byte offsets into the bounding box node's bounding box array for each axis, as determined by the ray direction signs.
@@ -109,7 +116,8 @@ class OM_ALIGN(16) AABBTree4:: TraversalRay
 
 
 
-class OM_ALIGN(128) AABBTree4:: Node
+template < Size width >
+class OM_ALIGN(128) AABBTree<width>:: Node
 {
 	public:
 		
@@ -133,7 +141,7 @@ class OM_ALIGN(128) AABBTree4:: Node
 				bounds[4] = other.bounds[4];
 				bounds[5] = other.bounds[5];
 				
-				for ( Index i = 0; i < 4; i++ )
+				for ( Index i = 0; i < width; i++ )
 				{
 					if ( isLeaf( other.child[i] ) )
 						child[i] = other.child[i];
@@ -156,7 +164,7 @@ class OM_ALIGN(128) AABBTree4:: Node
 				bounds[4] = other.bounds[4];
 				bounds[5] = other.bounds[5];
 				
-				for ( Index i = 0; i < 4; i++ )
+				for ( Index i = 0; i < width; i++ )
 				{
 					if ( isLeaf( other.child[i] ) )
 						child[i] = other.child[i];
@@ -278,13 +286,18 @@ class OM_ALIGN(128) AABBTree4:: Node
 			}
 			
 			
-			/// Compute and return the bounding box of this node's children.
+			/// Compute and return the bounding box of this node's non-empty children.
 			OM_FORCE_INLINE AABB3f getAABB() const
 			{
-				AABB3f result( bounds[0][0], bounds[1][0], bounds[2][0], bounds[3][0], bounds[4][0], bounds[5][0] );
+				AABB3f result( math::max<Float>(), -math::max<Float>() );
 				
-				for ( Index i = 1; i < 4; i++ )
+				for ( Index i = 0; i < width; i++ )
+				{
+					if ( isLeaf( child[i] ) && getLeafCount( child[i] ) == 0 )
+						continue;
+					
 					result |= AABB3f( bounds[0][i], bounds[1][i], bounds[2][i], bounds[3][i], bounds[4][i], bounds[5][i] );
+				}
 				
 				return result;
 			}
@@ -294,17 +307,17 @@ class OM_ALIGN(128) AABBTree4:: Node
 		//******	Ray Intersection Methods
 			
 			
-			OM_FORCE_INLINE SIMDInt4 intersectRay( const TraversalRay& ray, const SIMDFloat4& tMin, const SIMDFloat4& tMax, SIMDFloat4& near ) const
+			OM_FORCE_INLINE SIMDIntN intersectRay( const TraversalRay& ray, const SIMDFloatN& tMin, const SIMDFloatN& tMax, SIMDFloatN& near ) const
 			{
-				SIMDFloat4 txmin = (SIMDFloat4::load((const Float32*)((const UByte*)bounds + ray.signMin[0])) - ray.origin.x) * ray.inverseDirection.x;
-				SIMDFloat4 txmax = (SIMDFloat4::load((const Float32*)((const UByte*)bounds + ray.signMax[0])) - ray.origin.x) * ray.inverseDirection.x;
-				SIMDFloat4 tymin = (SIMDFloat4::load((const Float32*)((const UByte*)bounds + ray.signMin[1])) - ray.origin.y) * ray.inverseDirection.y;
-				SIMDFloat4 tymax = (SIMDFloat4::load((const Float32*)((const UByte*)bounds + ray.signMax[1])) - ray.origin.y) * ray.inverseDirection.y;
-				SIMDFloat4 tzmin = (SIMDFloat4::load((const Float32*)((const UByte*)bounds + ray.signMin[2])) - ray.origin.z) * ray.inverseDirection.z;
-				SIMDFloat4 tzmax = (SIMDFloat4::load((const Float32*)((const UByte*)bounds + ray.signMax[2])) - ray.origin.z) * ray.inverseDirection.z;
+				SIMDFloatN txmin = (SIMDFloatN::load((const Float32*)((const UByte*)bounds + ray.signMin[0])) - ray.origin.x) * ray.inverseDirection.x;
+				SIMDFloatN txmax = (SIMDFloatN::load((const Float32*)((const UByte*)bounds + ray.signMax[0])) - ray.origin.x) * ray.inverseDirection.x;
+				SIMDFloatN tymin = (SIMDFloatN::load((const Float32*)((const UByte*)bounds + ray.signMin[1])) - ray.origin.y) * ray.inverseDirection.y;
+				SIMDFloatN tymax = (SIMDFloatN::load((const Float32*)((const UByte*)bounds + ray.signMax[1])) - ray.origin.y) * ray.inverseDirection.y;
+				SIMDFloatN tzmin = (SIMDFloatN::load((const Float32*)((const UByte*)bounds + ray.signMin[2])) - ray.origin.z) * ray.inverseDirection.z;
+				SIMDFloatN tzmax = (SIMDFloatN::load((const Float32*)((const UByte*)bounds + ray.signMax[2])) - ray.origin.z) * ray.inverseDirection.z;
 				
 				near = math::max( math::max( txmin, tymin ), math::max( tzmin, tMin ) );
-				SIMDFloat4 far = math::min( math::min( math::min( txmax, tymax ), tzmax ), tMax );
+				SIMDFloatN far = math::min( math::min( math::min( txmax, tymax ), tzmax ), tMax );
 				
 				return near <= far;
 			}
@@ -326,7 +339,7 @@ class OM_ALIGN(128) AABBTree4:: Node
 		//******	Public Data Members
 			
 			
-			/// A set of 4 SIMD axis-aligned bounding boxes for this quad node.
+			/// A set of N SIMD axis-aligned bounding boxes for this N-ary node.
 			/**
 			  * The bounding boxes are stored in the following format:
 			  *	- 0: xMin
@@ -336,11 +349,11 @@ class OM_ALIGN(128) AABBTree4:: Node
 			  * - 4: zMin
 			  * - 5: zMax
 			  */
-			SIMDFloat4 bounds[6];
+			SIMDFloatN bounds[6];
 			
 			
 			/// A array of unions for each 64-bit child node pointer/leaf node.
-			Child child[4];
+			Child child[width];
 			
 			
 };
@@ -359,7 +372,8 @@ class OM_ALIGN(128) AABBTree4:: Node
 
 
 
-class OM_ALIGN(16) AABBTree4:: PrimitiveAABB
+template < Size width >
+class OM_ALIGN(16) AABBTree<width>:: PrimitiveAABB
 {
 	public:
 		
@@ -398,7 +412,8 @@ class OM_ALIGN(16) AABBTree4:: PrimitiveAABB
 
 
 
-class OM_ALIGN(16) AABBTree4:: SplitBin
+template < Size width >
+class OM_ALIGN(16) AABBTree<width>:: SplitBin
 {
 	public:
 		
@@ -426,7 +441,7 @@ class OM_ALIGN(16) AABBTree4:: SplitBin
 //##########################################################################################
 //##########################################################################################
 //############		
-//############		Cached Triangle Class Declaration
+//############		Parallel Build Class Declarations
 //############		
 //##########################################################################################
 //##########################################################################################
@@ -434,36 +449,190 @@ class OM_ALIGN(16) AABBTree4:: SplitBin
 
 
 
-class OM_ALIGN(16) AABBTree4:: CachedTriangle
+template < Size width >
+class AABBTree<width>:: Subtree
+{
+	public:
+		
+		OM_INLINE Subtree( Node* newNode, PrimitiveIndex newStart, PrimitiveCount newNumPrimitives, Size newDepth )
+			:	node( newNode ),
+				start( newStart ),
+				numPrimitives( newNumPrimitives ),
+				depth( newDepth ),
+				maxDepth( 0 )
+		{
+		}
+		
+		/// The node where the root of this subtree is to be built.
+		Node* node;
+		
+		/// The index of the first primitive in this subtree.
+		PrimitiveIndex start;
+		
+		/// The number of primitives in this subtree.
+		PrimitiveCount numPrimitives;
+		
+		/// The depth of the root of this subtree.
+		Size depth;
+		
+		/// The maximum depth of this subtree after it has been built.
+		Size maxDepth;
+		
+};
+
+
+
+
+template < Size width >
+class AABBTree<width>:: ParallelBuild
 {
 	public:
 		
-		OM_INLINE CachedTriangle( const SIMDVector3f& newV0,
-									const SIMDVector3f& newE1,
-									const SIMDVector3f& newE2,
-									const StaticArray<IndexType,4>& newIndices  )
-			:	v0( newV0 ),
-				e1( newE1 ),
-				e2( newE2 )
+		OM_INLINE ParallelBuild( ThreadPool* newThreadPool, PrimitiveCount newMaxSubtreeSize )
+			:	threadPool( newThreadPool ),
+				maxSubtreeSize( newMaxSubtreeSize )
 		{
-			indices[0] = newIndices[0];
-			indices[1] = newIndices[1];
-			indices[2] = newIndices[2];
-			indices[3] = newIndices[3];
 		}
 		
+		/// The thread pool that is used to execute the parallel jobs.
+		ThreadPool* threadPool;
+		
+		/// The maximum number of primitives in a subtree that is deferred to a parallel job.
+		PrimitiveCount maxSubtreeSize;
+		
+		/// The subtrees that were deferred during the serial build of the top of the tree, in depth-first order.
+		ArrayList<Subtree> subtrees;
+		
+};
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Cached Triangle Class Declaration
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+template < Size width >
+class OM_ALIGN(16) AABBTree<width>:: CachedTriangle
+{
+	public:
+		
 		/// The vertex of this triangle with index 0.
-		SIMDVector3f v0;
+		SIMDVector3fN v0;
 		
 		/// The edge vector between vertex 0 and vertex 1.
-		SIMDVector3f e1;
+		SIMDVector3fN e1;
 		
 		/// The edge vector between vertex 0 and vertex 2.
-		SIMDVector3f e2;
+		SIMDVector3fN e2;
+		
+		/// The indices of the N packed triangles.
+		PrimitiveIndex indices[width];
+		
+};
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Image Header Class Definition
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+template < Size width >
+class AABBTree<width>:: ImageHeader
+{
+	public:
+		
+		/// Create an image header that describes the specified built tree.
+		OM_INLINE ImageHeader( const AABBTree& tree )
+			:	version( VERSION ),
+				pointerSize( sizeof(Node*) ),
+				nodeSize( sizeof(Node) ),
+				primitiveSize( sizeof(CachedTriangle) ),
+				primitiveType( tree.cachedPrimitiveType ),
+				reserved( 0 ),
+				numNodes( tree.numNodes ),
+				numPrimitives( tree.numPrimitives ),
+				primitiveDataSize( tree.getCachedPrimitiveCount()*sizeof(CachedTriangle) ),
+				maxDepth( tree.maxDepth ),
+				maxNumPrimitivesPerLeaf( tree.maxNumPrimitivesPerLeaf )
+		{
+		}
+		
+		/// Return the offset in bytes of the first node from the start of the image.
+		OM_FORCE_INLINE static Size getNodesOffset()
+		{
+			return math::nextMultiple( Size(sizeof(ImageHeader)), IMAGE_ALIGNMENT );
+		}
+		
+		/// Return the offset in bytes of the primitive indices from the start of the image.
+		OM_FORCE_INLINE Size getIndicesOffset() const
+		{
+			return math::nextMultiple( getNodesOffset() + Size(numNodes)*sizeof(Node), IMAGE_ALIGNMENT );
+		}
+		
+		/// Return the offset in bytes of the cached primitives from the start of the image.
+		OM_FORCE_INLINE Size getPrimitivesOffset() const
+		{
+			return math::nextMultiple( getIndicesOffset() + Size(numPrimitives)*sizeof(PrimitiveIndex), IMAGE_ALIGNMENT );
+		}
+		
+		/// Return the total size in bytes of the image.
+		OM_FORCE_INLINE Size getImageSize() const
+		{
+			return getPrimitivesOffset() + Size(primitiveDataSize);
+		}
+		
+		/// The version of the image layout. This must change whenever the node or primitive layout changes.
+		static const UInt32 VERSION = 1;
+		
+		/// The version of the image layout that this image was written with.
+		UInt32 version;
+		
+		/// The size in bytes of a pointer on the system that wrote the image.
+		UInt32 pointerSize;
+		
+		/// The size in bytes of a node of the tree that wrote the image.
+		UInt32 nodeSize;
+		
+		/// The size in bytes of a cached primitive of the tree that wrote the image.
+		UInt32 primitiveSize;
+		
+		/// The type of the image's cached primitives, or BVHGeometry::UNDEFINED if they are not cached.
+		UInt32 primitiveType;
+		
+		/// Padding so that the following members are 8-byte aligned.
+		UInt32 reserved;
 		
-		/// The indices of the 4 packed triangles.
-		PrimitiveIndex indices[4];
+		/// The number of nodes in the image.
+		UInt64 numNodes;
 		
+		/// The number of primitive indices in the image.
+		UInt64 numPrimitives;
+		
+		/// The size in bytes of the image's cached primitives.
+		UInt64 primitiveDataSize;
+		
+		/// The maximum depth of the tree's hierarchy.
+		UInt64 maxDepth;
+		
+		/// The maximum number of primitives per leaf that the tree was built with.
+		UInt64 maxNumPrimitivesPerLeaf;
+
 };
 
 
@@ -480,7 +649,8 @@ class OM_ALIGN(16) AABBTree4:: CachedTriangle
 
 
 
-AABBTree4:: AABBTree4()
+template < Size width >
+AABBTree<width>:: AABBTree()
 	:	nodes( NULL ),
 		numNodes( 0 ),
 		numPrimitives( 0 ),
@@ -488,6 +658,7 @@ AABBTree4:: AABBTree4()
 		primitiveIndexCapacity( 0 ),
 		primitiveData( NULL ),
 		primitiveDataCapacity( 0 ),
+		image( NULL ),
 		geometry(),
 		cachedPrimitiveType( BVHGeometry::UNDEFINED ),
 		maxDepth( 0 ),
@@ -499,7 +670,8 @@ AABBTree4:: AABBTree4()
 
 
 
-AABBTree4:: AABBTree4( const AABBTree4& other )
+template < Size width >
+AABBTree<width>:: AABBTree( const AABBTree& other )
 	:	nodes( NULL ),
 		numNodes( other.numNodes ),
 		numPrimitives( other.numPrimitives ),
@@ -507,6 +679,7 @@ AABBTree4:: AABBTree4( const AABBTree4& other )
 		primitiveIndexCapacity( 0 ),
 		primitiveData( NULL ),
 		primitiveDataCapacity( 0 ),
+		image( NULL ),
 		geometry( other.geometry ),
 		cachedPrimitiveType( other.cachedPrimitiveType ),
 		maxDepth( other.maxDepth ),
@@ -538,8 +711,11 @@ AABBTree4:: AABBTree4( const AABBTree4& other )
 
 
 
-AABBTree4:: ~AABBTree4()
+template < Size width >
+AABBTree<width>:: ~AABBTree()
 {
+	releaseImage();
+	
 	if ( nodes )
 		util::deallocateAligned( nodes );
 	
@@ -564,10 +740,13 @@ AABBTree4:: ~AABBTree4()
 
 
 
-AABBTree4& AABBTree4:: operator = ( const AABBTree4& other )
+template < Size width >
+AABBTree<width>& AABBTree<width>:: operator = ( const AABBTree& other )
 {
 	if ( this != &other )
 	{
+		releaseImage();
+		
 		if ( numNodes < other.numNodes )
 		{
 			if ( nodes )
@@ -622,7 +801,8 @@ AABBTree4& AABBTree4:: operator = ( const AABBTree4& other )
 
 
 
-BVHGeometry* AABBTree4:: getGeometry() const
+template < Size width >
+BVHGeometry* AABBTree<width>:: getGeometry() const
 {
 	return geometry;
 }
@@ -630,7 +810,8 @@ BVHGeometry* AABBTree4:: getGeometry() const
 
 
 
-Bool AABBTree4:: setGeometry( BVHGeometry* newGeometry )
+template < Size width >
+Bool AABBTree<width>:: setGeometry( BVHGeometry* newGeometry )
 {
 	geometry = newGeometry;
 	
@@ -655,7 +836,27 @@ Bool AABBTree4:: setGeometry( BVHGeometry* newGeometry )
 
 
 
-void AABBTree4:: rebuild()
+template < Size width >
+void AABBTree<width>:: rebuild()
+{
+	rebuildTree( NULL );
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: rebuild( ThreadPool& threadPool )
+{
+	// A pool without worker threads gains nothing over a serial build.
+	rebuildTree( threadPool.getThreadCount() > 1 ? &threadPool : NULL );
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: rebuildTree( ThreadPool* threadPool )
 {
 	maxDepth = 0;
 	
@@ -672,6 +873,9 @@ void AABBTree4:: rebuild()
 	if ( newNumPrimitives == 0 )
 		return;
 	
+	// The tree's primitives are rebuilt in owned arrays rather than the read-only memory of an image.
+	releaseImage();
+	
 	//**************************************************************************************
 	
 	// Make sure the array of client primitive indices is big enough.
@@ -692,8 +896,22 @@ void AABBTree4:: rebuild()
 	PrimitiveAABB* primitiveAABBs = util::allocateAligned<PrimitiveAABB>( newNumPrimitives, 16 );
 	
 	// Initialize all PrimitiveAABB objects with the primitives for this tree.
-	for ( PrimitiveIndex i = 0; i < newNumPrimitives; i++ )
-		new (primitiveAABBs + i) PrimitiveAABB( geometry->getPrimitiveAABB(i) );
+	if ( threadPool != NULL )
+	{
+		const PrimitiveCount numJobs = (PrimitiveCount)threadPool->getThreadCount();
+		const PrimitiveCount jobSize = (newNumPrimitives + numJobs - 1) / numJobs;
+		
+		for ( PrimitiveIndex i = 0; i < newNumPrimitives; i += jobSize )
+		{
+			threadPool->addJob( FunctionCall<void ( const BVHGeometry*, PrimitiveAABB*, PrimitiveIndex, PrimitiveCount )>(
+								bind( computePrimitiveAABBs ), geometry, primitiveAABBs, i,
+								math::min( jobSize, newNumPrimitives - i ) ) );
+		}
+		
+		threadPool->finishJobs();
+	}
+	else
+		computePrimitiveAABBs( geometry, primitiveAABBs, 0, newNumPrimitives );
 	
 	//**************************************************************************************
 	
@@ -705,7 +923,7 @@ void AABBTree4:: rebuild()
 	//**************************************************************************************
 	
 	// Compute the maximum number of nodes needed for this tree (2*n - 1).
-	const Size newNumNodes = math::max( Size(2)*newNumPrimitives - 1, Size(5) );
+	const Size newNumNodes = math::max( Size(2)*newNumPrimitives - 1, width + 1 );
 	
 	// Allocate space for the nodes in this tree.
 	if ( newNumNodes > numNodes )
@@ -717,9 +935,47 @@ void AABBTree4:: rebuild()
 		numNodes = newNumNodes;
 	}
 	
-	// Build the tree, starting with the root node, returning the actual number of nodes needed.
-	const Size finalNumNodes = buildTreeRecursive( nodes, primitiveAABBs, primitiveIndices, 0, newNumPrimitives,
-													splitBins, numSplitBins, maxNumPrimitivesPerLeaf, 2, maxDepth );
+	Size finalNumNodes;
+	
+	if ( threadPool != NULL )
+	{
+		// Defer subtrees to parallel jobs once they are small enough to give each thread several jobs.
+		const Size numThreads = threadPool->getThreadCount();
+		ParallelBuild parallelBuild( threadPool, math::max( PrimitiveCount(newNumPrimitives / (numThreads*8)),
+															MIN_PARALLEL_SUBTREE_SIZE ) );
+		
+		// Build the top of the tree in a temporary node array that reserves space for the deferred subtrees.
+		Node* sparseNodes = util::allocateAligned<Node>( newNumNodes, sizeof(Node) );
+		
+		buildTreeRecursive( sparseNodes, primitiveAABBs, primitiveIndices, 0, newNumPrimitives,
+							splitBins, numSplitBins, maxNumPrimitivesPerLeaf, 2, maxDepth, &parallelBuild );
+		
+		// Build the deferred subtrees in parallel. Each one covers a disjoint range of primitives and nodes.
+		const Size numSubtrees = parallelBuild.subtrees.getSize();
+		
+		for ( Index i = 0; i < numSubtrees; i++ )
+		{
+			threadPool->addJob( FunctionCall<void ( Subtree*, const PrimitiveAABB*, PrimitiveIndex*, Size, Size )>(
+								bind( buildSubtree ), &parallelBuild.subtrees[i], primitiveAABBs, primitiveIndices,
+								numSplitBins, Size(maxNumPrimitivesPerLeaf) ) );
+		}
+		
+		threadPool->finishJobs();
+		
+		for ( Index i = 0; i < numSubtrees; i++ )
+			maxDepth = math::max( maxDepth, parallelBuild.subtrees[i].maxDepth );
+		
+		// Pack the nodes in the same depth-first order that a serial build produces.
+		finalNumNodes = packTree( *sparseNodes, nodes );
+		
+		util::deallocateAligned( sparseNodes );
+	}
+	else
+	{
+		// Build the tree, starting with the root node, returning the actual number of nodes needed.
+		finalNumNodes = buildTreeRecursive( nodes, primitiveAABBs, primitiveIndices, 0, newNumPrimitives,
+											splitBins, numSplitBins, maxNumPrimitivesPerLeaf, 2, maxDepth );
+	}
 	
 	// Reallocate the node memory to a smaller buffer to save memory.
 	if ( finalNumNodes < numNodes )
@@ -752,7 +1008,7 @@ void AABBTree4:: rebuild()
 		if ( primitiveData )
 			util::deallocateAligned( primitiveData );
 		
-		primitiveData = util::allocateAligned<UByte>( newPrimitiveDataSize, 16 );
+		primitiveData = util::allocateAligned<UByte>( newPrimitiveDataSize, sizeof(SIMDFloatN) );
 		primitiveDataCapacity = newPrimitiveDataSize;
 	}
 	
@@ -783,7 +1039,8 @@ void AABBTree4:: rebuild()
 
 
 
-void AABBTree4:: refit()
+template < Size width >
+void AABBTree<width>:: refit()
 {
 	if ( numNodes == 0 )
 		return;
@@ -795,6 +1052,9 @@ void AABBTree4:: refit()
 		return;
 	}
 	
+	// Refitting modifies the cached primitives, so they can't be shared with an image.
+	detachImage();
+	
 	// Refit the tree for different kinds of primitives.
 	Child root;
 	root.node = nodes;
@@ -812,6 +1072,174 @@ void AABBTree4:: refit()
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		BVH Image Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+template < Size width >
+Size AABBTree<width>:: getImageSize() const
+{
+	if ( numNodes == 0 || numPrimitives == 0 )
+		return 0;
+	
+	return ImageHeader( *this ).getImageSize();
+}
+
+
+
+
+template < Size width >
+Bool AABBTree<width>:: writeImage( UByte* newImage ) const
+{
+	if ( numNodes == 0 || numPrimitives == 0 || newImage == NULL ||
+		reinterpret_cast<PointerInt>( newImage ) % IMAGE_ALIGNMENT != 0 )
+		return false;
+	
+	const ImageHeader header( *this );
+	
+	// Zero the image so that the padding between its sections is deterministic.
+	util::zeroPOD( newImage, header.getImageSize() );
+	util::copyPOD( (ImageHeader*)newImage, &header, 1 );
+	
+	// Copy the nodes, replacing each child node pointer with the child's offset in bytes from the first node.
+	Node* imageNodes = (Node*)(newImage + ImageHeader::getNodesOffset());
+	util::copyPOD( imageNodes, nodes, numNodes );
+	
+	for ( Index n = 0; n < numNodes; n++ )
+	{
+		for ( Index i = 0; i < width; i++ )
+		{
+			Child& child = imageNodes[n].getChild(i);
+			
+			if ( !Node::isLeaf( child ) )
+				child.node = reinterpret_cast<Node*>( PointerInt((const UByte*)child.node - (const UByte*)nodes) );
+		}
+	}
+	
+	// The primitive indices and cached primitives don't contain pointers and are copied unchanged.
+	util::copyPOD( (PrimitiveIndex*)(newImage + header.getIndicesOffset()), primitiveIndices, numPrimitives );
+	
+	if ( header.primitiveDataSize > 0 )
+		util::copyPOD( newImage + header.getPrimitivesOffset(), primitiveData, Size(header.primitiveDataSize) );
+	
+	return true;
+}
+
+
+
+
+template < Size width >
+Bool AABBTree<width>:: setImage( const UByte* newImage, Size imageSize )
+{
+	if ( geometry == NULL || newImage == NULL || imageSize < ImageHeader::getNodesOffset() ||
+		reinterpret_cast<PointerInt>( newImage ) % IMAGE_ALIGNMENT != 0 )
+		return false;
+	
+	// Update the primitive set.
+	geometry->update();
+	
+	const ImageHeader& header = *(const ImageHeader*)newImage;
+	const UInt32 newPrimitiveType = geometry->getPrimitiveType() == BVHGeometry::TRIANGLES ?
+									BVHGeometry::TRIANGLES : BVHGeometry::UNDEFINED;
+	
+	// Make sure that the image was written by a compatible tree for the same primitives and that it fits in the memory.
+	// The counts are bounded by the image size before any offsets are computed, so that they can't overflow.
+	if ( header.version != ImageHeader::VERSION || header.pointerSize != sizeof(Node*) ||
+		header.nodeSize != sizeof(Node) || header.primitiveSize != sizeof(CachedTriangle) ||
+		header.primitiveType != newPrimitiveType || header.numNodes == 0 ||
+		header.numPrimitives == 0 || header.numPrimitives != geometry->getPrimitiveCount() ||
+		header.numNodes > imageSize / sizeof(Node) || header.primitiveDataSize > imageSize ||
+		header.primitiveDataSize % sizeof(CachedTriangle) != 0 || header.getImageSize() > imageSize )
+		return false;
+	
+	const Size newNumNodes = (Size)header.numNodes;
+	
+	// Leaves reference cached triangles if the primitives are cached, or primitive indices otherwise.
+	const Size numLeafPrimitives = newPrimitiveType == BVHGeometry::TRIANGLES ?
+									Size(header.primitiveDataSize) / sizeof(CachedTriangle) : Size(header.numPrimitives);
+	
+	// Copy the nodes, replacing each child offset with a pointer to the child node.
+	Node* newNodes = util::allocateAligned<Node>( newNumNodes, sizeof(Node) );
+	util::copyPOD( newNodes, (const Node*)(newImage + ImageHeader::getNodesOffset()), newNumNodes );
+	
+	// Keep track of the depth of each node so that a corrupt image can't overflow the traversal stack.
+	UByte* depths = util::allocate<UByte>( newNumNodes );
+	util::zeroPOD( depths, newNumNodes );
+	depths[0] = 1;
+	Bool valid = true;
+	
+	for ( Index n = 0; n < newNumNodes && valid; n++ )
+	{
+		for ( Index i = 0; i < width && valid; i++ )
+		{
+			Child& child = newNodes[n].getChild(i);
+			
+			if ( Node::isLeaf( child ) )
+				valid = Size(Node::getLeafOffset( child )) + Size(Node::getLeafCount( child )) <= numLeafPrimitives;
+			else
+			{
+				// Children are always stored after their parent, which also rules out cycles.
+				const Size childOffset = Size(reinterpret_cast<PointerInt>( child.node ));
+				const Index childIndex = childOffset / sizeof(Node);
+				
+				valid = childOffset % sizeof(Node) == 0 && childIndex > n && childIndex < newNumNodes &&
+						depths[n] < MAX_TREE_DEPTH;
+				
+				child.node = newNodes + childIndex;
+				
+				if ( valid )
+					depths[childIndex] = math::max( depths[childIndex], UByte(depths[n] + 1) );
+			}
+		}
+	}
+	
+	util::deallocate( depths );
+	
+	if ( !valid )
+	{
+		util::deallocateAligned( newNodes );
+		return false;
+	}
+	
+	//**************************************************************************************
+	// Replace the tree's data with the image.
+	
+	releaseImage();
+	
+	if ( nodes )
+		util::deallocateAligned( nodes );
+	
+	if ( primitiveData )
+		util::deallocateAligned( primitiveData );
+	
+	if ( primitiveIndices )
+		util::deallocate( primitiveIndices );
+	
+	nodes = newNodes;
+	numNodes = newNumNodes;
+	numPrimitives = (IndexType)header.numPrimitives;
+	primitiveIndices = (PrimitiveIndex*)(newImage + header.getIndicesOffset());
+	primitiveIndexCapacity = 0;
+	primitiveData = header.primitiveDataSize > 0 ? (UByte*)(newImage + header.getPrimitivesOffset()) : NULL;
+	primitiveDataCapacity = 0;
+	cachedPrimitiveType = (BVHGeometry::Type)newPrimitiveType;
+	maxDepth = (Size)header.maxDepth;
+	maxNumPrimitivesPerLeaf = (PrimitiveCount)header.maxNumPrimitivesPerLeaf;
+	image = newImage;
+	
+	return true;
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -823,23 +1251,81 @@ void AABBTree4:: refit()
 
 
 
-void AABBTree4:: intersectRay( BVHRay& ray ) const
+template < Size width >
+void AABBTree<width>:: intersectRay( BVHRay& ray ) const
+{
+	if ( numNodes == 0 )
+		return;
+	
+	if ( cachedPrimitiveType == BVHGeometry::TRIANGLES )
+		traceRayVsTriangles<false>( ray );
+	else
+		traceRayVsGeneric<false>( ray );
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: testRay( BVHRay& ray ) const
 {
 	if ( numNodes == 0 )
 		return;
 	
 	if ( cachedPrimitiveType == BVHGeometry::TRIANGLES )
-		traceRayVsTriangles( ray );
+		traceRayVsTriangles<true>( ray );
 	else
-		traceRayVsGeneric( ray );
+		traceRayVsGeneric<true>( ray );
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: intersectRays( BVHRay* rays, Size numRays ) const
+{
+	if ( numNodes == 0 )
+		return;
+	
+	const Bool triangles = cachedPrimitiveType == BVHGeometry::TRIANGLES;
+	
+	while ( numRays > 0 )
+	{
+		const Size packetSize = math::min( numRays, PACKET_SIZE );
+		
+		if ( triangles )
+			tracePacket<false,true>( rays, packetSize );
+		else
+			tracePacket<false,false>( rays, packetSize );
+		
+		rays += packetSize;
+		numRays -= packetSize;
+	}
 }
 
 
 
 
-void AABBTree4:: testRay( BVHRay& ray ) const
+template < Size width >
+void AABBTree<width>:: testRays( BVHRay* rays, Size numRays ) const
 {
-	return intersectRay( ray );
+	if ( numNodes == 0 )
+		return;
+	
+	const Bool triangles = cachedPrimitiveType == BVHGeometry::TRIANGLES;
+	
+	while ( numRays > 0 )
+	{
+		const Size packetSize = math::min( numRays, PACKET_SIZE );
+		
+		if ( triangles )
+			tracePacket<true,true>( rays, packetSize );
+		else
+			tracePacket<true,false>( rays, packetSize );
+		
+		rays += packetSize;
+		numRays -= packetSize;
+	}
 }
 
 
@@ -857,7 +1343,8 @@ void AABBTree4:: testRay( BVHRay& ray ) const
 
 
 
-Bool AABBTree4:: isValid() const
+template < Size width >
+Bool AABBTree<width>:: isValid() const
 {
 	return numNodes > 0;
 }
@@ -865,9 +1352,10 @@ Bool AABBTree4:: isValid() const
 
 
 
-Size AABBTree4:: getSizeInBytes() const
+template < Size width >
+Size AABBTree<width>:: getSizeInBytes() const
 {
-	Size totalSize = sizeof(AABBTree4);
+	Size totalSize = sizeof(AABBTree);
 	
 	totalSize += numNodes*sizeof(Node);
 	totalSize += primitiveDataCapacity;
@@ -890,7 +1378,8 @@ Size AABBTree4:: getSizeInBytes() const
 
 
 
-AABB3f AABBTree4:: getAABB() const
+template < Size width >
+AABB3f AABBTree<width>:: getAABB() const
 {
 	if ( numNodes == 0 )
 		return AABB3f( math::infinity<Float>(), math::negativeInfinity<Float>() );
@@ -901,7 +1390,8 @@ AABB3f AABBTree4:: getAABB() const
 
 
 
-Sphere3f AABBTree4:: getBoundingSphere() const
+template < Size width >
+Sphere3f AABBTree<width>:: getBoundingSphere() const
 {
 	if ( numNodes == 0 )
 		return Sphere3f( Vector3f(), math::infinity<Float>() );
@@ -926,7 +1416,9 @@ Sphere3f AABBTree4:: getBoundingSphere() const
 
 
 
-void AABBTree4:: traceRayVsGeneric( BVHRay& rayData ) const
+template < Size width >
+template < Bool anyHit >
+void AABBTree<width>:: traceRayVsGeneric( BVHRay& rayData ) const
 {
 	Child traversalStack[TRAVERSAL_STACK_SIZE];
 	Child* const stackBase = traversalStack;
@@ -938,8 +1430,9 @@ void AABBTree4:: traceRayVsGeneric( BVHRay& rayData ) const
 	const BVHGeometry* const geo = geometry;
 	const PrimitiveIndex* const indices = primitiveIndices;
 	TraversalRay ray( rayData );
-	const SIMDFloat4 tMin = rayData.tMin;
-	SIMDFloat4 tMax = rayData.tMax;
+	const Float tMaxInput = rayData.tMax;
+	const SIMDFloatN tMin = rayData.tMin;
+	SIMDFloatN tMax = rayData.tMax;
 	
 	while ( true )
 	{
@@ -947,8 +1440,21 @@ void AABBTree4:: traceRayVsGeneric( BVHRay& rayData ) const
 		
 		if ( Node::isLeaf( node ) )
 		{
-			geo->intersectRay( indices + Node::getLeafOffset( node ),
+			if ( anyHit )
+			{
+				geo->testRay( indices + Node::getLeafOffset( node ),
 								Node::getLeafCount( node ), rayData );
+				
+				// Stop at the first primitive that is hit.
+				if ( rayData.tMax < tMaxInput )
+					break;
+			}
+			else
+			{
+				geo->intersectRay( indices + Node::getLeafOffset( node ),
+									Node::getLeafCount( node ), rayData );
+			}
+			
 			tMax = rayData.tMax;
 		}
 		else
@@ -979,7 +1485,9 @@ void AABBTree4:: traceRayVsGeneric( BVHRay& rayData ) const
 
 
 
-void AABBTree4:: traceRayVsTriangles( BVHRay& rayData ) const
+template < Size width >
+template < Bool anyHit >
+void AABBTree<width>:: traceRayVsTriangles( BVHRay& rayData ) const
 {
 	Child traversalStack[TRAVERSAL_STACK_SIZE];
 	Child* const stackBase = traversalStack;
@@ -991,9 +1499,8 @@ void AABBTree4:: traceRayVsTriangles( BVHRay& rayData ) const
 	const CachedTriangle* const triangles = (const CachedTriangle*)primitiveData;
 	TraversalRay ray( rayData );
 	const Float tMaxInput = rayData.tMax;
-	const SIMDFloat4 tMin = rayData.tMin;
-	SIMDFloat4 tMax = rayData.tMax;
-	SIMDFloat4 triangleDistance;
+	const SIMDFloatN tMin = rayData.tMin;
+	SIMDFloatN tMax = rayData.tMax;
 	
 	while ( true )
 	{
@@ -1005,7 +1512,7 @@ void AABBTree4:: traceRayVsTriangles( BVHRay& rayData ) const
 			
 			if ( numNodePrimitives == 1 )
 			{
-				// Fast case for a single quad triangle.
+				// Fast case for a single packed triangle.
 				const CachedTriangle* triangle = triangles + Node::getLeafOffset( node );
 				
 				// Find the intersections and update the ray data.
@@ -1022,9 +1529,16 @@ void AABBTree4:: traceRayVsTriangles( BVHRay& rayData ) const
 					// Find the intersections and update the ray data.
 					rayIntersectsTriangles( ray, rayData, tMin, tMax, *triangle );
 					
+					if ( anyHit && rayData.tMax < tMaxInput )
+						break;
+					
 					triangle++;
 				}
 			}
+			
+			// Stop at the first triangle that is hit.
+			if ( anyHit && rayData.tMax < tMaxInput )
+				break;
 		}
 		else
 		{
@@ -1084,179 +1598,314 @@ OM_FORCE_INLINE static int clearFirstSetBit( int& mask )
 
 
 
-Bool AABBTree4:: traceRayVsNode( const TraversalRay& ray, const SIMDFloat4& tMin, const SIMDFloat4& tMax,
+template < Size width >
+Bool AABBTree<width>:: traceRayVsNode( const TraversalRay& ray, const SIMDFloatN& tMin, const SIMDFloatN& tMax,
 								Child& childNode, Child*& stack )
 {
 	const Node* const node = childNode.node;
 	
 	// Intersect the ray with the node's children.
-	SIMDFloat4 near;
-	SIMDInt4 intersectionResult = node->intersectRay( ray, tMin, tMax, near );
+	SIMDFloatN near;
+	SIMDIntN intersectionResult = node->intersectRay( ray, tMin, tMax, near );
 	Int mask = intersectionResult.getMask();
 	
 	//************************************************************************
 	
-	switch ( mask )
+	// No hits. Backtrack on the stack.
+	if ( mask == 0 )
+		return false;
+	
+	// Get the index of the first hit and clear it from the mask.
+	Int i = clearFirstSetBit( mask );
+	
+	// 1 Hit. Replace the current node with the hit child.
+	if ( mask == 0 )
 	{
-		// No hits. Backtrack on the stack.
-		case 0:
-			return false;
-		
-		// 1 Hit. Replace the current node with the hit child.
-		case 1 << 0:	childNode = node->getChild(0);	return true;
-		case 1 << 1:	childNode = node->getChild(1);	return true;
-		case 1 << 2:	childNode = node->getChild(2);	return true;
-		case 1 << 3:	childNode = node->getChild(3);	return true;
-		
-		// 2 Hits.
-		case 3: // 0011
+		childNode = node->getChild(i);
+		return true;
+	}
+	
+	// 2 Hits. Traverse the closer child first.
+	if ( (mask & (mask - 1)) == 0 )
+	{
+		const Int j = firstSetBit( mask );
+		stack++;
+		
+		if ( near[j] < near[i] )
 		{
-			stack++;
-			
-			if ( near[1] < near[0] )
-			{
-				*stack = node->getChild(0);
-				childNode = node->getChild(1);
-			}
-			else
-			{
-				*stack = node->getChild(1);
-				childNode = node->getChild(0);
-			}
-			return true;
+			*stack = node->getChild(i);
+			childNode = node->getChild(j);
 		}
-		
-		case 5: // 0101
+		else
 		{
-			stack++;
-			
-			if ( near[2] < near[0] )
-			{
-				*stack = node->getChild(0);
-				childNode = node->getChild(2);
-			}
-			else
-			{
-				*stack = node->getChild(2);
-				childNode = node->getChild(0);
-			}
-			return true;
+			*stack = node->getChild(j);
+			childNode = node->getChild(i);
 		}
+		return true;
+	}
+	
+	// There are more than 2 hit children. Restore the bit of the first hit child,
+	// then determine the index of the closest hit child.
+	mask |= (1 << i);
+	Int closestChildIndex = minIndex( math::select( intersectionResult, near, SIMDFloatN(math::infinity<Float>()) ) );
+	
+	// Clear the bit of the closest hit child.
+	mask &= ~(1 << closestChildIndex);
+	
+	// Put the other hit children onto the stack.
+	while ( mask )
+	{
+		i = clearFirstSetBit( mask );
+		stack++;
+		*stack = node->getChild(i);
+	}
+	
+	// Determine the next node to traverse.
+	childNode = node->getChild(closestChildIndex);
+	return true;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Ray Packet Tracing Method
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+template < Size width >
+template < Bool anyHit, Bool cachedTriangles >
+void AABBTree<width>:: tracePacket( BVHRay* rayData, Size numRays ) const
+{
+	typedef math::SIMDScalar<Float32,PACKET_SIZE> SIMDFloatP;
+	typedef math::SIMDScalar<Int32,PACKET_SIZE> SIMDIntP;
+	
+	// The packet's rays must all have the same direction signs so that they share
+	// the near and far planes of each box. Otherwise, trace the rays one at a time.
+	const Vector3f& firstDirection = rayData[0].direction;
+	
+	for ( Index r = 1; r < numRays; r++ )
+	{
+		const Vector3f& direction = rayData[r].direction;
 		
-		case 6: // 0110
+		if ( (direction.x < Float32(0)) != (firstDirection.x < Float32(0)) ||
+			(direction.y < Float32(0)) != (firstDirection.y < Float32(0)) ||
+			(direction.z < Float32(0)) != (firstDirection.z < Float32(0)) )
 		{
-			stack++;
-			
-			if ( near[2] < near[1] )
+			for ( r = 0; r < numRays; r++ )
 			{
-				*stack = node->getChild(1);
-				childNode = node->getChild(2);
-			}
-			else
-			{
-				*stack = node->getChild(2);
-				childNode = node->getChild(1);
+				if ( cachedTriangles )
+					traceRayVsTriangles<anyHit>( rayData[r] );
+				else
+					traceRayVsGeneric<anyHit>( rayData[r] );
 			}
-			return true;
+			
+			return;
 		}
+	}
+	
+	// Each stack entry has a node and a mask of the packet's rays that hit that node.
+	Child nodeStack[TRAVERSAL_STACK_SIZE + 1];
+	Int rayMaskStack[TRAVERSAL_STACK_SIZE + 1];
+	Size stackSize = 0;
+	
+	const CachedTriangle* const triangles = (const CachedTriangle*)primitiveData;
+	const BVHGeometry* const geo = geometry;
+	const PrimitiveIndex* const indices = primitiveIndices;
+	
+	// Prepare the single-ray traversal data for the primitive tests of each ray in the packet.
+	TraversalRay rays[PACKET_SIZE];
+	SIMDFloatN tMin[PACKET_SIZE];
+	SIMDFloatN tMax[PACKET_SIZE];
+	Float tMaxInput[PACKET_SIZE];
+	
+	// Prepare the packet in structure-of-arrays format, with one ray per SIMD lane.
+	// Unused lanes duplicate the first ray and are masked out of the traversal.
+	OM_ALIGN(32) Float32 packetData[8][PACKET_SIZE];
+	
+	for ( Index r = 0; r < PACKET_SIZE; r++ )
+	{
+		const BVHRay& ray = rayData[r < numRays ? r : 0];
+		const Vector3f inverseDirection = math::reciprocal( ray.direction );
 		
-		case 9: // 1001
+		for ( Index a = 0; a < 3; a++ )
 		{
-			stack++;
-			
-			if ( near[3] < near[0] )
-			{
-				*stack = node->getChild(0);
-				childNode = node->getChild(3);
-			}
-			else
-			{
-				*stack = node->getChild(3);
-				childNode = node->getChild(0);
-			}
-			return true;
+			packetData[a][r] = ray.origin[a];
+			packetData[3 + a][r] = inverseDirection[a];
 		}
 		
-		case 10: // 1010
+		packetData[6][r] = ray.tMin;
+		packetData[7][r] = ray.tMax;
+		
+		if ( r < numRays )
 		{
-			stack++;
-			
-			if ( near[3] < near[1] )
-			{
-				*stack = node->getChild(1);
-				childNode = node->getChild(3);
-			}
-			else
-			{
-				*stack = node->getChild(3);
-				childNode = node->getChild(1);
-			}
-			return true;
+			rays[r] = TraversalRay( ray );
+			tMin[r] = ray.tMin;
+			tMax[r] = ray.tMax;
+			tMaxInput[r] = ray.tMax;
 		}
+	}
+	
+	const SIMDFloatP originX = SIMDFloatP::load( packetData[0] );
+	const SIMDFloatP originY = SIMDFloatP::load( packetData[1] );
+	const SIMDFloatP originZ = SIMDFloatP::load( packetData[2] );
+	const SIMDFloatP inverseDirectionX = SIMDFloatP::load( packetData[3] );
+	const SIMDFloatP inverseDirectionY = SIMDFloatP::load( packetData[4] );
+	const SIMDFloatP inverseDirectionZ = SIMDFloatP::load( packetData[5] );
+	const SIMDFloatP packetTMin = SIMDFloatP::load( packetData[6] );
+	Float32* const packetTMax = packetData[7];
+	
+	// The indices of the near and far bounds of each axis in a node's bounds array.
+	const Index nearX = firstDirection.x < Float32(0) ? 1 : 0;
+	const Index nearY = firstDirection.y < Float32(0) ? 3 : 2;
+	const Index nearZ = firstDirection.z < Float32(0) ? 5 : 4;
+	
+	// A mask of the rays that have not yet hit anything, for any-hit tracing.
+	const Int allRays = (Int(1) << numRays) - 1;
+	Int activeRays = allRays;
+	
+	Child node;
+	node.node = nodes;
+	Int rayMask = allRays;
+	
+	while ( true )
+	{
+		// Skip the rays that have already hit something.
+		if ( anyHit )
+			rayMask &= activeRays;
 		
-		case 12: // 1100
+		if ( rayMask != 0 )
 		{
-			stack++;
-			
-			if ( near[3] < near[2] )
+			if ( Node::isLeaf( node ) )
 			{
-				*stack = node->getChild(2);
-				childNode = node->getChild(3);
+				const UInt32 leafOffset = Node::getLeafOffset( node );
+				const UInt32 leafCount = Node::getLeafCount( node );
+				
+				// Intersect each ray that hit the leaf with its primitives.
+				while ( rayMask )
+				{
+					const Int r = clearFirstSetBit( rayMask );
+					BVHRay& ray = rayData[r];
+					
+					if ( cachedTriangles )
+					{
+						const CachedTriangle* triangle = triangles + leafOffset;
+						const CachedTriangle* const trianglesEnd = triangle + leafCount;
+						
+						for ( ; triangle != trianglesEnd; triangle++ )
+						{
+							rayIntersectsTriangles( rays[r], ray, tMin[r], tMax[r], *triangle );
+							
+							if ( anyHit && ray.tMax < tMaxInput[r] )
+								break;
+						}
+					}
+					else
+					{
+						if ( anyHit )
+							geo->testRay( indices + leafOffset, leafCount, ray );
+						else
+							geo->intersectRay( indices + leafOffset, leafCount, ray );
+						
+						tMax[r] = ray.tMax;
+					}
+					
+					packetTMax[r] = ray.tMax;
+					
+					// Retire the ray at the first primitive that is hit.
+					if ( anyHit && ray.tMax < tMaxInput[r] )
+						activeRays &= ~(Int(1) << r);
+				}
+				
+				if ( anyHit && activeRays == 0 )
+					break;
 			}
 			else
 			{
-				*stack = node->getChild(3);
-				childNode = node->getChild(2);
+				const Node* const innerNode = node.node;
+				const SIMDFloatP tMaxP = SIMDFloatP::load( packetTMax );
+				const SIMDFloatP infinity( math::infinity<Float>() );
+				
+				// Intersect all rays in the packet with each child box, recording which rays
+				// hit each child and the closest entry distance of any ray for each child.
+				Int childRayMasks[width];
+				Float childNear[width];
+				Int childMask = 0;
+				
+				for ( Index i = 0; i < width; i++ )
+				{
+					const SIMDFloatP txmin = (SIMDFloatP( innerNode->bounds[nearX][i] ) - originX) * inverseDirectionX;
+					const SIMDFloatP txmax = (SIMDFloatP( innerNode->bounds[nearX ^ 1][i] ) - originX) * inverseDirectionX;
+					const SIMDFloatP tymin = (SIMDFloatP( innerNode->bounds[nearY][i] ) - originY) * inverseDirectionY;
+					const SIMDFloatP tymax = (SIMDFloatP( innerNode->bounds[nearY ^ 1][i] ) - originY) * inverseDirectionY;
+					const SIMDFloatP tzmin = (SIMDFloatP( innerNode->bounds[nearZ][i] ) - originZ) * inverseDirectionZ;
+					const SIMDFloatP tzmax = (SIMDFloatP( innerNode->bounds[nearZ ^ 1][i] ) - originZ) * inverseDirectionZ;
+					
+					const SIMDFloatP near = math::max( math::max( txmin, tymin ), math::max( tzmin, packetTMin ) );
+					const SIMDFloatP far = math::min( math::min( math::min( txmax, tymax ), tzmax ), tMaxP );
+					const SIMDIntP hit = near <= far;
+					const Int hitMask = hit.getMask() & rayMask;
+					
+					if ( hitMask == 0 )
+						continue;
+					
+					childRayMasks[i] = hitMask;
+					childNear[i] = math::min( math::select( hit, near, infinity ) )[0];
+					childMask |= Int(1) << i;
+				}
+				
+				if ( childMask != 0 )
+				{
+					// Find the closest hit child and traverse it next, with the others on the stack.
+					Int closestChildIndex = firstSetBit( childMask );
+					Int mask = childMask & (childMask - 1);
+					
+					while ( mask )
+					{
+						const Int i = clearFirstSetBit( mask );
+						
+						if ( childNear[i] < childNear[closestChildIndex] )
+							closestChildIndex = i;
+					}
+					
+					childMask &= ~(Int(1) << closestChildIndex);
+					
+					while ( childMask )
+					{
+						const Int i = clearFirstSetBit( childMask );
+						nodeStack[stackSize] = innerNode->getChild(i);
+						rayMaskStack[stackSize] = childRayMasks[i];
+						stackSize++;
+					}
+					
+					node = innerNode->getChild(closestChildIndex);
+					rayMask = childRayMasks[closestChildIndex];
+					continue;
+				}
 			}
-			return true;
 		}
 		
+		if ( stackSize == 0 )
+			break;
 		
-		default:
+		stackSize--;
+		node = nodeStack[stackSize];
+		rayMask = rayMaskStack[stackSize];
+	}
+	
+	// If a ray hit a cached triangle closer than its input t-max, set the hit geometry.
+	if ( cachedTriangles )
+	{
+		for ( Index r = 0; r < numRays; r++ )
 		{
-			// There are more than 2 hit children.
-			// Determine the index of the closest hit child.
-			Int closestChildIndex = minIndex( math::select( intersectionResult, near, SIMDFloat4(math::infinity<Float>()) ) );
-			
-			// Clear the bit of the closest hit child.
-			mask &= ~(1 << closestChildIndex);
-			
-			//****************************************************
-			// Second hit.
-			
-			// Get the index of the next hit and clear it from the mask.
-			Int i = clearFirstSetBit( mask );
-			
-			// Put the child onto the stack.
-			stack++;
-			*stack = node->getChild(i);
-			
-			//****************************************************
-			// Third hit.
-			
-			// Get the index of the next hit and clear it from the mask.
-			i = clearFirstSetBit( mask );
-			
-			// Put the child onto the stack.
-			stack++;
-			*stack = node->getChild(i);
-			
-			//****************************************************
-			// Fourth hit, if necessary.
-			
-			if ( mask )
-			{
-				// Get the index of the next hit and clear it from the mask.
-				i = clearFirstSetBit( mask );
-				
-				// Put the child onto the stack.
-				stack++;
-				*stack = node->getChild(i);
-			}
-			
-			// Determine the next node to traverse.
-			childNode = node->getChild(closestChildIndex);
-			return true;
+			if ( rayData[r].tMax < tMaxInput[r] )
+				rayData[r].geometry = geometry;
 		}
 	}
 }
@@ -1275,36 +1924,37 @@ Bool AABBTree4:: traceRayVsNode( const TraversalRay& ray, const SIMDFloat4& tMin
 
 
 
-void AABBTree4:: rayIntersectsTriangles( const TraversalRay& ray, BVHRay& rayData, const SIMDFloat4& tMin, SIMDFloat4& tMax,
+template < Size width >
+void AABBTree<width>:: rayIntersectsTriangles( const TraversalRay& ray, BVHRay& rayData, const SIMDFloatN& tMin, SIMDFloatN& tMax,
 										const CachedTriangle& triangle )
 {
 	// the vector perpendicular to edge 2 and the ray's direction
-	SIMDVector3f pvec = math::cross( ray.direction, triangle.e2 );
-	SIMDFloat4 det = math::dot( triangle.e1, pvec );
+	SIMDVector3fN pvec = math::cross( ray.direction, triangle.e2 );
+	SIMDFloatN det = math::dot( triangle.e1, pvec );
 	
 	// Do the first rejection test for the triangles, test to see if the ray is in the same plane as the triangle.
-	SIMDInt4 result = math::abs(det) >= math::epsilon<Float>();
+	SIMDIntN result = math::abs(det) >= math::epsilon<Float>();
 	
 	//************************************************************************************
 	
-	SIMDFloat4 inverseDet = Float(1) / det;
-	SIMDVector3f v0ToSource = ray.origin - triangle.v0;
-	SIMDFloat4 u = math::dot( v0ToSource, pvec ) * inverseDet;
+	SIMDFloatN inverseDet = SIMDFloatN(Float(1)) / det;
+	SIMDVector3fN v0ToSource = ray.origin - triangle.v0;
+	SIMDFloatN u = math::dot( v0ToSource, pvec ) * inverseDet;
 	
 	// Do the second rejection test for the triangles. See if the UV coordinate is within the valid range.
 	result &= (u >= Float(0)) & (u <= Float(1));
 	
 	//************************************************************************************
 	
-	SIMDVector3f qvec = math::cross( v0ToSource, triangle.e1 );
-	SIMDFloat4 v = math::dot( ray.direction, qvec ) * inverseDet;
+	SIMDVector3fN qvec = math::cross( v0ToSource, triangle.e1 );
+	SIMDFloatN v = math::dot( ray.direction, qvec ) * inverseDet;
 	
 	// Do the third rejection test for the triangles. See if the UV coordinate is within the valid range.
 	result &= (v >= Float(0)) & (u + v <= Float(1));
 	
 	//************************************************************************************
 	
-	SIMDFloat4 distance = math::dot( triangle.e2, qvec ) * inverseDet;
+	SIMDFloatN distance = math::dot( triangle.e2, qvec ) * inverseDet;
 	
 	// Make sure that the triangles are hit by the forward side of the ray.
 	result &= (distance > tMin) & (distance < tMax);
@@ -1315,7 +1965,7 @@ void AABBTree4:: rayIntersectsTriangles( const TraversalRay& ray, BVHRay& rayDat
 	if ( result.getMask() )
 	{
 		// Find the closest valid intersection.
-		distance = math::select( result, distance, SIMDFloat4(math::infinity<Float>()) );
+		distance = math::select( result, distance, SIMDFloatN(math::infinity<Float>()) );
 		Int minTIndex = minIndex( distance, tMax );
 		
 		// Update the ray data.
@@ -1342,70 +1992,69 @@ void AABBTree4:: rayIntersectsTriangles( const TraversalRay& ray, BVHRay& rayDat
 
 
 
-Size AABBTree4:: buildTreeRecursive( Node* node, const PrimitiveAABB* primitiveAABBs,
+template < Size width >
+Size AABBTree<width>:: buildTreeRecursive( Node* node, const PrimitiveAABB* primitiveAABBs,
 									PrimitiveIndex* primitiveIndices, PrimitiveIndex start, PrimitiveCount numPrimitives,
 									SplitBin* splitBins, Size numSplitBins, 
-									Size maxNumPrimitivesPerLeaf, Size depth, Size& maxDepth )
+									Size maxNumPrimitivesPerLeaf, Size depth, Size& maxDepth,
+									ParallelBuild* parallelBuild )
 {
+	// The thread pool used to bin large sets of primitives in parallel, or NULL if the build is serial.
+	ThreadPool* const threadPool = parallelBuild != NULL ? parallelBuild->threadPool : NULL;
+	
 	// The split axis used for each split (0 = X, 1 = Y, 2 = Z).
-	StaticArray<Index,3> splitAxis;
+	Index splitAxis;
 	
 	// The number of primitives in a child node (leaf or not).
-	StaticArray<PrimitiveCount,4> numChildPrimitives;
+	StaticArray<PrimitiveCount,width> numChildPrimitives;
 	
-	// The 4 volumes of the child nodes.
-	StaticArray<AABB3f,4> volumes;
+	// The N volumes of the child nodes.
+	StaticArray<AABB3f,width> volumes;
 	
-	//***************************************************************************
-	// Partition the set of primitives into two sets.
-	
-	PrimitiveIndex* const primitiveIndicesStart = primitiveIndices + start;
-	PrimitiveCount numLesserPrimitives = 0;
-	
-	partitionPrimitivesSAH( primitiveAABBs, primitiveIndicesStart, numPrimitives,
-							splitBins, numSplitBins, splitAxis[0], numLesserPrimitives,
-							volumes[0], volumes[2] );
-	
-	// Compute the number of primitives greater than the split plane along the split axis.
-	PrimitiveCount numGreaterPrimitives = numPrimitives - numLesserPrimitives;
+	// The offset of each child's primitives from the start of this node's primitives.
+	StaticArray<PrimitiveIndex,width> childStart;
 	
 	//***************************************************************************
-	// Partition the primitive subsets into four sets based on the next two splitting planes.
+	// Partition the set of primitives into 2, then 4, and so on up to N sets.
 	
-	// If the number of primitives on this side of the first partition is less than or equal to the max number of
-	// primitives per leaf, put all the primitives in the first child.
-	if ( numLesserPrimitives <= maxNumPrimitivesPerLeaf )
-	{
-		numChildPrimitives[0] = numLesserPrimitives;
-		numChildPrimitives[1] = 0;
-		volumes[0] = computeAABBForPrimitives( primitiveAABBs, primitiveIndicesStart, numLesserPrimitives );
-	}
-	else
-	{
-		partitionPrimitivesSAH( primitiveAABBs, primitiveIndicesStart, numLesserPrimitives,
-							splitBins, numSplitBins, splitAxis[1],
-							numChildPrimitives[0], volumes[0], volumes[1] );
-	}
+	PrimitiveIndex* const primitiveIndicesStart = primitiveIndices + start;
+	numChildPrimitives[0] = numPrimitives;
+	childStart[0] = 0;
 	
-	// If the number of primitives on this side of the first partition is less than or equal to the max number of
-	// primitives per leaf, put all the primitives in the first child.
-	if ( numGreaterPrimitives <= maxNumPrimitivesPerLeaf )
-	{
-		numChildPrimitives[2] = numGreaterPrimitives;
-		numChildPrimitives[3] = 0;
-		volumes[2] = computeAABBForPrimitives( primitiveAABBs, primitiveIndicesStart + numLesserPrimitives, numGreaterPrimitives );
-	}
-	else
+	for ( Size numSets = 1; numSets < width; numSets *= 2 )
 	{
-		partitionPrimitivesSAH( primitiveAABBs, primitiveIndicesStart + numLesserPrimitives, numGreaterPrimitives,
-							splitBins, numSplitBins, splitAxis[2],
-							numChildPrimitives[2], volumes[2], volumes[3] );
+		// Split the sets in reverse order so that set i is not overwritten before it is split into sets 2i and 2i+1.
+		for ( Index i = numSets; i > 0; )
+		{
+			i--;
+			
+			const PrimitiveCount numSetPrimitives = numChildPrimitives[i];
+			PrimitiveIndex* const setIndices = primitiveIndicesStart + childStart[i];
+			
+			childStart[2*i] = childStart[i];
+			
+			// If the number of primitives in this set is less than or equal to the max number of
+			// primitives per leaf, put all the primitives in the first child and leave the other empty.
+			if ( numSetPrimitives <= maxNumPrimitivesPerLeaf )
+			{
+				numChildPrimitives[2*i] = numSetPrimitives;
+				numChildPrimitives[2*i + 1] = 0;
+				volumes[2*i] = computeAABBForPrimitives( primitiveAABBs, setIndices, numSetPrimitives );
+				volumes[2*i + 1] = AABB3f( math::max<Float>(), -math::max<Float>() );
+			}
+			else
+			{
+				partitionPrimitivesSAH( primitiveAABBs, setIndices, numSetPrimitives,
+										splitBins, numSplitBins, splitAxis,
+										numChildPrimitives[2*i], volumes[2*i], volumes[2*i + 1], threadPool );
+				
+				numChildPrimitives[2*i + 1] = numSetPrimitives - numChildPrimitives[2*i];
+			}
+			
+			childStart[2*i + 1] = childStart[2*i] + numChildPrimitives[2*i];
+		}
 	}
 	
-	// Compute the number of primitives greater than the split plane along the split axis.
-	numChildPrimitives[1] = numLesserPrimitives - numChildPrimitives[0];
-	numChildPrimitives[3] = numGreaterPrimitives - numChildPrimitives[2];
-	
 	//***************************************************************************
 	// Determine for each child whether to create a leaf node or an inner node.
 	
@@ -1416,7 +2065,7 @@ Size AABBTree4:: buildTreeRecursive( Node* node, const PrimitiveAABB* primitiveA
 	Size numTreeNodes = 1;
 	PrimitiveIndex primitiveStartIndex = start;
 	
-	for ( Index i = 0; i < 4; i++ )
+	for ( Index i = 0; i < width; i++ )
 	{
 		// Set the child bounding box.
 		node->setChildAABB( i, volumes[i] );
@@ -1426,6 +2075,16 @@ Size AABBTree4:: buildTreeRecursive( Node* node, const PrimitiveAABB* primitiveA
 			// This child is a leaf node.
 			node->setLeaf( i, numChildPrimitives[i], primitiveStartIndex );
 		}
+		else if ( parallelBuild != NULL && numChildPrimitives[i] <= parallelBuild->maxSubtreeSize )
+		{
+			// This is an inner node that is built later by a parallel job.
+			node->setChild( i, numTreeNodes );
+			parallelBuild->subtrees.add( Subtree( node + numTreeNodes, primitiveStartIndex, numChildPrimitives[i], depth + 1 ) );
+			
+			// Reserve the maximum number of nodes the subtree can need. Every inner node has at
+			// least 2 non-empty children, so a subtree with N primitives has at most N - 1 nodes.
+			numTreeNodes += numChildPrimitives[i] - 1;
+		}
 		else
 		{
 			// This is an inner node. Set the relative index of this child from the parent node.
@@ -1435,7 +2094,7 @@ Size AABBTree4:: buildTreeRecursive( Node* node, const PrimitiveAABB* primitiveA
 			Size numChildNodes = buildTreeRecursive( node + numTreeNodes, primitiveAABBs, primitiveIndices,
 													primitiveStartIndex, numChildPrimitives[i],
 													splitBins, numSplitBins, maxNumPrimitivesPerLeaf,
-													depth + 1, maxDepth );
+													depth + 1, maxDepth, parallelBuild );
 			
 			// Add the number of nodes created in the child subtree.
 			numTreeNodes += numChildNodes;
@@ -1469,10 +2128,12 @@ Size AABBTree4:: buildTreeRecursive( Node* node, const PrimitiveAABB* primitiveA
 
 
 
-void AABBTree4:: partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives,
+template < Size width >
+void AABBTree<width>:: partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives,
 										SplitBin* splitBins, Size numSplitBins,
 										Index& splitAxis, PrimitiveCount& numLesserPrimitives,
-										AABB3f& lesserVolume, AABB3f& greaterVolume )
+										AABB3f& lesserVolume, AABB3f& greaterVolume,
+										ThreadPool* threadPool )
 {
 	// If there are no primitives to partition, return immediately.
 	if ( numPrimitives < 2 )
@@ -1508,6 +2169,45 @@ void AABBTree4:: partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, Pr
 	numLesserPrimitives = 0;
 	splitAxis = 0;
 	
+	//**************************************************************************************
+	// If there are many primitives, bin them for all 3 axes in parallel jobs.
+	
+	// Each job bins a contiguous range of primitives into its own split bins, which are
+	// merged in job order below. Since the counts are integers and the bounding boxes are
+	// combined with min and max, the merged bins exactly match those of a serial build.
+	SplitBin* jobSplitBins = NULL;
+	Size numJobs = 0;
+	
+	if ( threadPool != NULL && numPrimitives >= MIN_PARALLEL_BINNING_SIZE )
+	{
+		numJobs = threadPool->getThreadCount();
+		jobSplitBins = util::allocateAligned<SplitBin>( numJobs*3*numSplitBinsUsed, 16 );
+		
+		Vector3f binningConstant;
+		Vector3f binsStart;
+		
+		for ( Index axis = 0; axis < 3; axis++ )
+		{
+			binningConstant[axis] = binningConstant1 / centroidAABBSize[axis];
+			binsStart[axis] = centroidAABB.min[axis];
+		}
+		
+		const PrimitiveCount jobSize = (numPrimitives + numJobs - 1) / numJobs;
+		
+		for ( Index j = 0; j < numJobs; j++ )
+		{
+			const PrimitiveIndex jobStart = math::min( PrimitiveCount(j*jobSize), numPrimitives );
+			
+			threadPool->addJob( FunctionCall<void ( const PrimitiveAABB*, const PrimitiveIndex*, PrimitiveCount,
+													Vector3f, Vector3f, Size, SplitBin* )>(
+								bind( binPrimitives ), primitiveAABBs, primitiveIndices + jobStart,
+								math::min( jobSize, numPrimitives - jobStart ), binningConstant, binsStart,
+								numSplitBinsUsed, jobSplitBins + j*3*numSplitBinsUsed ) );
+		}
+		
+		threadPool->finishJobs();
+	}
+	
 	for ( Index axis = 0; axis < 3; axis++ )
 	{
 		// Compute some constants that are valid for all bins/primitives.
@@ -1522,17 +2222,36 @@ void AABBTree4:: partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, Pr
 		//**************************************************************************************
 		// For each primitive, determine which bin it overlaps and increase that bin's counter.
 		
-		for ( PrimitiveIndex i = 0; i < numPrimitives; i++ )
+		if ( jobSplitBins != NULL )
 		{
-			const PrimitiveAABB& t = primitiveAABBs[primitiveIndices[i]];
-			
-			Index binIndex = (Index)(binningConstant*(t.centroid[axis] - binsStart));
-			SplitBin& bin = splitBins[binIndex];
-			
-			// Update the number of primitives that this bin contains, as well as the AABB for those primitives.
-			bin.numPrimitives++;
-			bin.min = math::min( bin.min, t.min );
-			bin.max = math::max( bin.max, t.max );
+			// Merge the split bins for this axis from each parallel job.
+			for ( Index j = 0; j < numJobs; j++ )
+			{
+				const SplitBin* jobBins = jobSplitBins + (j*3 + axis)*numSplitBinsUsed;
+				
+				for ( Index i = 0; i < numSplitBinsUsed; i++ )
+				{
+					SplitBin& bin = splitBins[i];
+					bin.numPrimitives += jobBins[i].numPrimitives;
+					bin.min = math::min( bin.min, jobBins[i].min );
+					bin.max = math::max( bin.max, jobBins[i].max );
+				}
+			}
+		}
+		else
+		{
+			for ( PrimitiveIndex i = 0; i < numPrimitives; i++ )
+			{
+				const PrimitiveAABB& t = primitiveAABBs[primitiveIndices[i]];
+				
+				Index binIndex = (Index)(binningConstant*(t.centroid[axis] - binsStart));
+				SplitBin& bin = splitBins[binIndex];
+				
+				// Update the number of primitives that this bin contains, as well as the AABB for those primitives.
+				bin.numPrimitives++;
+				bin.min = math::min( bin.min, t.min );
+				bin.max = math::max( bin.max, t.max );
+			}
 		}
 		
 		//**************************************************************************************
@@ -1593,6 +2312,9 @@ void AABBTree4:: partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, Pr
 		}
 	}
 	
+	if ( jobSplitBins != NULL )
+		util::deallocateAligned( jobSplitBins );
+	
 	//**************************************************************************************
 	
 	// If the split was unsuccessful, try a median split that is guaranteed to split the primitives.
@@ -1652,6 +2374,104 @@ void AABBTree4:: partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, Pr
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Parallel Tree Construction Helper Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+template < Size width >
+void AABBTree<width>:: buildSubtree( Subtree* subtree, const PrimitiveAABB* primitiveAABBs, PrimitiveIndex* primitiveIndices,
+								Size numSplitBins, Size maxNumPrimitivesPerLeaf )
+{
+	// Each job needs its own temporary split bins.
+	SplitBin* splitBins = util::allocateAligned<SplitBin>( numSplitBins, 16 );
+	
+	buildTreeRecursive( subtree->node, primitiveAABBs, primitiveIndices, subtree->start, subtree->numPrimitives,
+						splitBins, numSplitBins, maxNumPrimitivesPerLeaf, subtree->depth, subtree->maxDepth );
+	
+	util::deallocateAligned( splitBins );
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: binPrimitives( const PrimitiveAABB* primitiveAABBs, const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives,
+								Vector3f binningConstant, Vector3f binsStart, Size numSplitBins, SplitBin* splitBins )
+{
+	// Initialize the split bins for all axes to their starting values.
+	for ( Index i = 0; i < 3*numSplitBins; i++ )
+		new (splitBins + i) SplitBin();
+	
+	for ( PrimitiveIndex i = 0; i < numPrimitives; i++ )
+	{
+		const PrimitiveAABB& t = primitiveAABBs[primitiveIndices[i]];
+		
+		for ( Index axis = 0; axis < 3; axis++ )
+		{
+			Index binIndex = (Index)(binningConstant[axis]*(t.centroid[axis] - binsStart[axis]));
+			SplitBin& bin = splitBins[axis*numSplitBins + binIndex];
+			
+			// Update the number of primitives that this bin contains, as well as the AABB for those primitives.
+			bin.numPrimitives++;
+			bin.min = math::min( bin.min, t.min );
+			bin.max = math::max( bin.max, t.max );
+		}
+	}
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: computePrimitiveAABBs( const BVHGeometry* geometry, PrimitiveAABB* primitiveAABBs,
+										PrimitiveIndex start, PrimitiveCount numPrimitives )
+{
+	const PrimitiveIndex end = start + numPrimitives;
+	
+	for ( PrimitiveIndex i = start; i < end; i++ )
+		new (primitiveAABBs + i) PrimitiveAABB( geometry->getPrimitiveAABB(i) );
+}
+
+
+
+
+template < Size width >
+Size AABBTree<width>:: packTree( const Node& node, Node* output )
+{
+	new (output) Node();
+	
+	for ( Index i = 0; i < 6; i++ )
+		output->bounds[i] = node.bounds[i];
+	
+	Size numTreeNodes = 1;
+	
+	for ( Index i = 0; i < width; i++ )
+	{
+		const Child& child = node.getChild(i);
+		
+		if ( Node::isLeaf( child ) )
+			output->getChild(i) = child;
+		else
+		{
+			// Relocate the child subtree to follow the nodes that were already packed.
+			output->setChild( i, numTreeNodes );
+			numTreeNodes += packTree( *child.node, output + numTreeNodes );
+		}
+	}
+	
+	return numTreeNodes;
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -1663,7 +2483,8 @@ void AABBTree4:: partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, Pr
 
 
 
-void AABBTree4:: partitionPrimitivesMedian( const PrimitiveAABB* primitiveAABBs, PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives,
+template < Size width >
+void AABBTree<width>:: partitionPrimitivesMedian( const PrimitiveAABB* primitiveAABBs, PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives,
 											Index splitAxis, PrimitiveCount& numLesserPrimitives,
 											AABB3f& lesserVolume, AABB3f& greaterVolume )
 {
@@ -1732,7 +2553,8 @@ void AABBTree4:: partitionPrimitivesMedian( const PrimitiveAABB* primitiveAABBs,
 
 
 
-AABB3f AABBTree4:: refitTreeGeneric( const Child& node )
+template < Size width >
+AABB3f AABBTree<width>:: refitTreeGeneric( const Child& node )
 {
 	if ( Node::isLeaf(node) )
 	{
@@ -1752,12 +2574,12 @@ AABB3f AABBTree4:: refitTreeGeneric( const Child& node )
 		AABB3f result( math::max<Float>(), math::min<Float>() );
 		
 		// Resursively find the new bounding box for the children of this node.
-		for ( Index i = 0; i < 4; i++ )
+		for ( Index i = 0; i < width; i++ )
 		{
 			Child child = node.node->getChild(i);
 			
 			// Skip empty leaves.
-			if ( Node::isLeaf(child) && child.leaf.count == 0 )
+			if ( Node::isLeaf(child) && Node::getLeafCount(child) == 0 )
 				continue;
 			
 			AABB3f childAABB = refitTreeGeneric( child );
@@ -1787,7 +2609,8 @@ AABB3f AABBTree4:: refitTreeGeneric( const Child& node )
 
 
 
-AABB3f AABBTree4:: refitTreeTriangles( const Child& node )
+template < Size width >
+AABB3f AABBTree<width>:: refitTreeTriangles( const Child& node )
 {
 	if ( Node::isLeaf(node) )
 	{
@@ -1802,7 +2625,7 @@ AABB3f AABBTree4:: refitTreeTriangles( const Child& node )
 		{
 			CachedTriangle& t = triangle[i];
 			
-			for ( Index j = 0; j < 4; j++ )
+			for ( Index j = 0; j < width; j++ )
 			{
 				PrimitiveIndex clientIndex = t.indices[j];
 				
@@ -1830,12 +2653,12 @@ AABB3f AABBTree4:: refitTreeTriangles( const Child& node )
 		AABB3f result( math::max<Float>(), math::min<Float>() );
 		
 		// Resursively find the new bounding box for the children of this node.
-		for ( Index i = 0; i < 4; i++ )
+		for ( Index i = 0; i < width; i++ )
 		{
 			Child child = node.node->getChild(i);
 			
 			// Skip empty leaves.
-			if ( Node::isLeaf(child) && child.leaf.count == 0 )
+			if ( Node::isLeaf(child) && Node::getLeafCount(child) == 0 )
 				continue;
 			
 			AABB3f childAABB = refitTreeTriangles( child );
@@ -1865,7 +2688,8 @@ AABB3f AABBTree4:: refitTreeTriangles( const Child& node )
 
 
 
-AABB3f AABBTree4:: computeAABBForPrimitives( const PrimitiveAABB* primitiveAABBs,
+template < Size width >
+AABB3f AABBTree<width>:: computeAABBForPrimitives( const PrimitiveAABB* primitiveAABBs,
 											const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives )
 {
 	/// Create a bounding box with the minimum at the max float value and visce versa.
@@ -1889,7 +2713,8 @@ AABB3f AABBTree4:: computeAABBForPrimitives( const PrimitiveAABB* primitiveAABBs
 
 
 
-AABB3f AABBTree4:: computeAABBForPrimitiveCentroids( const PrimitiveAABB* primitiveAABBs,
+template < Size width >
+AABB3f AABBTree<width>:: computeAABBForPrimitiveCentroids( const PrimitiveAABB* primitiveAABBs,
 													const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives )
 {
 	/// Create a bounding box with the minimum at the max float value and visce versa.
@@ -1913,7 +2738,8 @@ AABB3f AABBTree4:: computeAABBForPrimitiveCentroids( const PrimitiveAABB* primit
 
 
 
-float AABBTree4:: getAABBSurfaceArea( const SIMDFloat4& min, const SIMDFloat4& max )
+template < Size width >
+float AABBTree<width>:: getAABBSurfaceArea( const SIMDFloat4& min, const SIMDFloat4& max )
 {
 	const SIMDFloat4 aabbDimension = max - min;
 	
@@ -1936,7 +2762,8 @@ float AABBTree4:: getAABBSurfaceArea( const SIMDFloat4& min, const SIMDFloat4& m
 
 
 
-Size AABBTree4:: getTriangleArraySize() const
+template < Size width >
+Size AABBTree<width>:: getTriangleArraySize() const
 {
 	Child root;
 	root.node = nodes;
@@ -1946,15 +2773,16 @@ Size AABBTree4:: getTriangleArraySize() const
 
 
 
-Size AABBTree4:: getTriangleArraySize( const Child& node )
+template < Size width >
+Size AABBTree<width>:: getTriangleArraySize( const Child& node )
 {
 	if ( Node::isLeaf(node) )
-		return math::nextMultiple( Node::getLeafCount( node ), PrimitiveIndex(4) ) >> 2;
+		return math::nextMultiple( Node::getLeafCount( node ), PrimitiveIndex(width) ) / width;
 	else
 	{
 		Size result = 0;
 		
-		for ( Index i = 0; i < 4; i++ )
+		for ( Index i = 0; i < width; i++ )
 			result += getTriangleArraySize( node.node->getChild(i) );
 		
 		return result;
@@ -1964,7 +2792,8 @@ Size AABBTree4:: getTriangleArraySize( const Child& node )
 
 
 
-Size AABBTree4:: fillTriangleArray( CachedTriangle* triangles, const BVHGeometry* geometry,
+template < Size width >
+Size AABBTree<width>:: fillTriangleArray( CachedTriangle* triangles, const BVHGeometry* geometry,
 									Child& node, Size numFilled )
 {
 	Size currentOutputIndex = numFilled;
@@ -1973,23 +2802,23 @@ Size AABBTree4:: fillTriangleArray( CachedTriangle* triangles, const BVHGeometry
 	if ( Node::isLeaf(node) )
 	{
 		Size numLeafTriangles = (Size)Node::getLeafCount( node );
-		Size numTruncatedTriangles = ((numLeafTriangles >> 2) << 2);
+		Size numTruncatedTriangles = (numLeafTriangles / width)*width;
 		Size numPaddedTriangles = numTruncatedTriangles == numLeafTriangles ? 
-									numTruncatedTriangles : numTruncatedTriangles + 4;
+									numTruncatedTriangles : numTruncatedTriangles + width;
 		
-		// Update the per-node primitive count to reflect that 4 regular triangles = 1 cached triangle.
+		// Update the per-node primitive count to reflect that N regular triangles = 1 cached triangle.
 		Index currentOffset = (Index)Node::getLeafOffset( node );
-		const Size numIterations = numPaddedTriangles >> 2;
+		const Size numIterations = numPaddedTriangles / width;
 		Node::setLeaf( node, numIterations, currentOutputIndex );
 		
 		for ( Index k = 0; k < numIterations; k++ )
 		{
-			// Determine the number of triangles to go into this cached triangle, 4 or less.
-			Size numRemainingTriangles = math::min( numLeafTriangles - k*4, Size(4) );
+			// Determine the number of triangles to go into this cached triangle, N or less.
+			Size numRemainingTriangles = math::min( numLeafTriangles - k*width, Size(width) );
 			CachedTriangle& tri = triangles[currentOutputIndex];
 			
 			// Get the triangle from the primitive set.
-			for ( Index t = 0; t < 4; t++ )
+			for ( Index t = 0; t < width; t++ )
 			{
 				// If there are no more remaining triangles, use the last valid one.
 				PrimitiveIndex clientIndex;
@@ -2010,13 +2839,13 @@ Size AABBTree4:: fillTriangleArray( CachedTriangle* triangles, const BVHGeometry
 				tri.indices[t] = clientIndex;
 			}
 			
-			currentOffset += 4;
+			currentOffset += width;
 			currentOutputIndex++;
 		}
 	}
 	else
 	{
-		for ( Index i = 0; i < 4; i++ )
+		for ( Index i = 0; i < width; i++ )
 			currentOutputIndex += fillTriangleArray( triangles, geometry, node.node->getChild(i), currentOutputIndex );
 	}
 	
@@ -2037,14 +2866,15 @@ Size AABBTree4:: fillTriangleArray( CachedTriangle* triangles, const BVHGeometry
 
 
 
-UByte* AABBTree4:: copyPrimitiveData( Size& newCapacity ) const
+template < Size width >
+UByte* AABBTree<width>:: copyPrimitiveData( Size& newCapacity ) const
 {
 	switch ( cachedPrimitiveType )
 	{
 		case BVHGeometry::TRIANGLES:
 		{
 			newCapacity = getTriangleArraySize();
-			return (UByte*)util::copyArrayAligned( (const CachedTriangle*)primitiveData, newCapacity, 16 );
+			return (UByte*)util::copyArrayAligned( (const CachedTriangle*)primitiveData, newCapacity, sizeof(SIMDFloatN) );
 		}
 		
 		default:
@@ -2055,6 +2885,87 @@ UByte* AABBTree4:: copyPrimitiveData( Size& newCapacity ) const
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		BVH Image Helper Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+template < Size width >
+Size AABBTree<width>:: getCachedPrimitiveCount() const
+{
+	if ( cachedPrimitiveType != BVHGeometry::TRIANGLES )
+		return 0;
+	
+	// Each leaf references its own range of cached triangles, so the leaf counts add up to the size of the array.
+	Size result = 0;
+	
+	for ( Index n = 0; n < numNodes; n++ )
+	{
+		for ( Index i = 0; i < width; i++ )
+		{
+			const Child& child = nodes[n].getChild(i);
+			
+			if ( Node::isLeaf( child ) )
+				result += Node::getLeafCount( child );
+		}
+	}
+	
+	return result;
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: releaseImage()
+{
+	if ( image == NULL )
+		return;
+	
+	// The image memory is owned by the client, so just forget the pointers into it.
+	primitiveIndices = NULL;
+	primitiveIndexCapacity = 0;
+	primitiveData = NULL;
+	primitiveDataCapacity = 0;
+	image = NULL;
+}
+
+
+
+
+template < Size width >
+void AABBTree<width>:: detachImage()
+{
+	if ( image == NULL )
+		return;
+	
+	const PrimitiveIndex* imageIndices = primitiveIndices;
+	const UByte* imagePrimitiveData = primitiveData;
+	const Size primitiveDataSize = getCachedPrimitiveCount()*sizeof(CachedTriangle);
+	
+	releaseImage();
+	
+	primitiveIndices = util::allocate<PrimitiveIndex>( numPrimitives );
+	primitiveIndexCapacity = numPrimitives;
+	util::copyPOD( primitiveIndices, imageIndices, numPrimitives );
+	
+	if ( primitiveDataSize > 0 )
+	{
+		primitiveData = util::allocateAligned<UByte>( primitiveDataSize, sizeof(SIMDFloatN) );
+		primitiveDataCapacity = primitiveDataSize;
+		util::copyPOD( primitiveData, imagePrimitiveData, primitiveDataSize );
+	}
+}
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -2066,25 +2977,51 @@ UByte* AABBTree4:: copyPrimitiveData( Size& newCapacity ) const
 
 
 
-Int AABBTree4:: minIndex( const SIMDFloat4& x )
+template < Size width >
+Int AABBTree<width>:: minIndex( const SIMDFloatN& x )
+{
+	// Find the minimum value, then the first component that is equal to it.
+	const SIMDFloatN wideMin = math::min( x );
+	
+	return firstSetBit( (x == wideMin).getMask() );
+}
+
+
+
+
+template < Size width >
+Int AABBTree<width>:: minIndex( const SIMDFloatN& x, SIMDFloatN& wideMin )
 {
-	const SIMDInt4 indices1( 0, 1, 2, 3 );
-	const SIMDInt4 indices2( 2, 3, 0, 1 );
+	// Compute a wide vector of the minimum value.
+	wideMin = math::min( x );
+	
+	// Find the first component that is equal to the minimum.
+	return firstSetBit( (x == wideMin).getMask() );
+}
+
+
+
+
+template <>
+Int AABBTree<4>:: minIndex( const SIMDFloatN& x )
+{
+	const SIMDIntN indices1( 0, 1, 2, 3 );
+	const SIMDIntN indices2( 2, 3, 0, 1 );
 	
 	// Shuffle the value once to find the minimum of 0 & 2, 1 & 3.
-	SIMDFloat4 x2 = math::shuffle<2,3,0,1>( x );
+	SIMDFloatN x2 = math::shuffle<2,3,0,1>( x );
 	
 	// Determine the indices of the values which are the minimum of 0 & 2, 1 & 3.
-	SIMDInt4 indices3 = math::select( x < x2, indices1, indices2 );
+	SIMDIntN indices3 = math::select( x < x2, indices1, indices2 );
 	
 	// Find the minimum of 0 & 2, 1 & 3.
 	x2 = math::min( x, x2 );
 	
 	// Shuffle the values again to determine the minimum value.
-	SIMDFloat4 x3 = math::shuffle<1,0,3,2>( x2 );
+	SIMDFloatN x3 = math::shuffle<1,0,3,2>( x2 );
 	
 	// Compute the index of the closest intersection.
-	SIMDInt4 minimumIndex = math::select( x2 < x3, indices3, math::shuffle<1,0,3,2>( indices3 ) );
+	SIMDIntN minimumIndex = math::select( x2 < x3, indices3, math::shuffle<1,0,3,2>( indices3 ) );
 	
 	return minimumIndex[0];
 }
@@ -2092,25 +3029,26 @@ Int AABBTree4:: minIndex( const SIMDFloat4& x )
 
 
 
-Int AABBTree4:: minIndex( const SIMDFloat4& x, SIMDFloat4& wideMin )
+template <>
+Int AABBTree<4>:: minIndex( const SIMDFloatN& x, SIMDFloatN& wideMin )
 {
-	const SIMDInt4 indices1( 0, 1, 2, 3 );
-	const SIMDInt4 indices2( 2, 3, 0, 1 );
+	const SIMDIntN indices1( 0, 1, 2, 3 );
+	const SIMDIntN indices2( 2, 3, 0, 1 );
 	
 	// Shuffle the value once to find the minimum of 0 & 2, 1 & 3.
-	SIMDFloat4 x2 = math::shuffle<2,3,0,1>( x );
+	SIMDFloatN x2 = math::shuffle<2,3,0,1>( x );
 	
 	// Determine the indices of the values which are the minimum of 0 & 2, 1 & 3.
-	SIMDInt4 indices3 = math::select( x < x2, indices1, indices2 );
+	SIMDIntN indices3 = math::select( x < x2, indices1, indices2 );
 	
 	// Find the minimum of 0 & 2, 1 & 3.
 	x2 = math::min( x, x2 );
 	
 	// Shuffle the values again to determine the minimum value.
-	SIMDFloat4 x3 = math::shuffle<1,0,3,2>( x2 );
+	SIMDFloatN x3 = math::shuffle<1,0,3,2>( x2 );
 	
 	// Compute the index of the closest intersection.
-	SIMDInt4 minimumIndex = math::select( x2 < x3, indices3, math::shuffle<1,0,3,2>( indices3 ) );
+	SIMDIntN minimumIndex = math::select( x2 < x3, indices3, math::shuffle<1,0,3,2>( indices3 ) );
 	
 	// Compute a 4-wide vector of the minimum value.
 	wideMin = math::min( x2, x3 );
@@ -2121,6 +3059,23 @@ Int AABBTree4:: minIndex( const SIMDFloat4& x, SIMDFloat4& wideMin )
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Explicit Template Instantiations
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+template class AABBTree<4>;
+template class AABBTree<8>;
+
+
+
+
 //##########################################################################################
 //******************************  End Om BVH Namespace  ************************************
 OM_BVH_NAMESPACE_END
@@ -30,8 +30,8 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef INCLUDE_OM_BVH_AABB_TREE_4_H
-#define INCLUDE_OM_BVH_AABB_TREE_4_H
+#ifndef INCLUDE_OM_BVH_AABB_TREE_H
+#define INCLUDE_OM_BVH_AABB_TREE_H
 
 
 #include "omBVHConfig.h"
@@ -50,11 +50,19 @@ OM_BVH_NAMESPACE_START
 
 
 //********************************************************************************
-/// A class that implements a SIMD-accelerated 4-ary bounding volume hierarchy.
+/// A class that implements a SIMD-accelerated N-ary bounding volume hierarchy.
 /**
+  * Each node stores the boxes of its children and each cached triangle packs
+  * the same number of triangles, so that a node or leaf test is a single SIMD
+  * operation of the given width. The tree is instantiated for widths 4 and 8,
+  * as AABBTree4 and AABBTree8. The 8-wide tree fills the 256-bit registers available
+  * with AVX. Without AVX, its operations fall back to scalar code and AABBTree4
+  * should be used instead.
+  *
   * For performance reasons, this implementation is limited to (2^31 - 1) billion primitives per-BVH, roughly 2.1 billion.
   */
-class AABBTree4 : public BVH
+template < Size width >
+class AABBTree : public BVH
 {
 	public:
 		
@@ -62,28 +70,28 @@ class AABBTree4 : public BVH
 		//******	Constructors
 			
 			
-			/// Create a new quad AABB tree with no primitives.
-			AABBTree4();
+			/// Create a new N-ary AABB tree with no primitives.
+			AABBTree();
 			
 			
-			/// Create a copy of the specified quad AABB tree, using the same primitives.
-			AABBTree4( const AABBTree4& other );
+			/// Create a copy of the specified N-ary AABB tree, using the same primitives.
+			AABBTree( const AABBTree& other );
 			
 			
 		//********************************************************************************
 		//******	Destructor
 			
 			
-			/// Destroy this quad AABB tree.
-			virtual ~AABBTree4();
+			/// Destroy this N-ary AABB tree.
+			virtual ~AABBTree();
 			
 			
 		//********************************************************************************
 		//******	Assignment Operator
 			
 			
-			/// Assign a copy of another quad AABB tree to this one, using the same primitives.
-			AABBTree4& operator = ( const AABBTree4& other );
+			/// Assign a copy of another N-ary AABB tree to this one, using the same primitives.
+			AABBTree& operator = ( const AABBTree& other );
 			
 			
 		//********************************************************************************
@@ -110,10 +118,60 @@ class AABBTree4 : public BVH
 			virtual void rebuild();
 			
 			
+			/// Rebuild the BVH using the current set of primitives and the threads of the specified pool.
+			/**
+			  * The primitives are binned by parallel jobs at the top levels of the tree,
+			  * and the subtrees below are then built by parallel jobs. The resulting tree
+			  * is identical to the one built by rebuild(), regardless of the number of threads.
+			  */
+			void rebuild( ThreadPool& threadPool );
+			
+			
 			/// Do a quick update of the BVH by refitting the bounding volumes without changing the hierarchy.
 			virtual void refit();
 			
 			
+		//********************************************************************************
+		//******	BVH Image Methods
+			
+			
+			/// Return the size in bytes of the image of this BVH that is written by writeImage().
+			/**
+			  * If the BVH is not built, the method returns 0.
+			  */
+			Size getImageSize() const;
+			
+			
+			/// Write an image of this built BVH to the specified memory, which must hold getImageSize() bytes.
+			/**
+			  * The image contains the tree's nodes with child offsets in place of pointers,
+			  * followed by the primitive indices and cached primitives, so that it can be
+			  * stored in a file and later passed to setImage() instead of rebuilding the tree.
+			  * The memory must be aligned to IMAGE_ALIGNMENT bytes. The method returns
+			  * whether or not the image was written.
+			  */
+			Bool writeImage( UByte* image ) const;
+			
+			
+			/// Use an image of a BVH for this BVH's geometry instead of rebuilding the tree.
+			/**
+			  * The nodes are copied from the image, but the primitive indices and cached
+			  * primitives are used in place, so the image memory (e.g. a memory-mapped file)
+			  * must stay valid and unchanged until the BVH is rebuilt or destroyed. The image must
+			  * be aligned to IMAGE_ALIGNMENT bytes. If the image is not valid or was written for a
+			  * different number or type of primitives, FALSE is returned and the BVH is not changed.
+			  */
+			Bool setImage( const UByte* image, Size imageSize );
+		
+		
+		//********************************************************************************
+		//******	Public Static Data Members
+			
+			
+			/// The alignment in bytes that is required for the memory of a BVH image.
+			static const Size IMAGE_ALIGNMENT = 32*width;
+		
+		
 		//********************************************************************************
 		//******	Ray Tracing Methods
 			
@@ -127,8 +185,9 @@ class AABBTree4 : public BVH
 			
 			/// Test whether or not the specified ray hits anything in this BVH.
 			/**
-			  * The ray is populated with information about whether or not the ray was hit,
-			  * but no intersection results are provided.
+			  * The traversal stops as soon as any primitive closer than the ray's tMax
+			  * is hit, so the ray's intersection results describe that primitive, which
+			  * is not necessarily the closest one.
 			  *
 			  * This method can be faster than the intersectRay() method if only a
 			  * boolean occlusion result is needed.
@@ -136,6 +195,28 @@ class AABBTree4 : public BVH
 			virtual void testRay( BVHRay& ray ) const;
 			
 			
+			/// Trace the specified contiguous array of rays through this BVH and get the closest intersection for each.
+			/**
+			  * The rays are traced in packets of up to 8 consecutive rays that share one
+			  * traversal stack, so that each node is loaded once for all of the rays in
+			  * the packet that reach it. Rays with similar origins and directions, such as
+			  * rays from a common origin, should be adjacent in the array.
+			  *
+			  * Each ray finds the same closest distance as with intersectRay(). Only the
+			  * choice among several primitives at exactly that distance can differ.
+			  */
+			virtual void intersectRays( BVHRay* rays, Size numRays ) const;
+			
+			
+			/// Test whether or not each ray in the specified contiguous array hits anything in this BVH.
+			/**
+			  * The rays are traced in packets like intersectRays(). A ray stops
+			  * when it hits its first primitive, and the packet stops when all of its
+			  * rays have hit something or have finished their traversal.
+			  */
+			virtual void testRays( BVHRay* rays, Size numRays ) const;
+			
+			
 		//********************************************************************************
 		//******	BVH Attribute Accessor Methods
 			
@@ -194,7 +275,7 @@ class AABBTree4 : public BVH
 		//******	Private Class Declarations
 			
 			
-			/// A class that represents a single node in the quad AABB tree.
+			/// A class that represents a single node in the N-ary AABB tree.
 			class Node;
 			
 			
@@ -210,14 +291,38 @@ class AABBTree4 : public BVH
 			class CachedTriangle;
 			
 			
+			/// A class that describes the layout of a BVH image.
+			class ImageHeader;
+			
+			
 			/// A ray class with extra data used to speed up intersection tests.
 			class TraversalRay;
 			
 			
+			/// A class that describes a subtree whose construction is deferred to a parallel job.
+			class Subtree;
+			
+			
+			/// A class that stores the state of a parallel tree build.
+			class ParallelBuild;
+			
+			
 			/// Define the type to use for offsets in the BVH.
 			typedef UInt32 IndexType;
 			
 			
+			/// Define the SIMD type to use for a value for each child of a node.
+			typedef math::SIMDScalar<Float32,width> SIMDFloatN;
+			
+			
+			/// Define the SIMD type to use for an integer or mask for each child of a node.
+			typedef math::SIMDScalar<Int32,width> SIMDIntN;
+			
+			
+			/// Define the type to use for a set of N 3D vectors in structure-of-arrays format.
+			typedef math::SIMDVector3D<Float32,width> SIMDVector3fN;
+			
+			
 			/// A union type used to store either a pointer to a child node or leaf node info.
 			typedef union Child
 			{
@@ -240,24 +345,46 @@ class AABBTree4 : public BVH
 		//******	Private Ray Tracing Methods
 			
 			
-			OM_FORCE_INLINE static Bool traceRayVsNode( const TraversalRay& ray, const SIMDFloat4& tMin, const SIMDFloat4& tMax,
+			OM_FORCE_INLINE static Bool traceRayVsNode( const TraversalRay& ray, const SIMDFloatN& tMin, const SIMDFloatN& tMax,
 														Child& childNode, Child*& stack );
 			
 			
 			/// Trace a ray through the BVH for generic-typed primitives.
+			/**
+			  * If the template parameter is TRUE, the traversal stops at the first primitive
+			  * that is hit rather than finding the closest intersection.
+			  */
+			template < Bool anyHit >
 			OM_FORCE_INLINE void traceRayVsGeneric( BVHRay& ray ) const;
 			
 			
 			/// Trace a ray through the BVH for cached triangle primitives.
+			/**
+			  * If the template parameter is TRUE, the traversal stops at the first triangle
+			  * that is hit rather than finding the closest intersection.
+			  */
+			template < Bool anyHit >
 			OM_FORCE_INLINE void traceRayVsTriangles( BVHRay& ray ) const;
 			
 			
+			/// Trace a packet of up to PACKET_SIZE rays through the BVH with a shared traversal stack.
+			/**
+			  * Each stack entry stores a mask of the rays in the packet that hit the entry's
+			  * node. A ray is only tested against the children and primitives of the nodes
+			  * that it hits. If the first template parameter is TRUE, each ray stops at the
+			  * first primitive that it hits. The second template parameter is TRUE if the
+			  * primitives are cached triangles.
+			  */
+			template < Bool anyHit, Bool cachedTriangles >
+			void tracePacket( BVHRay* rays, Size numRays ) const;
+			
+			
 		//********************************************************************************
 		//******	Private Ray-Primitive Intersection Methods
 			
 			
 			/// Trace a ray through the BVH for cached triangle primitives.
-			OM_FORCE_INLINE static void rayIntersectsTriangles( const TraversalRay& ray, BVHRay& rayData, const SIMDFloat4& tMin, SIMDFloat4& tMax,
+			OM_FORCE_INLINE static void rayIntersectsTriangles( const TraversalRay& ray, BVHRay& rayData, const SIMDFloatN& tMin, SIMDFloatN& tMax,
 																const CachedTriangle& triangle );
 			
 			
@@ -265,14 +392,27 @@ class AABBTree4 : public BVH
 		//******	Private Tree Bulding Methods
 			
 			
+			/// Rebuild the tree, using the specified thread pool for a parallel build if it is not NULL.
+			void rebuildTree( ThreadPool* threadPool );
+			
+			
 			/// Build a tree starting at the specified node using the specified objects.
 			/**
 			  * This method returns the number of nodes in the tree created.
+			  *
+			  * If a parallel build is specified, the space for inner child subtrees that are small enough
+			  * is reserved and the subtrees are added to the parallel build rather than being built.
 			  */
 			static Size buildTreeRecursive( Node* node, const PrimitiveAABB* primitiveAABBs,
 											PrimitiveIndex* primitiveIndices, PrimitiveIndex start, PrimitiveCount numPrimitives,
 											SplitBin* splitBins, Size numSplitCandidates,
-											Size maxNumObjectsPerLeaf, Size depth, Size& maxDepth );
+											Size maxNumObjectsPerLeaf, Size depth, Size& maxDepth,
+											ParallelBuild* parallelBuild = NULL );
+			
+			
+			/// Build one of the subtrees that was deferred by a parallel build.
+			static void buildSubtree( Subtree* subtree, const PrimitiveAABB* primitiveAABBs, PrimitiveIndex* primitiveIndices,
+										Size numSplitCandidates, Size maxNumObjectsPerLeaf );
 			
 			
 			/// Partition the specified list of objects into two sets based on the given split plane.
@@ -284,7 +424,16 @@ class AABBTree4 : public BVH
 			static void partitionPrimitivesSAH( const PrimitiveAABB* primitiveAABBs, PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives,
 												SplitBin* splitBins, Size numSplitCandidates,
 												Index& axis, PrimitiveCount& numLesserObjects,
-												AABB3f& lesserVolume, AABB3f& greaterVolume );
+												AABB3f& lesserVolume, AABB3f& greaterVolume,
+												ThreadPool* threadPool = NULL );
+			
+			
+			/// Add the specified objects to the split bins for each of the 3 axes.
+			/**
+			  * The split bins are stored as 3 consecutive arrays of the given number of bins, one per axis.
+			  */
+			static void binPrimitives( const PrimitiveAABB* primitiveAABBs, const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives,
+										Vector3f binningConstant, Vector3f binsStart, Size numSplitBins, SplitBin* splitBins );
 			
 			
 			/// Partition the specified list of objects into two sets based on their median along the given axis.
@@ -293,6 +442,11 @@ class AABBTree4 : public BVH
 												AABB3f& lesserVolume, AABB3f& greaterVolume );
 			
 			
+			/// Initialize the cached bounding boxes for the specified range of primitives in a geometry.
+			static void computePrimitiveAABBs( const BVHGeometry* geometry, PrimitiveAABB* primitiveAABBs,
+												PrimitiveIndex start, PrimitiveCount numPrimitives );
+			
+			
 			/// Compute the axis-aligned bounding box for the specified list of objects.
 			static AABB3f computeAABBForPrimitives( const PrimitiveAABB* primitiveAABBs,
 													const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives );
@@ -342,12 +496,28 @@ class AABBTree4 : public BVH
 			UByte* copyPrimitiveData( Size& newCapacity ) const;
 			
 			
+			/// Return the number of cached primitives that are referenced by this tree's leaf nodes.
+			Size getCachedPrimitiveCount() const;
+			
+			
+			/// Stop using the primitives of a BVH image, without deallocating them.
+			void releaseImage();
+			
+			
+			/// Replace the primitives of a BVH image with private copies that can be modified.
+			void detachImage();
+			
+			
+			/// Copy the subtree with the specified root node to an array in depth-first order, returning the number of nodes copied.
+			static Size packTree( const Node& node, Node* output );
+			
+			
 			/// Return the index of the smallest value in the specified SIMD float.
-			OM_FORCE_INLINE static Int minIndex( const SIMDFloat4& x );
+			OM_FORCE_INLINE static Int minIndex( const SIMDFloatN& x );
 			
 			
 			/// Return the index of the smallest value in the specified SIMD float, placing the expanded min value in the output parameter.
-			OM_FORCE_INLINE static Int minIndex( const SIMDFloat4& x, SIMDFloat4& wideMin );
+			OM_FORCE_INLINE static Int minIndex( const SIMDFloatN& x, SIMDFloatN& wideMin );
 			
 			
 		//********************************************************************************
@@ -359,15 +529,27 @@ class AABBTree4 : public BVH
 			
 			
 			/// The number of entries that a traversal stack should be able to hold.
-			static const Size TRAVERSAL_STACK_SIZE = 4*MAX_TREE_DEPTH;
+			static const Size TRAVERSAL_STACK_SIZE = width*MAX_TREE_DEPTH;
+			
+			
+			/// The maximum number of rays that are traced together by intersectRays() and testRays().
+			static const Size PACKET_SIZE = 8;
 			
 			
 			/// The default intial number of splitting plane candidates that are considered when building the tree.
 			static const Size DEFAULT_NUM_SPLIT_CANDIDATES = 32;
 			
 			
+			/// The minimum number of primitives for which the SAH binning is split into parallel jobs.
+			static const PrimitiveCount MIN_PARALLEL_BINNING_SIZE = 1 << 15;
+			
+			
+			/// The minimum number of primitives that a parallel build puts in a deferred subtree job.
+			static const PrimitiveCount MIN_PARALLEL_SUBTREE_SIZE = 1 << 12;
+			
+			
 			/// The default maximum number of primitives that can be in a leaf node.
-			static const PrimitiveCount DEFAULT_MAX_PRIMITIVES_PER_LEAF = 4;
+			static const PrimitiveCount DEFAULT_MAX_PRIMITIVES_PER_LEAF = width;
 			
 			
 		//********************************************************************************
@@ -378,11 +560,11 @@ class AABBTree4 : public BVH
 			Node* nodes;
 			
 			
-			/// The number of nodes that are in this quad AABB tree.
+			/// The number of nodes that are in this N-ary AABB tree.
 			Size numNodes;
 			
 			
-			/// The number of primitives that are part of this qaud AABB tree.
+			/// The number of primitives that are part of this N-ary AABB tree.
 			IndexType numPrimitives;
 			
 			
@@ -406,6 +588,10 @@ class AABBTree4 : public BVH
 			Size primitiveDataCapacity;
 			
 			
+			/// A pointer to the BVH image whose primitives are used in place, or NULL if the primitives are owned.
+			const UByte* image;
+			
+			
 			/// An opaque interface to the geometry contained in this tree.
 			BVHGeometry* geometry;
 			
@@ -414,7 +600,7 @@ class AABBTree4 : public BVH
 			BVHGeometry::Type cachedPrimitiveType;
 			
 			
-			/// The maximum depth of the hierarchy of this quad AABB tree.
+			/// The maximum depth of the hierarchy of this N-ary AABB tree.
 			Size maxDepth;
 			
 			
@@ -422,7 +608,7 @@ class AABBTree4 : public BVH
 			Size numSplitCandidates;
 			
 			
-			/// The maximum number of primitives that this quad AABB tree can have per leaf node.
+			/// The maximum number of primitives that this N-ary AABB tree can have per leaf node.
 			PrimitiveCount maxNumPrimitivesPerLeaf;
 			
 			
@@ -431,6 +617,16 @@ class AABBTree4 : public BVH
 
 
 
+/// A SIMD-accelerated 4-ary bounding volume hierarchy.
+typedef AABBTree<4> AABBTree4;
+
+
+/// A SIMD-accelerated 8-ary bounding volume hierarchy.
+typedef AABBTree<8> AABBTree8;
+
+
+
+
 
 //##########################################################################################
 //******************************  End Om BVH Namespace  ************************************
@@ -439,4 +635,4 @@ OM_BVH_NAMESPACE_END
 //##########################################################################################
 
 
-#endif // INCLUDE_OM_BVH_AABB_TREE_4_H
+#endif // INCLUDE_OM_BVH_AABB_TREE_H
@@ -66,6 +66,24 @@ void BVH:: refit()
 
 
 
+void BVH:: intersectRays( BVHRay* rays, Size numRays ) const
+{
+	for ( Index i = 0; i < numRays; i++ )
+		this->intersectRay( rays[i] );
+}
+
+
+
+
+void BVH:: testRays( BVHRay* rays, Size numRays ) const
+{
+	for ( Index i = 0; i < numRays; i++ )
+		this->testRay( rays[i] );
+}
+
+
+
+
 Sphere3f BVH:: getBoundingSphere() const
 {
 	AABB3f bbox = this->getAABB();
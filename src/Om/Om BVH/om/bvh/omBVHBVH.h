@@ -125,6 +125,24 @@ class BVH
 			virtual void testRay( BVHRay& ray ) const = 0;
 			
 			
+			/// Trace the specified contiguous array of rays through this BVH and get the closest intersection for each.
+			/**
+			  * Each ray is populated with information about its intersection, exactly
+			  * as if intersectRay() was called for it. Implementations can trace the rays
+			  * together to share traversal work among coherent rays.
+			  *
+			  * The default implementation calls intersectRay() for each ray.
+			  */
+			virtual void intersectRays( BVHRay* rays, Size numRays ) const;
+			
+			
+			/// Test whether or not each ray in the specified contiguous array hits anything in this BVH.
+			/**
+			  * The default implementation calls testRay() for each ray.
+			  */
+			virtual void testRays( BVHRay* rays, Size numRays ) const;
+			
+			
 		//********************************************************************************
 		//******	BVH Attribute Accessor Methods
 			
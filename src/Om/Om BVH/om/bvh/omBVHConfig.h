@@ -110,6 +110,8 @@ using om::math::Sphere3d;
 
 using om::math::SIMDFloat4;
 using om::math::SIMDInt4;
+using om::math::SIMDFloat8;
+using om::math::SIMDInt8;
 
 
 typedef om::math::SIMDVector3D<Float32,4> SIMDVector3f;
@@ -31,6 +31,7 @@
  */
 
 #include "omBVHGeometry.h"
+#include "omBVHRay.h"
 
 
 //##########################################################################################
@@ -129,6 +130,30 @@ void BVHGeometry:: intersectRay( const PrimitiveIndex* primitiveIndices, Primiti
 
 
 
+void BVHGeometry:: testRay( PrimitiveIndex primitiveIndex, BVHRay& ray ) const
+{
+	this->intersectRay( primitiveIndex, ray );
+}
+
+
+
+
+void BVHGeometry:: testRay( const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives, BVHRay& ray ) const
+{
+	const Float tMaxInput = ray.tMax;
+	
+	for ( PrimitiveIndex i = 0; i < numPrimitives; i++ )
+	{
+		this->testRay( primitiveIndices[i], ray );
+		
+		if ( ray.tMax < tMaxInput )
+			return;
+	}
+}
+
+
+
+
 //##########################################################################################
 //******************************  End Om BVH Namespace  ************************************
 OM_BVH_NAMESPACE_END
@@ -194,6 +194,23 @@ class BVHGeometry
 			virtual void intersectRay( const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives, BVHRay& ray ) const;
 			
 			
+			/// Test whether or not the primitive with the specified index is intersected by the specified ray.
+			/**
+			  * If there is an intersection closer than the ray's tMax, the ray's
+			  * hit information should be updated, but the intersection does not need to
+			  * be the closest one. The default implementation calls intersectRay().
+			  */
+			virtual void testRay( PrimitiveIndex primitiveIndex, BVHRay& ray ) const;
+			
+			
+			/// Test whether or not any of the primitives with the specified indices are intersected by the specified ray.
+			/**
+			  * The default implementation calls the single-primitive version of testRay()
+			  * and stops after the first primitive that is intersected by the ray.
+			  */
+			virtual void testRay( const PrimitiveIndex* primitiveIndices, PrimitiveCount numPrimitives, BVHRay& ray ) const;
+		
+		
 		//********************************************************************************
 		//******	User Data Accessor Methods
 			
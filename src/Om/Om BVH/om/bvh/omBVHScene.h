@@ -38,7 +38,7 @@
 
 
 #include "omBVHBVH.h"
-#include "omAABBTree4.h"
+#include "omAABBTree.h"
 #include "omBVHTransform.h"
 
 
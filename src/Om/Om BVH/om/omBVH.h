@@ -43,7 +43,7 @@
 
 
 #include "bvh/omBVHBVH.h"
-#include "bvh/omAABBTree4.h"
+#include "bvh/omAABBTree.h"
 
 
 #include "bvh/omBVHInstance.h"
@@ -258,6 +258,92 @@ class Xoroshiro128
 
 
 
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Philox4x32 Counter-Based RNG Class
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// An implementation of the Philox4x32-10 counter-based pseudorandom number generator.
+/**
+  * Original version by John Salmon, Mark Moraes, Ron Dror and David Shaw
+  * ("Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011).
+  *
+  * Unlike the sequential generators, Philox has no state that is advanced between
+  * outputs. Each 128-bit counter value is mapped by a keyed bijection to 128 random bits,
+  * so any element of a random stream can be computed directly from its counter
+  * without generating the elements that precede it. This makes the output independent
+  * of how work is scheduled among threads or processes.
+  */
+class Philox4x32
+{
+	public:
+		
+		
+		/// The number of 32-bit words in a counter and output block.
+		static const Size COUNTER_SIZE = 4;
+		
+		
+		/// The number of 32-bit words in a key.
+		static const Size KEY_SIZE = 2;
+		
+		
+		/// Compute the 128-bit random output block for the specified counter and key.
+		OM_FORCE_INLINE static void generate( const UInt32 counter[COUNTER_SIZE], const UInt32 key[KEY_SIZE],
+											UInt32 output[COUNTER_SIZE] )
+		{
+			UInt32 c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+			UInt32 k0 = key[0], k1 = key[1];
+			
+			for ( Index i = 0; i < NUM_ROUNDS; i++ )
+			{
+				const UInt64 product0 = UInt64(MULTIPLIER_0)*c0;
+				const UInt64 product1 = UInt64(MULTIPLIER_1)*c2;
+				
+				c0 = UInt32(product1 >> 32) ^ c1 ^ k0;
+				c1 = UInt32(product1);
+				c2 = UInt32(product0 >> 32) ^ c3 ^ k1;
+				c3 = UInt32(product0);
+				
+				// Bump the key for the next round.
+				k0 += WEYL_0;
+				k1 += WEYL_1;
+			}
+			
+			output[0] = c0;
+			output[1] = c1;
+			output[2] = c2;
+			output[3] = c3;
+		}
+	
+	
+	private:
+		
+		/// The number of rounds of the bijection that are applied to each counter.
+		static const Size NUM_ROUNDS = 10;
+		
+		/// The multiplier for the first pair of counter words.
+		static const UInt32 MULTIPLIER_0 = 0xD2511F53;
+		
+		/// The multiplier for the second pair of counter words.
+		static const UInt32 MULTIPLIER_1 = 0xCD9E8D57;
+		
+		/// The increment for the first key word between rounds (the golden ratio).
+		static const UInt32 WEYL_0 = 0x9E3779B9;
+		
+		/// The increment for the second key word between rounds (sqrt(3) - 1).
+		static const UInt32 WEYL_1 = 0xBB67AE85;
+		
+};
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
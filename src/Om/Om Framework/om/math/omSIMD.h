@@ -45,8 +45,10 @@
 #include "omSIMDScalar.h"
 #include "omSIMDScalarInt16_8.h"
 #include "omSIMDScalarInt32_4.h"
+#include "omSIMDScalarInt32_8.h"
 #include "omSIMDScalarInt64_2.h"
 #include "omSIMDScalarFloat32_4.h"
+#include "omSIMDScalarFloat32_8.h"
 #include "omSIMDScalarFloat64_2.h"
 
 // SIMD Array Classes.
@@ -71,8 +73,10 @@ OM_MATH_NAMESPACE_START
 
 // SIMD Scalar Type Definitions for the given primitive type.
 typedef SIMDScalar<Float32,4>	SIMDFloat4;
+typedef SIMDScalar<Float32,8>	SIMDFloat8;
 typedef SIMDScalar<Float64,2>	SIMDDouble2;
 typedef SIMDScalar<Int32,4>		SIMDInt4;
+typedef SIMDScalar<Int32,8>		SIMDInt8;
 
 
 //##########################################################################################
@@ -0,0 +1,777 @@
+/*
+ * Project:     Om Software
+ * Version:     1.0.0
+ * Website:     http://www.carlschissler.com/om
+ * Author(s):   Carl Schissler
+ * 
+ * Copyright (c) 2016, Carl Schissler
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright
+ * 	   notice, this list of conditions and the following disclaimer.
+ * 	2. Redistributions in binary form must reproduce the above copyright
+ * 	   notice, this list of conditions and the following disclaimer in the
+ * 	   documentation and/or other materials provided with the distribution.
+ * 	3. Neither the name of the copyright holder nor the
+ * 	   names of its contributors may be used to endorse or promote products
+ * 	   derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_OM_SIMD_SCALAR_FLOAT_32_8_H
+#define INCLUDE_OM_SIMD_SCALAR_FLOAT_32_8_H
+
+
+#include "omMathConfig.h"
+
+
+#include "omSIMDScalar.h"
+#include "omSIMDScalarInt32_8.h"
+
+
+//##########################################################################################
+//******************************  Start Om Math Namespace  *********************************
+OM_MATH_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class representing an 8-component 32-bit floating-point SIMD scalar.
+/**
+  * This specialization of the SIMDScalar class uses a 256-bit AVX value to encode
+  * 8 32-bit floating-point values if AVX is enabled at compile time. Otherwise,
+  * the operations fall back to scalar code.
+  */
+template <>
+class OM_ALIGN(32) SIMDScalar<Float32,8>
+{
+	public:
+		
+		//********************************************************************************
+		//******	Public Type Declarations
+			
+			
+			/// The platform-specific vector type to use for 8 32-bit floats.
+			typedef SIMDTypeN<Float32,8>::Vector Float32x8;
+			
+			
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a new 8D SIMD scalar with all elements left uninitialized.
+			OM_FORCE_INLINE SIMDScalar()
+			{
+			}
+			
+			
+			/// Create a new 8D scalar with the specified raw float value.
+			OM_FORCE_INLINE SIMDScalar( Float32x8 rawFloat32x8 )
+				:	vf( rawFloat32x8 )
+			{
+			}
+			
+			
+			/// Create a new 8D scalar by converting the specified 8D integer SIMD scalar to floating point.
+			OM_FORCE_INLINE explicit SIMDScalar( const SIMDScalar<Int32,8>& simdScalar )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = _mm256_cvtepi32_ps( _mm256_castps_si256( simdScalar.vf ) );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = (Float32)simdScalar.x[i];
+#endif
+			}
+			
+			
+			/// Create a new 8D SIMD scalar with all elements equal to the specified value.
+			OM_FORCE_INLINE SIMDScalar( Float32 value )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = _mm256_set1_ps( value );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = value;
+#endif
+			}
+			
+			
+			/// Create a new 8D SIMD scalar with the elements equal to the specified 8 values.
+			OM_FORCE_INLINE SIMDScalar( Float32 a, Float32 b, Float32 c, Float32 d, Float32 e, Float32 f, Float32 g, Float32 h )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = _mm256_setr_ps( a, b, c, d, e, f, g, h );
+#else
+				x[0] = a; x[1] = b; x[2] = c; x[3] = d; x[4] = e; x[5] = f; x[6] = g; x[7] = h;
+#endif
+			}
+			
+			
+			/// Create a new 8D SIMD scalar from the first 8 values stored at specified pointer's location.
+			OM_FORCE_INLINE explicit SIMDScalar( const Float32* array )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = _mm256_loadu_ps( array );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = array[i];
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Copy Constructor
+			
+			
+			/// Create a new SIMD scalar with the same contents as another.
+			OM_FORCE_INLINE SIMDScalar( const SIMDScalar& other )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = other.vf;
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = other.x[i];
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Assignment Operator
+			
+			
+			/// Assign the contents of one SIMDScalar object to another.
+			OM_FORCE_INLINE SIMDScalar& operator = ( const SIMDScalar& other )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = other.vf;
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = other.x[i];
+#endif
+				return *this;
+			}
+			
+			
+		//********************************************************************************
+		//******	Load Methods
+			
+			
+			/// Load a SIMD scalar from the specified aligned pointer to values.
+			OM_FORCE_INLINE static SIMDScalar load( const Float32* array )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_load_ps( array ) );
+#else
+				return SIMDScalar( array );
+#endif
+			}
+			
+			
+			/// Load a SIMD scalar from the specified unaligned pointer to values.
+			OM_FORCE_INLINE static SIMDScalar loadUnaligned( const Float32* array )
+			{
+				return SIMDScalar( array );
+			}
+			
+			
+		//********************************************************************************
+		//******	Store Method
+			
+			
+			/// Store this SIMD scalar starting at the specified aligned destination pointer.
+			OM_FORCE_INLINE void store( Float32* destination ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				_mm256_store_ps( destination, vf );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					destination[i] = x[i];
+#endif
+			}
+			
+			
+			/// Store this SIMD scalar starting at the specified unaligned destination pointer.
+			OM_FORCE_INLINE void storeUnaligned( Float32* destination ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				_mm256_storeu_ps( destination, vf );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					destination[i] = x[i];
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Accessor Methods
+			
+			
+			/// Get a reference to the value stored at the specified component index in this scalar.
+			OM_FORCE_INLINE Float32& operator [] ( Index i )
+			{
+				return x[i];
+			}
+			
+			
+			/// Get the value stored at the specified component index in this scalar.
+			OM_FORCE_INLINE Float32 operator [] ( Index i ) const
+			{
+				return x[i];
+			}
+			
+			
+			/// Get a pointer to the first element in this scalar.
+			OM_FORCE_INLINE const Float32* toArray() const
+			{
+				return x;
+			}
+			
+			
+		//********************************************************************************
+		//******	Logical Operators
+			
+			
+			/// Compute the bitwise AND of this 8D SIMD vector with a mask and return the result.
+			OM_FORCE_INLINE SIMDScalar operator & ( const SIMDScalar<Int32,8>& vector ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_and_ps( vf, vector.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.xi[i] = xi[i] & vector.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Compute the bitwise OR of this 8D SIMD vector with a mask and return the result.
+			OM_FORCE_INLINE SIMDScalar operator | ( const SIMDScalar<Int32,8>& vector ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_or_ps( vf, vector.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.xi[i] = xi[i] | vector.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Comparison Operators
+			
+			
+			/// Perform a component-wise equality comparison between this an another 8D SIMD scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator == ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar<Int32,8>( _mm256_cmp_ps( vf, scalar.vf, _CMP_EQ_OQ ) );
+#else
+				SIMDScalar<Int32,8> result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -Int32(x[i] == scalar.x[i]);
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Perform a component-wise equality comparison between this 8D SIMD scalar and an expanded scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator == ( const Float32 value ) const
+			{
+				return *this == SIMDScalar( value );
+			}
+			
+			
+			/// Perform a component-wise inequality comparison between this an another 8D SIMD scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator != ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar<Int32,8>( _mm256_cmp_ps( vf, scalar.vf, _CMP_NEQ_UQ ) );
+#else
+				SIMDScalar<Int32,8> result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -Int32(x[i] != scalar.x[i]);
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Perform a component-wise inequality comparison between this 8D SIMD scalar and an expanded scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator != ( const Float32 value ) const
+			{
+				return *this != SIMDScalar( value );
+			}
+			
+			
+			/// Perform a component-wise less-than comparison between this an another 8D SIMD scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator < ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar<Int32,8>( _mm256_cmp_ps( vf, scalar.vf, _CMP_LT_OQ ) );
+#else
+				SIMDScalar<Int32,8> result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -Int32(x[i] < scalar.x[i]);
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Perform a component-wise less-than comparison between this 8D SIMD scalar and an expanded scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator < ( const Float32 value ) const
+			{
+				return *this < SIMDScalar( value );
+			}
+			
+			
+			/// Perform a component-wise greater-than comparison between this an another 8D SIMD scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator > ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar<Int32,8>( _mm256_cmp_ps( vf, scalar.vf, _CMP_GT_OQ ) );
+#else
+				SIMDScalar<Int32,8> result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -Int32(x[i] > scalar.x[i]);
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Perform a component-wise greater-than comparison between this 8D SIMD scalar and an expanded scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator > ( const Float32 value ) const
+			{
+				return *this > SIMDScalar( value );
+			}
+			
+			
+			/// Perform a component-wise less-than-or-equal-to comparison between this an another 8D SIMD scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator <= ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar<Int32,8>( _mm256_cmp_ps( vf, scalar.vf, _CMP_LE_OQ ) );
+#else
+				SIMDScalar<Int32,8> result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -Int32(x[i] <= scalar.x[i]);
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Perform a component-wise less-than-or-equal-to comparison between this 8D SIMD scalar and an expanded scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator <= ( const Float32 value ) const
+			{
+				return *this <= SIMDScalar( value );
+			}
+			
+			
+			/// Perform a component-wise greater-than-or-equal-to comparison between this an another 8D SIMD scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator >= ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar<Int32,8>( _mm256_cmp_ps( vf, scalar.vf, _CMP_GE_OQ ) );
+#else
+				SIMDScalar<Int32,8> result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -Int32(x[i] >= scalar.x[i]);
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Perform a component-wise greater-than-or-equal-to comparison between this 8D SIMD scalar and an expanded scalar.
+			OM_FORCE_INLINE SIMDScalar<Int32,8> operator >= ( const Float32 value ) const
+			{
+				return *this >= SIMDScalar( value );
+			}
+			
+			
+		//********************************************************************************
+		//******	Negation/Positivation Operators
+			
+			
+			/// Negate a scalar.
+			OM_FORCE_INLINE SIMDScalar operator - () const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_sub_ps( _mm256_setzero_ps(), vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Return the scalar unmodified.
+			OM_FORCE_INLINE SIMDScalar operator + () const
+			{
+				return *this;
+			}
+			
+			
+		//********************************************************************************
+		//******	Arithmetic Operators
+			
+			
+			/// Add this scalar to another and return the result.
+			OM_FORCE_INLINE SIMDScalar operator + ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_add_ps( vf, scalar.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] + scalar.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Add a value to every component of this scalar.
+			OM_FORCE_INLINE SIMDScalar operator + ( const Float32 value ) const
+			{
+				return *this + SIMDScalar( value );
+			}
+			
+			
+			/// Subtract a scalar from this scalar component-wise and return the result.
+			OM_FORCE_INLINE SIMDScalar operator - ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_sub_ps( vf, scalar.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] - scalar.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Subtract a value from every component of this scalar.
+			OM_FORCE_INLINE SIMDScalar operator - ( const Float32 value ) const
+			{
+				return *this - SIMDScalar( value );
+			}
+			
+			
+			/// Multiply component-wise this scalar and another scalar and return the result.
+			OM_FORCE_INLINE SIMDScalar operator * ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_mul_ps( vf, scalar.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] * scalar.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Multiply every component of this scalar by a value.
+			OM_FORCE_INLINE SIMDScalar operator * ( const Float32 value ) const
+			{
+				return *this * SIMDScalar( value );
+			}
+			
+			
+			/// Divide this scalar by another scalar component-wise and return the result.
+			OM_FORCE_INLINE SIMDScalar operator / ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_div_ps( vf, scalar.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] / scalar.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Divide every component of this scalar by a value.
+			OM_FORCE_INLINE SIMDScalar operator / ( const Float32 value ) const
+			{
+				return *this / SIMDScalar( value );
+			}
+			
+			
+		//********************************************************************************
+		//******	Arithmetic Assignment Operators
+			
+			
+			/// Add a scalar to this scalar, modifying this original scalar.
+			OM_FORCE_INLINE SIMDScalar& operator += ( const SIMDScalar& scalar )
+			{
+				return *this = *this + scalar;
+			}
+			
+			
+			/// Subtract a scalar from this scalar, modifying this original scalar.
+			OM_FORCE_INLINE SIMDScalar& operator -= ( const SIMDScalar& scalar )
+			{
+				return *this = *this - scalar;
+			}
+			
+			
+			/// Multiply component-wise this scalar and another scalar and modify this scalar.
+			OM_FORCE_INLINE SIMDScalar& operator *= ( const SIMDScalar& scalar )
+			{
+				return *this = *this * scalar;
+			}
+			
+			
+			/// Divide this scalar by another scalar component-wise and modify this scalar.
+			OM_FORCE_INLINE SIMDScalar& operator /= ( const SIMDScalar& scalar )
+			{
+				return *this = *this / scalar;
+			}
+			
+			
+		//********************************************************************************
+		//******	Public Data Members
+			
+			
+			/// The number of components there are in this scalar.
+			static const Size WIDTH = SIMDTypeN<Float32,8>::WIDTH;
+			
+			
+			/// The required alignment of this scalar type.
+			static const Size ALIGNMENT = SIMDTypeN<Float32,8>::ALIGNMENT;
+			
+			
+			union OM_ALIGN(32)
+			{
+				/// The platform-specific vector to use for 8 32-bit floats.
+				Float32x8 vf;
+				
+				/// The components of an 8D SIMD scalar in array format.
+				Float32 x[8];
+				
+				/// The components of an 8D SIMD scalar reinterpreted as integer bits.
+				Int32 xi[8];
+			};
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Free Vector Functions
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// Compute the absolute value of each component of the specified SIMD scalar and return the result.
+OM_FORCE_INLINE SIMDScalar<Float32,8> abs( const SIMDScalar<Float32,8>& scalar )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	return SIMDScalar<Float32,8>( _mm256_andnot_ps( _mm256_set1_ps( Float32(-0.0) ), scalar.vf ) );
+#else
+	SIMDScalar<Float32,8> result;
+	
+	for ( Index i = 0; i < 8; i++ )
+		result.x[i] = math::abs( scalar.x[i] );
+	
+	return result;
+#endif
+}
+
+
+
+
+/// Return an approximate reciprocal of the specified value with 23 bits of precision.
+OM_FORCE_INLINE SIMDScalar<Float32,8> reciprocal( const SIMDScalar<Float32,8>& v )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	// Compute reciprocal approximation, 12 bits of precision.
+	SIMDScalar<Float32,8> rcp( _mm256_rcp_ps( v.vf ) );
+	
+	// One iteration of newton-raphson increases to 23 bits of precision.
+	return (rcp + rcp) - v*(rcp*rcp);
+#else
+	return SIMDScalar<Float32,8>( Float32(1) ) / v;
+#endif
+}
+
+
+
+
+/// Compute the square root of each component of the specified SIMD scalar and return the result.
+OM_FORCE_INLINE SIMDScalar<Float32,8> sqrt( const SIMDScalar<Float32,8>& scalar )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	return SIMDScalar<Float32,8>( _mm256_sqrt_ps( scalar.vf ) );
+#else
+	SIMDScalar<Float32,8> result;
+	
+	for ( Index i = 0; i < 8; i++ )
+		result.x[i] = math::sqrt( scalar.x[i] );
+	
+	return result;
+#endif
+}
+
+
+
+
+/// Select elements from the first SIMD scalar if the selector is TRUE, otherwise from the second.
+OM_FORCE_INLINE SIMDScalar<Float32,8> select( const SIMDScalar<Int32,8>& selector,
+												const SIMDScalar<Float32,8>& scalar1, const SIMDScalar<Float32,8>& scalar2 )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	return SIMDScalar<Float32,8>( _mm256_blendv_ps( scalar2.vf, scalar1.vf, selector.vf ) );
+#else
+	SIMDScalar<Float32,8> result;
+	
+	for ( Index i = 0; i < 8; i++ )
+		result.x[i] = selector.x[i] ? scalar1.x[i] : scalar2.x[i];
+	
+	return result;
+#endif
+}
+
+
+
+
+/// Compute the minimum of each component of the specified SIMD scalars and return the result.
+OM_FORCE_INLINE SIMDScalar<Float32,8> min( const SIMDScalar<Float32,8>& scalar1, const SIMDScalar<Float32,8>& scalar2 )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	return SIMDScalar<Float32,8>( _mm256_min_ps( scalar1.vf, scalar2.vf ) );
+#else
+	SIMDScalar<Float32,8> result;
+	
+	for ( Index i = 0; i < 8; i++ )
+		result.x[i] = math::min( scalar1.x[i], scalar2.x[i] );
+	
+	return result;
+#endif
+}
+
+
+
+
+/// Compute the maximum of each component of the specified SIMD scalars and return the result.
+OM_FORCE_INLINE SIMDScalar<Float32,8> max( const SIMDScalar<Float32,8>& scalar1, const SIMDScalar<Float32,8>& scalar2 )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	return SIMDScalar<Float32,8>( _mm256_max_ps( scalar1.vf, scalar2.vf ) );
+#else
+	SIMDScalar<Float32,8> result;
+	
+	// Return the second value if either is NaN, like the SSE and AVX max instructions.
+	for ( Index i = 0; i < 8; i++ )
+		result.x[i] = scalar1.x[i] > scalar2.x[i] ? scalar1.x[i] : scalar2.x[i];
+	
+	return result;
+#endif
+}
+
+
+
+
+/// Compute the minimum component of the specified SIMD scalar and return the wide result.
+OM_FORCE_INLINE SIMDScalar<Float32,8> min( const SIMDScalar<Float32,8>& scalar )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	// Find the minimum of the two 128-bit halves, then of the pairs within the halves.
+	__m256 scalar2 = _mm256_min_ps( scalar.vf, _mm256_permute2f128_ps( scalar.vf, scalar.vf, 0x01 ) );
+	scalar2 = _mm256_min_ps( scalar2, _mm256_shuffle_ps( scalar2, scalar2, _MM_SHUFFLE(1,0,3,2) ) );
+	return SIMDScalar<Float32,8>( _mm256_min_ps( scalar2, _mm256_shuffle_ps( scalar2, scalar2, _MM_SHUFFLE(2,3,0,1) ) ) );
+#else
+	Float32 result = scalar.x[0];
+	
+	for ( Index i = 1; i < 8; i++ )
+		result = math::min( result, scalar.x[i] );
+	
+	return SIMDScalar<Float32,8>( result );
+#endif
+}
+
+
+
+
+/// Compute the maximum component of the specified SIMD scalar and return the wide result.
+OM_FORCE_INLINE SIMDScalar<Float32,8> max( const SIMDScalar<Float32,8>& scalar )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	// Find the maximum of the two 128-bit halves, then of the pairs within the halves.
+	__m256 scalar2 = _mm256_max_ps( scalar.vf, _mm256_permute2f128_ps( scalar.vf, scalar.vf, 0x01 ) );
+	scalar2 = _mm256_max_ps( scalar2, _mm256_shuffle_ps( scalar2, scalar2, _MM_SHUFFLE(1,0,3,2) ) );
+	return SIMDScalar<Float32,8>( _mm256_max_ps( scalar2, _mm256_shuffle_ps( scalar2, scalar2, _MM_SHUFFLE(2,3,0,1) ) ) );
+#else
+	Float32 result = scalar.x[0];
+	
+	for ( Index i = 1; i < 8; i++ )
+		result = math::max( result, scalar.x[i] );
+	
+	return SIMDScalar<Float32,8>( result );
+#endif
+}
+
+
+
+
+//##########################################################################################
+//******************************  End Om Math Namespace  ***********************************
+OM_MATH_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_OM_SIMD_SCALAR_FLOAT_32_8_H
@@ -0,0 +1,504 @@
+/*
+ * Project:     Om Software
+ * Version:     1.0.0
+ * Website:     http://www.carlschissler.com/om
+ * Author(s):   Carl Schissler
+ * 
+ * Copyright (c) 2016, Carl Schissler
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright
+ * 	   notice, this list of conditions and the following disclaimer.
+ * 	2. Redistributions in binary form must reproduce the above copyright
+ * 	   notice, this list of conditions and the following disclaimer in the
+ * 	   documentation and/or other materials provided with the distribution.
+ * 	3. Neither the name of the copyright holder nor the
+ * 	   names of its contributors may be used to endorse or promote products
+ * 	   derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_OM_SIMD_SCALAR_INT_32_8_H
+#define INCLUDE_OM_SIMD_SCALAR_INT_32_8_H
+
+
+#include "omMathConfig.h"
+
+
+#include "omSIMDScalar.h"
+
+
+//##########################################################################################
+//******************************  Start Om Math Namespace  *********************************
+OM_MATH_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class representing an 8-component 32-bit signed-integer SIMD scalar.
+/**
+  * This specialization of the SIMDScalar class uses a 256-bit value to encode
+  * 8 32-bit signed-integer values. It is mostly used to hold the masks produced
+  * by comparisons of 8-component floating-point SIMD scalars.
+  *
+  * The bitwise and mask operations use AVX if it is enabled at compile time, while
+  * the integer arithmetic operations require AVX2. Otherwise, the operations fall
+  * back to scalar code.
+  */
+template <>
+class OM_ALIGN(32) SIMDScalar<Int32,8>
+{
+	public:
+		
+		//********************************************************************************
+		//******	Public Type Declarations
+			
+			
+			/// The platform-specific vector type to use for 8 32-bit floats.
+			typedef SIMDTypeN<Float32,8>::Vector Float32x8;
+			
+			
+			/// The platform-specific vector type to use for 8 32-bit integers.
+			typedef SIMDTypeN<Int32,8>::Vector Int32x8;
+			
+			
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a new 8D SIMD scalar with all elements left uninitialized.
+			OM_FORCE_INLINE SIMDScalar()
+			{
+			}
+			
+			
+			/// Create a new 8D vector with the specified raw integer value.
+			OM_FORCE_INLINE SIMDScalar( Int32x8 simdScalar )
+				:	vi( simdScalar )
+			{
+			}
+			
+			
+			/// Create a new 8D vector with the specified raw float value, reinterpreting as integers.
+			OM_FORCE_INLINE SIMDScalar( Float32x8 simdScalar )
+				:	vf( simdScalar )
+			{
+			}
+			
+			
+			/// Create a new 8D SIMD scalar with all elements equal to the specified value.
+			OM_FORCE_INLINE SIMDScalar( Int32 value )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = _mm256_castsi256_ps( _mm256_set1_epi32( value ) );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = value;
+#endif
+			}
+			
+			
+			/// Create a new 8D SIMD scalar with the elements equal to the specified 8 values.
+			OM_FORCE_INLINE SIMDScalar( Int32 a, Int32 b, Int32 c, Int32 d, Int32 e, Int32 f, Int32 g, Int32 h )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = _mm256_castsi256_ps( _mm256_setr_epi32( a, b, c, d, e, f, g, h ) );
+#else
+				x[0] = a; x[1] = b; x[2] = c; x[3] = d; x[4] = e; x[5] = f; x[6] = g; x[7] = h;
+#endif
+			}
+			
+			
+			/// Create a new 8D SIMD scalar from the first 8 values stored at specified aligned pointer's location.
+			OM_FORCE_INLINE explicit SIMDScalar( const Int32* array )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = _mm256_load_ps( (const Float32*)array );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = array[i];
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Copy Constructor
+			
+			
+			/// Create a new SIMD scalar with the same contents as another.
+			OM_FORCE_INLINE SIMDScalar( const SIMDScalar& other )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = other.vf;
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = other.x[i];
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Assignment Operator
+			
+			
+			/// Assign the contents of one SIMDScalar object to another.
+			OM_FORCE_INLINE SIMDScalar& operator = ( const SIMDScalar& other )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				vf = other.vf;
+#else
+				for ( Index i = 0; i < 8; i++ )
+					x[i] = other.x[i];
+#endif
+				return *this;
+			}
+			
+			
+		//********************************************************************************
+		//******	Load Methods
+			
+			
+			/// Load a SIMD scalar from the specified aligned pointer to values.
+			OM_FORCE_INLINE static SIMDScalar load( const Int32* array )
+			{
+				return SIMDScalar( array );
+			}
+			
+			
+			/// Load a SIMD scalar from the specified unaligned pointer to values.
+			OM_FORCE_INLINE static SIMDScalar loadUnaligned( const Int32* array )
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_loadu_ps( (const Float32*)array ) );
+#else
+				return SIMDScalar( array );
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Store Method
+			
+			
+			/// Store this SIMD scalar starting at the specified aligned destination pointer.
+			OM_FORCE_INLINE void store( Int32* destination ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				_mm256_store_ps( (Float32*)destination, vf );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					destination[i] = x[i];
+#endif
+			}
+			
+			
+			/// Store this SIMD scalar starting at the specified unaligned destination pointer.
+			OM_FORCE_INLINE void storeUnaligned( Int32* destination ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				_mm256_storeu_ps( (Float32*)destination, vf );
+#else
+				for ( Index i = 0; i < 8; i++ )
+					destination[i] = x[i];
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Accessor Methods
+			
+			
+			/// Get a reference to the value stored at the specified component index in this scalar.
+			OM_FORCE_INLINE Int32& operator [] ( Index i )
+			{
+				return x[i];
+			}
+			
+			
+			/// Get the value stored at the specified component index in this scalar.
+			OM_FORCE_INLINE Int32 operator [] ( Index i ) const
+			{
+				return x[i];
+			}
+			
+			
+			/// Return a pointer to the first element in this scalar.
+			OM_FORCE_INLINE const Int32* toArray() const
+			{
+				return x;
+			}
+			
+			
+		//********************************************************************************
+		//******	Mask Methods
+			
+			
+			/// Return a mask which indicates if high-order bits of each of the components are true.
+			OM_FORCE_INLINE Int getMask() const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return _mm256_movemask_ps( vf );
+#else
+				Int mask = 0;
+				
+				for ( Index i = 0; i < 8; i++ )
+					mask |= ((UInt32)x[i] >> 31) << i;
+				
+				return mask;
+#endif
+			}
+			
+			
+			/// Return whether or not any component of this scalar has the high-order bit set.
+			OM_FORCE_INLINE Bool testMaskAny() const
+			{
+				return this->getMask() != 0;
+			}
+			
+			
+			/// Return whether or not all components of this scalar have the high-order bit set.
+			OM_FORCE_INLINE Bool testMaskAll() const
+			{
+				return this->getMask() == 0xFF;
+			}
+			
+			
+		//********************************************************************************
+		//******	Logical Operators
+			
+			
+			/// Return the bitwise NOT of this 8D SIMD vector.
+			OM_FORCE_INLINE SIMDScalar operator ~ () const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_xor_ps( vf, _mm256_castsi256_ps( _mm256_set1_epi32( 0xFFFFFFFF ) ) ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = ~x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Compute the bitwise AND of this 8D SIMD vector with another and return the result.
+			OM_FORCE_INLINE SIMDScalar operator & ( const SIMDScalar& vector ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_and_ps( vf, vector.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] & vector.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Compute the bitwise OR of this 8D SIMD vector with another and return the result.
+			OM_FORCE_INLINE SIMDScalar operator | ( const SIMDScalar& vector ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_or_ps( vf, vector.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] | vector.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Compute the bitwise XOR of this 8D SIMD vector with another and return the result.
+			OM_FORCE_INLINE SIMDScalar operator ^ ( const SIMDScalar& vector ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+				return SIMDScalar( _mm256_xor_ps( vf, vector.vf ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] ^ vector.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Logical Assignment Operators
+			
+			
+			/// Compute the logical AND of this 8D SIMD vector with another and assign it to this vector.
+			OM_FORCE_INLINE SIMDScalar& operator &= ( const SIMDScalar& vector )
+			{
+				return *this = *this & vector;
+			}
+			
+			
+			/// Compute the logical OR of this 8D SIMD vector with another and assign it to this vector.
+			OM_FORCE_INLINE SIMDScalar& operator |= ( const SIMDScalar& vector )
+			{
+				return *this = *this | vector;
+			}
+			
+			
+			/// Compute the bitwise XOR of this 8D SIMD vector with another and assign it to this vector.
+			OM_FORCE_INLINE SIMDScalar& operator ^= ( const SIMDScalar& vector )
+			{
+				return *this = *this ^ vector;
+			}
+			
+			
+		//********************************************************************************
+		//******	Comparison Operators
+			
+			
+			/// Compare two 8D SIMD scalars component-wise for equality.
+			OM_FORCE_INLINE SIMDScalar operator == ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,1)
+				return SIMDScalar( _mm256_cmpeq_epi32( vi, scalar.vi ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = -Int32(x[i] == scalar.x[i]);
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Compare two 8D SIMD scalars component-wise for inequality.
+			OM_FORCE_INLINE SIMDScalar operator != ( const SIMDScalar& scalar ) const
+			{
+				return ~(*this == scalar);
+			}
+			
+			
+		//********************************************************************************
+		//******	Arithmetic Operators
+			
+			
+			/// Add this scalar to another and return the result.
+			OM_FORCE_INLINE SIMDScalar operator + ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,1)
+				return SIMDScalar( _mm256_add_epi32( vi, scalar.vi ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] + scalar.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+			/// Subtract a scalar from this scalar component-wise and return the result.
+			OM_FORCE_INLINE SIMDScalar operator - ( const SIMDScalar& scalar ) const
+			{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,1)
+				return SIMDScalar( _mm256_sub_epi32( vi, scalar.vi ) );
+#else
+				SIMDScalar result;
+				
+				for ( Index i = 0; i < 8; i++ )
+					result.x[i] = x[i] - scalar.x[i];
+				
+				return result;
+#endif
+			}
+			
+			
+		//********************************************************************************
+		//******	Public Data Members
+			
+			
+			/// The number of components there are in this scalar.
+			static const Size WIDTH = SIMDTypeN<Int32,8>::WIDTH;
+			
+			
+			/// The required alignment of this scalar type.
+			static const Size ALIGNMENT = SIMDTypeN<Int32,8>::ALIGNMENT;
+			
+			
+			union OM_ALIGN(32)
+			{
+				/// The platform-specific vector to use for 8 32-bit floats.
+				Float32x8 vf;
+				
+				/// The platform-specific vector to use for 8 32-bit integers.
+				Int32x8 vi;
+				
+				/// The components of an 8D SIMD scalar in array format.
+				Int32 x[8];
+			};
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Free Vector Functions
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// Select elements from the first SIMD scalar if the selector is TRUE, otherwise from the second.
+OM_FORCE_INLINE SIMDScalar<Int32,8> select( const SIMDScalar<Int32,8>& selector,
+											const SIMDScalar<Int32,8>& scalar1, const SIMDScalar<Int32,8>& scalar2 )
+{
+#if OM_USE_SIMD && defined(OM_SIMD_SSE) && OM_SSE_VERSION_IS_SUPPORTED(5,0)
+	return SIMDScalar<Int32,8>( _mm256_blendv_ps( scalar2.vf, scalar1.vf, selector.vf ) );
+#else
+	SIMDScalar<Int32,8> result;
+	
+	for ( Index i = 0; i < 8; i++ )
+		result.x[i] = selector.x[i] ? scalar1.x[i] : scalar2.x[i];
+	
+	return result;
+#endif
+}
+
+
+
+
+//##########################################################################################
+//******************************  End Om Math Namespace  ***********************************
+OM_MATH_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_OM_SIMD_SCALAR_INT_32_8_H
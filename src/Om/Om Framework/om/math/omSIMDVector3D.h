@@ -341,6 +341,130 @@ class OM_ALIGN(16) SIMDVector3D<T,4>
 
 
 
+//********************************************************************************
+/// A class that represents a set of 8 3D vectors stored in a SIMD-compatible format.
+/**
+  * This specialization stores each component of the 8 vectors in an 8-wide SIMD scalar,
+  * matching the 256-bit registers available with AVX.
+  */
+template < typename T >
+class OM_ALIGN(32) SIMDVector3D<T,8>
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create an 8-wide 3D SIMD vector with all vector components equal to zero.
+			OM_FORCE_INLINE SIMDVector3D()
+				:	x( T(0) ),
+					y( T(0) ),
+					z( T(0) )
+			{
+			}
+			
+			
+			/// Create an 8-wide 3D SIMD vector with all of the eight vectors equal to the specified vector.
+			OM_FORCE_INLINE SIMDVector3D( const VectorND<T,3>& vector )
+				:	x( vector.x ),
+					y( vector.y ),
+					z( vector.z )
+			{
+			}
+			
+			
+			/// Create an 8-wide 3D SIMD vector with the specified X, Y, and Z SIMDScalars.
+			OM_FORCE_INLINE SIMDVector3D( const SIMDScalar<T,8>& newX, const SIMDScalar<T,8>& newY, const SIMDScalar<T,8>& newZ )
+				:	x( newX ),
+					y( newY ),
+					z( newZ )
+			{
+			}
+			
+			
+		//********************************************************************************
+		//******	Magnitude Methods
+			
+			
+			/// Return the 8-component SIMD scalar squared magnitude of this 8-wide SIMD 3D vector.
+			OM_FORCE_INLINE SIMDScalar<T,8> getMagnitudeSquared() const
+			{
+				return x*x + y*y + z*z;
+			}
+			
+			
+		//********************************************************************************
+		//******	Arithmetic Operators
+			
+			
+			/// Compute and return the component-wise sum of this 8-wide SIMD 3D vector with another.
+			OM_FORCE_INLINE SIMDVector3D operator + ( const SIMDVector3D& other ) const
+			{
+				return SIMDVector3D( x + other.x, y + other.y, z + other.z );
+			}
+			
+			
+			/// Compute and return the component-wise difference of this 8-wide SIMD 3D vector with another.
+			OM_FORCE_INLINE SIMDVector3D operator - ( const SIMDVector3D& other ) const
+			{
+				return SIMDVector3D( x - other.x, y - other.y, z - other.z );
+			}
+			
+			
+			/// Compute and return the component-wise multiplication of this 8-wide SIMD 3D vector with another.
+			OM_FORCE_INLINE SIMDVector3D operator * ( const SIMDVector3D& other ) const
+			{
+				return SIMDVector3D( x*other.x, y*other.y, z*other.z );
+			}
+			
+			
+			/// Compute and return the component-wise multiplication of this 8-wide SIMD 3D vector with an 8-wide SIMD scalar.
+			OM_FORCE_INLINE SIMDVector3D operator * ( const SIMDScalar<T,8>& scalar ) const
+			{
+				return SIMDVector3D( x*scalar, y*scalar, z*scalar );
+			}
+			
+			
+		//********************************************************************************
+		//******	Required Alignment Accessor Methods
+			
+			
+			/// Return the alignment required for objects of this type.
+			OM_FORCE_INLINE static Size getAlignment()
+			{
+				return 32;
+			}
+			
+			
+			/// Get the width of this vector (number of 3D vectors it has).
+			OM_FORCE_INLINE static Size getWidth()
+			{
+				return 8;
+			}
+			
+			
+		//********************************************************************************
+		//******	Public Data Members
+			
+			
+			/// The X component vector of this SIMDVector3D.
+			OM_ALIGN(32) SIMDScalar<T,8> x;
+			
+			
+			/// The Y component vector of this SIMDVector3D.
+			OM_ALIGN(32) SIMDScalar<T,8> y;
+			
+			
+			/// The Z component vector of this SIMDVector3D.
+			OM_ALIGN(32) SIMDScalar<T,8> z;
+			
+			
+};
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
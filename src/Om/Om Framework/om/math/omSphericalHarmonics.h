@@ -102,6 +102,18 @@ class SHExpansion
 			}
 			
 			
+		//********************************************************************************
+		//******	Destructor
+			
+			
+			/// Destroy a spherical harmonic expansion, deallocating its coefficients.
+			OM_INLINE ~SHExpansion()
+			{
+				if ( coefficients )
+					util::deallocateAligned( coefficients );
+			}
+			
+			
 		//********************************************************************************
 		//******	Assignment Operator
 			
@@ -194,7 +194,25 @@
 
         #endif
 	#else
-		#define OM_ALIGNED_MALLOC( size, alignment ) (OM_MALLOC( size ))
+		#include <stdlib.h>
+		
+		namespace om { namespace util {
+		
+		/// Allocate memory with the requested alignment, as needed by 256-bit AVX loads and stores.
+		OM_FORCE_INLINE void* posix_memalign_wrapper( size_t size, size_t alignment )
+		{
+			void* pointer;
+			
+			// posix_memalign() requires an alignment that is a multiple of the pointer size.
+			if ( posix_memalign( &pointer, alignment > sizeof(void*) ? alignment : sizeof(void*), size ) != 0 )
+				return NULL;
+			
+			return pointer;
+		}
+		
+		}; };
+		
+		#define OM_ALIGNED_MALLOC( size, alignment ) (om::util::posix_memalign_wrapper( size, alignment ))
 	#endif
 	
 	#define OM_ALIGNED_FREE(X) (std::free(X))
@@ -46,6 +46,8 @@
 #include "threads/omSignal.h"
 #include "threads/omSemaphore.h"
 #include "threads/omThreadPool.h"
+#include "threads/omJobScheduler.h"
+#include "threads/omLockFreeQueue.h"
 
 
 #endif // INCLUDE_OM_THREADS_H
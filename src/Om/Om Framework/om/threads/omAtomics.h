@@ -68,6 +68,13 @@ T readAndSet( T& operand, T value );
 
 
 
+/// Read the operand with acquire semantics, so later memory reads cannot be reordered before it.
+template < typename T >
+T readAcquire( const T& operand );
+
+
+
+
 //##########################################################################################
 //##########################################################################################
 //############		
@@ -233,6 +240,31 @@ OM_INLINE T readAndSet( T& operand, T value )
 
 
 
+template < typename T >
+OM_INLINE T readAcquire( const T& operand )
+{
+	T value = *(const volatile T*)&operand;
+	
+	__sync_synchronize();
+	
+	return value;
+}
+
+
+
+#elif defined(OM_COMPILER_MSVC)
+
+
+
+template < typename T >
+OM_INLINE T readAcquire( const T& operand )
+{
+	// Volatile reads have acquire semantics with MSVC's default /volatile:ms behavior.
+	return *(const volatile T*)&operand;
+}
+
+
+
 #endif
 
 
@@ -509,6 +541,18 @@ class Atomic
 			}
 			
 			
+			/// Return the current un-boxed atomic value, read with acquire semantics.
+			/**
+			  * Memory reads that follow this method cannot be reordered before it, so
+			  * data published by another thread before it modified this atomic value
+			  * is visible once the new value is observed.
+			  */
+			OM_FORCE_INLINE T readAcquire() const
+			{
+				return atomic::readAcquire( value );
+			}
+			
+			
 		//********************************************************************************
 		//******	Increment Operators
 			
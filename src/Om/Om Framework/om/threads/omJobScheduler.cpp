@@ -0,0 +1,537 @@
+/*
+ * Project:     Om Software
+ * Version:     1.0.0
+ * Website:     http://www.carlschissler.com/om
+ * Author(s):   Carl Schissler
+ * 
+ * Copyright (c) 2016, Carl Schissler
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright
+ * 	   notice, this list of conditions and the following disclaimer.
+ * 	2. Redistributions in binary form must reproduce the above copyright
+ * 	   notice, this list of conditions and the following disclaimer in the
+ * 	   documentation and/or other materials provided with the distribution.
+ * 	3. Neither the name of the copyright holder nor the
+ * 	   names of its contributors may be used to endorse or promote products
+ * 	   derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "omJobScheduler.h"
+
+
+//##########################################################################################
+//****************************  Start Om Threads Namespace  ********************************
+OM_THREADS_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Worker Thread Class Declaration
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+class JobScheduler:: Worker : public ThreadBase
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a new worker thread that is a member of the specified job scheduler.
+			OM_INLINE Worker( JobScheduler* newScheduler, Index newThreadIndex )
+				:	scheduler( newScheduler ),
+					threadIndex( newThreadIndex ),
+					taskStart( 0 ),
+					taskEnd( 0 ),
+					wakeSemaphore( 0 ),
+					shouldStop( 0 ),
+					rangeAccessed( 0 )
+			{
+			}
+			
+			
+		//********************************************************************************
+		//******	Thread Control Methods
+			
+			
+			/// Indicate to the worker thread that it should stop after it finishes its current tasks.
+			OM_INLINE void requestStop()
+			{
+				shouldStop++;
+				wakeSemaphore.up();
+			}
+			
+			
+			/// Wait for this thread to stop.
+			OM_INLINE void join()
+			{
+				ThreadBase::joinThread();
+			}
+			
+			
+			/// Start this thread if it is not already running.
+			OM_INLINE Bool start()
+			{
+				return ThreadBase::startThread();
+			}
+			
+			
+			/// Awaken this worker so that it starts executing its tasks.
+			OM_INLINE void wake()
+			{
+				wakeSemaphore.up();
+			}
+			
+			
+		//********************************************************************************
+		//******	Task Range Methods
+			
+			
+			/// Replace the range of tasks that this worker should execute.
+			OM_INLINE void setTasks( Index newTaskStart, Index newTaskEnd )
+			{
+				lockRange();
+				taskStart = newTaskStart;
+				taskEnd = newTaskEnd;
+				unlockRange();
+			}
+			
+			
+			/// Steal the back half of this worker's remaining tasks, returning whether or not any tasks were stolen.
+			OM_INLINE Bool stealTasks( Index& stolenStart, Index& stolenEnd )
+			{
+				lockRange();
+				
+				const Size numRemaining = taskEnd - taskStart;
+				
+				if ( numRemaining == 0 )
+				{
+					unlockRange();
+					return false;
+				}
+				
+				// Take the back half, rounded up, so that the last task can be stolen.
+				stolenEnd = taskEnd;
+				stolenStart = taskEnd - (numRemaining + 1)/2;
+				taskEnd = stolenStart;
+				
+				unlockRange();
+				
+				return true;
+			}
+			
+			
+	protected:
+		
+		//********************************************************************************
+		//******	Protected Virtual Run Function
+			
+			
+			/// The method called by ThreadBase as the entry point for a new worker thread.
+			virtual void run()
+			{
+				if ( scheduler == NULL )
+					return;
+				
+				while ( !shouldStop )
+				{
+					// Wait for a new task set.
+					wakeSemaphore.down();
+					
+					if ( shouldStop )
+						break;
+					
+					Index taskIndex;
+					
+					// Execute tasks from this worker's range, then from other workers' ranges.
+					while ( getNextTask( taskIndex ) || stealNextTask( taskIndex ) )
+					{
+						scheduler->taskFunction( taskIndex, threadIndex );
+						scheduler->finishTasks( 1 );
+					}
+				}
+			}
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Helper Methods
+			
+			
+			/// Remove the next task from the front of this worker's range, returning whether or not there was one.
+			OM_FORCE_INLINE Bool getNextTask( Index& taskIndex )
+			{
+				lockRange();
+				
+				if ( taskStart < taskEnd )
+				{
+					taskIndex = taskStart;
+					taskStart++;
+					unlockRange();
+					return true;
+				}
+				
+				unlockRange();
+				
+				return false;
+			}
+			
+			
+			/// Steal tasks from another worker, returning the first stolen task and keeping the rest.
+			Bool stealNextTask( Index& taskIndex )
+			{
+				const util::ArrayList<Worker*>& workers = scheduler->workers;
+				const Size numWorkers = workers.getSize();
+				
+				// Visit the other workers in order, starting with the next one.
+				for ( Index i = 1; i < numWorkers; i++ )
+				{
+					Worker* victim = workers[(threadIndex + i) % numWorkers];
+					Index stolenStart, stolenEnd;
+					
+					if ( victim->stealTasks( stolenStart, stolenEnd ) )
+					{
+						// Keep the remainder of the stolen range so that it can be stolen again.
+						if ( stolenStart + 1 < stolenEnd )
+							setTasks( stolenStart + 1, stolenEnd );
+						
+						taskIndex = stolenStart;
+						return true;
+					}
+				}
+				
+				return false;
+			}
+			
+			
+			/// Wait until the task range is not accessed by another thread.
+			OM_FORCE_INLINE void lockRange()
+			{
+				while ( rangeAccessed++ )
+				{
+					rangeAccessed--;
+					ThreadBase::yield();
+				}
+			}
+			
+			
+			/// Unlock access to the task range.
+			OM_FORCE_INLINE void unlockRange()
+			{
+				rangeAccessed--;
+			}
+			
+			
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// A pointer to the job scheduler that has this worker thread.
+			JobScheduler* scheduler;
+			
+			
+			/// The index of this worker thread within the job scheduler.
+			Index threadIndex;
+			
+			
+			/// The index of the next task that this worker should execute.
+			Index taskStart;
+			
+			
+			/// The index after the last task that this worker should execute.
+			Index taskEnd;
+			
+			
+			/// A semaphore that this worker waits on when it has no tasks.
+			Semaphore wakeSemaphore;
+			
+			
+			/// A boolean value indicating whether or not this worker thread should stop processing.
+			Atomic<Size> shouldStop;
+			
+			
+			/// An atomic value that protects the task range.
+			Atomic<Size> rangeAccessed;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Constructors
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+JobScheduler:: JobScheduler()
+	:	numUnfinishedTasks( 0 ),
+		finishSemaphore( NULL )
+{
+}
+
+
+
+
+JobScheduler:: JobScheduler( Size newNumberOfThreads )
+	:	numUnfinishedTasks( 0 ),
+		finishSemaphore( NULL )
+{
+	this->setThreadCount( newNumberOfThreads );
+}
+
+
+
+
+JobScheduler:: JobScheduler( const JobScheduler& other )
+	:	numUnfinishedTasks( 0 ),
+		finishSemaphore( NULL ),
+		priority( other.priority )
+{
+	this->setThreadCount( other.getThreadCount() );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Destructor
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+JobScheduler:: ~JobScheduler()
+{
+	this->setThreadCount( 0 );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Assignment Operator
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+JobScheduler& JobScheduler:: operator = ( const JobScheduler& other )
+{
+	if ( this != &other )
+	{
+		priority = other.priority;
+		this->setThreadCount( other.getThreadCount() );
+	}
+	
+	return *this;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Thread Management Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void JobScheduler:: setThreadCount( Size numThreads )
+{
+	if ( workers.getSize() == numThreads )
+		return;
+	
+	// Make sure that no tasks are executing.
+	this->finish();
+	
+	// Stop all of the previous workers, since idle workers may still read the worker list.
+	const Size oldNumThreads = workers.getSize();
+	
+	for ( Index i = 0; i < oldNumThreads; i++ )
+		workers[i]->requestStop();
+	
+	for ( Index i = 0; i < oldNumThreads; i++ )
+	{
+		workers[i]->join();
+		util::destruct( workers[i] );
+	}
+	
+	workers.clear();
+	
+	// Create the new workers, then start them once the list is complete.
+	for ( Index i = 0; i < numThreads; i++ )
+		workers.add( util::construct<Worker>( this, i ) );
+	
+	for ( Index i = 0; i < numThreads; i++ )
+	{
+		workers[i]->start();
+		workers[i]->setPriority( priority );
+	}
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Task Management Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+void JobScheduler:: start( const TaskFunction& function, Size numTasks, Semaphore* newFinishSemaphore )
+{
+	// Wait for the previous task set to finish.
+	this->finish();
+	
+	const Size numWorkers = workers.getSize();
+	
+	if ( numTasks == 0 || numWorkers == 0 )
+	{
+		// Execute the tasks on the calling thread if there are no workers.
+		for ( Index i = 0; i < numTasks; i++ )
+			function( i, 0 );
+		
+		if ( newFinishSemaphore )
+			newFinishSemaphore->up();
+		
+		return;
+	}
+	
+	taskFunction = function;
+	finishSemaphore = newFinishSemaphore;
+	numUnfinishedTasks += numTasks;
+	
+	// Divide the tasks into contiguous ranges of nearly equal size.
+	const Size tasksPerWorker = numTasks / numWorkers;
+	const Size numExtraTasks = numTasks % numWorkers;
+	Index taskStart = 0;
+	
+	for ( Index i = 0; i < numWorkers; i++ )
+	{
+		const Size numWorkerTasks = tasksPerWorker + (i < numExtraTasks ? 1 : 0);
+		workers[i]->setTasks( taskStart, taskStart + numWorkerTasks );
+		taskStart += numWorkerTasks;
+	}
+	
+	// Awaken the workers.
+	for ( Index i = 0; i < numWorkers; i++ )
+		workers[i]->wake();
+}
+
+
+
+
+void JobScheduler:: finish()
+{
+	if ( numUnfinishedTasks == Size(0) )
+		return;
+	
+	finishSignal.lock();
+	
+	while ( numUnfinishedTasks > Size(0) )
+		finishSignal.wait();
+	
+	finishSignal.unlock();
+}
+
+
+
+
+void JobScheduler:: finishTasks( Size numTasks )
+{
+	// Read the semaphore before the last task finishes, since the next task set may replace it.
+	Semaphore* semaphore = finishSemaphore;
+	
+	if ( (numUnfinishedTasks -= numTasks) == Size(0) )
+	{
+		finishSignal.lock();
+		finishSignal.signal();
+		finishSignal.unlock();
+		
+		if ( semaphore )
+			semaphore->up();
+	}
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Thread Priority Accessor Methods
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+Bool JobScheduler:: setPriority( const ThreadPriority& newPriority )
+{
+	priority = newPriority;
+	
+	const Size numThreads = workers.getSize();
+	
+	// Set the priority for all of the threads.
+	for ( Index i = 0; i < numThreads; i++ )
+		workers[i]->setPriority( newPriority );
+	
+	return true;
+}
+
+
+
+
+//##########################################################################################
+//****************************  End Om Threads Namespace  **********************************
+OM_THREADS_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
@@ -0,0 +1,249 @@
+/*
+ * Project:     Om Software
+ * Version:     1.0.0
+ * Website:     http://www.carlschissler.com/om
+ * Author(s):   Carl Schissler
+ * 
+ * Copyright (c) 2016, Carl Schissler
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright
+ * 	   notice, this list of conditions and the following disclaimer.
+ * 	2. Redistributions in binary form must reproduce the above copyright
+ * 	   notice, this list of conditions and the following disclaimer in the
+ * 	   documentation and/or other materials provided with the distribution.
+ * 	3. Neither the name of the copyright holder nor the
+ * 	   names of its contributors may be used to endorse or promote products
+ * 	   derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_OM_JOB_SCHEDULER_H
+#define INCLUDE_OM_JOB_SCHEDULER_H
+
+
+#include "omThreadsConfig.h"
+
+
+#include "omThreadBase.h"
+#include "omSemaphore.h"
+#include "omMutex.h"
+#include "omSignal.h"
+#include "omAtomics.h"
+
+
+//##########################################################################################
+//****************************  Start Om Threads Namespace  ********************************
+OM_THREADS_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that executes sets of fine-grained tasks on worker threads using work stealing.
+/**
+  * A task set is a function that is called once for each task index in the range [0, N).
+  * When a task set is started, the task indices are divided into contiguous ranges,
+  * one per worker thread. Each worker executes tasks from the front of its own range.
+  * When a worker runs out of tasks, it steals the back half of the remaining range of
+  * another worker. This balances the load when the cost of tasks varies widely,
+  * without the overhead of a shared job queue.
+  *
+  * Each task is called with the index of the task and the index of the worker thread
+  * that executes it, so that the task can access thread-local data without synchronization.
+  *
+  * Only one task set may be executing at a time.
+  */
+class JobScheduler
+{
+	public:
+		
+		//********************************************************************************
+		//******	Public Type Declarations
+			
+			
+			/// The type of function that is called for each task, given the task index and worker thread index.
+			typedef lang::Function<void ( Index taskIndex, Index threadIndex )> TaskFunction;
+			
+			
+		//********************************************************************************
+		//******	Constructors
+			
+			
+			/// Create a job scheduler which has no threads.
+			JobScheduler();
+			
+			
+			/// Create a new job scheduler which has the specified number of worker threads.
+			JobScheduler( Size newNumberOfThreads );
+			
+			
+			/// Create a job scheduler with the same number of threads as another job scheduler.
+			private: JobScheduler( const JobScheduler& other );
+			public:
+			
+			
+		//********************************************************************************
+		//******	Destructor
+			
+			
+			/// Wait for the current task set to finish, then destroy the job scheduler.
+			~JobScheduler();
+			
+			
+		//********************************************************************************
+		//******	Assignment Operator
+			
+			
+			/// Assign the number of threads of another job scheduler to this job scheduler.
+			private: JobScheduler& operator = ( const JobScheduler& other );
+			public:
+			
+			
+		//********************************************************************************
+		//******	Thread Management Methods
+			
+			
+			/// Return the number of worker threads that are part of this job scheduler.
+			OM_INLINE Size getThreadCount() const
+			{
+				return workers.getSize();
+			}
+			
+			
+			/// Set the number of worker threads that should be part of this job scheduler.
+			/**
+			  * This method waits for the current task set to finish before changing
+			  * the number of threads.
+			  */
+			void setThreadCount( Size numThreads );
+			
+			
+		//********************************************************************************
+		//******	Task Management Methods
+			
+			
+			/// Start executing the specified task function for each task index in the range [0, numTasks).
+			/**
+			  * The method returns immediately after the tasks are distributed to the
+			  * worker threads. Use finish() or isFinished() to determine when all tasks are done.
+			  * If there is a task set that is still executing, the method waits for it to finish first.
+			  *
+			  * If a semaphore is specified, it is raised once when the last task
+			  * of the task set has finished. This allows a consumer thread to wait on the
+			  * same semaphore for both task completion and other events.
+			  */
+			void start( const TaskFunction& function, Size numTasks, Semaphore* finishSemaphore = NULL );
+			
+			
+			/// Execute the specified task function for each task index in [0, numTasks) and wait for all tasks to finish.
+			OM_INLINE void run( const TaskFunction& function, Size numTasks )
+			{
+				this->start( function, numTasks );
+				this->finish();
+			}
+			
+			
+			/// Return whether or not all tasks from the last task set have finished executing.
+			OM_INLINE Bool isFinished() const
+			{
+				return numUnfinishedTasks == Size(0);
+			}
+			
+			
+			/// Wait for all tasks from the last task set to finish executing.
+			void finish();
+			
+			
+		//********************************************************************************
+		//******	Thread Priority Accessor Methods
+			
+			
+			/// Return the thread priority that is used for all of the threads in this scheduler.
+			OM_INLINE ThreadPriority getPriority() const
+			{
+				return priority;
+			}
+			
+			
+			/// Set the thread priority that is used for all of the threads in this scheduler.
+			/**
+			  * The method returns whether or not the priority was successfully changed.
+			  */
+			Bool setPriority( const ThreadPriority& newPriority );
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Class Declarations
+			
+			
+			/// A class that represents a single worker thread that is a part of this scheduler.
+			class Worker;
+			
+			
+		//********************************************************************************
+		//******	Private Helper Methods
+			
+			
+			/// Called by a worker thread when it has finished the specified number of tasks.
+			OM_FORCE_INLINE void finishTasks( Size numTasks );
+			
+			
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// A list of the worker threads that are part of this job scheduler.
+			util::ArrayList<Worker*> workers;
+			
+			
+			/// The function that is called for each task in the current task set.
+			TaskFunction taskFunction;
+			
+			
+			/// The number of tasks in the current task set that have not yet finished.
+			Atomic<Size> numUnfinishedTasks;
+			
+			
+			/// A semaphore that is raised when the current task set finishes, or NULL if there is none.
+			Semaphore* finishSemaphore;
+			
+			
+			/// An object that is used to signal waiting threads upon completion of a task set.
+			Signal finishSignal;
+			
+			
+			/// The thread priority to use for all of the threads in this scheduler.
+			ThreadPriority priority;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//****************************  End Om Threads Namespace  **********************************
+OM_THREADS_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_OM_JOB_SCHEDULER_H
@@ -0,0 +1,203 @@
+/*
+ * Project:     Om Software
+ * Version:     1.0.0
+ * Website:     http://www.carlschissler.com/om
+ * Author(s):   Carl Schissler
+ * 
+ * Copyright (c) 2016, Carl Schissler
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 	1. Redistributions of source code must retain the above copyright
+ * 	   notice, this list of conditions and the following disclaimer.
+ * 	2. Redistributions in binary form must reproduce the above copyright
+ * 	   notice, this list of conditions and the following disclaimer in the
+ * 	   documentation and/or other materials provided with the distribution.
+ * 	3. Neither the name of the copyright holder nor the
+ * 	   names of its contributors may be used to endorse or promote products
+ * 	   derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_OM_LOCK_FREE_QUEUE_H
+#define INCLUDE_OM_LOCK_FREE_QUEUE_H
+
+
+#include "omThreadsConfig.h"
+
+
+#include "omAtomics.h"
+
+
+//##########################################################################################
+//****************************  Start Om Threads Namespace  ********************************
+OM_THREADS_NAMESPACE_START
+//******************************************************************************************
+//##########################################################################################
+
+
+
+
+//********************************************************************************
+/// A class that implements a bounded lock-free queue for one producer thread and one consumer thread.
+/**
+  * The queue stores its elements in a fixed-size ring buffer. Exactly one thread may
+  * add elements to the queue and exactly one (possibly different) thread may remove
+  * elements from the queue at the same time. Neither operation ever blocks: add() fails
+  * if the queue is full and remove() fails if the queue is empty.
+  *
+  * The capacity must be a power of two.
+  */
+template < typename T, Size capacity >
+class LockFreeQueue
+{
+	public:
+		
+		//********************************************************************************
+		//******	Constructor
+			
+			
+			/// Create a new empty lock-free queue.
+			OM_INLINE LockFreeQueue()
+				:	head( 0 ),
+					tail( 0 )
+			{
+			}
+			
+			
+		//********************************************************************************
+		//******	Producer Methods
+			
+			
+			/// Add a new element to the end of the queue, returning whether or not it was added.
+			/**
+			  * This method may only be called by the producer thread. If the queue
+			  * is full, the method fails and returns FALSE.
+			  */
+			OM_INLINE Bool add( const T& newElement )
+			{
+				const Size currentTail = tail;
+				
+				// Don't overwrite a slot until the consumer's read of it is visible.
+				if ( currentTail - head.readAcquire() >= capacity )
+					return false;
+				
+				elements[currentTail & (capacity - 1)] = newElement;
+				
+				// Publish the new element after it has been written.
+				tail++;
+				
+				return true;
+			}
+			
+			
+		//********************************************************************************
+		//******	Consumer Methods
+			
+			
+			/// Remove the element at the front of the queue and place it in the output parameter.
+			/**
+			  * This method may only be called by the consumer thread. If the queue
+			  * is empty, the method fails and returns FALSE.
+			  */
+			OM_INLINE Bool remove( T& element )
+			{
+				const Size currentHead = head;
+				
+				// Don't read the element until the producer's write of it is visible.
+				if ( currentHead == tail.readAcquire() )
+					return false;
+				
+				element = elements[currentHead & (capacity - 1)];
+				
+				// Release the element's slot back to the producer after it has been read.
+				head++;
+				
+				return true;
+			}
+			
+			
+		//********************************************************************************
+		//******	Accessor Methods
+			
+			
+			/// Return the number of elements that are currently in the queue.
+			/**
+			  * The returned value is not synchronized with the producer or consumer, so
+			  * it may not represent the instantaneous state of the queue.
+			  */
+			OM_INLINE Size getSize() const
+			{
+				return tail.readAcquire() - head.readAcquire();
+			}
+			
+			
+			/// Return whether or not the queue currently has no elements.
+			OM_INLINE Bool isEmpty() const
+			{
+				return tail.readAcquire() == head.readAcquire();
+			}
+			
+			
+			/// Return the maximum number of elements that can be stored in the queue.
+			OM_INLINE static Size getCapacity()
+			{
+				return capacity;
+			}
+			
+			
+			/// Remove all elements from the queue.
+			/**
+			  * This method is not thread-safe and may only be called when neither the
+			  * producer nor the consumer are accessing the queue.
+			  */
+			OM_INLINE void clear()
+			{
+				head = Atomic<Size>( 0 );
+				tail = Atomic<Size>( 0 );
+			}
+			
+			
+	private:
+		
+		//********************************************************************************
+		//******	Private Data Members
+			
+			
+			/// The ring buffer of elements in the queue.
+			T elements[capacity];
+			
+			
+			/// The total number of elements that have been removed from the queue by the consumer.
+			Atomic<Size> head;
+			
+			
+			/// The total number of elements that have been added to the queue by the producer.
+			Atomic<Size> tail;
+			
+			
+			
+};
+
+
+
+
+//##########################################################################################
+//****************************  End Om Threads Namespace  **********************************
+OM_THREADS_NAMESPACE_END
+//******************************************************************************************
+//##########################################################################################
+
+
+#endif // INCLUDE_OM_LOCK_FREE_QUEUE_H
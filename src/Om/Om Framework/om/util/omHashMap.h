@@ -1101,7 +1101,7 @@ class HashMap
 						/// Advance the iterator to the next non-empty bucket.
 						OM_INLINE void advanceToNextFullBucket()
 						{
-							while ( *currentBucket == NULL && currentBucket != bucketsEnd )
+							while ( currentBucket != bucketsEnd && *currentBucket == NULL )
 								currentBucket++;
 							
 							if ( currentBucket == bucketsEnd )
@@ -1278,7 +1278,7 @@ class HashMap
 						/// Advance the iterator to the next non-empty bucket.
 						OM_INLINE void advanceToNextFullBucket()
 						{
-							while ( *currentBucket == NULL && currentBucket != bucketsEnd )
+							while ( currentBucket != bucketsEnd && *currentBucket == NULL )
 								currentBucket++;
 							
 							if ( currentBucket == bucketsEnd )
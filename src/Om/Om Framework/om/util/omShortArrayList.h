@@ -1368,7 +1368,11 @@ class ShortArrayList
 			
 			
 			/// A local array of bytes used to store short lists of elements.
-			UByte localStorage[localCapacity*sizeof(T)];
+			/**
+			  * The storage is aligned for the element type so that SIMD-aligned
+			  * elements can be stored locally.
+			  */
+			alignas(T) UByte localStorage[localCapacity*sizeof(T)];
 			
 			
 };
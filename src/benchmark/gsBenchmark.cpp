@@ -0,0 +1,767 @@
+/*
+ * Project:     GSound
+ * 
+ * File:        benchmark/gsBenchmark.cpp
+ * Contents:    Scene-level ray tracing and propagation throughput benchmark
+ * 
+ * Author(s):   Carl Schissler
+ * Website:     http://gamma.cs.unc.edu/GSOUND/
+ * 
+ * License:
+ * 
+ *     Copyright (C) 2010-16 Carl Schissler, University of North Carolina at Chapel Hill.
+ *     All rights reserved.
+ *     
+ *     Permission to use, copy, modify, and distribute this software and its
+ *     documentation for educational, research, and non-profit purposes, without
+ *     fee, and without a written agreement is hereby granted, provided that the
+ *     above copyright notice, this paragraph, and the following four paragraphs
+ *     appear in all copies.
+ *     
+ *     Permission to incorporate this software into commercial products may be
+ *     obtained by contacting the University of North Carolina at Chapel Hill.
+ *     
+ *     This software program and documentation are copyrighted by Carl Schissler and
+ *     the University of North Carolina at Chapel Hill. The software program and
+ *     documentation are supplied "as is", without any accompanying services from
+ *     the University of North Carolina at Chapel Hill or the authors. The University
+ *     of North Carolina at Chapel Hill and the authors do not warrant that the
+ *     operation of the program will be uninterrupted or error-free. The end-user
+ *     understands that the program was developed for research purposes and is advised
+ *     not to rely exclusively on the program for any reason.
+ *     
+ *     IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR ITS
+ *     EMPLOYEES OR THE AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT,
+ *     SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS,
+ *     ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE
+ *     UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED
+ *     OF THE POSSIBILITY OF SUCH DAMAGE.
+ *     
+ *     THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ *     DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *     WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ *     STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS
+ *     ON AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND
+ *     THE AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ *     ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+
+#include <gsound/gsound.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+using namespace gsound;
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Benchmark Configuration
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// The parameters that control how much work each benchmark phase does.
+struct BenchmarkOptions
+{
+	BenchmarkOptions()
+		:	numThreads( 8 ),
+			numRays( 20000 ),
+			numBVHRays( 1000000 ),
+			numFrames( 3 ),
+			randomSeed( 1 ),
+			outputPath( NULL )
+	{
+	}
+	
+	/// The number of threads used for mesh preprocessing and sound propagation.
+	Size numThreads;
+	
+	/// The number of specular and diffuse rays traced per listener on each propagation frame.
+	Size numRays;
+	
+	/// The number of rays traced through each mesh BVH for each BVH query type.
+	Size numBVHRays;
+	
+	/// The number of propagation frames that are timed for each propagation phase.
+	Size numFrames;
+	
+	/// The seed for the random rays and the procedural room geometry.
+	UInt32 randomSeed;
+	
+	/// The path of the file where the JSON results are written, or NULL for standard output.
+	const char* outputPath;
+};
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Procedural Room Generation
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// A procedurally generated room that is benchmarked.
+struct BenchmarkRoom
+{
+	/// The name of the room that identifies it in the results.
+	const char* name;
+	
+	/// The vertices of the room's triangles.
+	ArrayList<SoundVertex> vertices;
+	
+	/// The triangles of the room, all using material 0.
+	ArrayList<SoundTriangle> triangles;
+	
+	/// The bounding box of the room's interior where sources, listeners and rays are placed.
+	AABB3f interior;
+	
+	/// The positions of the sound sources in the room.
+	ArrayList<Vector3f> sources;
+	
+	/// The positions of the listeners in the room.
+	ArrayList<Vector3f> listeners;
+};
+
+
+
+
+/// Add a planar grid of quads with corner p, edge vectors u and v, and the given number of subdivisions.
+static void addGrid( BenchmarkRoom& room, const Vector3f& p, const Vector3f& u, const Vector3f& v,
+					Size numU, Size numV )
+{
+	const Index baseIndex = room.vertices.getSize();
+	
+	for ( Index j = 0; j <= numV; j++ )
+	{
+		for ( Index i = 0; i <= numU; i++ )
+			room.vertices.add( p + u*(Real(i) / Real(numU)) + v*(Real(j) / Real(numV)) );
+	}
+	
+	for ( Index j = 0; j < numV; j++ )
+	{
+		for ( Index i = 0; i < numU; i++ )
+		{
+			const Index v0 = baseIndex + j*(numU + 1) + i;
+			const Index v1 = v0 + 1;
+			const Index v2 = v0 + (numU + 1);
+			const Index v3 = v2 + 1;
+			
+			room.triangles.add( SoundTriangle( v0, v1, v3, 0 ) );
+			room.triangles.add( SoundTriangle( v0, v3, v2, 0 ) );
+		}
+	}
+}
+
+
+
+
+/// Add the six faces of an axis-aligned box, each subdivided into a grid with cells of about the given size.
+static void addBox( BenchmarkRoom& room, const Vector3f& min, const Vector3f& max, Real cellSize )
+{
+	const Vector3f size = max - min;
+	const Size nx = math::max( Size(math::ceiling( size.x / cellSize )), Size(1) );
+	const Size ny = math::max( Size(math::ceiling( size.y / cellSize )), Size(1) );
+	const Size nz = math::max( Size(math::ceiling( size.z / cellSize )), Size(1) );
+	const Vector3f dx( size.x, 0, 0 );
+	const Vector3f dy( 0, size.y, 0 );
+	const Vector3f dz( 0, 0, size.z );
+	
+	addGrid( room, min, dx, dy, nx, ny );
+	addGrid( room, min + dz, dy, dx, ny, nx );
+	addGrid( room, min, dz, dx, nz, nx );
+	addGrid( room, min + dy, dx, dz, nx, nz );
+	addGrid( room, min, dy, dz, ny, nz );
+	addGrid( room, min + dx, dz, dy, nz, ny );
+}
+
+
+
+
+/// Create the fixed set of rooms that are benchmarked.
+static void createRooms( ArrayList<BenchmarkRoom>& rooms )
+{
+	//****************************************************************************
+	// A small empty shoebox room.
+	{
+		rooms.addNew();
+		BenchmarkRoom& room = rooms.getLast();
+		room.name = "shoebox";
+		room.interior = AABB3f( Vector3f( 0, 0, 0 ), Vector3f( 10, 7, 3.5f ) );
+		addBox( room, room.interior.min, room.interior.max, Real(100) );
+		room.sources.add( Vector3f( 2, 2, 1.5f ) );
+		room.listeners.add( Vector3f( 7, 5, 1.2f ) );
+		room.listeners.add( Vector3f( 8, 2, 1.7f ) );
+	}
+	
+	//****************************************************************************
+	// An office floor with partition walls that produce many diffraction edges.
+	{
+		rooms.addNew();
+		BenchmarkRoom& room = rooms.getLast();
+		room.name = "office";
+		room.interior = AABB3f( Vector3f( 0, 0, 0 ), Vector3f( 24, 12, 3 ) );
+		addBox( room, room.interior.min, room.interior.max, Real(2) );
+		
+		// Partition walls with a doorway gap in each wall.
+		for ( Index i = 1; i < 4; i++ )
+		{
+			const Real x = Real(6*i);
+			addBox( room, Vector3f( x - 0.1f, 0, 0 ), Vector3f( x + 0.1f, 4, 3 ), Real(2) );
+			addBox( room, Vector3f( x - 0.1f, 5, 0 ), Vector3f( x + 0.1f, 12, 3 ), Real(2) );
+		}
+		
+		room.sources.add( Vector3f( 3, 8, 1.5f ) );
+		room.sources.add( Vector3f( 15, 2, 1.5f ) );
+		room.listeners.add( Vector3f( 21, 9, 1.2f ) );
+		room.listeners.add( Vector3f( 9, 6, 1.2f ) );
+	}
+	
+	//****************************************************************************
+	// A large subdivided hall with a grid of pillars.
+	{
+		rooms.addNew();
+		BenchmarkRoom& room = rooms.getLast();
+		room.name = "hall";
+		room.interior = AABB3f( Vector3f( 0, 0, 0 ), Vector3f( 40, 25, 12 ) );
+		addBox( room, room.interior.min, room.interior.max, Real(2.5) );
+		
+		for ( Index i = 1; i < 5; i++ )
+		{
+			for ( Index j = 1; j < 4; j++ )
+			{
+				const Vector3f center( Real(8*i), Real(6.25f*j), 0 );
+				addBox( room, center - Vector3f( 0.5f, 0.5f, 0 ), center + Vector3f( 0.5f, 0.5f, 12 ), Real(4) );
+			}
+		}
+		
+		room.sources.add( Vector3f( 4, 12.5f, 1.5f ) );
+		room.sources.add( Vector3f( 20, 3, 1.5f ) );
+		room.listeners.add( Vector3f( 36, 12.5f, 1.2f ) );
+		room.listeners.add( Vector3f( 20, 22, 1.2f ) );
+		room.listeners.add( Vector3f( 12, 9, 1.2f ) );
+	}
+}
+
+
+
+
+/// Return the material that is used for all benchmark room surfaces.
+static SoundMaterial getRoomMaterial()
+{
+	const Float frequencies[] = { 63.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f };
+	FrequencyResponse reflectivity, scattering, transmission( 0.0f );
+	
+	for ( Index i = 0; i < 8; i++ )
+	{
+		reflectivity.setFrequency( frequencies[i], math::sqrt( 1.0f - 0.3f ) );
+		scattering.setFrequency( frequencies[i], 0.5f );
+	}
+	
+	return SoundMaterial( reflectivity, scattering, transmission );
+}
+
+
+
+
+/// Return a propagation request with the same defaults as the Python bindings' context.
+static PropagationRequest getDefaultRequest( const BenchmarkOptions& options )
+{
+	const Float frequencies[] = { 63.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f };
+	PropagationRequest request;
+	request.frequencies = FrequencyBands( frequencies );
+	request.flags.set( PropagationFlags::DIRECT, true );
+	request.flags.set( PropagationFlags::SPECULAR, true );
+	request.flags.set( PropagationFlags::DIFFUSE, true );
+	request.flags.set( PropagationFlags::DIFFRACTION, true );
+	request.flags.set( PropagationFlags::SOURCE_DIRECTIVITY, false );
+	request.flags.set( PropagationFlags::DOPPLER_SORTING, false );
+	request.flags.set( PropagationFlags::ADAPTIVE_QUALITY, false );
+	request.flags.set( PropagationFlags::AIR_ABSORPTION, true );
+	request.flags.set( PropagationFlags::ADAPTIVE_IR_LENGTH, true );
+	request.flags.set( PropagationFlags::VISIBILITY_CACHE, false );
+	request.flags.set( PropagationFlags::IR_THRESHOLD, true );
+	request.flags.set( PropagationFlags::IR_CACHE, true );
+	request.flags.set( PropagationFlags::SAMPLED_IR, true );
+	request.flags.set( PropagationFlags::STATISTICS, true );
+	request.targetDt = 1.0f / 15.0f;
+	request.sampleRate = 16000;
+	request.numSpecularRays = options.numRays;
+	request.maxSpecularDepth = 200;
+	request.numSpecularSamples = 100;
+	request.numDiffuseRays = options.numRays;
+	request.maxDiffuseDepth = 200;
+	request.numDiffuseSamples = 3;
+	request.responseTime = 5.0;
+	request.maxIRLength = 3.0;
+	request.numThreads = options.numThreads;
+	
+	return request;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		JSON Output
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// Write a JSON key and number pair with the given indentation, followed by a comma if not the last value.
+static void writeValue( FILE* file, Size indent, const char* key, Double value, Bool last = false )
+{
+	for ( Index i = 0; i < indent; i++ )
+		std::fputs( "  ", file );
+	
+	std::fprintf( file, "\"%s\": %.9g%s\n", key, value, last ? "" : "," );
+}
+
+
+
+
+/// Write a JSON key and string pair with the given indentation, followed by a comma if not the last value.
+static void writeString( FILE* file, Size indent, const char* key, const char* value, Bool last = false )
+{
+	for ( Index i = 0; i < indent; i++ )
+		std::fputs( "  ", file );
+	
+	std::fprintf( file, "\"%s\": \"%s\"%s\n", key, value, last ? "" : "," );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Mesh Preprocessing Benchmark
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// Preprocess the room into a sound mesh and write the time spent in each preprocessing stage.
+static Bool benchmarkPreprocessing( const BenchmarkRoom& room, const BenchmarkOptions& options,
+									SoundMesh& mesh, FILE* file )
+{
+	const SoundMaterial material = getRoomMaterial();
+	SoundStatistics statistics;
+	MeshRequest request;
+	request.flags.set( MeshFlags::STATISTICS, true );
+	request.statistics = &statistics;
+	request.numThreads = options.numThreads;
+	
+	SoundMeshPreprocessor preprocessor;
+	om::time::Timer timer;
+	
+	if ( !preprocessor.processMesh( room.vertices.getPointer(), room.vertices.getSize(),
+									room.triangles.getPointer(), room.triangles.getSize(),
+									&material, 1, request, mesh ) )
+		return false;
+	
+	timer.update();
+	
+	std::fputs( "      \"preprocess\": {\n", file );
+	writeValue( file, 4, "inputTriangles", (Double)room.triangles.getSize() );
+	writeValue( file, 4, "triangles", (Double)mesh.getTriangleCount() );
+	writeValue( file, 4, "vertices", (Double)mesh.getVertexCount() );
+	writeValue( file, 4, "totalTime", timer.getLastInterval().getSeconds() );
+	writeValue( file, 4, "weldTime", statistics.weldTime.getSeconds() );
+	writeValue( file, 4, "simplifyTime", statistics.simplifyTime.getSeconds() );
+	writeValue( file, 4, "bvhTime", statistics.bvhTime.getSeconds() );
+	writeValue( file, 4, "edgeTime", statistics.edgeTime.getSeconds() );
+	writeValue( file, 4, "edgeVisibilityTime", statistics.edgeVisibilityTime.getSeconds(), true );
+	std::fputs( "      },\n", file );
+	
+	return true;
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		BVH Ray Tracing Benchmark
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// Generate random rays that start inside the room's interior and have uniformly distributed directions.
+static void generateRays( const BenchmarkRoom& room, const BenchmarkOptions& options, ArrayList<BVHRay>& rays )
+{
+	math::Random<Real> random( options.randomSeed );
+	const AABB3f& interior = room.interior;
+	
+	rays.clear();
+	rays.setCapacity( options.numBVHRays );
+	
+	for ( Index i = 0; i < options.numBVHRays; i++ )
+	{
+		const Vector3f origin( random.sample( interior.min.x, interior.max.x ),
+								random.sample( interior.min.y, interior.max.y ),
+								random.sample( interior.min.z, interior.max.z ) );
+		Vector3f direction;
+		Real length2;
+		
+		do
+		{
+			direction = Vector3f( random.sample( -1, 1 ), random.sample( -1, 1 ), random.sample( -1, 1 ) );
+			length2 = direction.getMagnitudeSquared();
+		}
+		while ( length2 > Real(1) || length2 < Real(1e-6) );
+		
+		rays.add( BVHRay( Ray3f( origin, direction / math::sqrt( length2 ) ), 0, math::infinity<Float>() ) );
+	}
+}
+
+
+
+
+/// Trace the rays with the given query type and return the number of rays traced per second.
+static Double timeRays( const BVH& bvh, const ArrayList<BVHRay>& sourceRays, Bool any, Bool packet,
+						Size& numHits )
+{
+	ArrayList<BVHRay> rays( sourceRays );
+	const Size numRays = rays.getSize();
+	om::time::Timer timer;
+	
+	if ( packet )
+	{
+		if ( any )
+			bvh.testRays( rays.getPointer(), numRays );
+		else
+			bvh.intersectRays( rays.getPointer(), numRays );
+	}
+	else
+	{
+		for ( Index i = 0; i < numRays; i++ )
+		{
+			if ( any )
+				bvh.testRay( rays[i] );
+			else
+				bvh.intersectRay( rays[i] );
+		}
+	}
+	
+	timer.update();
+	numHits = 0;
+	
+	for ( Index i = 0; i < numRays; i++ )
+		numHits += rays[i].hitValid();
+	
+	return Double(numRays) / math::max( timer.getLastInterval().getSeconds(), 1e-9 );
+}
+
+
+
+
+/// Trace random rays through the mesh's BVH and write the throughput of each query type.
+static void benchmarkBVH( const BenchmarkRoom& room, const BenchmarkOptions& options,
+						const SoundMesh& mesh, FILE* file )
+{
+	const BVH* bvh = mesh.getBVH();
+	ArrayList<BVHRay> rays;
+	generateRays( room, options, rays );
+	
+	Size intersectHits, testHits, intersectPacketHits, testPacketHits;
+	const Double intersectRate = timeRays( *bvh, rays, false, false, intersectHits );
+	const Double testRate = timeRays( *bvh, rays, true, false, testHits );
+	const Double intersectPacketRate = timeRays( *bvh, rays, false, true, intersectPacketHits );
+	const Double testPacketRate = timeRays( *bvh, rays, true, true, testPacketHits );
+	
+	std::fputs( "      \"bvh\": {\n", file );
+	writeString( file, 4, "type", dynamic_cast<const AABBTree8*>( bvh ) ? "AABBTree8" : "AABBTree4" );
+	writeValue( file, 4, "sizeInBytes", (Double)bvh->getSizeInBytes() );
+	writeValue( file, 4, "rays", (Double)rays.getSize() );
+	writeValue( file, 4, "hitFraction", Double(intersectHits) / math::max( Double(rays.getSize()), 1.0 ) );
+	writeValue( file, 4, "intersectRaysPerSecond", intersectRate );
+	writeValue( file, 4, "testRaysPerSecond", testRate );
+	writeValue( file, 4, "intersectPacketRaysPerSecond", intersectPacketRate );
+	writeValue( file, 4, "testPacketRaysPerSecond", testPacketRate, true );
+	std::fputs( "      },\n", file );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Sound Propagation Benchmark
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+/// A set of propagation flags that isolate one phase of sound propagation.
+struct PropagationPhase
+{
+	/// The name of the phase in the results.
+	const char* name;
+	
+	/// The propagation type flags that are enabled for the phase.
+	UInt32 flags;
+};
+
+
+
+
+/// Propagate sound with only the given phase enabled and write the average per-frame times.
+static void benchmarkPhase( SoundScene& scene, const BenchmarkOptions& options,
+							const PropagationPhase& phase, Bool last, FILE* file )
+{
+	PropagationRequest request = getDefaultRequest( options );
+	SoundStatistics statistics;
+	request.statistics = &statistics;
+	request.flags.set( PropagationFlags::DIRECT, (phase.flags & PropagationFlags::DIRECT) != 0 );
+	request.flags.set( PropagationFlags::SPECULAR, (phase.flags & PropagationFlags::SPECULAR) != 0 );
+	request.flags.set( PropagationFlags::DIFFUSE, (phase.flags & PropagationFlags::DIFFUSE) != 0 );
+	request.flags.set( PropagationFlags::DIFFRACTION, (phase.flags & PropagationFlags::DIFFRACTION) != 0 );
+	
+	SoundPropagator propagator;
+	SoundSceneIR sceneIR;
+	
+	// Warm up the propagator's caches and thread pool so that only steady-state frames are timed.
+	propagator.propagateSound( scene, request, sceneIR );
+	
+	Double propagationTime = 0, rayTracingTime = 0, cacheUpdateTime = 0, irTime = 0;
+	Size irLength = 0;
+	ImpulseResponse ir;
+	IRRequest irRequest;
+	irRequest.ir = true;
+	irRequest.metrics = false;
+	irRequest.normalize = true;
+	irRequest.channelLayout = ChannelLayout::MONO;
+	
+	for ( Index frame = 0; frame < options.numFrames; frame++ )
+	{
+		propagator.propagateSound( scene, request, sceneIR );
+		propagationTime += statistics.propagationTime.getSeconds();
+		rayTracingTime += statistics.rayTracingTime.getSeconds();
+		cacheUpdateTime += statistics.cacheUpdateTime.getSeconds();
+		
+		// Time the conversion of each source-listener IR to the output format.
+		om::time::Timer timer;
+		
+		for ( Index l = 0; l < sceneIR.getListenerCount(); l++ )
+		{
+			const SoundListenerIR& listenerIR = sceneIR.getListenerIR( l );
+			
+			for ( Index s = 0; s < listenerIR.getSourceCount(); s++ )
+			{
+				const SoundSourceIR& sourceIR = listenerIR.getSourceIR( s );
+				irLength += sourceIR.getSampledIR().getLengthInSamples();
+				ir.setIR( sourceIR, *scene.getListener( l ), irRequest );
+			}
+		}
+		
+		timer.update();
+		irTime += timer.getLastInterval().getSeconds();
+	}
+	
+	const Double frameScale = 1.0 / math::max( options.numFrames, Size(1) );
+	
+	std::fprintf( file, "        \"%s\": {\n", phase.name );
+	writeValue( file, 5, "propagationTime", propagationTime*frameScale );
+	writeValue( file, 5, "rayTracingTime", rayTracingTime*frameScale );
+	writeValue( file, 5, "cacheUpdateTime", cacheUpdateTime*frameScale );
+	writeValue( file, 5, "irOutputTime", irTime*frameScale );
+	writeValue( file, 5, "irSamples", Double(irLength)*frameScale, true );
+	std::fprintf( file, "        }%s\n", last ? "" : "," );
+}
+
+
+
+
+/// Propagate sound in the room for each propagation phase and write the timing results.
+static void benchmarkPropagation( const BenchmarkRoom& room, const BenchmarkOptions& options,
+								SoundMesh& mesh, FILE* file )
+{
+	SoundObject object;
+	object.setMesh( &mesh );
+	
+	SoundScene scene;
+	scene.addObject( &object );
+	
+	ArrayList<SoundSource> sources;
+	ArrayList<SoundListener> listeners;
+	sources.setCapacity( room.sources.getSize() );
+	listeners.setCapacity( room.listeners.getSize() );
+	
+	for ( Index i = 0; i < room.sources.getSize(); i++ )
+	{
+		sources.addNew();
+		SoundSource& source = sources.getLast();
+		source.setTransform( Transform3f( room.sources[i] ) );
+		source.setRadius( 0.01f );
+		source.setPower( 1 );
+		scene.addSource( &source );
+	}
+	
+	for ( Index i = 0; i < room.listeners.getSize(); i++ )
+	{
+		listeners.addNew();
+		SoundListener& listener = listeners.getLast();
+		listener.setTransform( Transform3f( room.listeners[i] ) );
+		listener.setRadius( 0.01f );
+		listener.setSensitivity( 0 );
+		scene.addListener( &listener );
+	}
+	
+	const PropagationPhase phases[] =
+	{
+		{ "direct", PropagationFlags::DIRECT },
+		{ "specular", PropagationFlags::SPECULAR },
+		{ "diffuse", PropagationFlags::DIFFUSE },
+		{ "diffraction", PropagationFlags::DIFFRACTION },
+		{ "all", PropagationFlags::DIRECT | PropagationFlags::SPECULAR |
+					PropagationFlags::DIFFUSE | PropagationFlags::DIFFRACTION }
+	};
+	const Size numPhases = sizeof(phases) / sizeof(PropagationPhase);
+	
+	std::fputs( "      \"propagation\": {\n", file );
+	writeValue( file, 4, "sources", (Double)room.sources.getSize() );
+	writeValue( file, 4, "listeners", (Double)room.listeners.getSize() );
+	std::fputs( "        \"phases\": {\n", file );
+	
+	for ( Index i = 0; i < numPhases; i++ )
+		benchmarkPhase( scene, options, phases[i], i + 1 == numPhases, file );
+	
+	std::fputs( "        }\n", file );
+	std::fputs( "      }\n", file );
+}
+
+
+
+
+//##########################################################################################
+//##########################################################################################
+//############		
+//############		Main Function
+//############		
+//##########################################################################################
+//##########################################################################################
+
+
+
+
+static void printUsage( const char* program )
+{
+	std::fprintf( stderr, "Usage: %s [--threads N] [--rays N] [--bvh-rays N] [--frames N] [--seed N] [--output FILE]\n",
+				program );
+}
+
+
+
+
+int main( int argc, char** argv )
+{
+	BenchmarkOptions options;
+	
+	for ( int i = 1; i < argc; i++ )
+	{
+		const char* arg = argv[i];
+		
+		if ( std::strcmp( arg, "--help" ) == 0 || i + 1 >= argc )
+		{
+			printUsage( argv[0] );
+			return std::strcmp( arg, "--help" ) == 0 ? 0 : 1;
+		}
+		
+		const char* value = argv[++i];
+		
+		if ( std::strcmp( arg, "--threads" ) == 0 )
+			options.numThreads = (Size)std::strtoul( value, NULL, 10 );
+		else if ( std::strcmp( arg, "--rays" ) == 0 )
+			options.numRays = (Size)std::strtoul( value, NULL, 10 );
+		else if ( std::strcmp( arg, "--bvh-rays" ) == 0 )
+			options.numBVHRays = (Size)std::strtoul( value, NULL, 10 );
+		else if ( std::strcmp( arg, "--frames" ) == 0 )
+			options.numFrames = (Size)std::strtoul( value, NULL, 10 );
+		else if ( std::strcmp( arg, "--seed" ) == 0 )
+			options.randomSeed = (UInt32)std::strtoul( value, NULL, 10 );
+		else if ( std::strcmp( arg, "--output" ) == 0 )
+			options.outputPath = value;
+		else
+		{
+			printUsage( argv[0] );
+			return 1;
+		}
+	}
+	
+	FILE* file = options.outputPath ? std::fopen( options.outputPath, "w" ) : stdout;
+	
+	if ( !file )
+	{
+		std::fprintf( stderr, "Unable to open output file %s\n", options.outputPath );
+		return 1;
+	}
+	
+	ArrayList<BenchmarkRoom> rooms;
+	createRooms( rooms );
+	
+	std::fputs( "{\n", file );
+	std::fputs( "  \"options\": {\n", file );
+	writeValue( file, 2, "threads", (Double)options.numThreads );
+	writeValue( file, 2, "rays", (Double)options.numRays );
+	writeValue( file, 2, "bvhRays", (Double)options.numBVHRays );
+	writeValue( file, 2, "frames", (Double)options.numFrames );
+	writeValue( file, 2, "seed", (Double)options.randomSeed, true );
+	std::fputs( "  },\n", file );
+	std::fputs( "  \"rooms\": [\n", file );
+	
+	for ( Index i = 0; i < rooms.getSize(); i++ )
+	{
+		const BenchmarkRoom& room = rooms[i];
+		SoundMesh mesh;
+		
+		std::fputs( "    {\n", file );
+		writeString( file, 3, "name", room.name );
+		
+		if ( !benchmarkPreprocessing( room, options, mesh, file ) )
+		{
+			std::fprintf( stderr, "Unable to preprocess room %s\n", room.name );
+			return 1;
+		}
+		
+		benchmarkBVH( room, options, mesh, file );
+		benchmarkPropagation( room, options, mesh, file );
+		
+		std::fprintf( file, "    }%s\n", i + 1 == rooms.getSize() ? "" : "," );
+	}
+	
+	std::fputs( "  ]\n", file );
+	std::fputs( "}\n", file );
+	
+	if ( file != stdout )
+		std::fclose( file );
+	
+	return 0;
+}
@@ -119,4 +119,39 @@ gs::Bool Context::getNormalize()
 void Context::setNormalize(gs::Bool flag)
 {
     ir_request.normalize = flag;
-}
\ No newline at end of file
+}
+
+gs::Bool Context::getCompactIR()
+{
+    return prop_request.flags.isSet(gs::PropagationFlags::COMPACT_IR);
+}
+
+void Context::setCompactIR(gs::Bool flag)
+{
+    prop_request.flags.set(gs::PropagationFlags::COMPACT_IR, flag);
+}
+
+gs::Float Context::getResponseTime()
+{
+    return prop_request.responseTime;
+}
+
+void Context::setResponseTime(gs::Float time)
+{
+    prop_request.responseTime = time;
+}
+
+gs::UInt32 Context::getRandomSeed()
+{
+    return prop_request.randomSeed;
+}
+
+void Context::setRandomSeed(gs::UInt32 seed)
+{
+    prop_request.randomSeed = seed;
+}
+
+void Context::resetCache()
+{
+    prop_request.internalData.reset();
+}
@@ -42,6 +42,18 @@ public:
     gs::Bool getNormalize();
     void setNormalize(gs::Bool flag);
 
+    gs::Bool getCompactIR();
+    void setCompactIR(gs::Bool flag);
+
+    gs::Float getResponseTime();
+    void setResponseTime(gs::Float time);
+
+    gs::UInt32 getRandomSeed();
+    void setRandomSeed(gs::UInt32 seed);
+
+    // drop the path and IR caches that persist between stateful Scene.computeIR() calls
+    void resetCache();
+
 private:
 
 	gs::IRRequest ir_request;
@@ -39,6 +39,33 @@ Listener::getRadius() const
 	return m_listener.getRadius();
 }
 
+void
+Listener::setMicrophones( const std::vector<std::vector<float>> &_mics )
+{
+	m_listener.clearMicrophones();
+
+	for ( const auto &mic : _mics )
+	{
+		if ( mic.size() != 3 )
+			throw std::runtime_error( "Microphone positions must be [x, y, z] lists!" );
+
+		m_listener.addMicrophone( omm::Vector3f( mic.data() ) );
+	}
+}
+
+std::vector<std::vector<float>>
+Listener::getMicrophones() const
+{
+	std::vector<std::vector<float>> ret;
+	for ( gs::Index m = 0; m < m_listener.getMicrophoneCount(); ++m )
+	{
+		const omm::Vector3f &mic = m_listener.getMicrophone( m );
+		ret.push_back( { mic.x, mic.y, mic.z } );
+	}
+
+	return ret;
+}
+
 
 //void
 //Listener::setChannelLayoutType( oms::ChannelLayout::Type _layout )
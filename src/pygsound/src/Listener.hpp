@@ -22,6 +22,9 @@ public:
 	void setRadius( float _radius );
 	float getRadius() const;
 
+	void setMicrophones( const std::vector<std::vector<float>> &_mics );
+	std::vector<std::vector<float>> getMicrophones() const;
+
 //	void setChannelLayoutType( oms::ChannelLayout::Type _layout );
 //	oms::ChannelLayout::Type getChannelLayoutType() const;
 //
@@ -0,0 +1,85 @@
+#include "PathList.hpp"
+#include <cstddef>
+#include <stdexcept>
+
+py::dtype
+PathList::recordType()
+{
+    const std::string bands = "(" + std::to_string(GSOUND_FREQUENCY_COUNT) + ",)f4";
+
+    py::list names, formats, offsets;
+    auto addField = [&]( const char *name, const std::string &format, size_t offset ){
+        names.append(name);
+        formats.append(format);
+        offsets.append(offset);
+    };
+
+    addField("hash", "u8", offsetof(gs::SoundPathRecord, hash));
+    addField("source", "u4", offsetof(gs::SoundPathRecord, source));
+    addField("listener", "u4", offsetof(gs::SoundPathRecord, listener));
+    addField("flags", "u4", offsetof(gs::SoundPathRecord, flags));
+    addField("delay", "f4", offsetof(gs::SoundPathRecord, delay));
+    addField("distance", "f4", offsetof(gs::SoundPathRecord, distance));
+    addField("relative_speed", "f4", offsetof(gs::SoundPathRecord, relativeSpeed));
+    addField("direction", "(3,)f4", offsetof(gs::SoundPathRecord, direction));
+    addField("source_direction", "(3,)f4", offsetof(gs::SoundPathRecord, sourceDirection));
+    addField("intensity", bands, offsetof(gs::SoundPathRecord, intensity));
+
+    py::dict spec;
+    spec["names"] = names;
+    spec["formats"] = formats;
+    spec["offsets"] = offsets;
+    spec["itemsize"] = sizeof(gs::SoundPathRecord);
+
+    return py::dtype::from_args(spec);
+}
+
+void
+PathList::save( const std::string &_path, py::array _paths, const std::vector<float> &_frequencies, bool _append )
+{
+    if ( !_paths.dtype().equal(recordType()) || !(_paths.flags() & py::array::c_style) )
+        throw std::runtime_error( "Paths must be a contiguous array of the pygsound path dtype!" );
+    if ( _frequencies.size() != GSOUND_FREQUENCY_COUNT )
+        throw std::runtime_error( "Frequency list has incompatible length!" );
+
+    gs::Real centers[GSOUND_FREQUENCY_COUNT];
+    for ( size_t b = 0; b < GSOUND_FREQUENCY_COUNT; ++b )
+        centers[b] = _frequencies[b];
+
+    const gs::SoundPathRecord* records = reinterpret_cast<const gs::SoundPathRecord*>( _paths.data() );
+    bool written;
+    {
+        py::gil_scoped_release release;
+        written = gs::SoundPathFile::write( gs::UTF8String( _path.c_str() ), gs::FrequencyBands( centers ),
+                                            records, gs::Size( _paths.size() ), _append );
+    }
+
+    if ( !written )
+        throw std::runtime_error( "Cannot write path file " + _path );
+}
+
+py::dict
+PathList::load( const std::string &_path )
+{
+    gs::SoundPathFile* file = new gs::SoundPathFile();
+    if ( !file->open( gs::UTF8String( _path.c_str() ) ) ){
+        delete file;
+        throw std::runtime_error( "Cannot open path file " + _path );
+    }
+
+    // the arrays are views of the read-only mapping, which stays open until both are released
+    py::capsule owner( file, []( void *f ){ delete reinterpret_cast<gs::SoundPathFile*>( f ); } );
+
+    py::array paths( recordType(), { py::ssize_t(file->getPathCount()) }, { py::ssize_t(sizeof(gs::SoundPathRecord)) },
+                     file->getPaths(), owner );
+    py::array_t<float> frequencies( { py::ssize_t(GSOUND_FREQUENCY_COUNT) }, { py::ssize_t(sizeof(float)) },
+                                    file->getFrequencies(), owner );
+    paths.attr("setflags")( py::arg("write") = false );
+    frequencies.attr("setflags")( py::arg("write") = false );
+
+    py::dict ret;
+    ret["paths"] = paths;
+    ret["frequencies"] = frequencies;
+
+    return ret;
+}
@@ -0,0 +1,24 @@
+#ifndef INC_PATHLIST_HPP
+#define INC_PATHLIST_HPP
+
+#include "Python.hpp"
+#include <gsound/gsSoundPathFile.h>
+#include <string>
+#include <vector>
+
+namespace gs = gsound;
+namespace py = pybind11;
+
+// Discrete paths are exported as NumPy structured arrays that share the layout of gs::SoundPathRecord,
+// so they can be filled in place, written to disk as-is, and memory-mapped back without conversion.
+class PathList
+{
+public:
+
+	static py::dtype recordType();
+
+	static void save( const std::string &_path, py::array _paths, const std::vector<float> &_frequencies, bool _append = false );
+	static py::dict load( const std::string &_path );
+};
+
+#endif  // INC_PATHLIST_HPP
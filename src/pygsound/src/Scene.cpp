@@ -3,11 +3,81 @@
 #include "SoundMesh.hpp"
 #include "Listener.hpp"
 #include "Context.hpp"
+#include "PathList.hpp"
 #include <iostream>
+#include <algorithm>
 
 namespace omm = om::math;
 namespace omt = om::time;
 
+namespace
+{
+
+// Copies each synthesized IR into its own slot of a list of per-pair channel vectors, indexed by [i_src][i_lis].
+struct PairWriter
+{
+    std::vector<std::vector<std::vector<float>>>* pairs;
+    int n_lis;
+
+    void write( gs::Index i_lis, gs::Index i_src, const gs::ImpulseResponse& ir )
+    {
+        std::vector<std::vector<float>>& channels = (*pairs)[i_src*n_lis + i_lis];
+        channels.resize(ir.getChannelCount());
+        for (gs::Index ch = 0; ch < ir.getChannelCount(); ch++)
+            channels[ch].assign(ir.getChannel(ch), ir.getChannel(ch) + ir.getLengthInSamples());
+    }
+};
+
+// Copies each synthesized IR channel-major into a shared buffer at the offset reserved for its pair.
+struct BatchWriter
+{
+    float* output;
+    const py::ssize_t* lengths;
+    const py::ssize_t* offsets;
+    py::ssize_t n_lis;
+    py::ssize_t n_channels;
+    bool swapBuffer;
+
+    void write( gs::Index i_lis, gs::Index i_src, const gs::ImpulseResponse& ir )
+    {
+        // lengths and offsets are indexed by the caller's [i_src, i_lis] before any swap
+        const py::ssize_t index = swapBuffer ? py::ssize_t(i_lis)*n_lis + i_src : py::ssize_t(i_src)*n_lis + i_lis;
+        const py::ssize_t length = lengths[index];
+        float* pairOutput = output + offsets[index];
+
+        for (py::ssize_t ch = 0; ch < n_channels; ch++)
+            std::copy(ir.getChannel(ch), ir.getChannel(ch) + length, pairOutput + ch*length);
+    }
+};
+
+// Copies the metrics of each pair into a [metric, i_src, i_lis, band] buffer.
+struct MetricsWriter
+{
+    enum { METRIC_COUNT = 7 };
+
+    float* output;
+    py::ssize_t n_src;
+    py::ssize_t n_lis;
+    bool swapBuffer;
+
+    void write( gs::Index i_lis, gs::Index i_src, const gs::ImpulseResponse& ir )
+    {
+        const py::ssize_t s = swapBuffer ? py::ssize_t(i_lis) : py::ssize_t(i_src);
+        const py::ssize_t l = swapBuffer ? py::ssize_t(i_src) : py::ssize_t(i_lis);
+        const gs::IRMetrics& metrics = ir.getMetrics();
+        const gs::FrequencyBandResponse* responses[METRIC_COUNT] =
+            { &metrics.t60, &metrics.edt, &metrics.c50, &metrics.c80, &metrics.d50, &metrics.g, &metrics.ts };
+
+        for (py::ssize_t m = 0; m < METRIC_COUNT; m++){
+            float* pairOutput = output + ((m*n_src + s)*n_lis + l)*GSOUND_FREQUENCY_COUNT;
+            for (gs::Index b = 0; b < GSOUND_FREQUENCY_COUNT; b++)
+                pairOutput[b] = (*responses[m])[b];
+        }
+    }
+};
+
+}
+
 Scene::Scene()
 {
 	m_scene.addObject( &m_soundObject );
@@ -26,6 +96,9 @@ Scene::computeIR( std::vector<SoundSource> &_sources, std::vector<Listener> &_li
     int n_src = _sources.size();
     int n_lis = _listeners.size();
 
+    m_scene.clearSources();
+    m_scene.clearListeners();
+
     for (SoundSource& p : _sources){
         m_scene.addSource(&p.m_source);
     }
@@ -39,33 +112,12 @@ Scene::computeIR( std::vector<SoundSource> &_sources, std::vector<Listener> &_li
 
     propagator.propagateSound(m_scene, _context.internalPropReq(), sceneIR);
 
-    py::list IRPairs(n_src);
-    auto rate = _context.getSampleRate();
-    for (int i_src = 0; i_src < n_src; ++i_src){
-        py::list srcSamples(n_src);
-        for (int i_lis = 0; i_lis < n_lis; ++i_lis){
-            const gs::SoundSourceIR& sourceIR = sceneIR.getListenerIR(i_lis).getSourceIR(i_src);
-            gs::ImpulseResponse result;
-            result.setIR(sourceIR, *m_scene.getListener(i_lis), _context.internalIRReq());
-            auto numOfChannels = int(result.getChannelCount());
-
-            py::list samples;
-            for (int ch = 0; ch < numOfChannels; ch++)
-            {
-                auto *sample_ch = result.getChannel(ch);
-                std::vector<float> samples_ch(sample_ch, sample_ch+result.getLengthInSamples());
-                samples.append(samples_ch);
-            }
-            srcSamples[i_lis] = samples;
-        }
-        IRPairs[i_src] = srcSamples;
-    }
+    py::list IRPairs = collectIR(n_src, n_lis, _context);
 
-    m_scene.clearSources();
-    m_scene.clearListeners();
+    restoreHandles();
 
     py::dict ret;
-    ret["rate"] = rate;
+    ret["rate"] = _context.getSampleRate();
     ret["samples"] = IRPairs;   // index by [i_src, i_lis, i_channel]
 
     return ret;
@@ -127,3 +179,406 @@ Scene::computeIR( std::vector<std::vector<float>> &_sources, std::vector<std::ve
 
 	return ret;
 }
+
+py::dict
+Scene::computeIRBatch( py::array_t<float, py::array::c_style | py::array::forcecast> _sources,
+                       py::array_t<float, py::array::c_style | py::array::forcecast> _listeners, Context &_context,
+                       float src_radius, float src_power, float lis_radius)
+{
+    const py::ssize_t n_src = _sources.shape(0);
+    const py::ssize_t n_lis = _listeners.shape(0);
+
+    std::vector<SoundSource> sources;
+    std::vector<Listener> listeners;
+    const bool swapBuffer = propagateBatch(_sources, _listeners, _context, src_radius, src_power, lis_radius, sources, listeners);
+    const py::ssize_t n_prop_src = py::ssize_t(sources.size());
+    const py::ssize_t n_prop_lis = py::ssize_t(listeners.size());
+
+    // Lay out every IR back to back in one buffer, channel-major within each pair, indexed by the caller's [i_src, i_lis].
+    const gs::IRRequest& irRequest = _context.internalIRReq();
+    const py::ssize_t n_channels = py::ssize_t(irRequest.channelLayout.getChannelCount());
+
+    py::array_t<py::ssize_t> lengths({ n_src, n_lis });
+    py::array_t<py::ssize_t> offsets({ n_src, n_lis });
+    auto lengths_w = lengths.mutable_unchecked<2>();
+    auto offsets_w = offsets.mutable_unchecked<2>();
+    py::ssize_t total = 0;
+
+    for (py::ssize_t i_src = 0; i_src < n_prop_src; ++i_src){
+        for (py::ssize_t i_lis = 0; i_lis < n_prop_lis; ++i_lis){
+            const gs::SoundListenerIR& listenerIR = sceneIR.getListenerIR(i_lis);
+            const gs::SoundSourceIR& sourceIR = listenerIR.getSourceIR(i_src);
+            const py::ssize_t length = py::ssize_t(gs::ImpulseResponse::getLengthInSamples(sourceIR, *listenerIR.getListener()));
+            const py::ssize_t s = swapBuffer ? i_lis : i_src;
+            const py::ssize_t l = swapBuffer ? i_src : i_lis;
+            lengths_w(s, l) = length;
+            offsets_w(s, l) = total;
+            total += length*n_channels;
+        }
+    }
+
+    py::array_t<float> samples(total);
+
+    BatchWriter writer;
+    writer.output = samples.mutable_data();
+    writer.lengths = lengths.data();
+    writer.offsets = offsets.data();
+    writer.n_lis = n_lis;
+    writer.n_channels = n_channels;
+    writer.swapBuffer = swapBuffer;
+
+    {
+        // synthesize the pairs on the context's threads, each writing its own slice of the buffer
+        py::gil_scoped_release release;
+        synthesizer.synthesize(sceneIR, irRequest, _context.getThreadsCount(), gs::bind(&BatchWriter::write, &writer));
+    }
+
+    restoreHandles();
+
+    py::dict ret;
+    ret["rate"] = _context.getSampleRate();
+    ret["channels"] = n_channels;
+    ret["samples"] = samples;   // IR [i_src, i_lis] is samples[offsets[i_src, i_lis]:][:channels*lengths[i_src, i_lis]]
+    ret["lengths"] = lengths;
+    ret["offsets"] = offsets;
+
+    return ret;
+}
+
+py::dict
+Scene::computeMetricsBatch( py::array_t<float, py::array::c_style | py::array::forcecast> _sources,
+                            py::array_t<float, py::array::c_style | py::array::forcecast> _listeners, Context &_context,
+                            float src_radius, float src_power, float lis_radius)
+{
+    const py::ssize_t n_src = _sources.shape(0);
+    const py::ssize_t n_lis = _listeners.shape(0);
+
+    std::vector<SoundSource> sources;
+    std::vector<Listener> listeners;
+    const bool swapBuffer = propagateBatch(_sources, _listeners, _context, src_radius, src_power, lis_radius, sources, listeners);
+
+    // only bin the energy of each pair and evaluate the metrics on the bins, without synthesizing a waveform
+    gs::IRRequest irRequest = _context.internalIRReq();
+    irRequest.ir = false;
+    irRequest.binEnergy = true;
+    irRequest.metrics = true;
+
+    const py::ssize_t n_bands = GSOUND_FREQUENCY_COUNT;
+    py::array_t<float> metrics({ py::ssize_t(MetricsWriter::METRIC_COUNT), n_src, n_lis, n_bands });
+
+    MetricsWriter writer;
+    writer.output = metrics.mutable_data();
+    writer.n_src = n_src;
+    writer.n_lis = n_lis;
+    writer.swapBuffer = swapBuffer;
+
+    {
+        py::gil_scoped_release release;
+        synthesizer.synthesize(sceneIR, irRequest, _context.getThreadsCount(), gs::bind(&MetricsWriter::write, &writer));
+    }
+
+    restoreHandles();
+
+    const gs::FrequencyBands& frequencies = _context.internalPropReq().frequencies;
+    py::array_t<float> bands(n_bands);
+    for (py::ssize_t b = 0; b < n_bands; ++b)
+        bands.mutable_at(b) = frequencies[b];
+
+    // each metric is a view of the shared buffer indexed by [i_src, i_lis, i_band]
+    py::dict ret;
+    ret["frequencies"] = bands;
+    ret["t60"] = metrics[py::int_(0)];
+    ret["edt"] = metrics[py::int_(1)];
+    ret["c50"] = metrics[py::int_(2)];
+    ret["c80"] = metrics[py::int_(3)];
+    ret["d50"] = metrics[py::int_(4)];
+    ret["g"] = metrics[py::int_(5)];
+    ret["ts"] = metrics[py::int_(6)];
+
+    return ret;
+}
+
+py::dict
+Scene::computePathsBatch( py::array_t<float, py::array::c_style | py::array::forcecast> _sources,
+                          py::array_t<float, py::array::c_style | py::array::forcecast> _listeners, Context &_context,
+                          float src_radius, float src_power, float lis_radius)
+{
+    const py::ssize_t n_src = _sources.shape(0);
+    const py::ssize_t n_lis = _listeners.shape(0);
+
+    // Doppler sorting keeps the direct, specular and diffraction paths discrete, while the
+    // diffuse energy is still accumulated in the sampled IR of each pair.
+    gs::PropagationFlags &flags = _context.internalPropReq().flags;
+    const bool sorting = flags.isSet(gs::PropagationFlags::DOPPLER_SORTING);
+    flags.set(gs::PropagationFlags::DOPPLER_SORTING, true);
+
+    std::vector<SoundSource> sources;
+    std::vector<Listener> listeners;
+    bool swapBuffer;
+    try {
+        swapBuffer = propagateBatch(_sources, _listeners, _context, src_radius, src_power, lis_radius, sources, listeners);
+    }
+    catch (...) {
+        flags.set(gs::PropagationFlags::DOPPLER_SORTING, sorting);
+        throw;
+    }
+    flags.set(gs::PropagationFlags::DOPPLER_SORTING, sorting);
+
+    const py::ssize_t n_prop_src = py::ssize_t(sources.size());
+    const py::ssize_t n_prop_lis = py::ssize_t(listeners.size());
+    const py::ssize_t n_bands = GSOUND_FREQUENCY_COUNT;
+
+    // the paths and histograms of every pair are packed back to back, indexed by the caller's [i_src, i_lis]
+    py::array_t<py::ssize_t> path_counts({ n_src, n_lis });
+    py::array_t<py::ssize_t> path_offsets({ n_src, n_lis });
+    py::array_t<py::ssize_t> hist_lengths({ n_src, n_lis });
+    py::array_t<py::ssize_t> hist_offsets({ n_src, n_lis });
+    auto path_counts_w = path_counts.mutable_unchecked<2>();
+    auto path_offsets_w = path_offsets.mutable_unchecked<2>();
+    auto hist_lengths_w = hist_lengths.mutable_unchecked<2>();
+    auto hist_offsets_w = hist_offsets.mutable_unchecked<2>();
+    py::ssize_t total_paths = 0;
+    py::ssize_t total_samples = 0;
+
+    for (py::ssize_t i_src = 0; i_src < n_prop_src; ++i_src){
+        for (py::ssize_t i_lis = 0; i_lis < n_prop_lis; ++i_lis){
+            const gs::SoundSourceIR& sourceIR = sceneIR.getListenerIR(i_lis).getSourceIR(i_src);
+            const py::ssize_t s = swapBuffer ? i_lis : i_src;
+            const py::ssize_t l = swapBuffer ? i_src : i_lis;
+            path_counts_w(s, l) = py::ssize_t(sourceIR.getPathCount());
+            path_offsets_w(s, l) = total_paths;
+            hist_lengths_w(s, l) = py::ssize_t(sourceIR.isCompact() ? sourceIR.getCompactIR().getLengthInSamples()
+                                                                  : sourceIR.getSampledIR().getLengthInSamples());
+            hist_offsets_w(s, l) = total_samples;
+            total_paths += path_counts_w(s, l);
+            total_samples += hist_lengths_w(s, l);
+        }
+    }
+
+    // the records are written straight into the NumPy buffers, without any per-path Python objects
+    py::array paths( PathList::recordType(), { total_paths } );
+    py::array_t<float> histogram({ total_samples, n_bands });
+    gs::SoundPathRecord* records = reinterpret_cast<gs::SoundPathRecord*>( paths.mutable_data() );
+    float* bins = histogram.mutable_data();
+
+    {
+        py::gil_scoped_release release;
+        gs::SampledIR expandedIR;   // compact IRs are expanded one pair at a time
+
+        for (py::ssize_t i_src = 0; i_src < n_prop_src; ++i_src){
+            for (py::ssize_t i_lis = 0; i_lis < n_prop_lis; ++i_lis){
+                const gs::SoundSourceIR& sourceIR = sceneIR.getListenerIR(i_lis).getSourceIR(i_src);
+                const gs::SampledIR& sampledIR = sourceIR.expandSampledIR(expandedIR);
+                const py::ssize_t s = swapBuffer ? i_lis : i_src;
+                const py::ssize_t l = swapBuffer ? i_src : i_lis;
+                gs::SoundPathRecord* pairRecords = records + path_offsets_w(s, l);
+
+                // paths traced from a listener to a source are reversed back to the caller's source and listener
+                for (gs::Index p = 0; p < sourceIR.getPathCount(); ++p){
+                    pairRecords[p] = gs::SoundPathRecord(sourceIR.getPath(p), gs::UInt32(i_src), gs::UInt32(i_lis));
+                    if (swapBuffer)
+                        pairRecords[p].reverse();
+                }
+
+                std::copy(sampledIR.getIntensity(), sampledIR.getIntensity() + hist_lengths_w(s, l)*n_bands,
+                          bins + hist_offsets_w(s, l)*n_bands);
+            }
+        }
+    }
+
+    restoreHandles();
+
+    const gs::FrequencyBands& frequencies = _context.internalPropReq().frequencies;
+    py::array_t<float> bands(n_bands);
+    for (py::ssize_t b = 0; b < n_bands; ++b)
+        bands.mutable_at(b) = frequencies[b];
+
+    py::dict ret;
+    ret["rate"] = _context.getSampleRate();
+    ret["frequencies"] = bands;
+    ret["paths"] = paths;                       // paths of [i_src, i_lis] are paths[path_offsets[i_src, i_lis]:][:path_counts[i_src, i_lis]]
+    ret["path_counts"] = path_counts;
+    ret["path_offsets"] = path_offsets;
+    ret["histogram"] = histogram;               // diffuse energy per sample and band, histogram[hist_offsets[i_src, i_lis]:][:hist_lengths[i_src, i_lis]]
+    ret["hist_lengths"] = hist_lengths;
+    ret["hist_offsets"] = hist_offsets;
+
+    return ret;
+}
+
+void
+Scene::addSource( std::shared_ptr<SoundSource> _source )
+{
+    if (!_source || std::find(m_sources.begin(), m_sources.end(), _source) != m_sources.end())
+        return;
+
+    m_sources.push_back(_source);
+    m_scene.addSource(&_source->m_source);
+}
+
+void
+Scene::addListener( std::shared_ptr<Listener> _listener )
+{
+    if (!_listener || std::find(m_listeners.begin(), m_listeners.end(), _listener) != m_listeners.end())
+        return;
+
+    m_listeners.push_back(_listener);
+    m_scene.addListener(&_listener->m_listener);
+}
+
+bool
+Scene::removeSource( const std::shared_ptr<SoundSource> &_source )
+{
+    auto it = std::find(m_sources.begin(), m_sources.end(), _source);
+    if (it == m_sources.end())
+        return false;
+
+    m_scene.removeSource(&_source->m_source);
+    m_sources.erase(it);
+    return true;
+}
+
+bool
+Scene::removeListener( const std::shared_ptr<Listener> &_listener )
+{
+    auto it = std::find(m_listeners.begin(), m_listeners.end(), _listener);
+    if (it == m_listeners.end())
+        return false;
+
+    m_scene.removeListener(&_listener->m_listener);
+    m_listeners.erase(it);
+    return true;
+}
+
+void
+Scene::clearSources()
+{
+    m_sources.clear();
+    m_scene.clearSources();
+}
+
+void
+Scene::clearListeners()
+{
+    m_listeners.clear();
+    m_scene.clearListeners();
+}
+
+py::dict
+Scene::computeIR( Context &_context )
+{
+    // The scene already holds exactly the persistent handles, in the order they were added.
+    // Propagation caches are keyed by the gs::SoundSource/gs::SoundListener addresses, which stay
+    // fixed for the lifetime of each handle, so successive calls reuse the previous frame's paths.
+    int n_src = m_sources.size();
+    int n_lis = m_listeners.size();
+
+    if (m_scene.getObjectCount() == 0){
+        std::cerr << "object count is zero, cannot propagate sound!" << std::endl;
+    }
+
+    {
+        py::gil_scoped_release release;
+        propagator.propagateSound(m_scene, _context.internalPropReq(), sceneIR);
+    }
+
+    py::dict ret;
+    ret["rate"] = _context.getSampleRate();
+    ret["samples"] = collectIR(n_src, n_lis, _context);   // index by [i_src, i_lis, i_channel]
+
+    return ret;
+}
+
+bool
+Scene::propagateBatch( py::array_t<float, py::array::c_style | py::array::forcecast> &_sources,
+                       py::array_t<float, py::array::c_style | py::array::forcecast> &_listeners, Context &_context,
+                       float src_radius, float src_power, float lis_radius,
+                       std::vector<SoundSource> &sources, std::vector<Listener> &listeners )
+{
+    if ( _sources.ndim() != 2 || _sources.shape(1) != 3 || _listeners.ndim() != 2 || _listeners.shape(1) != 3 )
+        throw std::runtime_error( "Source and listener locations must be N x 3 arrays!" );
+
+    // listener propagation is most expensive, so swap them for computation if there are more listeners
+    const bool swapBuffer = _sources.shape(0) < _listeners.shape(0);
+    auto src_pos = swapBuffer ? _listeners.unchecked<2>() : _sources.unchecked<2>();
+    auto lis_pos = swapBuffer ? _sources.unchecked<2>() : _listeners.unchecked<2>();
+    const py::ssize_t n_prop_src = src_pos.shape(0);
+    const py::ssize_t n_prop_lis = lis_pos.shape(0);
+
+    m_scene.clearSources();
+    m_scene.clearListeners();
+
+    // the scene keeps pointers to the handles, so they must not move after they are added
+    sources.clear();
+    listeners.clear();
+    sources.reserve( n_prop_src );
+    listeners.reserve( n_prop_lis );
+
+    for (py::ssize_t i = 0; i < n_prop_src; ++i){
+        sources.emplace_back( std::vector<float>{ src_pos(i, 0), src_pos(i, 1), src_pos(i, 2) } );
+        sources.back().setRadius(src_radius);
+        sources.back().setPower(src_power);
+        m_scene.addSource(&sources.back().m_source);
+    }
+    for (py::ssize_t i = 0; i < n_prop_lis; ++i){
+        listeners.emplace_back( std::vector<float>{ lis_pos(i, 0), lis_pos(i, 1), lis_pos(i, 2) } );
+        listeners.back().setRadius(lis_radius);
+        m_scene.addListener(&listeners.back().m_listener);
+    }
+
+    if (m_scene.getObjectCount() == 0){
+        std::cerr << "object count is zero, cannot propagate sound!" << std::endl;
+    }
+
+    {
+        py::gil_scoped_release release;
+        propagator.propagateSound(m_scene, _context.internalPropReq(), sceneIR);
+    }
+
+    return swapBuffer;
+}
+
+void
+Scene::restoreHandles()
+{
+    // put back the persistent handles after a stateless call used the scene for its own sources and listeners
+    m_scene.clearSources();
+    m_scene.clearListeners();
+
+    for (auto& p : m_sources){
+        m_scene.addSource(&p->m_source);
+    }
+    for (auto& p : m_listeners){
+        m_scene.addListener(&p->m_listener);
+    }
+}
+
+py::list
+Scene::collectIR( int n_src, int n_lis, Context &_context )
+{
+    std::vector<std::vector<std::vector<float>>> pairs(size_t(n_src)*n_lis);
+    PairWriter writer;
+    writer.pairs = &pairs;
+    writer.n_lis = n_lis;
+
+    {
+        // synthesize the pairs on the context's threads before converting them to Python lists
+        py::gil_scoped_release release;
+        synthesizer.synthesize(sceneIR, _context.internalIRReq(), _context.getThreadsCount(),
+                               gs::bind(&PairWriter::write, &writer));
+    }
+
+    py::list IRPairs(n_src);
+    for (int i_src = 0; i_src < n_src; ++i_src){
+        py::list srcSamples(n_lis);
+        for (int i_lis = 0; i_lis < n_lis; ++i_lis){
+            py::list samples;
+            for (const std::vector<float>& samples_ch : pairs[size_t(i_src)*n_lis + i_lis])
+                samples.append(samples_ch);
+            srcSamples[i_lis] = samples;
+        }
+        IRPairs[i_src] = srcSamples;
+    }
+
+    return IRPairs;
+}
@@ -6,7 +6,10 @@
 #include <gsound/gsSoundObject.h>
 #include <gsound/gsSoundPropagator.h>
 #include <gsound/gsImpulseResponse.h>
+#include <gsound/gsIRSynthesizer.h>
 #include <pybind11/stl.h>
+#include <memory>
+#include <vector>
 
 namespace gs = gsound;
 namespace py = pybind11;
@@ -27,6 +30,40 @@ public:
     py::dict computeIR( std::vector<SoundSource> &_sources, std::vector<Listener> &_listeners, Context &_context );
     py::dict computeIR( std::vector<std::vector<float>> &_sources, std::vector<std::vector<float>> &_listeners, Context &_context,
                             float src_radius = 0.01, float src_power = 1.0, float lis_radius = 0.01);
+    py::dict computeIRBatch( py::array_t<float, py::array::c_style | py::array::forcecast> _sources,
+                            py::array_t<float, py::array::c_style | py::array::forcecast> _listeners, Context &_context,
+                            float src_radius = 0.01, float src_power = 1.0, float lis_radius = 0.01);
+    // Acoustic metrics only: the energy of each pair is binned and evaluated without synthesizing a waveform.
+    py::dict computeMetricsBatch( py::array_t<float, py::array::c_style | py::array::forcecast> _sources,
+                            py::array_t<float, py::array::c_style | py::array::forcecast> _listeners, Context &_context,
+                            float src_radius = 0.01, float src_power = 1.0, float lis_radius = 0.01);
+    // Discrete direct, specular and diffraction paths of each pair as a structured array, with the diffuse energy
+    // returned as the per-band energy histogram of each pair's sampled IR.
+    py::dict computePathsBatch( py::array_t<float, py::array::c_style | py::array::forcecast> _sources,
+                            py::array_t<float, py::array::c_style | py::array::forcecast> _listeners, Context &_context,
+                            float src_radius = 0.01, float src_power = 1.0, float lis_radius = 0.01);
+
+    // Persistent sources and listeners stay in the scene between calls, so the propagation caches
+    // stored in the Context warm-start when they are moved and computeIR( _context ) is called again.
+    void addSource( std::shared_ptr<SoundSource> _source );
+    void addListener( std::shared_ptr<Listener> _listener );
+    bool removeSource( const std::shared_ptr<SoundSource> &_source );
+    bool removeListener( const std::shared_ptr<Listener> &_listener );
+    void clearSources();
+    void clearListeners();
+    py::dict computeIR( Context &_context );
+
+private:
+
+    bool propagateBatch( py::array_t<float, py::array::c_style | py::array::forcecast> &_sources,
+                         py::array_t<float, py::array::c_style | py::array::forcecast> &_listeners, Context &_context,
+                         float src_radius, float src_power, float lis_radius,
+                         std::vector<SoundSource> &sources, std::vector<Listener> &listeners );
+    void restoreHandles();
+    py::list collectIR( int n_src, int n_lis, Context &_context );
+
+    std::vector<std::shared_ptr<SoundSource>> m_sources;
+    std::vector<std::shared_ptr<Listener>> m_listeners;
 
 public:
 
@@ -34,6 +71,7 @@ public:
 	gs::SoundObject m_soundObject;
 	gs::SoundPropagator propagator;
 	gs::SoundSceneIR sceneIR;
+	gs::IRSynthesizer synthesizer;
 
 };
 
@@ -2,8 +2,13 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <iterator>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
@@ -12,6 +17,7 @@
 #include <gsound/gsSoundObject.h>
 #include <gsound/gsSoundMesh.h>
 #include <gsound/gsSoundMeshPreprocessor.h>
+#include <om/omFileSystem.h>
 #include <om/omMath.h>
 #include <om/omSound.h>
 
@@ -19,8 +25,131 @@ namespace gs = gsound;
 namespace oms = om::sound;
 namespace omm = om::math;
 
+namespace
+{
+
+// Bump this when loadObj changes how it builds a mesh, so that stale cache entries are never used.
+const char *const MESH_CACHE_VERSION = "pygsound-mesh-cache-2";
+
+// 64-bit FNV-1a hash of everything that determines the preprocessed mesh.
+class MeshCacheKey
+{
+public:
+
+	void add( const void *_data, std::size_t _size )
+	{
+		const unsigned char *bytes = static_cast< const unsigned char * >( _data );
+		for ( std::size_t i = 0; i < _size; ++i )
+			m_hash = ( m_hash ^ bytes[i] ) * 1099511628211ull;
+	}
+
+	template < typename T >
+	void add( const T &_value ) { add( &_value, sizeof( T ) ); }
+
+	void add( const std::string &_string )
+	{
+		add( _string.size() );
+		add( _string.data(), _string.size() );
+	}
+
+	std::string str() const
+	{
+		char hex[17];
+		std::snprintf( hex, sizeof( hex ), "%016llx", static_cast< unsigned long long >( m_hash ) );
+		return hex;
+	}
+
+private:
+
+	std::uint64_t m_hash = 14695981039346656037ull;
+};
+
+bool readFile( const std::string &_path, std::string &_contents )
+{
+	std::ifstream file( _path, std::ios::binary );
+	if ( !file )
+		return false;
+
+	std::ostringstream contents;
+	contents << file.rdbuf();
+	_contents = contents.str();
+	return true;
+}
+
+// Returns the cache file name for the OBJ, its material libraries and the preprocessing parameters,
+// or an empty string if the OBJ cannot be read.
+std::string meshCacheName( const std::string &_path, const std::string &_basepath, float _forceabsorp, float _forcescatter,
+                           const gs::MeshRequest &_request )
+{
+	std::string obj;
+	if ( !readFile( _path, obj ) )
+		return std::string();
+
+	MeshCacheKey key;
+	key.add( std::string( MESH_CACHE_VERSION ) );
+	key.add( obj );
+
+	// the materials come from every library named by an mtllib statement, as tinyobj resolves them
+	std::istringstream lines( obj );
+	std::string line;
+	while ( std::getline( lines, line ) )
+	{
+		std::istringstream tokens( line );
+		std::string token;
+		if ( !( tokens >> token ) || token != "mtllib" )
+			continue;
+
+		while ( tokens >> token )
+		{
+			std::string mtl;
+			key.add( token );
+			if ( readFile( _basepath + token, mtl ) )
+				key.add( mtl );
+		}
+	}
+
+	key.add( _forceabsorp );
+	key.add( _forcescatter );
+	key.add( _request.flags );
+	key.add( _request.voxelSize );
+	key.add( _request.weldTolerance );
+	key.add( _request.simplifyTolerance );
+	key.add( _request.minDiffractionEdgeAngle );
+	key.add( _request.minDiffractionEdgeLength );
+	key.add( _request.edgeResolution );
+	key.add( _request.minRaysPerEdge );
+	key.add( _request.maxRaysPerEdge );
+	key.add( _request.edgeOffset );
+	key.add( _request.diffuseResolution );
+
+	return key.str() + ".gsmesh";
+}
+
+// Writes the mesh to a temporary file that is renamed into place, so that concurrent workers never read a partial file.
+void saveCachedMesh( const gs::SoundMesh &_mesh, const std::string &_cachedir, const std::string &_cachepath )
+{
+	om::Directory directory( gs::UTF8String( _cachedir.c_str() ) );
+	if ( !directory.exists() && !directory.create() )
+	{
+		std::cerr << "WARNING: cannot create mesh cache directory " << _cachedir << "\n";
+		return;
+	}
+
+	const std::string temppath = _cachepath + "." + std::to_string( std::random_device()() ) + ".tmp";
+	if ( !_mesh.save( temppath.c_str() ) || std::rename( temppath.c_str(), _cachepath.c_str() ) != 0 )
+	{
+		std::remove( temppath.c_str() );
+
+		// another worker may have written the same mesh first
+		if ( !om::File( gs::UTF8String( _cachepath.c_str() ) ).exists() )
+			std::cerr << "WARNING: cannot write mesh cache file " << _cachepath << "\n";
+	}
+}
+
+}
+
 std::shared_ptr< SoundMesh >
-SoundMesh::loadObj( const std::string &_path, float _forceabsorp, float _forcescatter )
+SoundMesh::loadObj( const std::string &_path, float _forceabsorp, float _forcescatter, const std::string &_cachedir )
 {
 	tinyobj::attrib_t attrib;
 	std::vector< tinyobj::shape_t > shapes;
@@ -32,6 +161,28 @@ SoundMesh::loadObj( const std::string &_path, float _forceabsorp, float _forcesc
     basepath = _path;
     basepath.erase(loc + 1);
 
+    gs::MeshRequest meshRequest;
+    meshRequest.minDiffractionEdgeAngle = 30;
+    meshRequest.minDiffractionEdgeLength = 0.5;
+
+    // an empty cache directory falls back to the environment, so that existing scripts can share a cache
+    std::string cachedir = _cachedir;
+    if ( cachedir.empty() && std::getenv( "PYGSOUND_MESH_CACHE" ) )
+        cachedir = std::getenv( "PYGSOUND_MESH_CACHE" );
+
+    std::string cachepath;
+    if ( !cachedir.empty() )
+    {
+        const std::string cachename = meshCacheName( _path, basepath, _forceabsorp, _forcescatter, meshRequest );
+        if ( !cachename.empty() )
+        {
+            cachepath = cachedir + "/" + cachename;
+
+            auto cached = std::make_shared< SoundMesh >();
+            if ( gs::SoundMesh::load( cachepath.c_str(), cached->m_mesh ) )
+                return cached;
+        }
+    }
 
 	bool errv = tinyobj::LoadObj( &attrib, &shapes, &materials, &err, _path.c_str(), basepath.c_str() );
 	if ( !errv )
@@ -164,14 +315,13 @@ SoundMesh::loadObj( const std::string &_path, float _forceabsorp, float _forcesc
 	auto ret = std::make_shared< SoundMesh >();
 
 	gs::SoundMeshPreprocessor preprocessor;
-    gs::MeshRequest meshRequest;
-    meshRequest.minDiffractionEdgeAngle = 30;
-    meshRequest.minDiffractionEdgeLength = 0.5;
 	if ( !preprocessor.processMesh( &verts[0], verts.size(),
 	                                &tris[0], tris.size(),
 	                                &mats[0], mats.size(), meshRequest, ret->m_mesh ) )
 		throw std::runtime_error( "Cannot preprocess sound mesh!" );
 
+	if ( !cachepath.empty() )
+		saveCachedMesh( ret->m_mesh, cachedir, cachepath );
 
 	return ret;
 }
@@ -11,7 +11,8 @@ class SoundMesh
 {
 public:
 
-	static std::shared_ptr< SoundMesh > loadObj( const std::string &_path, float _forceabsorp = -1.0, float _forcescatter = -1.0 );
+	static std::shared_ptr< SoundMesh > loadObj( const std::string &_path, float _forceabsorp = -1.0, float _forcescatter = -1.0,
+	                                             const std::string &_cachedir = std::string() );
 	static std::shared_ptr< SoundMesh > createBox( float _width, float _length, float _height, float _absorp = 0.5, float _scatter = 0.1 );
     static std::shared_ptr< SoundMesh > createBox( float _width, float _length, float _height, std::vector<float> _absorp, float _scatter = 0.1 );
 
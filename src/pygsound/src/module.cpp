@@ -15,6 +15,7 @@
 #include "SoundSource.hpp"
 #include "Listener.hpp"
 #include "MicrophoneArrays.hpp"
+#include "PathList.hpp"
 
 
 namespace py = pybind11;
@@ -36,13 +37,20 @@ PYBIND11_MODULE(pygsound, ps)
             .def_property( "threads_count", &Context::getThreadsCount, &Context::setThreadsCount )
             .def_property( "sample_rate", &Context::getSampleRate, &Context::setSampleRate )
             .def_property( "channel_type", &Context::getChannelLayout, &Context::setChannelLayout )
-            .def_property( "normalize", &Context::getNormalize, &Context::setNormalize );
+            .def_property( "normalize", &Context::getNormalize, &Context::setNormalize )
+            .def_property( "compact_ir", &Context::getCompactIR, &Context::setCompactIR,
+                           "Store sampled IRs at reduced precision between propagation and synthesis to save memory" )
+            .def_property( "response_time", &Context::getResponseTime, &Context::setResponseTime )
+            .def_property( "random_seed", &Context::getRandomSeed, &Context::setRandomSeed,
+                           "Seed of the per-ray random streams; results do not depend on threads_count" )
+            .def( "reset_cache", &Context::resetCache, "Drop the propagation caches kept between stateful Scene.computeIR calls" );
 
 	py::class_< SoundMesh, std::shared_ptr< SoundMesh > >( ps, "SoundMesh" )
             .def(py::init<>());
 
-	ps.def( "loadobj", &SoundMesh::loadObj, "A function to load mesh and materials",
-            py::arg("_path"), py::arg("_forceabsorp") = -1.0, py::arg("_forcescatter") = -1.0 );
+	ps.def( "loadobj", &SoundMesh::loadObj,
+            "A function to load mesh and materials, reusing the preprocessed mesh from _cachedir (or $PYGSOUND_MESH_CACHE) when the files are unchanged",
+            py::arg("_path"), py::arg("_forceabsorp") = -1.0, py::arg("_forcescatter") = -1.0, py::arg("_cachedir") = "" );
     ps.def( "createbox", py::overload_cast<float, float, float, float, float>(&SoundMesh::createBox),
             "A function to create a simple shoebox mesh", py::arg("_width"), py::arg("_length"), py::arg("_height"),
             py::arg("_absorp") = 0.5, py::arg("_scatter") = 0.1 );
@@ -50,13 +58,36 @@ PYBIND11_MODULE(pygsound, ps)
             "A function to create a simple shoebox mesh", py::arg("_width"), py::arg("_length"), py::arg("_height"),
             py::arg("_absorp"), py::arg("_scatter") = 0.1 );
 
+    ps.attr( "path_dtype" ) = PathList::recordType();
+    ps.def( "savepaths", &PathList::save, "A function to write a path array to a binary path file that can be memory-mapped",
+            py::arg("_path"), py::arg("_paths"), py::arg("_frequencies"), py::arg("_append") = false );
+    ps.def( "loadpaths", &PathList::load, "A function to memory-map the paths of a binary path file as a read-only array",
+            py::arg("_path") );
+
     py::class_< Scene, std::shared_ptr< Scene > >( ps, "Scene" )
             .def(py::init<>())
 			.def( "setMesh", &Scene::setMesh )
 			.def( "computeIR", py::overload_cast<std::vector<SoundSource>&, std::vector<Listener>&, Context&>(&Scene::computeIR),
                   "A function to calculate IRs based on pre-defined sources and listeners", py::arg("_sources"), py::arg("_listeners"), py::arg("_context"))
 			.def( "computeIR", py::overload_cast<std::vector<std::vector<float>>&, std::vector<std::vector<float>>&, Context&, float, float, float>(&Scene::computeIR),
-                  "A function to calculate IRs based on source and listener locations", py::arg("_sources"), py::arg("_listeners"), py::arg("_context"), py::arg("src_radius") = 0.01, py::arg("src_power") = 1.0, py::arg("lis_radius") = 0.01 );
+                  "A function to calculate IRs based on source and listener locations", py::arg("_sources"), py::arg("_listeners"), py::arg("_context"), py::arg("src_radius") = 0.01, py::arg("src_power") = 1.0, py::arg("lis_radius") = 0.01 )
+			.def( "computeIRBatch", &Scene::computeIRBatch,
+                  "A function to calculate IRs for N x 3 source and listener location arrays into one packed float32 array",
+                  py::arg("_sources"), py::arg("_listeners"), py::arg("_context"), py::arg("src_radius") = 0.01, py::arg("src_power") = 1.0, py::arg("lis_radius") = 0.01 )
+			.def( "computeMetricsBatch", &Scene::computeMetricsBatch,
+                  "A function to calculate per-band acoustic metrics for N x 3 source and listener location arrays without synthesizing the IRs",
+                  py::arg("_sources"), py::arg("_listeners"), py::arg("_context"), py::arg("src_radius") = 0.01, py::arg("src_power") = 1.0, py::arg("lis_radius") = 0.01 )
+			.def( "computePathsBatch", &Scene::computePathsBatch,
+                  "A function to export the discrete direct, specular and diffraction paths and the diffuse energy histogram for N x 3 source and listener location arrays",
+                  py::arg("_sources"), py::arg("_listeners"), py::arg("_context"), py::arg("src_radius") = 0.01, py::arg("src_power") = 1.0, py::arg("lis_radius") = 0.01 )
+			.def( "computeIR", py::overload_cast<Context&>(&Scene::computeIR),
+                  "A function to calculate IRs for the persistent sources and listeners, reusing the propagation caches of the previous call", py::arg("_context") )
+			.def( "addSource", &Scene::addSource, py::arg("_source") )
+			.def( "addListener", &Scene::addListener, py::arg("_listener") )
+			.def( "removeSource", &Scene::removeSource, py::arg("_source") )
+			.def( "removeListener", &Scene::removeListener, py::arg("_listener") )
+			.def( "clearSources", &Scene::clearSources )
+			.def( "clearListeners", &Scene::clearListeners );
 
 	py::class_< SoundSource, std::shared_ptr< SoundSource > >( ps, "Source" )
             .def( py::init<std::vector<float>>() )
@@ -67,7 +98,9 @@ PYBIND11_MODULE(pygsound, ps)
 	py::class_< Listener, std::shared_ptr< Listener > >( ps, "Listener" )
             .def( py::init<std::vector<float>>() )
 			.def_property( "pos", &Listener::getPosition, &Listener::setPosition )
-			.def_property( "radius", &Listener::getRadius, &Listener::setRadius  );
+			.def_property( "radius", &Listener::getRadius, &Listener::setRadius  )
+			.def_property( "microphones", &Listener::getMicrophones, &Listener::setMicrophones,
+                  "Microphone positions relative to the listener in meters; a listener with microphones outputs one channel per microphone" );
 
 
 	py::enum_< oms::ChannelLayout::Type >( ps, "ChannelLayoutType" )
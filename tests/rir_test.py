@@ -2,6 +2,8 @@ import unittest
 import pygsound as ps
 import multiprocessing
 import numpy as np
+import os
+import tempfile
 
 
 def check_ir(samples):
@@ -19,6 +21,31 @@ def same_ir(ir1, ir2):
     assert corrcoef > corrcoef_thresh, "IRs are not similar"
 
 
+def box_scene(x=10, y=6, z=2):
+    scene = ps.Scene()
+    scene.setMesh(ps.createbox(x, y, z, 0.5, 0.5))
+    return scene
+
+
+def batch_irs(scene, src_locs, lis_locs, **ctx_overrides):
+    # a fresh single-threaded context for each call traces the same rays
+    ctx = ps.Context()
+    ctx.diffuse_count = 2000
+    ctx.specular_count = 2000
+    ctx.threads_count = 1
+    ctx.channel_type = ps.ChannelLayoutType.mono
+    ctx.sample_rate = 16000
+    for name, value in ctx_overrides.items():
+        setattr(ctx, name, value)
+        assert getattr(ctx, name) == value
+    return scene.computeIRBatch(np.asarray(src_locs), np.asarray(lis_locs), ctx)
+
+
+def same_batch(ref, res):
+    assert (res['lengths'] == ref['lengths']).all()
+    assert np.array_equal(res['samples'], ref['samples'])
+
+
 class MainTest(unittest.TestCase):
     def test_exception(self):
         self.assertRaises(AssertionError, check_ir, [1, 0, 0])
@@ -80,6 +107,286 @@ class MainTest(unittest.TestCase):
                 check_ir(ir2)
                 same_ir(ir1, ir2)  # IRs should be similar by reciprocity
 
+    @staticmethod
+    def test_rir_batch():
+        roomdim = [10, 10, 10]
+        src_locs = np.array([[0.5, 0.5, 0.5], [9.5, 9.5, 9.5]], dtype=np.float32)
+        lis_locs = np.array([[2.5, 0.5, 0.5], [5.0, 5.0, 5.0], [9.5, 0.5, 0.5]], dtype=np.float32)
+
+        mesh = ps.createbox(roomdim[0], roomdim[1], roomdim[2], 0.5, 0.5)
+
+        ctx = ps.Context()
+        ctx.diffuse_count = 20000
+        ctx.specular_count = 2000
+        ctx.threads_count = min(multiprocessing.cpu_count(), 8)
+        ctx.channel_type = ps.ChannelLayoutType.mono
+        ctx.sample_rate = 16000
+
+        scene = ps.Scene()
+        scene.setMesh(mesh)
+
+        res = scene.computeIRBatch(src_locs, lis_locs, ctx)
+        ref = scene.computeIR(src_locs.tolist(), lis_locs.tolist(), ctx)
+        assert res['samples'].dtype == np.float32
+        assert res['lengths'].shape == (len(src_locs), len(lis_locs))
+
+        for i_src in range(len(src_locs)):
+            for i_lis in range(len(lis_locs)):
+                offset = res['offsets'][i_src, i_lis]
+                length = res['lengths'][i_src, i_lis]
+                ir = res['samples'][offset:offset + res['channels'] * length].reshape(res['channels'], length)
+                check_ir(ir[0])
+                same_ir(ir[0], ref['samples'][i_src][i_lis][0])
+
+    @staticmethod
+    def test_metrics_batch():
+        roomdim = [10, 10, 10]
+        src_locs = np.array([[0.5, 0.5, 0.5], [9.5, 9.5, 9.5]], dtype=np.float32)
+        lis_locs = np.array([[2.5, 0.5, 0.5], [5.0, 5.0, 5.0], [9.5, 0.5, 0.5]], dtype=np.float32)
+
+        mesh = ps.createbox(roomdim[0], roomdim[1], roomdim[2], 0.5, 0.5)
+
+        ctx = ps.Context()
+        ctx.diffuse_count = 20000
+        ctx.specular_count = 2000
+        ctx.threads_count = min(multiprocessing.cpu_count(), 8)
+        ctx.sample_rate = 16000
+
+        scene = ps.Scene()
+        scene.setMesh(mesh)
+
+        res = scene.computeMetricsBatch(src_locs, lis_locs, ctx)
+        n_bands = len(res['frequencies'])
+        for name in ['t60', 'edt', 'c50', 'c80', 'd50', 'g', 'ts']:
+            assert res[name].dtype == np.float32
+            assert res[name].shape == (len(src_locs), len(lis_locs), n_bands)
+            assert np.isfinite(res[name]).all(), name + " contains NAN or INF"
+        assert (res['t60'] > 0).all(), "T60 is not positive"
+        assert ((res['d50'] >= 0) & (res['d50'] <= 1)).all(), "D50 is not a fraction"
+
+        # swapping sources and listeners must return the same layout
+        swapped = scene.computeMetricsBatch(lis_locs, src_locs, ctx)
+        assert swapped['t60'].shape == (len(lis_locs), len(src_locs), n_bands)
+
+    @staticmethod
+    def test_paths_batch():
+        mesh = ps.createbox(10, 6, 2, 0.5, 0.5)
+
+        ctx = ps.Context()
+        ctx.diffuse_count = 2000
+        ctx.specular_count = 2000
+        ctx.threads_count = min(multiprocessing.cpu_count(), 8)
+        ctx.channel_type = ps.ChannelLayoutType.mono
+        ctx.sample_rate = 16000
+
+        scene = ps.Scene()
+        scene.setMesh(mesh)
+
+        src_locs = np.array([[1, 1, 1], [5, 3, 1]])
+        lis_locs = np.array([[8.5, 5, 1.5], [2, 4, 0.5], [6, 1, 1]])
+        res = scene.computePathsBatch(src_locs, lis_locs, ctx)
+        paths = res['paths']
+        assert paths.dtype == ps.path_dtype
+        assert res['path_counts'].shape == (len(src_locs), len(lis_locs))
+        assert res['path_counts'].sum() == len(paths)
+        assert res['histogram'].shape == (res['hist_lengths'].sum(), len(res['frequencies']))
+
+        for i_src in range(len(src_locs)):
+            for i_lis in range(len(lis_locs)):
+                off, n = res['path_offsets'][i_src, i_lis], res['path_counts'][i_src, i_lis]
+                pair = paths[off:off + n]
+                assert (pair['source'] == i_src).all() and (pair['listener'] == i_lis).all()
+
+                # the shoebox is empty, so every pair has an unoccluded direct path
+                direct = pair[(pair['flags'] & 1) == 1]
+                assert len(direct) == 1
+                diff = lis_locs[i_lis] - src_locs[i_src]
+                assert abs(direct['distance'][0] - np.linalg.norm(diff)) < 0.05
+                assert np.allclose(direct['direction'][0], -diff / np.linalg.norm(diff), atol=0.02)
+
+        # swapping sources and listeners reverses the direct paths
+        swapped = scene.computePathsBatch(lis_locs, src_locs, ctx)
+        assert swapped['path_counts'].shape == (len(lis_locs), len(src_locs))
+        for i_src in range(len(src_locs)):
+            for i_lis in range(len(lis_locs)):
+                off, n = res['path_offsets'][i_src, i_lis], res['path_counts'][i_src, i_lis]
+                soff, sn = swapped['path_offsets'][i_lis, i_src], swapped['path_counts'][i_lis, i_src]
+                direct = paths[off:off + n][(paths[off:off + n]['flags'] & 1) == 1]
+                sdirect = swapped['paths'][soff:soff + sn][(swapped['paths'][soff:soff + sn]['flags'] & 1) == 1]
+                assert abs(direct['delay'][0] - sdirect['delay'][0]) < 1e-5
+                assert np.allclose(direct['direction'][0], sdirect['source_direction'][0], atol=0.02)
+
+        with tempfile.TemporaryDirectory() as tmp:
+            fname = os.path.join(tmp, 'paths.bin')
+            ps.savepaths(fname, paths[:10], res['frequencies'])
+            ps.savepaths(fname, paths[10:], res['frequencies'], _append=True)
+            loaded = ps.loadpaths(fname)
+            assert loaded['paths'].tobytes() == paths.tobytes()
+            assert np.allclose(loaded['frequencies'], res['frequencies'])
+            assert not loaded['paths'].flags.writeable
+            del loaded
+
+    @staticmethod
+    def test_loadobj_cache():
+        with tempfile.TemporaryDirectory() as tmpdir:
+            objpath = os.path.join(tmpdir, 'room.obj')
+            with open(os.path.join(tmpdir, 'room.mtl'), 'w') as f:
+                f.write('newmtl wall\nsound_a 0.3 0.3 0.3 0.3 0.3 0.3 0.3 0.3\nsound_s 0.2 0.2 0.2 0.2 0.2 0.2 0.2 0.2\n')
+            with open(objpath, 'w') as f:
+                f.write('mtllib room.mtl\nusemtl wall\n')
+                for x in [0, 8]:
+                    for y in [0, 6]:
+                        for z in [0, 3]:
+                            f.write('v {} {} {}\n'.format(x, y, z))
+                for face in [(1, 3, 2), (2, 3, 4), (5, 6, 7), (6, 8, 7), (1, 2, 5), (2, 6, 5),
+                             (3, 7, 4), (4, 7, 8), (1, 5, 3), (3, 5, 7), (2, 4, 6), (4, 8, 6)]:
+                    f.write('f {} {} {}\n'.format(*face))
+
+            cachedir = os.path.join(tmpdir, 'cache')
+            results = []
+            for _ in range(2):
+                # the first load preprocesses and caches the mesh, the second loads the cached mesh
+                scene = ps.Scene()
+                scene.setMesh(ps.loadobj(objpath, _cachedir=cachedir))
+                assert len(os.listdir(cachedir)) == 1
+                results.append(batch_irs(scene, [[1, 1, 1]], [[6, 4, 1.5]]))
+
+            same_batch(*results)
+
+            # other materials are a different cache entry
+            ps.loadobj(objpath, 0.5, _cachedir=cachedir)
+            assert len(os.listdir(cachedir)) == 2
+
+    @staticmethod
+    def test_rir_compact():
+        scene = box_scene()
+        src_locs = [[1, 1, 1]]
+        lis_locs = [[8.5, 5, 1.5], [2, 4, 0.5], [6, 1, 1]]
+        ref = batch_irs(scene, src_locs, lis_locs, compact_ir=False)
+        res = batch_irs(scene, src_locs, lis_locs, compact_ir=True)
+
+        # the compact IRs are only stored at lower precision, so they synthesize almost the same waveforms
+        assert (res['lengths'] == ref['lengths']).all()
+        peak = np.max(np.abs(ref['samples']))
+        assert np.max(np.abs(res['samples'] - ref['samples'])) < 1e-2 * peak
+
+    @staticmethod
+    def test_rir_listener_parallel():
+        scene = box_scene()
+
+        # the batch propagates from whichever side has fewer locations, so both sides are grids
+        src_locs = [[x, 1, 1] for x in np.linspace(1, 9, 8)]
+        lis_locs = [[x, y, 1.2] for x in np.linspace(2, 8, 4) for y in [2.5, 4.5]]
+
+        # many listeners with few rays are propagated one listener per thread,
+        # and each listener traces the same rays as in a single-threaded run
+        ref = batch_irs(scene, src_locs, lis_locs, diffuse_count=200, specular_count=200)
+        res = batch_irs(scene, src_locs, lis_locs, diffuse_count=200, specular_count=200, threads_count=4)
+        same_batch(ref, res)
+
+    @staticmethod
+    def test_rir_direct_parallel():
+        scene = box_scene()
+        src_locs = [[x, y, 1] for x in np.linspace(1, 9, 8) for y in np.linspace(1, 5, 8)]
+        lis_locs = [[5, 3, 1.2]]
+
+        # with no rays traced, the IRs contain only the direct paths, which are split between the threads
+        ref = batch_irs(scene, src_locs, lis_locs, diffuse_count=0, specular_count=0)
+        res = batch_irs(scene, src_locs, lis_locs, diffuse_count=0, specular_count=0, threads_count=4)
+        assert (ref['lengths'] > 0).all()
+        same_batch(ref, res)
+
+    @staticmethod
+    def test_rir_stateful():
+        roomdim = [10, 10, 10]
+        mesh = ps.createbox(roomdim[0], roomdim[1], roomdim[2], 0.5, 0.5)
+
+        ctx = ps.Context()
+        ctx.diffuse_count = 20000
+        ctx.specular_count = 2000
+        ctx.threads_count = min(multiprocessing.cpu_count(), 8)
+        ctx.channel_type = ps.ChannelLayoutType.mono
+        ctx.sample_rate = 16000
+
+        scene = ps.Scene()
+        scene.setMesh(mesh)
+
+        src = ps.Source([0.5, 0.5, 0.5])
+        lis = ps.Listener([2.5, 0.5, 0.5])
+        scene.addSource(src)
+        scene.addListener(lis)
+
+        for step in range(5):
+            lis.pos = [2.5 + 0.05 * step, 0.5, 0.5]
+            res = scene.computeIR(ctx)
+            assert len(res['samples']) == 1 and len(res['samples'][0]) == 1
+            check_ir(res['samples'][0][0][0])
+
+        # a stateless call in between must leave the persistent handles in the scene
+        # (with a shared context it does evict their caches, so both IRs here start cold)
+        ref = scene.computeIR([src.pos], [lis.pos], ctx)
+        res = scene.computeIR(ctx)
+        same_ir(res['samples'][0][0][0], ref['samples'][0][0][0])
+
+        assert scene.removeListener(lis)
+        assert not scene.removeListener(lis)
+        scene.clearSources()
+
+    @staticmethod
+    def test_rir_microphones():
+        mesh = ps.createbox(10, 10, 10, 0.5, 0.5)
+
+        ctx = ps.Context()
+        ctx.diffuse_count = 2000
+        ctx.specular_count = 2000
+        ctx.threads_count = min(multiprocessing.cpu_count(), 8)
+        ctx.channel_type = ps.ChannelLayoutType.mono
+        ctx.sample_rate = 16000
+
+        scene = ps.Scene()
+        scene.setMesh(mesh)
+
+        mics = [[0.5, 0, 0], [-0.5, 0, 0], [0, 0.5, 0], [0, -0.5, 0], [0, 0, 0.5], [0, 0, -0.5]]
+        src = ps.Source([2.5, 5, 5])
+        lis = ps.Listener([5.5, 5, 5])
+        lis.microphones = mics
+        assert np.allclose(lis.microphones, mics)
+
+        res = scene.computeIR([src], [lis], ctx)
+        channels = res['samples'][0][0]
+        assert len(channels) == len(mics)
+        for ch in channels:
+            check_ir(ch)
+
+        # the direct sound reaches the microphone facing the source first
+        first = [int(np.argmax(np.abs(np.asarray(ch)) > 1e-6)) for ch in channels]
+        assert first[1] < first[0]
+        assert abs(first[1] - (2.5 / 343.0) * 16000) <= 3
+
+    @staticmethod
+    def test_rir_microphone_occluded():
+        # the walls absorb all sound, so the IRs contain only the direct sound
+        scene = ps.Scene()
+        scene.setMesh(ps.createbox(10, 10, 10, 1.0, 0.0))
+
+        ctx = ps.Context()
+        ctx.diffuse_count = 200
+        ctx.specular_count = 200
+        ctx.threads_count = 1
+        ctx.channel_type = ps.ChannelLayoutType.mono
+        ctx.sample_rate = 16000
+        ctx.normalize = False
+
+        # the first microphone is outside of the room, behind the wall between it and the source
+        src = ps.Source([2, 5, 5])
+        lis = ps.Listener([9.5, 5, 5])
+        lis.microphones = [[1, 0, 0], [-1, 0, 0]]
+
+        res = scene.computeIR([src], [lis], ctx)
+        occluded, visible = [np.asarray(ch) for ch in res['samples'][0][0]]
+        check_ir(visible)
+        assert np.max(np.abs(occluded)) < 1e-6 * np.max(np.abs(visible))
+
 
 def compute_scene_ir_absorb(roomdim, tasks, r):
     # Initialize scene mesh